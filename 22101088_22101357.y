@@ -3,6 +3,28 @@
 #include "symbol_table.h"
 #include "ast.h"
 #include "three_addr_code.h"
+#include "ast_passes.h"
+#include "compiler.h"
+#include "mapped_source.h"
+#include "flat_ast_file.h"
+#include "output_buffer.h"
+#include "ast_bench.h"
+#include "batch_driver.h"
+#include "compile_server.h"
+#include "tac_vm.h"
+#include "tac_threaded.h"
+#include "tac_bytecode.h"
+#include "tac_native.h"
+#include "tac_jit.h"
+#include "tac_c_backend.h"
+#include "tac_profile.h"
+#include "tac_layout.h"
+#include "tac_census.h"
+#include "ast_stress.h"
+#include "incremental.h"
+#include "compile_cache.h"
+#include "watch_mode.h"
+#include "program_generator.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -10,17 +32,44 @@
 /* Define the type for all grammar symbols */
 #define YYSTYPE symbol_info*
 
+/* Bison only grows its stacks in C++ when it's told the value type can
+   be copied as raw bytes, which a pointer can. Without this they stay at
+   200 entries and a few hundred nested parentheses or ifs fail with
+   "memory exhausted". Past bison's default 10000 entries, only memory
+   limits nesting. */
+#define YYSTYPE_IS_TRIVIAL 1
+#define YYMAXDEPTH 100000000
+
 extern FILE *yyin;
+void yyrestart(FILE *input_file);
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+YY_BUFFER_STATE yy_scan_buffer(char *base, unsigned int size);
+void yy_delete_buffer(YY_BUFFER_STATE b);
 int yyparse(void);
 int yylex(void);
 extern YYSTYPE yylval;
+extern char *yytext;
+extern int yyleng;
 
 symbol_table *symtbl = new symbol_table();
 ProgramNode* ast_root = new ProgramNode();
+FlatAst flat_ast; // built alongside the node tree while flat_ast.enabled is set
+bool lower_flat_ast = false; // --flat-ast: generate code from flat_ast instead
+bool time_passes = false; // --time-passes: print the pass timing after compiling
 
 int lines = 1;
 int errors = 0;
-ofstream outlog, outerror, outcode;
+// The output streams get attached to files (compile_file) or to in-memory
+// sinks (compile_in_place) before each compilation
+ostream outlog(NULL), outerror(NULL), outcode(NULL);
+OutputBuffer log_out, error_out, code_out;
+
+bool scan_mapped = false; // --mmap: map input files instead of reading them through yyin
+bool emit_bytecode = false; // --bytecode: also write code.bin next to code.txt
+string pgo_profile; // --pgo FILE: lay code.txt out for this profile
+string emit_ast_path; // --emit-ast FILE: also save the flat tree there
+string cache_dir; // --cache DIR: reuse the outputs of earlier identical compiles
+size_t cache_max_mb = 256; // --cache-size MB: bound on the cache directory
 
 string varlist=""; //for variable declarartion list
 vector<string>paramlist; //for parameter list fot func dec and func def
@@ -33,8 +82,8 @@ string ret_type, func_name, func_ret_type;
 
 void yyerror(char *s)
 {
-	outlog<<"At line "<<lines<<" "<<s<<endl<<endl;
-	outerror<<"At line "<<lines<<" "<<s<<endl<<endl;
+	outlog<<"At line "<<lines<<" "<<s<<"\n\n";
+	outerror<<"At line "<<lines<<" "<<s<<"\n\n";
 	errors++;
 	
 	varlist = "";
@@ -59,21 +108,22 @@ void yyerror(char *s)
 
 start : program
 	{
-		outlog<<"At line no: "<<lines<<" start : program "<<endl<<endl;
-		outlog<<"Symbol Table"<<endl<<endl;
+		outlog<<"At line no: "<<lines<<" start : program "<<"\n\n";
+		outlog<<"Symbol Table"<<"\n\n";
 		
 		symtbl->Print_all_scope(outlog);
 		
 		$$ = $1;
 		// Root of AST is the program node
 		ast_root = (ProgramNode*)$1->get_ast_node();
+		flat_ast.root = $1->get_flat_node();
 	}
 	;
 
 program : program unit
 	{
-		outlog<<"At line no: "<<lines<<" program : program unit "<<endl<<endl;
-		outlog<<$1->getname()+"\n"+$2->getname()<<endl<<endl;
+		outlog<<"At line no: "<<lines<<" program : program unit "<<"\n\n";
+		outlog<<$1->getname()+"\n"+$2->getname()<<"\n\n";
 		
 		$$ = new symbol_info($1->getname()+"\n"+$2->getname(),"program");
 		
@@ -91,11 +141,15 @@ program : program unit
 		}
 		
 		$$->set_ast_node(prog);
+		
+		uint32_t flat_prog = $1->get_flat_node() != FLAT_NONE ? $1->get_flat_node() : flat_ast.program();
+		flat_ast.append(flat_prog, $2->get_flat_node());
+		$$->set_flat_node(flat_prog);
 	}
 	| unit
 	{
-		outlog<<"At line no: "<<lines<<" program : unit "<<endl<<endl;
-		outlog<<$1->getname()<<endl<<endl;
+		outlog<<"At line no: "<<lines<<" program : unit "<<"\n\n";
+		outlog<<$1->getname()<<"\n\n";
 		
 		$$ = new symbol_info($1->getname(),"program");
 		
@@ -105,24 +159,30 @@ program : program unit
 			prog->add_unit($1->get_ast_node());
 		}
 		$$->set_ast_node(prog);
+		
+		uint32_t flat_prog = flat_ast.program();
+		flat_ast.append(flat_prog, $1->get_flat_node());
+		$$->set_flat_node(flat_prog);
 	}
 	;
 
 unit : var_declaration
 	 {
-		outlog<<"At line no: "<<lines<<" unit : var_declaration "<<endl<<endl;
-		outlog<<$1->getname()<<endl<<endl;
+		outlog<<"At line no: "<<lines<<" unit : var_declaration "<<"\n\n";
+		outlog<<$1->getname()<<"\n\n";
 		
 		$$ = new symbol_info($1->getname(),"unit");
 		$$->set_ast_node($1->get_ast_node());
+		$$->set_flat_node($1->get_flat_node());
 	 }
      | func_definition
      {
-		outlog<<"At line no: "<<lines<<" unit : func_definition "<<endl<<endl;
-		outlog<<$1->getname()<<endl<<endl;
+		outlog<<"At line no: "<<lines<<" unit : func_definition "<<"\n\n";
+		outlog<<$1->getname()<<"\n\n";
 		
 		$$ = new symbol_info($1->getname(),"unit");
 		$$->set_ast_node($1->get_ast_node());
+		$$->set_flat_node($1->get_flat_node());
 	 }
 	 | error
 	 {
@@ -132,18 +192,21 @@ unit : var_declaration
 
 func_definition : type_specifier id_name LPAREN parameter_list RPAREN enter_func compound_statement
 		{	
-			outlog<<"At line no: "<<lines<<" func_definition : type_specifier ID LPAREN parameter_list RPAREN compound_statement "<<endl<<endl;
-			outlog<<$1->getname()<<" "<<$2->getname()<<"("+$4->getname()+")\n"<<$7->getname()<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" func_definition : type_specifier ID LPAREN parameter_list RPAREN compound_statement "<<"\n\n";
+			outlog<<$1->getname()<<" "<<$2->getname()<<"("+$4->getname()+")\n"<<$7->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+" "+$2->getname()+"("+$4->getname()+")\n"+$7->getname(),"func_def");	
 			
 			// Create AST node for function definition
 			FuncDeclNode* func = new FuncDeclNode($1->getname(), $2->getname());
 			
+			uint32_t flat_func = flat_ast.func($1->getname(), $2->getname());
+			
 			// Add parameters
 			for(int i = 0; i < paramlist.size(); i++) {
 				if(paramname[i] != "_null_") {
 					func->add_param(paramlist[i], paramname[i]);
+					flat_ast.append(flat_func, flat_ast.param(paramlist[i], paramname[i]));
 				}
 			}
 			
@@ -151,8 +214,10 @@ func_definition : type_specifier id_name LPAREN parameter_list RPAREN enter_func
 			if($7->get_ast_node()) {
 				func->set_body((BlockNode*)$7->get_ast_node());
 			}
+			flat_ast.set_body(flat_func, $7->get_flat_node());
 			
 			$$->set_ast_node(func);
+			$$->set_flat_node(flat_func);
 			
 			if(symtbl->getID()!=1)
 			{
@@ -165,8 +230,8 @@ func_definition : type_specifier id_name LPAREN parameter_list RPAREN enter_func
 		| type_specifier id_name LPAREN RPAREN enter_func compound_statement
 		{
 			
-			outlog<<"At line no: "<<lines<<" func_definition : type_specifier ID LPAREN RPAREN compound_statement "<<endl<<endl;
-			outlog<<$1->getname()<<" "<<$2->getname()<<"()\n"<<$6->getname()<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" func_definition : type_specifier ID LPAREN RPAREN compound_statement "<<"\n\n";
+			outlog<<$1->getname()<<" "<<$2->getname()<<"()\n"<<$6->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+" "+$2->getname()+"()\n"+$6->getname(),"func_def");	
 			
@@ -180,6 +245,10 @@ func_definition : type_specifier id_name LPAREN parameter_list RPAREN enter_func
 			
 			$$->set_ast_node(func);
 			
+			uint32_t flat_func = flat_ast.func($1->getname(), $2->getname());
+			flat_ast.set_body(flat_func, $6->get_flat_node());
+			$$->set_flat_node(flat_func);
+			
 			if(symtbl->getID()!=1)
 			{
 				symtbl->Remove_from_table($2->getname());
@@ -201,8 +270,8 @@ enter_func : {
 					{
 						if(paramname[i]=="_null_")
 						{
-							outerror<<"At line no: "<<lines<<" Parameter "<<i+1<<"'s name not given in function definition of "<<func_name<<endl<<endl;
-							outlog<<"At line no: "<<lines<<" Parameter "<<i+1<<"'s name not given in function definition of "<<func_name<<endl<<endl;
+							outerror<<"At line no: "<<lines<<" Parameter "<<i+1<<"'s name not given in function definition of "<<func_name<<"\n\n";
+							outlog<<"At line no: "<<lines<<" Parameter "<<i+1<<"'s name not given in function definition of "<<func_name<<"\n\n";
 							errors++;
 						}
 					}
@@ -218,16 +287,16 @@ enter_func : {
 				}
 				else
 				{
-					outerror<<"At line no: "<<lines<<" Multiple declaration of function "<<func_name<<endl<<endl;
-					outlog<<"At line no: "<<lines<<" Multiple declaration of function "<<func_name<<endl<<endl;
+					outerror<<"At line no: "<<lines<<" Multiple declaration of function "<<func_name<<"\n\n";
+					outlog<<"At line no: "<<lines<<" Multiple declaration of function "<<func_name<<"\n\n";
 					errors++;
 					// (symtbl->Lookup_in_table(func_name))->setidtype("func_def");
 				}
 					
 				if((symtbl->Lookup_in_table(func_name))->getvartype() != func_ret_type)
 				{
-					outerror<<"At line no: "<<lines<<" Return type mismatch of function "<<func_name<<endl<<endl;
-					outlog<<"At line no: "<<lines<<" Return type mismatch of function "<<func_name<<endl<<endl;
+					outerror<<"At line no: "<<lines<<" Return type mismatch of function "<<func_name<<"\n\n";
+					outlog<<"At line no: "<<lines<<" Return type mismatch of function "<<func_name<<"\n\n";
 					errors++;
 				}
 				
@@ -238,15 +307,15 @@ enter_func : {
 
 parameter_list : parameter_list COMMA type_specifier ID
 		{
-			outlog<<"At line no: "<<lines<<" parameter_list : parameter_list COMMA type_specifier ID "<<endl<<endl;
-			outlog<<$1->getname()+","+$3->getname()+" "+$4->getname()<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" parameter_list : parameter_list COMMA type_specifier ID "<<"\n\n";
+			outlog<<$1->getname()+","+$3->getname()+" "+$4->getname()<<"\n\n";
 					
 			$$ = new symbol_info($1->getname()+","+$3->getname()+" "+$4->getname(),"param_list");
 			
 			if(count(paramname.begin(),paramname.end(),$4->getname()))
 			{
-				outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<$4->getname()<<" in parameter of "<<func_name<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<$4->getname()<<" in parameter of "<<func_name<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<$4->getname()<<" in parameter of "<<func_name<<"\n\n";
+				outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<$4->getname()<<" in parameter of "<<func_name<<"\n\n";
 				errors++;
 			}
 			
@@ -255,8 +324,8 @@ parameter_list : parameter_list COMMA type_specifier ID
 		}
 		| parameter_list COMMA type_specifier
 		{
-			outlog<<"At line no: "<<lines<<" parameter_list : parameter_list COMMA type_specifier "<<endl<<endl;
-			outlog<<$1->getname()+","+$3->getname()<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" parameter_list : parameter_list COMMA type_specifier "<<"\n\n";
+			outlog<<$1->getname()+","+$3->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+","+$3->getname(),"param_list");
 			
@@ -265,8 +334,8 @@ parameter_list : parameter_list COMMA type_specifier ID
 		}
  		| type_specifier ID
  		{
-			outlog<<"At line no: "<<lines<<" parameter_list : type_specifier ID "<<endl<<endl;
-			outlog<<$1->getname()<<" "<<$2->getname()<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" parameter_list : type_specifier ID "<<"\n\n";
+			outlog<<$1->getname()<<" "<<$2->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+" "+$2->getname(),"param_list");
 			
@@ -275,8 +344,8 @@ parameter_list : parameter_list COMMA type_specifier ID
 		}
 		| type_specifier
 		{
-			outlog<<"At line no: "<<lines<<" parameter_list : type_specifier "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" parameter_list : type_specifier "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"param_list");
 			
@@ -287,27 +356,29 @@ parameter_list : parameter_list COMMA type_specifier ID
 
 compound_statement : LCURL enter_scope_variables statements RCURL
 			{ 
- 		    	outlog<<"At line no: "<<lines<<" compound_statement : LCURL statements RCURL "<<endl<<endl;
-				outlog<<"{\n"+$3->getname()+"\n}"<<endl<<endl;
+ 		    	outlog<<"At line no: "<<lines<<" compound_statement : LCURL statements RCURL "<<"\n\n";
+				outlog<<"{\n"+$3->getname()+"\n}"<<"\n\n";
 				
 				$$ = new symbol_info("{\n"+$3->getname()+"\n}","comp_stmnt");
 				
 				// Set AST node for compound statement
 				$$->set_ast_node($3->get_ast_node());
+				$$->set_flat_node($3->get_flat_node());
 				
 				symtbl->Print_all_scope(outlog);
 			    symtbl->exit_scope(outlog);
  		    }
  		    | LCURL enter_scope_variables RCURL
  		    { 
- 		    	outlog<<"At line no: "<<lines<<" compound_statement : LCURL RCURL "<<endl<<endl;
-				outlog<<"{\n}"<<endl<<endl;
+ 		    	outlog<<"At line no: "<<lines<<" compound_statement : LCURL RCURL "<<"\n\n";
+				outlog<<"{\n}"<<"\n\n";
 				
 				$$ = new symbol_info("{\n}","comp_stmnt");
 				
 				// Create empty block node
 				BlockNode* block = new BlockNode();
 				$$->set_ast_node(block);
+				$$->set_flat_node(flat_ast.block());
 				
 				symtbl->Print_all_scope(outlog);
 			    symtbl->exit_scope(outlog);
@@ -340,21 +411,22 @@ enter_scope_variables :
  		    
 var_declaration : type_specifier declaration_list SEMICOLON
 		 {
-			outlog<<"At line no: "<<lines<<" var_declaration : type_specifier declaration_list SEMICOLON "<<endl<<endl;
-			outlog<<$1->getname()<<" "<<varlist<<";"<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" var_declaration : type_specifier declaration_list SEMICOLON "<<"\n\n";
+			outlog<<$1->getname()<<" "<<varlist<<";"<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+" "+varlist+";","var_dec");
 			
 			if($1->getname()=="void")
 			{
-				outerror<<"At line no: "<<lines<<" variable type can not be void "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" variable type can not be void "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" variable type can not be void "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" variable type can not be void "<<"\n\n";
 				errors++;
 				$1 = new symbol_info("error","type"); //variable is declared void so pass error instead
 			}
 			
 			// Create AST node for variable declaration
 			DeclNode* declNode = new DeclNode($1->getname());
+			uint32_t flat_decl = flat_ast.decl($1->getname());
 			
 			// Parse the varlist to add variables to the declaration node
 			stringstream _varlist(varlist);
@@ -365,6 +437,7 @@ var_declaration : type_specifier declaration_list SEMICOLON
 				if(varname.find("[") == string::npos) // normal variable
 				{
 					declNode->add_var(varname, 0);
+					flat_ast.append(flat_decl, flat_ast.decl_var(varname, 0));
 					
 					if(symtbl->Insert_in_table(varname,"ID"))
 					{
@@ -373,8 +446,8 @@ var_declaration : type_specifier declaration_list SEMICOLON
 					}
 					else
 					{
-						outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<varname<<endl<<endl;
-						outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<varname<<endl<<endl;
+						outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<varname<<"\n\n";
+						outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<varname<<"\n\n";
 						errors++;
 					}
 				}
@@ -387,6 +460,7 @@ var_declaration : type_specifier declaration_list SEMICOLON
 					getline(_varname,size,']'); // get array size
 					
 					declNode->add_var(name, stoi(size));
+					flat_ast.append(flat_decl, flat_ast.decl_var(name, stoi(size)));
 					
 					if(symtbl->Insert_in_table(name,"ID"))
 					{
@@ -396,38 +470,39 @@ var_declaration : type_specifier declaration_list SEMICOLON
 					}
 					else
 					{
-						outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<name<<endl<<endl;
-						outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<name<<endl<<endl;
+						outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<name<<"\n\n";
+						outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<name<<"\n\n";
 						errors++;
 					}
 				}
 			}
 			
 			$$->set_ast_node(declNode);
+			$$->set_flat_node(flat_decl);
 			varlist = "";
 		 }
  		 ;
 
 type_specifier : INT
 		{
-			outlog<<"At line no: "<<lines<<" type_specifier : INT "<<endl<<endl;
-			outlog<<"int"<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" type_specifier : INT "<<"\n\n";
+			outlog<<"int"<<"\n\n";
 			
 			$$ = new symbol_info("int","type");
 			ret_type = "int";
 	    }
  		| FLOAT
  		{
-			outlog<<"At line no: "<<lines<<" type_specifier : FLOAT "<<endl<<endl;
-			outlog<<"float"<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" type_specifier : FLOAT "<<"\n\n";
+			outlog<<"float"<<"\n\n";
 			
 			$$ = new symbol_info("float","type");
 			ret_type = "float";
 	    }
  		| VOID
  		{
-			outlog<<"At line no: "<<lines<<" type_specifier : VOID "<<endl<<endl;
-			outlog<<"void"<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" type_specifier : VOID "<<"\n\n";
+			outlog<<"void"<<"\n\n";
 			
 			$$ = new symbol_info("void","type");
 			ret_type = "void";
@@ -437,11 +512,11 @@ type_specifier : INT
 declaration_list : declaration_list COMMA id_name
 		  {
  		  	string name = $3->getname();
- 		  	outlog<<"At line no: "<<lines<<" declaration_list : declaration_list COMMA ID "<<endl<<endl;
+ 		  	outlog<<"At line no: "<<lines<<" declaration_list : declaration_list COMMA ID "<<"\n\n";
  		  	
  		  	varlist=varlist+","+name;
  		  	
-			outlog<<varlist<<endl<<endl;
+			outlog<<varlist<<"\n\n";
 			
 			$$ = new symbol_info(varlist,"decl_list");
  		  }
@@ -449,19 +524,19 @@ declaration_list : declaration_list COMMA id_name
  		  {
  		  	string name = $3->getname();
  		  	string size = $5->getname();
- 		  	outlog<<"At line no: "<<lines<<" declaration_list : declaration_list COMMA ID LTHIRD CONST_INT RTHIRD "<<endl<<endl;
+ 		  	outlog<<"At line no: "<<lines<<" declaration_list : declaration_list COMMA ID LTHIRD CONST_INT RTHIRD "<<"\n\n";
  		  	
  		  	varlist=varlist+","+name+"["+size+"]";
  		  	
-			outlog<<varlist<<endl<<endl;
+			outlog<<varlist<<"\n\n";
 			
 			$$ = new symbol_info(varlist,"decl_list");
  		  }
  		  |id_name
  		  {
  		  	string name = $1->getname();
- 		  	outlog<<"At line no: "<<lines<<" declaration_list : ID "<<endl<<endl;
-			outlog<<name<<endl<<endl;
+ 		  	outlog<<"At line no: "<<lines<<" declaration_list : ID "<<"\n\n";
+			outlog<<name<<"\n\n";
 			
 			varlist+=name;
 			
@@ -471,8 +546,8 @@ declaration_list : declaration_list COMMA id_name
  		  {
  		  	string name = $1->getname();
  		  	string size = $3->getname();
- 		  	outlog<<"At line no: "<<lines<<" declaration_list : ID LTHIRD CONST_INT RTHIRD "<<endl<<endl;
-			outlog<<name+"["+size+"]"<<endl<<endl;
+ 		  	outlog<<"At line no: "<<lines<<" declaration_list : ID LTHIRD CONST_INT RTHIRD "<<"\n\n";
+			outlog<<name+"["+size+"]"<<"\n\n";
 			
 			varlist=varlist+name+"["+size+"]";
 			
@@ -489,8 +564,8 @@ id_name : ID
 
 statements : statement
 	   {
-	    	outlog<<"At line no: "<<lines<<" statements : statement "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" statements : statement "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"stmnts");
 			
@@ -500,11 +575,15 @@ statements : statement
 				block->add_statement((StmtNode*)$1->get_ast_node());
 			}
 			$$->set_ast_node(block);
+			
+			uint32_t flat_block = flat_ast.block();
+			flat_ast.append(flat_block, $1->get_flat_node());
+			$$->set_flat_node(flat_block);
 	   }
 	   | statements statement
 	   {
-	    	outlog<<"At line no: "<<lines<<" statements : statements statement "<<endl<<endl;
-			outlog<<$1->getname()<<"\n"<<$2->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" statements : statements statement "<<"\n\n";
+			outlog<<$1->getname()<<"\n"<<$2->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+"\n"+$2->getname(),"stmnts");
 			
@@ -514,72 +593,81 @@ statements : statement
 				block->add_statement((StmtNode*)$2->get_ast_node());
 			}
 			$$->set_ast_node(block);
+			
+			flat_ast.append($1->get_flat_node(), $2->get_flat_node());
+			$$->set_flat_node($1->get_flat_node());
 	   }
 	   | error
 	   {
 	  		$$ = new symbol_info("","stmnts");
 			BlockNode* block = new BlockNode();
 			$$->set_ast_node(block);
+			$$->set_flat_node(flat_ast.block());
 	   }  
 	   | statements error
 	   {
 	   		$$ = new symbol_info($1->getname(),"stmnts");
 			$$->set_ast_node($1->get_ast_node());
+			$$->set_flat_node($1->get_flat_node());
 	   }
 	   ;
 	   
 statement : var_declaration
 	  {
-	    	outlog<<"At line no: "<<lines<<" statement : var_declaration "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" statement : var_declaration "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"stmnt");
 			$$->set_ast_node($1->get_ast_node());
+			$$->set_flat_node($1->get_flat_node());
 	  }
 	  | func_definition
 	  {
-	  		outlog<<"At line no: "<<lines<<" Function definition must be in the global scope "<<endl<<endl;
-	  		outerror<<"At line no: "<<lines<<" Function definition must be in the global scope "<<endl<<endl;
+	  		outlog<<"At line no: "<<lines<<" Function definition must be in the global scope "<<"\n\n";
+	  		outerror<<"At line no: "<<lines<<" Function definition must be in the global scope "<<"\n\n";
 	  		errors++;
 	  		$$ = new symbol_info("","stmnt");
 	  		
 	  }
 	  | expression_statement
 	  {
-	    	outlog<<"At line no: "<<lines<<" statement : expression_statement "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" statement : expression_statement "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"stmnt");
 			$$->set_ast_node($1->get_ast_node());
+			$$->set_flat_node($1->get_flat_node());
 	  }
 	  | compound_statement
 	  {
-	    	outlog<<"At line no: "<<lines<<" statement : compound_statement "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" statement : compound_statement "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"stmnt");
 			$$->set_ast_node($1->get_ast_node());
+			$$->set_flat_node($1->get_flat_node());
 	  }
 	  | FOR LPAREN expression_statement expression_statement expression RPAREN statement
 	  {
-	    	outlog<<"At line no: "<<lines<<" statement : FOR LPAREN expression_statement expression_statement expression RPAREN statement "<<endl<<endl;
-			outlog<<"for("<<$3->getname()<<$4->getname()<<$5->getname()<<")\n"<<$7->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" statement : FOR LPAREN expression_statement expression_statement expression RPAREN statement "<<"\n\n";
+			outlog<<"for("<<$3->getname()<<$4->getname()<<$5->getname()<<")\n"<<$7->getname()<<"\n\n";
 			
 			$$ = new symbol_info("for("+$3->getname()+$4->getname()+$5->getname()+")\n"+$7->getname(),"stmnt");
 			
 			// Create AST node for for loop
 			ForNode* forNode = new ForNode(
-				(ExprNode*)$3->get_ast_node(),
-				(ExprNode*)$4->get_ast_node(),
+				ast_cast<ExprStmtNode>($3->get_ast_node()),
+				ast_cast<ExprStmtNode>($4->get_ast_node()),
 				(ExprNode*)$5->get_ast_node(),
 				(StmtNode*)$7->get_ast_node()
 			);
 			$$->set_ast_node(forNode);
+			$$->set_flat_node(flat_ast.for_stmt($3->get_flat_node(), $4->get_flat_node(), $5->get_flat_node(), $7->get_flat_node()));
 	  }
 	  | IF LPAREN expression RPAREN statement %prec LOWER_THAN_ELSE
 	  {
-	    	outlog<<"At line no: "<<lines<<" statement : IF LPAREN expression RPAREN statement "<<endl<<endl;
-			outlog<<"if("<<$3->getname()<<")\n"<<$5->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" statement : IF LPAREN expression RPAREN statement "<<"\n\n";
+			outlog<<"if("<<$3->getname()<<")\n"<<$5->getname()<<"\n\n";
 			
 			$$ = new symbol_info("if("+$3->getname()+")\n"+$5->getname(),"stmnt");
 			
@@ -589,11 +677,12 @@ statement : var_declaration
 				(StmtNode*)$5->get_ast_node()
 			);
 			$$->set_ast_node(ifNode);
+			$$->set_flat_node(flat_ast.if_stmt($3->get_flat_node(), $5->get_flat_node()));
 	  }
 	  | IF LPAREN expression RPAREN statement ELSE statement
 	  {
-	    	outlog<<"At line no: "<<lines<<" statement : IF LPAREN expression RPAREN statement ELSE statement "<<endl<<endl;
-			outlog<<"if("<<$3->getname()<<")\n"<<$5->getname()<<"\nelse\n"<<$7->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" statement : IF LPAREN expression RPAREN statement ELSE statement "<<"\n\n";
+			outlog<<"if("<<$3->getname()<<")\n"<<$5->getname()<<"\nelse\n"<<$7->getname()<<"\n\n";
 			
 			$$ = new symbol_info("if("+$3->getname()+")\n"+$5->getname()+"\nelse\n"+$7->getname(),"stmnt");
 			
@@ -604,11 +693,12 @@ statement : var_declaration
 				(StmtNode*)$7->get_ast_node()
 			);
 			$$->set_ast_node(ifNode);
+			$$->set_flat_node(flat_ast.if_stmt($3->get_flat_node(), $5->get_flat_node(), $7->get_flat_node()));
 	  }
 	  | WHILE LPAREN expression RPAREN statement
 	  {
-	    	outlog<<"At line no: "<<lines<<" statement : WHILE LPAREN expression RPAREN statement "<<endl<<endl;
-			outlog<<"while("<<$3->getname()<<")\n"<<$5->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" statement : WHILE LPAREN expression RPAREN statement "<<"\n\n";
+			outlog<<"while("<<$3->getname()<<")\n"<<$5->getname()<<"\n\n";
 			
 			$$ = new symbol_info("while("+$3->getname()+")\n"+$5->getname(),"stmnt");
 			
@@ -618,16 +708,17 @@ statement : var_declaration
 				(StmtNode*)$5->get_ast_node()
 			);
 			$$->set_ast_node(whileNode);
+			$$->set_flat_node(flat_ast.while_stmt($3->get_flat_node(), $5->get_flat_node()));
 	  }
 	  | PRINTLN LPAREN id_name RPAREN SEMICOLON
 	  {
-	    	outlog<<"At line no: "<<lines<<" statement : PRINTLN LPAREN ID RPAREN SEMICOLON "<<endl<<endl;
-			outlog<<"printf("<<$3->getname()<<");"<<endl<<endl; 
+	    	outlog<<"At line no: "<<lines<<" statement : PRINTLN LPAREN ID RPAREN SEMICOLON "<<"\n\n";
+			outlog<<"printf("<<$3->getname()<<");"<<"\n\n"; 
 			
 			if(symtbl->Lookup_in_table($3->getname()) == NULL)
 			{
-				outerror<<"At line no: "<<lines<<" Undeclared variable "<<$3->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" Undeclared variable "<<$3->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" Undeclared variable "<<$3->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" Undeclared variable "<<$3->getname()<<"\n\n";
 				errors++;
 			}
 			
@@ -640,55 +731,59 @@ statement : var_declaration
 			                         symtbl->Lookup_in_table($3->getname())->getvartype() : "error");
 			ExprStmtNode* printNode = new ExprStmtNode(var);
 			$$->set_ast_node(printNode);
+			$$->set_flat_node(flat_ast.expr_stmt(flat_ast.var($3->getname(), var->get_type())));
 	  }
 	  | RETURN expression SEMICOLON
 	  {
-	    	outlog<<"At line no: "<<lines<<" statement : RETURN expression SEMICOLON "<<endl<<endl;
-			outlog<<"return "<<$2->getname()<<";"<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" statement : RETURN expression SEMICOLON "<<"\n\n";
+			outlog<<"return "<<$2->getname()<<";"<<"\n\n";
 			
 			$$ = new symbol_info("return "+$2->getname()+";","stmnt");
 			
 			// Create AST node for return statement
 			ReturnNode* returnNode = new ReturnNode((ExprNode*)$2->get_ast_node());
 			$$->set_ast_node(returnNode);
+			$$->set_flat_node(flat_ast.return_stmt($2->get_flat_node()));
 	  }
 	  ;
 	  
 expression_statement : SEMICOLON
 			{
-				outlog<<"At line no: "<<lines<<" expression_statement : SEMICOLON "<<endl<<endl;
-				outlog<<";"<<endl<<endl;
+				outlog<<"At line no: "<<lines<<" expression_statement : SEMICOLON "<<"\n\n";
+				outlog<<";"<<"\n\n";
 				
 				$$ = new symbol_info(";","expr_stmt");
 				
 				// Create empty expression statement
 				ExprStmtNode* exprStmt = new ExprStmtNode(nullptr);
 				$$->set_ast_node(exprStmt);
+				$$->set_flat_node(flat_ast.expr_stmt(FLAT_NONE));
 	        }			
 			| expression SEMICOLON 
 			{
-				outlog<<"At line no: "<<lines<<" expression_statement : expression SEMICOLON "<<endl<<endl;
-				outlog<<$1->getname()<<";"<<endl<<endl;
+				outlog<<"At line no: "<<lines<<" expression_statement : expression SEMICOLON "<<"\n\n";
+				outlog<<$1->getname()<<";"<<"\n\n";
 				
 				$$ = new symbol_info($1->getname()+";","expr_stmt");
 				
 				// Create expression statement from expression
 				ExprStmtNode* exprStmt = new ExprStmtNode((ExprNode*)$1->get_ast_node());
 				$$->set_ast_node(exprStmt);
+				$$->set_flat_node(flat_ast.expr_stmt($1->get_flat_node()));
 	        }
 			;
 	  
 variable : id_name 	
       {
-	    outlog<<"At line no: "<<lines<<" variable : ID "<<endl<<endl;
-		outlog<<$1->getname()<<endl<<endl;
+	    outlog<<"At line no: "<<lines<<" variable : ID "<<"\n\n";
+		outlog<<$1->getname()<<"\n\n";
 			
 		$$ = new symbol_info($1->getname(),"varbl");
 		
 		if(symtbl->Lookup_in_table($1->getname()) == NULL)
 		{
-			outerror<<"At line no: "<<lines<<" Undeclared variable "<<$1->getname()<<endl<<endl;
-			outlog<<"At line no: "<<lines<<" Undeclared variable "<<$1->getname()<<endl<<endl;
+			outerror<<"At line no: "<<lines<<" Undeclared variable "<<$1->getname()<<"\n\n";
+			outlog<<"At line no: "<<lines<<" Undeclared variable "<<$1->getname()<<"\n\n";
 			errors++;
 			
 			$$->setvartype("error");; //not found set error type
@@ -697,20 +792,20 @@ variable : id_name
 		{
 			if((symtbl->Lookup_in_table($1->getname()))->getidtype() == "array")
 			{
-				outerror<<"At line no: "<<lines<<" variable is of array type : "<<$1->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" variable is of array type : "<<$1->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" variable is of array type : "<<$1->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" variable is of array type : "<<$1->getname()<<"\n\n";
 				errors++;
 			}
 			else if((symtbl->Lookup_in_table($1->getname()))->getidtype() == "func_def") 
 			{
-				outerror<<"At line no: "<<lines<<" variable is of function type : "<<$1->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" variable is of function type : "<<$1->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" variable is of function type : "<<$1->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" variable is of function type : "<<$1->getname()<<"\n\n";
 				errors++;
 			}
 			else if((symtbl->Lookup_in_table($1->getname()))->getidtype() == "func_dec") 
 			{
-				outerror<<"At line no: "<<lines<<" variable is of function type : "<<$1->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" variable is of function type : "<<$1->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" variable is of function type : "<<$1->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" variable is of function type : "<<$1->getname()<<"\n\n";
 				errors++;
 			}
 			
@@ -722,34 +817,35 @@ variable : id_name
 		// Create AST node for variable
 		VarNode* varNode = new VarNode($1->getname(), $$->getvartype());
 		$$->set_ast_node(varNode);
+		$$->set_flat_node(flat_ast.var($1->getname(), $$->getvartype()));
 	 }	
 	 | id_name LTHIRD expression RTHIRD 
 	 {
-	 	outlog<<"At line no: "<<lines<<" variable : ID LTHIRD expression RTHIRD "<<endl<<endl;
-		outlog<<$1->getname()<<"["<<$3->getname()<<"]"<<endl<<endl;
+	 	outlog<<"At line no: "<<lines<<" variable : ID LTHIRD expression RTHIRD "<<"\n\n";
+		outlog<<$1->getname()<<"["<<$3->getname()<<"]"<<"\n\n";
 		
 		$$ = new symbol_info($1->getname()+"["+$3->getname()+"]","varbl");
 		
 		if(symtbl->Lookup_in_table($1->getname()) == NULL)
 		{
-			outerror<<"At line no: "<<lines<<" Undeclared variable "<<$1->getname()<<endl<<endl;
-			outlog<<"At line no: "<<lines<<" Undeclared variable "<<$1->getname()<<endl<<endl;
+			outerror<<"At line no: "<<lines<<" Undeclared variable "<<$1->getname()<<"\n\n";
+			outlog<<"At line no: "<<lines<<" Undeclared variable "<<$1->getname()<<"\n\n";
 			errors++;
 			
 			$$->setvartype("error");; //not found set error type
 		}
 		else if((symtbl->Lookup_in_table($1->getname()))->getidtype() != "array") //variable is not an array
 		{
-			outerror<<"At line no: "<<lines<<" variable is not of array type : "<<$1->getname()<<endl<<endl;
-			outlog<<"At line no: "<<lines<<" variable is not of array type : "<<$1->getname()<<endl<<endl;
+			outerror<<"At line no: "<<lines<<" variable is not of array type : "<<$1->getname()<<"\n\n";
+			outlog<<"At line no: "<<lines<<" variable is not of array type : "<<$1->getname()<<"\n\n";
 			errors++;
 			
 			$$->setvartype("error");; //doesnt match set error type
 		}
 		else if($3->getvartype()!="int") // get type of expression of array index
 		{
-			outerror<<"At line no: "<<lines<<" array index is not of integer type : "<<$1->getname()<<endl<<endl;
-			outlog<<"At line no: "<<lines<<" array index is not of integer type : "<<$1->getname()<<endl<<endl;
+			outerror<<"At line no: "<<lines<<" array index is not of integer type : "<<$1->getname()<<"\n\n";
+			outlog<<"At line no: "<<lines<<" array index is not of integer type : "<<$1->getname()<<"\n\n";
 			errors++;
 			
 			$$->setvartype("error");
@@ -762,38 +858,40 @@ variable : id_name
 		// Create AST node for array access
 		VarNode* varNode = new VarNode($1->getname(), $$->getvartype(), (ExprNode*)$3->get_ast_node());
 		$$->set_ast_node(varNode);
+		$$->set_flat_node(flat_ast.var($1->getname(), $$->getvartype(), $3->get_flat_node()));
 	 }
 	 ;
 	 
 expression : logic_expression //expr can be void
 	   {
-	    	outlog<<"At line no: "<<lines<<" expression : logic_expression "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" expression : logic_expression "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"expr");
 			$$->setvartype($1->getvartype());
 			$$->set_ast_node($1->get_ast_node());
+			$$->set_flat_node($1->get_flat_node());
 	   }
 	   | variable ASSIGNOP logic_expression 	
 	   {
-	    	outlog<<"At line no: "<<lines<<" expression : variable ASSIGNOP logic_expression "<<endl<<endl;
-			outlog<<$1->getname()<<"="<<$3->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" expression : variable ASSIGNOP logic_expression "<<"\n\n";
+			outlog<<$1->getname()<<"="<<$3->getname()<<"\n\n";
 
 			$$ = new symbol_info($1->getname()+"="+$3->getname(),"expr");
 			$$->setvartype($1->getvartype());
 			
 			if($1->getvartype() == "void" || $3->getvartype() == "void") //if any of them is a void
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
 				errors++;
 				
 				$$->setvartype("error");
 			}
 			else if($1->getvartype() == "int" && $3->getvartype() == "float") // assignment of float into int
 			{
-				outerror<<"At line no: "<<lines<<" Warning: Assignment of float value into variable of integer type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" Warning: Assignment of float value into variable of integer type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" Warning: Assignment of float value into variable of integer type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" Warning: Assignment of float value into variable of integer type "<<"\n\n";
 				errors++;
 				
 				$$->setvartype("int");
@@ -811,22 +909,24 @@ expression : logic_expression //expr can be void
 				$$->getvartype()
 			);
 			$$->set_ast_node(assignNode);
+			$$->set_flat_node(flat_ast.assign($1->get_flat_node(), $3->get_flat_node(), $$->getvartype()));
 	   }
 	   ;
 			
 logic_expression : rel_expression //lgc_expr can be void
 	     {
-	    	outlog<<"At line no: "<<lines<<" logic_expression : rel_expression "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" logic_expression : rel_expression "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"lgc_expr");
 			$$->setvartype($1->getvartype());
 			$$->set_ast_node($1->get_ast_node());
+			$$->set_flat_node($1->get_flat_node());
 	     }	
 		 | rel_expression LOGICOP rel_expression 
 		 {
-	    	outlog<<"At line no: "<<lines<<" logic_expression : rel_expression LOGICOP rel_expression "<<endl<<endl;
-			outlog<<$1->getname()<<$2->getname()<<$3->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" logic_expression : rel_expression LOGICOP rel_expression "<<"\n\n";
+			outlog<<$1->getname()<<$2->getname()<<$3->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+$2->getname()+$3->getname(),"lgc_expr");
 			$$->setvartype("int");
@@ -835,8 +935,8 @@ logic_expression : rel_expression //lgc_expr can be void
 			
 			if($1->getvartype() == "void" || $3->getvartype() == "void") //if any of them is a void
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
 				errors++;
 				
 				$$->setvartype("error");
@@ -855,22 +955,24 @@ logic_expression : rel_expression //lgc_expr can be void
 				$$->getvartype()
 			);
 			$$->set_ast_node(logicNode);
+			$$->set_flat_node(flat_ast.binary($2->getname(), $1->get_flat_node(), $3->get_flat_node(), $$->getvartype()));
 	     }	
 		 ;
 			
 rel_expression	: simple_expression //rel_expr can be void
 		{
-	    	outlog<<"At line no: "<<lines<<" rel_expression : simple_expression "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" rel_expression : simple_expression "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"rel_expr");
 			$$->setvartype($1->getvartype());
 			$$->set_ast_node($1->get_ast_node());
+			$$->set_flat_node($1->get_flat_node());
 	    }
 		| simple_expression RELOP simple_expression
 		{
-	    	outlog<<"At line no: "<<lines<<" rel_expression : simple_expression RELOP simple_expression "<<endl<<endl;
-			outlog<<$1->getname()<<$2->getname()<<$3->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" rel_expression : simple_expression RELOP simple_expression "<<"\n\n";
+			outlog<<$1->getname()<<$2->getname()<<$3->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+$2->getname()+$3->getname(),"rel_expr");
 			$$->setvartype("int");
@@ -879,8 +981,8 @@ rel_expression	: simple_expression //rel_expr can be void
 			
 			if($1->getvartype() == "void" || $3->getvartype() == "void") //if any of them is a void
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
 				errors++;
 				
 				$$->setvartype("error");
@@ -899,23 +1001,25 @@ rel_expression	: simple_expression //rel_expr can be void
 				$$->getvartype()
 			);
 			$$->set_ast_node(relNode);
+			$$->set_flat_node(flat_ast.binary($2->getname(), $1->get_flat_node(), $3->get_flat_node(), $$->getvartype()));
 	    }
 		;
 				
 simple_expression : term //simp_expr can be void
           {
-	    	outlog<<"At line no: "<<lines<<" simple_expression : term "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" simple_expression : term "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"simp_expr");
 			$$->setvartype($1->getvartype());
 			$$->set_ast_node($1->get_ast_node());
+			$$->set_flat_node($1->get_flat_node());
 			
 	      }
 		  | simple_expression ADDOP term 
 		  {
-	    	outlog<<"At line no: "<<lines<<" simple_expression : simple_expression ADDOP term "<<endl<<endl;
-			outlog<<$1->getname()<<$2->getname()<<$3->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" simple_expression : simple_expression ADDOP term "<<"\n\n";
+			outlog<<$1->getname()<<$2->getname()<<$3->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+$2->getname()+$3->getname(),"simp_expr");
 			$$->setvartype($1->getvartype());
@@ -924,8 +1028,8 @@ simple_expression : term //simp_expr can be void
 			
 			if($1->getvartype() == "void" || $3->getvartype() == "void") //if any of them is a void
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
 				errors++;
 				
 				$$->setvartype("error");
@@ -949,23 +1053,25 @@ simple_expression : term //simp_expr can be void
 				$$->getvartype()
 			);
 			$$->set_ast_node(addopNode);
+			$$->set_flat_node(flat_ast.binary($2->getname(), $1->get_flat_node(), $3->get_flat_node(), $$->getvartype()));
 	      }
 		  ;
 					
 term :	unary_expression //term can be void because of un_expr->factor
      {
-	    	outlog<<"At line no: "<<lines<<" term : unary_expression "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" term : unary_expression "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"term");
 			$$->setvartype($1->getvartype());
 			$$->set_ast_node($1->get_ast_node());
+			$$->set_flat_node($1->get_flat_node());
 			
 	 }
      |  term MULOP unary_expression
      {
-	    	outlog<<"At line no: "<<lines<<" term : term MULOP unary_expression "<<endl<<endl;
-			outlog<<$1->getname()<<$2->getname()<<$3->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" term : term MULOP unary_expression "<<"\n\n";
+			outlog<<$1->getname()<<$2->getname()<<$3->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+$2->getname()+$3->getname(),"term");
 			$$->setvartype($1->getvartype());
@@ -973,8 +1079,8 @@ term :	unary_expression //term can be void because of un_expr->factor
 			//do type checking of both side of mulop
 			if($1->getvartype() == "void" || $3->getvartype() == "void") //if any of them is a void
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
 				errors++;
 				
 				$$->setvartype("error");
@@ -992,8 +1098,8 @@ term :	unary_expression //term can be void because of un_expr->factor
 				{
 					if($3->getname()=="0")
 					{
-						outerror<<"At line no: "<<lines<<" Modulus by 0 "<<endl<<endl;
-						outlog<<"At line no: "<<lines<<" Modulus by 0 "<<endl<<endl;
+						outerror<<"At line no: "<<lines<<" Modulus by 0 "<<"\n\n";
+						outlog<<"At line no: "<<lines<<" Modulus by 0 "<<"\n\n";
 						errors++;
 						
 						$$->setvartype("error");
@@ -1002,8 +1108,8 @@ term :	unary_expression //term can be void because of un_expr->factor
 				}
 				else if($1->getvartype() == "float" || $3->getvartype() == "float")
 				{
-					outerror<<"At line no: "<<lines<<" Modulus operator on non integer type "<<endl<<endl;
-					outlog<<"At line no: "<<lines<<" Modulus operator on non integer type "<<endl<<endl;
+					outerror<<"At line no: "<<lines<<" Modulus operator on non integer type "<<"\n\n";
+					outlog<<"At line no: "<<lines<<" Modulus operator on non integer type "<<"\n\n";
 					errors++;
 					
 					$$->setvartype("error");
@@ -1014,8 +1120,8 @@ term :	unary_expression //term can be void because of un_expr->factor
 			{
 				if($3->getname()=="0")
 				{
-					outerror<<"At line no: "<<lines<<" Divide by 0 "<<endl<<endl;
-					outlog<<"At line no: "<<lines<<" Divide by 0 "<<endl<<endl;
+					outerror<<"At line no: "<<lines<<" Divide by 0 "<<"\n\n";
+					outlog<<"At line no: "<<lines<<" Divide by 0 "<<"\n\n";
 					errors++;
 					
 					$$->setvartype("error");
@@ -1034,21 +1140,22 @@ term :	unary_expression //term can be void because of un_expr->factor
 				$$->getvartype()
 			);
 			$$->set_ast_node(mulopNode);
+			$$->set_flat_node(flat_ast.binary($2->getname(), $1->get_flat_node(), $3->get_flat_node(), $$->getvartype()));
 	 }
      ;
 
 unary_expression : ADDOP unary_expression  // un_expr can be void because of factor
 		 {
-	    	outlog<<"At line no: "<<lines<<" unary_expression : ADDOP unary_expression "<<endl<<endl;
-			outlog<<$1->getname()<<$2->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" unary_expression : ADDOP unary_expression "<<"\n\n";
+			outlog<<$1->getname()<<$2->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname()+$2->getname(),"un_expr");
 			$$->setvartype($2->getvartype());
 			
 			if($2->getvartype()=="void")
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type : "<<$2->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type : "<<$2->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type : "<<$2->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type : "<<$2->getname()<<"\n\n";
 				errors++;
 				
 				$$->setvartype("error");
@@ -1061,19 +1168,20 @@ unary_expression : ADDOP unary_expression  // un_expr can be void because of fac
 				$$->getvartype()
 			);
 			$$->set_ast_node(unaryNode);
+			$$->set_flat_node(flat_ast.unary($1->getname(), $2->get_flat_node(), $$->getvartype()));
 	     }
 		 | NOT unary_expression 
 		 {
-	    	outlog<<"At line no: "<<lines<<" unary_expression : NOT unary_expression "<<endl<<endl;
-			outlog<<"!"<<$2->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" unary_expression : NOT unary_expression "<<"\n\n";
+			outlog<<"!"<<$2->getname()<<"\n\n";
 			
 			$$ = new symbol_info("!"+$2->getname(),"un_expr");
 			$$->setvartype("int");
 			
 			if($2->getvartype()=="void")
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type : "<<$2->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type : "<<$2->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type : "<<$2->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type : "<<$2->getname()<<"\n\n";
 				errors++;
 				
 				$$->setvartype("error");
@@ -1086,15 +1194,17 @@ unary_expression : ADDOP unary_expression  // un_expr can be void because of fac
 				$$->getvartype()
 			);
 			$$->set_ast_node(notNode);
+			$$->set_flat_node(flat_ast.unary("!", $2->get_flat_node(), $$->getvartype()));
 	     }
 		 | factor 
 		 {
-	    	outlog<<"At line no: "<<lines<<" unary_expression : factor "<<endl<<endl;
-			outlog<<$1->getname()<<endl<<endl;
+	    	outlog<<"At line no: "<<lines<<" unary_expression : factor "<<"\n\n";
+			outlog<<$1->getname()<<"\n\n";
 			
 			$$ = new symbol_info($1->getname(),"un_expr");
 			$$->setvartype($1->getvartype());
 			$$->set_ast_node($1->get_ast_node());
+			$$->set_flat_node($1->get_flat_node());
 			
 			//outlog<<$1->getvartype()<<endl;
 	     }
@@ -1102,17 +1212,18 @@ unary_expression : ADDOP unary_expression  // un_expr can be void because of fac
 	
 factor	: variable  // factor can be void
     {
-	    outlog<<"At line no: "<<lines<<" factor : variable "<<endl<<endl;
-		outlog<<$1->getname()<<endl<<endl;
+	    outlog<<"At line no: "<<lines<<" factor : variable "<<"\n\n";
+		outlog<<$1->getname()<<"\n\n";
 			
 		$$ = new symbol_info($1->getname(),"fctr");
 		$$->setvartype($1->getvartype());
 		$$->set_ast_node($1->get_ast_node());
+		$$->set_flat_node($1->get_flat_node());
 	}
 	| id_name LPAREN argument_list RPAREN
 	{
-	    outlog<<"At line no: "<<lines<<" factor : ID LPAREN argument_list RPAREN "<<endl<<endl;
-	    outlog<<$1->getname()<<"("<<$3->getname()<<")"<<endl<<endl;
+	    outlog<<"At line no: "<<lines<<" factor : ID LPAREN argument_list RPAREN "<<"\n\n";
+	    outlog<<$1->getname()<<"("<<$3->getname()<<")"<<"\n\n";
 	
 	    $$ = new symbol_info($1->getname()+"("+$3->getname()+")","fctr");
 	    $$->setvartype("error");
@@ -1122,16 +1233,16 @@ factor	: variable  // factor can be void
 	    // Type checking (existing code)
 	    if(symtbl->Lookup_in_table($1->getname())==NULL) //undeclared function
 	    {
-	        outerror<<"At line no: "<<lines<<" Undeclared function: "<<$1->getname()<<endl<<endl;
-	        outlog<<"At line no: "<<lines<<" Undeclared function: "<<$1->getname()<<endl<<endl;
+	        outerror<<"At line no: "<<lines<<" Undeclared function: "<<$1->getname()<<"\n\n";
+	        outlog<<"At line no: "<<lines<<" Undeclared function: "<<$1->getname()<<"\n\n";
 	        errors++;
 	    }
 	    else
 	    {
 	        if((symtbl->Lookup_in_table($1->getname()))->getidtype()=="func_dec") //declared but not defined
 	        {
-	            outerror<<"At line no: "<<lines<<" Undefined function: "<<$1->getname()<<endl<<endl;
-	            outlog<<"At line no: "<<lines<<" Undefined function: "<<$1->getname()<<endl<<endl;
+	            outerror<<"At line no: "<<lines<<" Undefined function: "<<$1->getname()<<"\n\n";
+	            outlog<<"At line no: "<<lines<<" Undefined function: "<<$1->getname()<<"\n\n";
 	            errors++;
 	        }
 	        else if((symtbl->Lookup_in_table($1->getname()))->getidtype()=="func_def")
@@ -1140,8 +1251,8 @@ factor	: variable  // factor can be void
 	
 	            if(arglist.size()!=templist.size()) //number of prameters don't match
 	            {
-	                outerror<<"At line no: "<<lines<<" Inconsistencies in number of arguments in function call: "<<$1->getname()<<endl<<endl;
-	                outlog<<"At line no: "<<lines<<" Inconsistencies in number of arguments in function call: "<<$1->getname()<<endl<<endl;
+	                outerror<<"At line no: "<<lines<<" Inconsistencies in number of arguments in function call: "<<$1->getname()<<"\n\n";
+	                outlog<<"At line no: "<<lines<<" Inconsistencies in number of arguments in function call: "<<$1->getname()<<"\n\n";
 	                errors++;
 	            }
 	            else if(templist.size()!=0)
@@ -1154,8 +1265,8 @@ factor	: variable  // factor can be void
 	                        else if(arglist[i]!="error")
 	                        {
 	                            flag = 1;
-	                            outerror<<"At line no: "<<lines<<" "<<"argument "<<i+1<<" type mismatch in function call: "<<$1->getname()<<endl<<endl;
-	                            outlog<<"At line no: "<<lines<<" "<<"argument "<<i+1<<" type mismatch in function call: "<<$1->getname()<<endl<<endl;
+	                            outerror<<"At line no: "<<lines<<" "<<"argument "<<i+1<<" type mismatch in function call: "<<$1->getname()<<"\n\n";
+	                            outlog<<"At line no: "<<lines<<" "<<"argument "<<i+1<<" type mismatch in function call: "<<$1->getname()<<"\n\n";
 	                            errors++;
 	                        }
 	                    }
@@ -1170,7 +1281,7 @@ factor	: variable  // factor can be void
 	
 	    // Get arguments from the ArgumentsNode if it exists
 	    if ($3->get_ast_node()) {
-	        ArgumentsNode* argsNode = dynamic_cast<ArgumentsNode*>($3->get_ast_node());
+	        ArgumentsNode* argsNode = ast_cast<ArgumentsNode>($3->get_ast_node());
 	        if (argsNode) {
 	            // Add each argument to the function call
 	            for (auto arg : argsNode->get_arguments()) {
@@ -1180,22 +1291,24 @@ factor	: variable  // factor can be void
 	    }
 	
 	    $$->set_ast_node(funcCall);
+	    $$->set_flat_node(flat_ast.call($1->getname(), $$->getvartype(), $3->get_flat_node()));
 	
 	    arglist.clear();
 	}
 	| LPAREN expression RPAREN
 	{
-	   	outlog<<"At line no: "<<lines<<" factor : LPAREN expression RPAREN "<<endl<<endl;
-		outlog<<"("<<$2->getname()<<")"<<endl<<endl;
+	   	outlog<<"At line no: "<<lines<<" factor : LPAREN expression RPAREN "<<"\n\n";
+		outlog<<"("<<$2->getname()<<")"<<"\n\n";
 		
 		$$ = new symbol_info("("+$2->getname()+")","fctr");
 		$$->setvartype($2->getvartype());
 		$$->set_ast_node($2->get_ast_node()); // Pass through the expression AST
+		$$->set_flat_node($2->get_flat_node());
 	}
 	| CONST_INT 
 	{
-	    outlog<<"At line no: "<<lines<<" factor : CONST_INT "<<endl<<endl;
-		outlog<<$1->getname()<<endl<<endl;
+	    outlog<<"At line no: "<<lines<<" factor : CONST_INT "<<"\n\n";
+		outlog<<$1->getname()<<"\n\n";
 			
 		$$ = new symbol_info($1->getname(),"fctr");
 		$$->setvartype("int");
@@ -1203,11 +1316,12 @@ factor	: variable  // factor can be void
 		// Create AST node for integer constant
 		ConstNode* intNode = new ConstNode($1->getname(), "int");
 		$$->set_ast_node(intNode);
+		$$->set_flat_node(flat_ast.constant($1->getname(), "int"));
 	}
 	| CONST_FLOAT
 	{
-	    outlog<<"At line no: "<<lines<<" factor : CONST_FLOAT "<<endl<<endl;
-		outlog<<$1->getname()<<endl<<endl;
+	    outlog<<"At line no: "<<lines<<" factor : CONST_FLOAT "<<"\n\n";
+		outlog<<$1->getname()<<"\n\n";
 			
 		$$ = new symbol_info($1->getname(),"fctr");
 		$$->setvartype("float");
@@ -1215,11 +1329,12 @@ factor	: variable  // factor can be void
 		// Create AST node for float constant
 		ConstNode* floatNode = new ConstNode($1->getname(), "float");
 		$$->set_ast_node(floatNode);
+		$$->set_flat_node(flat_ast.constant($1->getname(), "float"));
 	}
 	| variable INCOP 
 	{
-	    outlog<<"At line no: "<<lines<<" factor : variable INCOP "<<endl<<endl;
-		outlog<<$1->getname()<<"++"<<endl<<endl;
+	    outlog<<"At line no: "<<lines<<" factor : variable INCOP "<<"\n\n";
+		outlog<<$1->getname()<<"++"<<"\n\n";
 			
 		$$ = new symbol_info($1->getname()+"++","fctr");
 		$$->setvartype($1->getvartype());
@@ -1231,11 +1346,16 @@ factor	: variable  // factor can be void
 		BinaryOpNode* addNode = new BinaryOpNode("+", varNode, oneNode, $1->getvartype());
 		AssignNode* assignNode = new AssignNode(varNode, addNode, $1->getvartype());
 		$$->set_ast_node(assignNode);
+		
+		// The flat tree can share the variable without any ownership trouble
+		uint32_t flat_one = flat_ast.constant("1", "int");
+		uint32_t flat_update = flat_ast.binary("+", $1->get_flat_node(), flat_one, $1->getvartype());
+		$$->set_flat_node(flat_ast.assign($1->get_flat_node(), flat_update, $1->getvartype()));
 	}
 	| variable DECOP
 	{
-	    outlog<<"At line no: "<<lines<<" factor : variable DECOP "<<endl<<endl;
-		outlog<<$1->getname()<<"--"<<endl<<endl;
+	    outlog<<"At line no: "<<lines<<" factor : variable DECOP "<<"\n\n";
+		outlog<<$1->getname()<<"--"<<"\n\n";
 			
 		$$ = new symbol_info($1->getname()+"--","fctr");
 		$$->setvartype($1->getvartype());
@@ -1247,65 +1367,74 @@ factor	: variable  // factor can be void
 		BinaryOpNode* subNode = new BinaryOpNode("-", varNode, oneNode, $1->getvartype());
 		AssignNode* assignNode = new AssignNode(varNode, subNode, $1->getvartype());
 		$$->set_ast_node(assignNode);
+		
+		// The flat tree can share the variable without any ownership trouble
+		uint32_t flat_one = flat_ast.constant("1", "int");
+		uint32_t flat_update = flat_ast.binary("-", $1->get_flat_node(), flat_one, $1->getvartype());
+		$$->set_flat_node(flat_ast.assign($1->get_flat_node(), flat_update, $1->getvartype()));
 	}
 	;
 	
 argument_list : arguments
               {
-                    outlog<<"At line no: "<<lines<<" argument_list : arguments "<<endl<<endl;
-                    outlog<<$1->getname()<<endl<<endl;
+                    outlog<<"At line no: "<<lines<<" argument_list : arguments "<<"\n\n";
+                    outlog<<$1->getname()<<"\n\n";
                         
                     $$ = $1; // Pass through the arguments node
               }
               |
               {
-                    outlog<<"At line no: "<<lines<<" argument_list :  "<<endl<<endl;
-                    outlog<<""<<endl<<endl;
+                    outlog<<"At line no: "<<lines<<" argument_list :  "<<"\n\n";
+                    outlog<<""<<"\n\n";
                         
                     $$ = new symbol_info("","arg_list");
                     // Create empty arguments node
                     ArgumentsNode* args = new ArgumentsNode();
                     $$->set_ast_node(args);
+                    $$->set_flat_node(flat_ast.args());
               }
               ;
     
 arguments : arguments COMMA logic_expression
           {
-                outlog<<"At line no: "<<lines<<" arguments : arguments COMMA logic_expression "<<endl<<endl;
-                outlog<<$1->getname()<<","<<$3->getname()<<endl<<endl;
+                outlog<<"At line no: "<<lines<<" arguments : arguments COMMA logic_expression "<<"\n\n";
+                outlog<<$1->getname()<<","<<$3->getname()<<"\n\n";
                         
                 $$ = new symbol_info($1->getname()+","+$3->getname(),"arg");
                 
                 // Get existing arguments node or create new one
-                ArgumentsNode* args;
-                if ($1->get_ast_node()) {
-                    args = dynamic_cast<ArgumentsNode*>($1->get_ast_node());
-                } else {
+                ArgumentsNode* args = ast_cast<ArgumentsNode>($1->get_ast_node());
+                if (!args) {
                     args = new ArgumentsNode();
                 }
                 
                 // Add the new argument
                 if ($3->get_ast_node()) {
-                    args->add_argument(dynamic_cast<ExprNode*>($3->get_ast_node()));
+                    args->add_argument(ast_cast<ExprNode>($3->get_ast_node()));
                 }
                 
                 $$->set_ast_node(args);
+                flat_ast.append($1->get_flat_node(), $3->get_flat_node());
+                $$->set_flat_node($1->get_flat_node());
                 arglist.push_back($3->getvartype());
           }
           | logic_expression
           {
-                outlog<<"At line no: "<<lines<<" arguments : logic_expression "<<endl<<endl;
-                outlog<<$1->getname()<<endl<<endl;
+                outlog<<"At line no: "<<lines<<" arguments : logic_expression "<<"\n\n";
+                outlog<<$1->getname()<<"\n\n";
                         
                 $$ = new symbol_info($1->getname(),"arg");
                 
                 // Create a new arguments node with single argument
                 ArgumentsNode* args = new ArgumentsNode();
                 if ($1->get_ast_node()) {
-                    args->add_argument(dynamic_cast<ExprNode*>($1->get_ast_node()));
+                    args->add_argument(ast_cast<ExprNode>($1->get_ast_node()));
                 }
                 
                 $$->set_ast_node(args);
+                uint32_t flat_args = flat_ast.args();
+                flat_ast.append(flat_args, $1->get_flat_node());
+                $$->set_flat_node(flat_args);
                 arglist.push_back($1->getvartype());
           }
           ;
@@ -1313,62 +1442,557 @@ arguments : arguments COMMA logic_expression
 
 %%
 
-int main(int argc, char *argv[])
+// Puts the parser/scanner globals back to their startup values so one process
+// can compile several inputs in a row (batch mode)
+void reset_compiler_state()
 {
-	if(argc != 2) 
-	{
-		cout<<"Please input file name"<<endl;
-		return 0;
-	}
-	yyin = fopen(argv[1], "r");
-	outlog.open("log.txt", ios::trunc);
-	outerror.open("error.txt", ios::trunc);
-	outcode.open("code.txt", ios::trunc);
+	delete symtbl;
+	symtbl = new symbol_table();
+	// ast_delete frees the variable x++ shares between the assignment and
+	// the addition only once
+	ast_delete(ast_root);
+	ast_root = new ProgramNode();
+	flat_ast.clear();
+	
+	lines = 1;
+	errors = 0;
+	
+	varlist = "";
+	paramlist.clear();
+	paramname.clear();
+	arglist.clear();
+	is_func = 0;
+	ret_type = "";
+	func_name = "";
+	func_ret_type = "";
+	
+	temp_cond = "";
+	var_last_loaded_temp.clear();
+	var_last_assigned_temp.clear();
+}
 
-	if(yyin == NULL)
-	{
-		cout<<"Couldn't open file"<<endl;
-		return 0;
-	}
+// Filled in by run_passes for the library API
+CompileStats pass_stats;
+
+// Runs both passes over whatever the scanner is currently reading and writes
+// to whatever outlog/outerror/outcode are attached to. Returns the error count.
+int run_passes(const string& code_name, bool quiet)
+{
+	auto start = chrono::steady_clock::now();
+	pass_stats = CompileStats();
 	
 	// First pass: Parse the input and build AST
-	cout << "==== Pass 1: Parsing input and building AST ====" << endl;
-	outlog << "==== Pass 1: Parsing input and building AST ====" << endl;
+	if(!quiet) cout << "==== Pass 1: Parsing input and building AST ====" << endl;
+	outlog << "==== Pass 1: Parsing input and building AST ====" << "\n";
 	
 	symtbl->enter_scope(outlog);
 	yyparse();
 	
-	outlog << endl << "Symbol Table after first pass:" << endl;
+	outlog << "\n" << "Symbol Table after first pass:" << "\n";
 	symtbl->Print_all_scope(outlog);
 	
+	auto parsed = chrono::steady_clock::now();
+	pass_stats.parse_seconds = chrono::duration<double>(parsed - start).count();
+	
 	// Only proceed to second pass if no errors
 	if (errors == 0 && ast_root) {
-		cout << "==== Pass 2: Generating Three-Address Code from AST ====" << endl;
-		outlog << endl << "==== Pass 2: Generating Three-Address Code from AST ====" << endl;
+		if(!quiet) cout << "==== Pass 2: Generating Three-Address Code from AST ====" << endl;
+		outlog << "\n" << "==== Pass 2: Generating Three-Address Code from AST ====" << "\n";
 		
 		// Generate three-address code (second pass)
-		outlog << "Generating Three-Address Code..." << endl;
-		ThreeAddrCodeGenerator tacGen(ast_root, outcode);
-		tacGen.generate();
+		outlog << "Generating Three-Address Code..." << "\n";
+		// The enabled passes, ending with code generation (ast_passes.h)
+		AstPassContext context = {outlog, outcode, lower_flat_ast ? &flat_ast : NULL};
+		ast_passes().run(ast_root, context);
 		
-		outlog << "Three-Address Code Generation Complete" << endl;
-		cout << "Three-Address Code Generation Complete. Output written to code.txt" << endl;
+		outlog << "Three-Address Code Generation Complete" << "\n";
+		if(!quiet) cout << "Three-Address Code Generation Complete. Output written to " << code_name << endl;
 	} else {
-		cout << "Three-Address Code generation skipped due to errors" << endl;
-		outlog << endl << "Three-Address Code generation skipped due to errors" << endl;
-		outcode << "// Three-Address Code generation failed due to errors" << endl;
+		if(!quiet) cout << "Three-Address Code generation skipped due to errors" << endl;
+		outlog << "\n" << "Three-Address Code generation skipped due to errors" << "\n";
+		outcode << "// Three-Address Code generation failed due to errors" << "\n";
 	}
 	
-	outlog<<endl<<"Total lines: "<<lines<<endl;
-	outlog<<"Total errors: "<<errors<<endl;
-	outerror<<"Total errors: "<<errors<<endl;
+	outlog<<"\n"<<"Total lines: "<<lines<<"\n";
+	outlog<<"Total errors: "<<errors<<"\n";
+	outerror<<"Total errors: "<<errors<<"\n";
 	
-	outlog.close();
-	outerror.close();
-	outcode.close();
+	pass_stats.codegen_seconds = chrono::duration<double>(chrono::steady_clock::now() - parsed).count();
+	pass_stats.lines = lines;
+	pass_stats.errors = errors;
+	return errors;
+}
 
+// Where the bytecode for code_path goes: code.txt -> code.bin
+string bytecode_path(const string& code_path)
+{
+	if(code_path.size() > 4 && code_path.compare(code_path.size() - 4, 4, ".txt") == 0)
+		return code_path.substr(0, code_path.size() - 4) + ".bin";
+	return code_path + ".bin";
+}
+
+// Reorders the blocks of the TAC just written to code_path for pgo_profile
+void apply_block_layout(const string& code_path, bool quiet)
+{
+	string summary, error;
+	if(!layout_tac_file(code_path, pgo_profile, summary, error))
+	{
+		if(!quiet) cout<<"Block layout skipped: "<<error<<endl;
+		return;
+	}
+	if(!quiet) cout<<"Block layout: "<<summary<<endl;
+}
+
+// Encodes the TAC just written to code_path as bytecode beside it
+void write_bytecode(const string& code_path, bool quiet)
+{
+	ifstream in(code_path.c_str(), ios::binary);
+	stringstream text;
+	text << in.rdbuf();
 	
-	fclose(yyin);
+	string error;
+	string bytecode = tac_text_to_bytecode(text.str(), error);
+	string path = bytecode_path(code_path);
+	if(bytecode.empty() || !save_tac_bytecode(bytecode, path, error))
+	{
+		if(!quiet) cout<<"Couldn't write bytecode: "<<error<<endl;
+		return;
+	}
+	if(!quiet) cout<<"Bytecode written to "<<path<<endl;
+}
+
+// Runs both passes on one input file and writes the log, error and code files.
+// Returns the number of errors found, or -1 if the input couldn't be opened.
+int compile_file(const char *input, const string& log_path, const string& error_path, const string& code_path, bool quiet)
+{
+	MappedSource mapped;
+	bool opened;
+	if(scan_mapped) opened = mapped.open(input);
+	else opened = (yyin = fopen(input, "r")) != NULL;
 	
+	log_out.open(log_path);
+	error_out.open(error_path);
+	code_out.open(code_path);
+	outlog.rdbuf(&log_out);
+	outerror.rdbuf(&error_out);
+	outcode.rdbuf(&code_out);
+
+	int result = -1;
+	if(!opened)
+	{
+		if(!quiet) cout<<"Couldn't open file"<<endl;
+	}
+	else if(scan_mapped)
+	{
+		YY_BUFFER_STATE scan = yy_scan_buffer(mapped.data(), mapped.scan_size());
+		result = run_passes(code_path, quiet);
+		yy_delete_buffer(scan);
+	}
+	else
+	{
+		yyrestart(yyin);
+		result = run_passes(code_path, quiet);
+		fclose(yyin);
+		yyin = NULL;
+	}
+	
+	// The only flush point: everything goes out here
+	log_out.close();
+	error_out.close();
+	code_out.close();
+	
+	if(!pgo_profile.empty() && result == 0) apply_block_layout(code_path, quiet);
+	if(emit_bytecode && result == 0) write_bytecode(code_path, quiet);
+	
+	return result;
+}
+
+// Generates code from a flat tree saved with --emit-ast instead of a source
+// file: no scanning or parsing, and the tree is lowered straight from the
+// mapped file. Returns 0, or -1 if the file couldn't be used.
+int compile_ast_file(const char *input, const string& code_path, bool quiet)
+{
+	auto start = chrono::steady_clock::now();
+	FlatAstFile file;
+	string error;
+	if(!file.open(input, error))
+	{
+		if(!quiet) cout<<"Couldn't load the tree: "<<error<<endl;
+		return -1;
+	}
+	auto mapped = chrono::steady_clock::now();
+	
+	code_out.open(code_path);
+	outcode.rdbuf(&code_out);
+	temp_cond = "";
+	var_last_loaded_temp.clear();
+	var_last_assigned_temp.clear();
+	ThreeAddrCodeGenerator(file.view(), outcode).generate();
+	code_out.close();
+	
+	if(!quiet)
+	{
+		cout<<"Loaded "<<file.view().size()<<" nodes ("<<file.bytes()<<" bytes) in "
+			<<chrono::duration<double>(mapped - start).count() * 1000<<" ms, lowered in "
+			<<chrono::duration<double>(chrono::steady_clock::now() - mapped).count() * 1000<<" ms. Output written to "<<code_path<<endl;
+	}
+	if(!pgo_profile.empty()) apply_block_layout(code_path, quiet);
+	if(emit_bytecode) write_bytecode(code_path, quiet);
 	return 0;
-}
\ No newline at end of file
+}
+
+// Everything besides the source that changes what compile_file writes
+string compile_settings()
+{
+	string settings = "passes=" + ast_passes().enabled_names();
+	settings += string(";flat=") + (lower_flat_ast ? "1" : "0");
+	settings += string(";bytecode=") + (emit_bytecode ? "1" : "0");
+	if(!pgo_profile.empty())
+	{
+		ifstream in(pgo_profile.c_str(), ios::binary);
+		stringstream profile;
+		profile << in.rdbuf();
+		settings += ";pgo=" + to_string(fnv1a(profile.str()));
+	}
+	return settings;
+}
+
+// compile_file through the cache in cache_dir: a hit writes the stored
+// outputs instead of compiling, a miss compiles and stores them
+int compile_file_cached(const char *input, const string& log_path, const string& error_path, const string& code_path, bool quiet)
+{
+	CompileCache cache((size_t)cache_max_mb << 20);
+	string error;
+	ifstream in(input, ios::binary);
+	if(!in || !cache.open(cache_dir, error))
+	{
+		if(!quiet && in) cout<<"Not caching: "<<error<<endl;
+		return compile_file(input, log_path, error_path, code_path, quiet);
+	}
+	stringstream source;
+	source << in.rdbuf();
+	in.close();
+	
+	auto start = chrono::steady_clock::now();
+	string text = source.str(), settings = compile_settings();
+	string key = cache.key(text, settings);
+	vector<CachedOutput> outputs;
+	int result;
+	if(cache.load(key, text, settings, outputs, result))
+	{
+		for(const CachedOutput& output : outputs)
+		{
+			ofstream out(output.name.c_str(), ios::binary | ios::trunc);
+			out.write(output.bytes.data(), output.bytes.size());
+			out.close();
+			if(!out)
+			{
+				// The compile writes the outputs itself, or reports why it can't
+				if(!quiet) cout<<"Cache hit not restored, couldn't write "<<output.name<<endl;
+				return compile_file(input, log_path, error_path, code_path, quiet);
+			}
+		}
+		if(!quiet)
+		{
+			cout<<"Cache hit: "<<outputs.size()<<" outputs restored from "<<cache_dir<<" in "
+				<<chrono::duration<double>(chrono::steady_clock::now() - start).count() * 1000<<" ms"<<endl;
+		}
+		return result;
+	}
+	
+	result = compile_file(input, log_path, error_path, code_path, quiet);
+	vector<string> paths = {log_path, error_path, code_path};
+	if(emit_bytecode && result == 0) paths.push_back(bytecode_path(code_path));
+	for(const string& path : paths)
+	{
+		ifstream file(path.c_str(), ios::binary);
+		if(!file) return result; // nothing to store if an output is missing
+		stringstream bytes;
+		bytes << file.rdbuf();
+		outputs.push_back({path, bytes.str()});
+	}
+	if(!cache.store(key, text, settings, outputs, result, error) && !quiet) cout<<"Not cached: "<<error<<endl;
+	return result;
+}
+
+mutex compile_lock;
+
+CompileResult compile_in_place(char* buffer, size_t size, const CompileOptions& options)
+{
+	lock_guard<mutex> guard(compile_lock);
+	CompileResult result;
+	
+	// Outputs without a caller sink go straight into the result strings
+	if(options.code_sink) code_out.attach(options.code_sink->rdbuf());
+	else code_out.attach(&result.tac);
+	if(options.error_sink) error_out.attach(options.error_sink->rdbuf());
+	else error_out.attach(&result.errors);
+	if(options.log_sink) log_out.attach(options.log_sink->rdbuf());
+	else log_out.attach(&result.log);
+	outcode.rdbuf(&code_out);
+	outerror.rdbuf(&error_out);
+	outlog.rdbuf(options.generate_log ? &log_out : NULL);
+	
+	reset_compiler_state();
+	int errs = -1;
+	YY_BUFFER_STATE scan = yy_scan_buffer(buffer, size);
+	if(scan == NULL)
+	{
+		outerror << "Source buffer is not terminated by two NUL bytes\n";
+	}
+	else
+	{
+		errs = run_passes("", true);
+		yy_delete_buffer(scan);
+	}
+	
+	// Every path ends here, so each sink gets its text and is let go
+	log_out.close();
+	error_out.close();
+	code_out.close();
+	if(errs < 0) return result;
+	
+	result.ok = errs == 0;
+	if(result.ok && options.generate_bytecode && !options.code_sink)
+	{
+		string error;
+		result.bytecode = tac_text_to_bytecode(result.tac, error);
+	}
+	result.stats = pass_stats;
+	result.stats.source_bytes = size - 2;
+	return result;
+}
+
+CompileResult compile(string_view source, const CompileOptions& options)
+{
+	// yy_scan_buffer wants a writable buffer ending in two NULs; keep one
+	// around per thread so repeated calls don't allocate
+	thread_local vector<char> buffer;
+	buffer.assign(source.begin(), source.end());
+	buffer.push_back('\0');
+	buffer.push_back('\0');
+	return compile_in_place(buffer.data(), buffer.size(), options);
+}
+
+bool lex_source(string_view source, vector<SourceToken>& tokens)
+{
+	lock_guard<mutex> guard(compile_lock);
+	thread_local vector<char> buffer;
+	buffer.assign(source.begin(), source.end());
+	buffer.push_back('\0');
+	buffer.push_back('\0');
+	tokens.clear();
+	YY_BUFFER_STATE scan = yy_scan_buffer(buffer.data(), buffer.size());
+	if(scan == NULL) return false;
+	int saved_lines = lines;
+	for(;;)
+	{
+		yylval = NULL;
+		int token = yylex();
+		delete yylval;
+		if(token == 0) break;
+		SourceToken t;
+		switch(token)
+		{
+			case INT: case FLOAT: case VOID: t.kind = SRC_TYPE; break;
+			case ID: t.kind = SRC_ID; break;
+			case LPAREN: t.kind = SRC_LPAREN; break;
+			case RPAREN: t.kind = SRC_RPAREN; break;
+			case LCURL: t.kind = SRC_LCURL; break;
+			case RCURL: t.kind = SRC_RCURL; break;
+			case SEMICOLON: t.kind = SRC_SEMICOLON; break;
+			default: t.kind = SRC_OTHER; break;
+		}
+		t.begin = yytext - buffer.data();
+		t.end = t.begin + yyleng;
+		tokens.push_back(t);
+	}
+	yylval = NULL;
+	lines = saved_lines;
+	yy_delete_buffer(scan);
+	return true;
+}
+
+#ifndef COMPILER_LIBRARY
+int main(int argc, char *argv[])
+{
+	if(argc >= 2 && string(argv[1]) == "--batch")
+	{
+		return run_batch(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--serve")
+	{
+		if(argc != 3)
+		{
+			cout<<"Usage: "<<argv[0]<<" --serve SOCKET"<<endl;
+			return 1;
+		}
+		CompileServer server(argv[2]);
+		return server.run();
+	}
+	if(argc >= 2 && string(argv[1]) == "--client")
+	{
+		return run_client(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--loadgen")
+	{
+		return run_loadgen(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--run")
+	{
+		return run_tac(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--bench-dispatch")
+	{
+		return run_dispatch_bench(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--bench-load")
+	{
+		return run_load_bench(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--native")
+	{
+		return run_native(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--jit")
+	{
+		return run_jit_bench(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--native-c")
+	{
+		return run_native_c(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--profile")
+	{
+		return run_profile(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--census")
+	{
+		return run_census(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--bench-ast")
+	{
+		return run_ast_bench(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--stress-depth")
+	{
+		return run_depth_stress(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--generate")
+	{
+		return run_generate(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--watch")
+	{
+		return run_watch(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--incremental")
+	{
+		if(argc < 3)
+		{
+			cout<<"Usage: "<<argv[0]<<" --incremental FILE..."<<endl;
+			return 1;
+		}
+		return run_incremental(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--list-passes")
+	{
+		cout<<"AST passes, in the order they run:"<<endl;
+		ast_passes().write_passes(cout);
+		return 0;
+	}
+	
+	while(argc >= 2 && (string(argv[1]) == "--mmap" || string(argv[1]) == "--bytecode" || string(argv[1]) == "--pgo" || string(argv[1]) == "--flat-ast"
+		|| string(argv[1]) == "--pass" || string(argv[1]) == "--no-pass" || string(argv[1]) == "--time-passes"
+		|| string(argv[1]) == "--emit-ast" || string(argv[1]) == "--cache" || string(argv[1]) == "--cache-size"))
+	{
+		// An option that takes a value needs it and the input file after it
+		string option = argv[1];
+		const char *value = option == "--pgo" || option == "--emit-ast" ? "FILE" : option == "--cache" ? "DIR"
+			: option == "--cache-size" ? "MB" : option == "--pass" || option == "--no-pass" ? "NAME" : NULL;
+		if(value && argc < 4)
+		{
+			cout<<"Usage: "<<argv[0]<<" "<<option<<" "<<value<<" [options] file"<<endl;
+			return 1;
+		}
+		if(string(argv[1]) == "--pgo")
+		{
+			pgo_profile = argv[2];
+			argv++;
+			argc--;
+		}
+		else if(string(argv[1]) == "--emit-ast")
+		{
+			emit_ast_path = argv[2];
+			flat_ast.enabled = true;
+			argv++;
+			argc--;
+		}
+		else if(string(argv[1]) == "--cache")
+		{
+			cache_dir = argv[2];
+			argv++;
+			argc--;
+		}
+		else if(string(argv[1]) == "--cache-size")
+		{
+			cache_max_mb = strtoul(argv[2], NULL, 10);
+			argv++;
+			argc--;
+		}
+		else if(string(argv[1]) == "--pass" || string(argv[1]) == "--no-pass")
+		{
+			if(!ast_passes().set_enabled(argv[2], string(argv[1]) == "--pass"))
+			{
+				cout<<"No pass named "<<argv[2]<<" (see --list-passes)"<<endl;
+				return 1;
+			}
+			argv++;
+			argc--;
+		}
+		else if(string(argv[1]) == "--mmap") scan_mapped = true;
+		else if(string(argv[1]) == "--bytecode") emit_bytecode = true;
+		else if(string(argv[1]) == "--flat-ast") lower_flat_ast = flat_ast.enabled = true;
+		else if(string(argv[1]) == "--time-passes") time_passes = true;
+		argv++;
+		argc--;
+	}
+	
+	// Code from the flat tree, or a saved one, would silently miss a rewrite
+	// of the node tree
+	const char *rewriter = ast_passes().tree_rewriter();
+	if(rewriter && (lower_flat_ast || !emit_ast_path.empty()))
+	{
+		cout<<"The "<<rewriter<<" pass rewrites the node tree only, so it can't be used with "
+			<<(lower_flat_ast ? "--flat-ast" : "--emit-ast")<<endl;
+		return 1;
+	}
+	
+	// A tree saved earlier with --emit-ast stands in for the source
+	if(argc == 3 && string(argv[1]) == "--from-ast")
+	{
+		return compile_ast_file(argv[2], "code.txt", false) == 0 ? 0 : 1;
+	}
+	
+	if(argc != 2) 
+	{
+		cout<<"Please input file name"<<endl;
+		return 0;
+	}
+	
+	// A saved tree comes from the parse, so --emit-ast always compiles
+	int result;
+	if(!cache_dir.empty() && emit_ast_path.empty()) result = compile_file_cached(argv[1], "log.txt", "error.txt", "code.txt", false);
+	else result = compile_file(argv[1], "log.txt", "error.txt", "code.txt", false);
+	if(time_passes) ast_passes().write_timing(cout);
+	if(!emit_ast_path.empty() && result == 0)
+	{
+		string error;
+		if(save_flat_ast(flat_ast, emit_ast_path, error)) cout<<"Tree saved to "<<emit_ast_path<<endl;
+		else cout<<"Tree not saved: "<<error<<endl;
+	}
+	
+	return 0;
+}
+
+#endif // COMPILER_LIBRARY
\ No newline at end of file
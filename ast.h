@@ -6,7 +6,9 @@
 #include <string>
 #include <fstream>
 #include <map>
+#include <unordered_map>
 #include <cctype>
+#include <cstdint>
 
 
 using namespace std;
@@ -16,90 +18,79 @@ map<string, string> var_last_loaded_temp;
 // Map to track the last assigned temp for each variable (for return statements)
 map<string, string> var_last_assigned_temp;
 
+// A label starts a new basic block. Control can arrive from a jump, so temps
+// loaded or assigned before it no longer hold the variables' current values.
+void emit_label(ostream& outcode, int label) {
+    outcode << "L" << label << ":" << "\n";
+    var_last_loaded_temp.clear();
+    var_last_assigned_temp.clear();
+}
+
+// Which class a node is. Passes and code generation dispatch on this (see
+// ast_visitor.h and AstLowering below) instead of going through
+// dynamic_cast. Statements and expressions each take a contiguous range.
+enum AstKind : uint8_t {
+    AST_PROGRAM, AST_FUNC_DECL, AST_ARGUMENTS,
+    AST_BLOCK, AST_DECL, AST_EXPR_STMT, AST_IF, AST_WHILE, AST_FOR, AST_RETURN,
+    AST_VAR, AST_CONST, AST_BINARY, AST_UNARY, AST_ASSIGN, AST_CALL,
+    AST_KIND_COUNT
+};
+
+struct AstChildren;
+class AstLowering;
+
+// Nodes don't delete their children and don't generate their own code:
+// ast_delete (ast_visitor.h) frees a tree and AstLowering below lowers it,
+// both without recursing, so nesting depth is only limited by memory.
 class ASTNode {
     public:
+        const AstKind kind;
+        uint32_t extra_refs; // parents past the first, for nodes ExprDagPass shares
+        ASTNode(AstKind k) : kind(k), extra_refs(0) {}
         virtual ~ASTNode() {}
-        virtual string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp, int& temp_count, int& label_count) const = 0;
 };
 
+// Checked downcast on the kind tag: NULL if n is NULL or isn't a T. Every
+// node class says which kinds it covers with a static classof.
+template <class T>
+T* ast_cast(ASTNode* n) {
+    return n && T::classof(n) ? static_cast<T*>(n) : NULL;
+}
+
+template <class T>
+const T* ast_cast(const ASTNode* n) {
+    return n && T::classof(n) ? static_cast<const T*>(n) : NULL;
+}
+
 
 class ExprNode : public ASTNode {
     protected:
         string node_type; //Type information(int, float, void, etc.)
     public:
-        ExprNode(string type) : node_type(type) {}
+        ExprNode(AstKind k, string type) : ASTNode(k), node_type(type) {}
+        static bool classof(const ASTNode* n) { return n->kind >= AST_VAR && n->kind <= AST_CALL; }
         virtual string get_type() const { return node_type; }
 };
 
-// VarNode class modification 
+// VarNode class modification
 class VarNode : public ExprNode {
     private:
         string name;
         ExprNode* index; // For array access, nullptr for simple variables
-    
+        friend struct AstChildren;
+        friend class AstLowering;
+
     public:
+        static bool classof(const ASTNode* n) { return n->kind == AST_VAR; }
         VarNode(string name, string type, ExprNode* idx = nullptr)
-            : ExprNode(type), name(name), index(idx) {}
-        
-        ~VarNode() { if(index) delete index; }
-        
+            : ExprNode(AST_VAR, type), name(name), index(idx) {}
+
         bool has_index() const { return index != nullptr; }
-        
-        string generate_index_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                                  int& temp_count, int& label_count) const {
-            if (!index) return "0"; //No index,breturn default
-
-            string idx_temp = index->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            string idx_result = "t" + to_string(temp_count++);
-            outcode << idx_result << " = " << idx_temp << endl;
-            
-            return idx_result;
-        }
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
+        ExprNode* get_index() const { return index; }
 
-            if (symbol_to_temp.find(name) == symbol_to_temp.end()) {
-                // Regular variable - store its name
-                symbol_to_temp[name] = name;
-            }
-            string var_temp = symbol_to_temp[name];
-            
-            if (has_index()) {
-                //array
-                string idx_temp = generate_index_code(outcode, symbol_to_temp, temp_count, label_count);
-                string result_temp = "t" + to_string(temp_count++);
-                outcode << result_temp << " = " << var_temp << "[" << idx_temp << "]" << endl;
-                return result_temp;
-            } else {
-                // Check if we recently loaded this variable - reuse the temp if available
-                if (var_last_loaded_temp.find(name) != var_last_loaded_temp.end()) {
-                    return var_last_loaded_temp[name];
-                }
-                // If var_temp already starts with "t" followed by digits, it's already a temp (like function parameters)
-                // Return it directly without creating a new load
-                if (var_temp.length() > 1 && var_temp[0] == 't') {
-                    bool is_temp = true;
-                    for (size_t i = 1; i < var_temp.length(); i++) {
-                        if (!isdigit(var_temp[i])) {
-                            is_temp = false;
-                            break;
-                        }
-                    }
-                    if (is_temp) {
-                        return var_temp;
-                    }
-                }
-                // Load variable into a new temp before using it
-                string result_temp = "t" + to_string(temp_count++);
-                outcode << result_temp << " = " << var_temp << endl;
-                var_last_loaded_temp[name] = result_temp;
-                return result_temp;
-            }
-        }
         string get_name() const { return name; }
 };
-    
+
 
 // Constant node
 
@@ -108,14 +99,10 @@ class ConstNode : public ExprNode {
         string value;
 
     public:
-        ConstNode(string val, string type) : ExprNode(type), value(val) {}
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
-            string const_temp = "t" + to_string(temp_count++);
-            outcode << const_temp << " = " << value << endl;
-            return const_temp;
-        }
+        static bool classof(const ASTNode* n) { return n->kind == AST_CONST; }
+        ConstNode(string val, string type) : ExprNode(AST_CONST, type), value(val) {}
+
+        const string& get_value() const { return value; }
 };
 
 // Binary operation node
@@ -125,27 +112,17 @@ private:
     string op;
     ExprNode* left;
     ExprNode* right;
+    friend struct AstChildren;
+    friend class AstLowering;
 
 public:
+    static bool classof(const ASTNode* n) { return n->kind == AST_BINARY; }
     BinaryOpNode(string op, ExprNode* left, ExprNode* right, string result_type)
-        : ExprNode(result_type), op(op), left(left), right(right) {}
-    
-    ~BinaryOpNode() {
-        delete left;
-        delete right;
-    }
-    
-    string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                        int& temp_count, int& label_count) const override {
-        string left_temp = left->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-        string right_temp = right->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-        
-        string result_temp = "t" + to_string(temp_count++);
-        
-        outcode << result_temp << " = " << left_temp << " " << op << " " << right_temp << endl;
-        temp_cond = result_temp;
-        return result_temp;
-    }
+        : ExprNode(AST_BINARY, result_type), op(op), left(left), right(right) {}
+
+    const string& get_op() const { return op; }
+    ExprNode* get_left() const { return left; }
+    ExprNode* get_right() const { return right; }
 };
 
 // Unary operation node
@@ -154,22 +131,16 @@ class UnaryOpNode : public ExprNode {
 private:
     string op;
     ExprNode* expr;
+    friend struct AstChildren;
+    friend class AstLowering;
 
 public:
+    static bool classof(const ASTNode* n) { return n->kind == AST_UNARY; }
     UnaryOpNode(string op, ExprNode* expr, string result_type)
-        : ExprNode(result_type), op(op), expr(expr) {}
-    
-    ~UnaryOpNode() { delete expr; }
-    
-    string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                        int& temp_count, int& label_count) const override {
-        string expr_temp = expr->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-
-        string result_temp = "t" + to_string(temp_count++);
-        
-        outcode <<result_temp << " = " << op << expr_temp << endl;
-        return result_temp;
-    }
+        : ExprNode(AST_UNARY, result_type), op(op), expr(expr) {}
+
+    const string& get_op() const { return op; }
+    ExprNode* get_expr() const { return expr; }
 };
 
 // Assignment node
@@ -178,41 +149,20 @@ class AssignNode : public ExprNode {
     private:
         VarNode* lhs;
         ExprNode* rhs;
+        friend struct AstChildren;
+        friend class AstLowering;
 
     public:
+        static bool classof(const ASTNode* n) { return n->kind == AST_ASSIGN; }
         AssignNode(VarNode* lhs, ExprNode* rhs, string result_type)
-            : ExprNode(result_type), lhs(lhs), rhs(rhs) {}
-        
-        ~AssignNode() {
-            delete lhs;
-            delete rhs;
-        }
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
-            // Generate code for right-hand side
-            string rhs_temp = rhs->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            
-            if (lhs->has_index()) { //if array
-                string array_temp = symbol_to_temp[lhs->get_name()]; // Get the base array variable
-                string idx_temp = lhs->generate_index_code(outcode, symbol_to_temp, temp_count, label_count);
-                outcode << array_temp << "[" << idx_temp << "] = " << rhs_temp << endl;
-            } else { //if variable
-                string var_name = lhs->get_name();
-                // For regular variables, store the variable name itself (not a temp)
-                // Function parameters already have temps assigned in FuncDeclNode
-                if (symbol_to_temp.find(var_name) == symbol_to_temp.end()) {
-                    symbol_to_temp[var_name] = var_name; // Store variable name
-                }
-                
-                string lhs_temp = symbol_to_temp[var_name];
-                outcode << lhs_temp << " = " << rhs_temp << endl;
-                // Clear the last loaded temp since the variable was modified
-                var_last_loaded_temp.erase(var_name);
-                // Track the last assigned temp for return statements
-                var_last_assigned_temp[var_name] = rhs_temp;
-            }
-            return rhs_temp;
+            : ExprNode(AST_ASSIGN, result_type), lhs(lhs), rhs(rhs) {}
+
+        VarNode* get_lhs() const { return lhs; }
+
+        // x++ and x-- are built as x = x + 1 over a single VarNode, which
+        // the addition owns
+        bool shares_target() const {
+            return rhs && rhs->kind == AST_BINARY && static_cast<BinaryOpNode*>(rhs)->get_left() == lhs;
         }
 };
 
@@ -220,8 +170,8 @@ class AssignNode : public ExprNode {
 
 class StmtNode : public ASTNode {
     public:
-        virtual string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                                    int& temp_count, int& label_count) const = 0;
+        StmtNode(AstKind k) : ASTNode(k) {}
+        static bool classof(const ASTNode* n) { return n->kind >= AST_BLOCK && n->kind <= AST_RETURN; }
     };
 
     // Expression statement node
@@ -229,21 +179,14 @@ class StmtNode : public ASTNode {
     class ExprStmtNode : public StmtNode {
     private:
         ExprNode* expr;
+        friend struct AstChildren;
+        friend class AstLowering;
 
     public:
-        ExprStmtNode(ExprNode* e) : expr(e) {}
-        ~ExprStmtNode() { if(expr) delete expr; }
-        
+        static bool classof(const ASTNode* n) { return n->kind == AST_EXPR_STMT; }
+        ExprStmtNode(ExprNode* e) : StmtNode(AST_EXPR_STMT), expr(e) {}
+
         ExprNode* get_expr() const { return expr; }
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
-            if (expr) {
-                // Just generate code for the expression
-                expr->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            }
-            return ""; // Statements don't need to return a temp
-        }
 };
 
 // Block (compound statement) node
@@ -251,25 +194,16 @@ class StmtNode : public ASTNode {
 class BlockNode : public StmtNode {
     private:
         vector<StmtNode*> statements;
+        friend struct AstChildren;
+        friend class AstLowering;
 
     public:
-        ~BlockNode() {
-            for (auto stmt : statements) {
-                delete stmt;
-            }
-        }
-        
+        static bool classof(const ASTNode* n) { return n->kind == AST_BLOCK; }
+        BlockNode() : StmtNode(AST_BLOCK) {}
+
         void add_statement(StmtNode* stmt) {
             if (stmt) statements.push_back(stmt);
         }
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
-            for (auto stmt : statements) {
-                stmt->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            }
-            return "";
-        }
 };
 
 // If statement node
@@ -279,51 +213,13 @@ class IfNode : public StmtNode {
         ExprNode* condition;
         StmtNode* then_block;
         StmtNode* else_block; // nullptr if no else part
-    
+        friend struct AstChildren;
+        friend class AstLowering;
+
     public:
+        static bool classof(const ASTNode* n) { return n->kind == AST_IF; }
         IfNode(ExprNode* cond, StmtNode* then_stmt, StmtNode* else_stmt = nullptr)
-            : condition(cond), then_block(then_stmt), else_block(else_stmt) {}
-        
-        ~IfNode() {
-            delete condition;
-            delete then_block;
-            if (else_block) delete else_block;
-        }
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
-            // Generate code for the condition
-            string cond_temp = condition->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            
-            // Match the exact format in code3.txt
-            int then_label = label_count++;
-            int else_label = label_count++;
-            
-            // Output the if condition and goto statements exactly as in code3.txt
-            outcode << "if " << cond_temp << " goto L" << then_label << endl;
-            outcode << "goto L" << else_label << endl;
-            outcode << "L" << then_label << ":" << endl;
-            
-            // Generate code for the then block
-            then_block->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            
-            // Handle the else part if it exists
-            if (else_block) {
-                int end_label = label_count++;
-                outcode << "goto L" << end_label << endl;
-                outcode << "L" << else_label << ":" << endl;
-                else_block->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-                outcode << "L" << end_label << ":" << endl;
-            } else {
-                // If there's no else block, generate goto to end label, then else label, then end label
-                int end_label = label_count++;
-                outcode << "goto L" << end_label << endl;
-                outcode << "L" << else_label << ":" << endl;
-                outcode << "L" << end_label << ":" << endl;
-            }
-            
-            return "";
-        }
+            : StmtNode(AST_IF), condition(cond), then_block(then_stmt), else_block(else_stmt) {}
 };
 // While statement node
 
@@ -331,155 +227,40 @@ class WhileNode : public StmtNode {
 private:
     ExprNode* condition;
     StmtNode* body;
+    friend struct AstChildren;
+    friend class AstLowering;
 
 public:
+    static bool classof(const ASTNode* n) { return n->kind == AST_WHILE; }
     WhileNode(ExprNode* cond, StmtNode* body_stmt)
-        : condition(cond), body(body_stmt) {}
-    
-    ~WhileNode() {
-        delete condition;
-        delete body;
-    }
-    
-    string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                        int& temp_count, int& label_count) const override {
-        int start_label = label_count++;
-        int body_label = label_count++;
-        int end_label = label_count++; 
-        
-        outcode << "L" << start_label << ":" << endl;
-        
-        string cond_temp = condition->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-        
-        // If false, exit
-        outcode << "if " << cond_temp << " goto L" << body_label << endl;
-        outcode << "goto L" << end_label << endl;
-        
-        //body
-        outcode << "L" << body_label << ":" << endl;
-        body->generate_code(outcode, symbol_to_temp, temp_count, label_count); 
-
-        
-        // jump to condition 
-        outcode << "goto L" << start_label << endl;
-        outcode << "L" << end_label << ":" << endl;
-        
-        return "";
-    }
+        : StmtNode(AST_WHILE), condition(cond), body(body_stmt) {}
 };
 
 class ForNode : public StmtNode {
     private:
-        ExprNode* init;
-        ExprNode* condition;
+        ExprStmtNode* init;      // the header's first two parts are
+        ExprStmtNode* condition; // expression statements
         ExprNode* update;
         StmtNode* body;
-    
+        friend struct AstChildren;
+        friend class AstLowering;
+
     public:
-        ForNode(ExprNode* init_expr, ExprNode* cond_expr, ExprNode* update_expr, StmtNode* body_stmt)
-            : init(init_expr), condition(cond_expr), update(update_expr), body(body_stmt) {}
-        
-        ~ForNode() {
-            if (init) delete init;
-            if (condition) delete condition;
-            if (update) delete update;
-            delete body;
-        }
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
-            // Generate initialization code
-            if (init) {
-                init->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            }
-            
-            int cond_label = label_count++;
-            int body_label = label_count++;
-            int end_label = label_count++;
-            
-            // Start of the loop: condition check
-            outcode << "L" << cond_label << ":" << endl;
-
-            if (condition) {
-                // Check if condition is an ExprStmtNode (wrapped expression) and extract the expression
-                ExprStmtNode* expr_stmt = dynamic_cast<ExprStmtNode*>(condition);
-                ExprNode* cond_expr = nullptr;
-                
-                if (expr_stmt) {
-                    cond_expr = expr_stmt->get_expr();
-                } else {
-                    cond_expr = dynamic_cast<ExprNode*>(condition);
-                }
-                
-                string cond_temp = "";
-                if (cond_expr) {
-                    // Clear temp_cond before generating condition code
-                    temp_cond = "";
-                    cond_temp = cond_expr->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-                    // BinaryOpNode sets temp_cond as a side effect, prefer it if available
-                    if (!temp_cond.empty()) {
-                        cond_temp = temp_cond;
-                    }
-                }
-                
-                if (!cond_temp.empty()) {
-                    outcode << "if " << cond_temp << " goto L" << body_label << endl;
-                } else {
-                    outcode << "if  goto L" << body_label << endl;
-                }
-                outcode << "goto L" << end_label << endl;
-            }
-            temp_cond = "";
-            
-
-            outcode << "L" << body_label << ":" << endl;
-            body->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            
-    
-            if (update) {
-                update->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            }
-            
-            // Jump back to condition
-            outcode << "goto L" << cond_label << endl;
-            outcode << "L" << end_label << ":" << endl;
-            
-            
-            return "";
-        }
+        static bool classof(const ASTNode* n) { return n->kind == AST_FOR; }
+        ForNode(ExprStmtNode* init_expr, ExprStmtNode* cond_expr, ExprNode* update_expr, StmtNode* body_stmt)
+            : StmtNode(AST_FOR), init(init_expr), condition(cond_expr), update(update_expr), body(body_stmt) {}
     };
 // Return statement node
 
 class ReturnNode : public StmtNode {
     private:
         ExprNode* expr;
+        friend struct AstChildren;
+        friend class AstLowering;
 
     public:
-        ReturnNode(ExprNode* e) : expr(e) {}
-        ~ReturnNode() { if (expr) delete expr; }
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
-            if (expr) {
-                // Check if returning a simple variable - use last assigned temp if available
-                VarNode* var_node = dynamic_cast<VarNode*>(expr);
-                if (var_node && !var_node->has_index()) {
-                    string var_name = var_node->get_name();
-                    if (var_last_assigned_temp.find(var_name) != var_last_assigned_temp.end()) {
-                        string ret_temp = var_last_assigned_temp[var_name];
-                        outcode << "return " << ret_temp << endl;
-                        return "";
-                    }
-                }
-                // Generate code for the return value
-                string ret_temp = expr->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-                outcode << "return " << ret_temp << endl;
-            } else {
-                // Void return
-                outcode << "return" << endl;
-            }
-            return "";
-        }
+        static bool classof(const ASTNode* n) { return n->kind == AST_RETURN; }
+        ReturnNode(ExprNode* e) : StmtNode(AST_RETURN), expr(e) {}
 };
 
 // Declaration node
@@ -490,32 +271,13 @@ class DeclNode : public StmtNode {
         vector<pair<string, int>> vars; // Variable name and array size (0 for regular vars)
 
     public:
-        DeclNode(string t) : type(t) {}
-        
+        static bool classof(const ASTNode* n) { return n->kind == AST_DECL; }
+        DeclNode(string t) : StmtNode(AST_DECL), type(t) {}
+
         void add_var(string name, int array_size = 0) {
             vars.push_back(make_pair(name, array_size));
         }
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
-            for (auto var : vars) {
-                string var_name = var.first;
-                int array_size = var.second;
-                
-                // Assign a temp name to this variable if it doesn't have one yet
-                if (symbol_to_temp.find(var_name) == symbol_to_temp.end()) {
-                    symbol_to_temp[var_name] = var.first; 
-                }
-                
-                if (array_size > 0) {
-                    outcode << "// Declaration: " << type << " " << var_name << "[" << array_size << "]" << endl;
-                } else {
-                    outcode << "// Declaration: " << type << " " << var_name << endl;
-                }
-            }
-            return "";
-        }
-        
+
         string get_type() const { return type; }
         const vector<pair<string, int>>& get_vars() const { return vars; }
 };
@@ -528,89 +290,55 @@ class FuncDeclNode : public ASTNode {
         string name;
         vector<pair<string, string>> params; // Parameter type and name
         BlockNode* body;
+        friend struct AstChildren;
+        friend class AstLowering;
 
     public:
-        FuncDeclNode(string ret_type, string n) : return_type(ret_type), name(n), body(nullptr) {}
-        ~FuncDeclNode() { if (body) delete body; }
-        
+        static bool classof(const ASTNode* n) { return n->kind == AST_FUNC_DECL; }
+        FuncDeclNode(string ret_type, string n) : ASTNode(AST_FUNC_DECL), return_type(ret_type), name(n), body(nullptr) {}
+
         void add_param(string type, string name) {
             params.push_back(make_pair(type, name));
         }
-        
+
         void set_body(BlockNode* b) {
             body = b;
         }
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
-            // Resetting for each function
-            symbol_to_temp.clear();
-            var_last_loaded_temp.clear();
-            var_last_assigned_temp.clear();
-            
-            outcode << "// Function: " << return_type << " " << name << "(";
-            
-            // Printing parameter list
-            for (size_t i = 0; i < params.size(); ++i) {
-                outcode << params[i].first << " " << params[i].second;
-                if (i < params.size() - 1) {
-                    outcode << ", ";
-                }
-            }
-            outcode << ")" << endl;
-            
-            for (size_t i = 0; i < params.size(); ++i) {
-                string param_name = params[i].second;
-                // assigning temp variable to function params
-                string temp_var = "t" + to_string(temp_count++);
-                symbol_to_temp[param_name] = temp_var;
-                outcode << temp_var << " = " << param_name << endl;
-            }
-            
-            if (body) {
-                body->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            }
-            
-            outcode << endl; // Blank line after function
-            
-            return "";
-        }
+
+        const string& get_name() const { return name; }
+        const string& get_return_type() const { return return_type; }
+        const vector<pair<string, string>>& get_params() const { return params; }
 };
 
-// Helper class for function arguments
+// Helper class for function arguments. It only exists while parsing: the
+// arguments are handed over to the FuncCallNode.
 
 class ArgumentsNode : public ASTNode {
 private:
     vector<ExprNode*> args;
 
 public:
-    ~ArgumentsNode() {
-        // Don't delete args here - they'll be transferred to FuncCallNode
-    }
-    
+    static bool classof(const ASTNode* n) { return n->kind == AST_ARGUMENTS; }
+    ArgumentsNode() : ASTNode(AST_ARGUMENTS) {}
+
     void add_argument(ExprNode* arg) {
         if (arg) args.push_back(arg);
     }
-    
+
     ExprNode* get_argument(int index) const {
         if (index >= 0 && index < args.size()) {
             return args[index];
         }
         return nullptr;
     }
-    
+
     size_t size() const {
         return args.size();
     }
-    
+
     const vector<ExprNode*>& get_arguments() const {
         return args;
     }
-    
-    string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                        int& temp_count, int& label_count) const override {
-        return "";
-    }
 };
 
 // Function call node
@@ -619,43 +347,19 @@ class FuncCallNode : public ExprNode {
 private:
     string func_name;
     vector<ExprNode*> arguments;
+    friend struct AstChildren;
+    friend class AstLowering;
 
 public:
+    static bool classof(const ASTNode* n) { return n->kind == AST_CALL; }
     FuncCallNode(string name, string result_type)
-        : ExprNode(result_type), func_name(name) {}
-    
-    ~FuncCallNode() {
-        for (auto arg : arguments) {
-            delete arg;
-        }
-    }
-    
+        : ExprNode(AST_CALL, result_type), func_name(name) {}
+
+    const string& get_name() const { return func_name; }
+
     void add_argument(ExprNode* arg) {
         if (arg) arguments.push_back(arg);
     }
-    
-    string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                        int& temp_count, int& label_count) const override {
-        // Generate code for each argument
-        vector<string> arg_temps;
-        for (auto arg : arguments) {
-            string arg_temp = arg->generate_code(outcode, symbol_to_temp, temp_count, label_count);
-            arg_temps.push_back(arg_temp);
-        }
-        
-        // Push parameters directly without creating extra temps
-        for (int i = 0; i < arg_temps.size(); i++) {
-            outcode << "param " << arg_temps[i] << endl;
-        }
-        
-        // Create a temp for the function call result
-        string result_temp = "t" + to_string(temp_count++);
-        
-        // Generate the function call
-        outcode << result_temp << " = call " << func_name << ", " << arg_temps.size() << endl;
-        
-        return result_temp;
-    }
 };
 
 // Program node (root of AST)
@@ -663,27 +367,439 @@ public:
 class ProgramNode : public ASTNode {
     private:
         vector<ASTNode*> units;
+        friend struct AstChildren;
+        friend class AstLowering;
 
     public:
-        ~ProgramNode() {
-            for (auto unit : units) {
-                delete unit;
-            }
-        }
-        
+        static bool classof(const ASTNode* n) { return n->kind == AST_PROGRAM; }
+        ProgramNode() : ASTNode(AST_PROGRAM) {}
+
         void add_unit(ASTNode* unit) {
             if (unit) units.push_back(unit);
         }
-        
-        string generate_code(ofstream& outcode, map<string, string>& symbol_to_temp,
-                            int& temp_count, int& label_count) const override {
+};
+
+// Generates three address code for a tree. Instead of recursing it keeps a
+// stack of frames, one per node being lowered. A frame that needs a child's
+// temp pushes the child, and picks up at its next stage once the child is
+// done, with the child's temp in `result`.
+class AstLowering {
+private:
+    struct Frame {
+        const ASTNode* n;
+        int stage;
+        size_t i;      // next child, for nodes with a list of them
+        int labels[3];
+        string a, b;   // temps held across children
+        size_t args;   // where a call's argument temps start in arg_temps
+        Frame(const ASTNode* node) : n(node), stage(0), i(0), args(0) {}
+    };
+
+    ostream& outcode;
+    map<string, string>& symbol_to_temp;
+    int& temp_count;
+    int& label_count;
+    vector<Frame> frames;
+    vector<string> arg_temps; // of the calls being lowered, innermost last
+    unordered_map<const ASTNode*, string> shared_temps; // of shared nodes lowered so far
+    string result;
+
+    string new_temp() { return "t" + to_string(temp_count++); }
+
+    // Where a variable lives. One seen for the first time (a global, or a
+    // local before its first assignment) goes by its own name.
+    const string& variable(const string& name) {
+        auto it = symbol_to_temp.find(name);
+        if (it == symbol_to_temp.end()) it = symbol_to_temp.insert(make_pair(name, name)).first;
+        return it->second;
+    }
+
+    static bool is_temp_name(const string& s) {
+        if (s.length() <= 1 || s[0] != 't') return false;
+        for (size_t i = 1; i < s.length(); i++) {
+            if (!isdigit(s[i])) return false;
+        }
+        return true;
+    }
+
+    // Array indices get a temp of their own
+    string index_copy(const string& idx_temp) {
+        string idx_result = new_temp();
+        outcode << idx_result << " = " << idx_temp << "\n";
+        return idx_result;
+    }
+
+    // A shared node is only lowered the first time; it's shared within
+    // straight-line code, so its temp still holds the value afterwards
+    void push(const ASTNode* n) {
+        if (n->extra_refs) {
+            auto it = shared_temps.find(n);
+            if (it != shared_temps.end()) {
+                result = it->second;
+                if (n->kind == AST_BINARY) temp_cond = result;
+                return;
+            }
+        }
+        frames.push_back(Frame(n));
+    }
+
+    void finish(string temp) {
+        if (frames.back().n->extra_refs) shared_temps[frames.back().n] = temp;
+        result = move(temp);
+        frames.pop_back();
+    }
+
+    // Runs the top frame until it pushes a child or finishes. A push can
+    // move the frames, so nothing touches f after one. A push that finds the
+    // child already lowered leaves its temp in `result` straight away, and
+    // the frame's next step picks it up as usual.
+    void step() {
+        Frame& f = frames.back();
+        switch (f.n->kind) {
+        case AST_PROGRAM: {
+            const vector<ASTNode*>& units = static_cast<const ProgramNode*>(f.n)->units;
+            if (f.i < units.size()) push(units[f.i++]);
+            else finish("");
+            return;
+        }
+        case AST_FUNC_DECL: {
+            const FuncDeclNode* fn = static_cast<const FuncDeclNode*>(f.n);
+            if (f.stage == 0) {
+                // Resetting for each function
+                symbol_to_temp.clear();
+                var_last_loaded_temp.clear();
+                var_last_assigned_temp.clear();
+
+                outcode << "// Function: " << fn->return_type << " " << fn->name << "(";
+                for (size_t i = 0; i < fn->params.size(); ++i) {
+                    outcode << fn->params[i].first << " " << fn->params[i].second;
+                    if (i < fn->params.size() - 1) outcode << ", ";
+                }
+                outcode << ")" << "\n";
 
-            for (auto unit : units) {
-                unit->generate_code(outcode, symbol_to_temp, temp_count, label_count);
+                for (size_t i = 0; i < fn->params.size(); ++i) {
+                    // assigning temp variable to function params
+                    string temp_var = new_temp();
+                    symbol_to_temp[fn->params[i].second] = temp_var;
+                    outcode << temp_var << " = " << fn->params[i].second << "\n";
+                }
+                f.stage = 1;
+                if (fn->body) push(fn->body);
+                return;
+            }
+            outcode << "\n"; // Blank line after function
+            finish("");
+            return;
+        }
+        case AST_BLOCK: {
+            const vector<StmtNode*>& statements = static_cast<const BlockNode*>(f.n)->statements;
+            if (f.i < statements.size()) push(statements[f.i++]);
+            else finish("");
+            return;
+        }
+        case AST_DECL: {
+            const DeclNode* decl = static_cast<const DeclNode*>(f.n);
+            for (auto& var : decl->get_vars()) {
+                variable(var.first);
+                if (var.second > 0) {
+                    outcode << "// Declaration: " << decl->get_type() << " " << var.first << "[" << var.second << "]" << "\n";
+                } else {
+                    outcode << "// Declaration: " << decl->get_type() << " " << var.first << "\n";
+                }
+            }
+            finish("");
+            return;
+        }
+        case AST_EXPR_STMT: {
+            const ExprStmtNode* stmt = static_cast<const ExprStmtNode*>(f.n);
+            if (f.stage == 0) {
+                f.stage = 1;
+                if (stmt->expr) push(stmt->expr);
+                return;
+            }
+            finish(""); // Statements don't need to return a temp
+            return;
+        }
+        case AST_IF: {
+            const IfNode* node = static_cast<const IfNode*>(f.n);
+            switch (f.stage) {
+            case 0:
+                f.stage = 1;
+                push(node->condition);
+                return;
+            case 1:
+                f.labels[0] = label_count++; // then
+                f.labels[1] = label_count++; // else
+                outcode << "if " << result << " goto L" << f.labels[0] << "\n";
+                outcode << "goto L" << f.labels[1] << "\n";
+                emit_label(outcode, f.labels[0]);
+                f.stage = 2;
+                push(node->then_block);
+                return;
+            case 2:
+                // The else label is there even without an else part
+                f.labels[2] = label_count++; // end
+                outcode << "goto L" << f.labels[2] << "\n";
+                emit_label(outcode, f.labels[1]);
+                f.stage = 3;
+                if (node->else_block) push(node->else_block);
+                return;
+            default:
+                emit_label(outcode, f.labels[2]);
+                finish("");
+                return;
             }
-            
-            return "";
         }
+        case AST_WHILE: {
+            const WhileNode* node = static_cast<const WhileNode*>(f.n);
+            switch (f.stage) {
+            case 0:
+                f.labels[0] = label_count++; // start
+                f.labels[1] = label_count++; // body
+                f.labels[2] = label_count++; // end
+                emit_label(outcode, f.labels[0]);
+                f.stage = 1;
+                push(node->condition);
+                return;
+            case 1:
+                outcode << "if " << result << " goto L" << f.labels[1] << "\n";
+                outcode << "goto L" << f.labels[2] << "\n";
+                emit_label(outcode, f.labels[1]);
+                f.stage = 2;
+                push(node->body);
+                return;
+            default:
+                // jump to condition
+                outcode << "goto L" << f.labels[0] << "\n";
+                emit_label(outcode, f.labels[2]);
+                finish("");
+                return;
+            }
+        }
+        case AST_FOR: {
+            const ForNode* node = static_cast<const ForNode*>(f.n);
+            switch (f.stage) {
+            case 0:
+                f.stage = 1;
+                if (node->init) push(node->init);
+                return;
+            case 1:
+                f.labels[0] = label_count++; // condition
+                f.labels[1] = label_count++; // body
+                f.labels[2] = label_count++; // end
+                emit_label(outcode, f.labels[0]);
+                f.stage = 3;
+                if (node->condition) {
+                    // Unwrap the expression statement (empty for `for (;;)`)
+                    if (node->condition->expr) {
+                        temp_cond = "";
+                        f.stage = 2;
+                        push(node->condition->expr);
+                        return;
+                    }
+                    outcode << "if  goto L" << f.labels[1] << "\n";
+                    outcode << "goto L" << f.labels[2] << "\n";
+                }
+                return;
+            case 2:
+                // BinaryOpNode sets temp_cond as a side effect, prefer it if available
+                outcode << "if " << (temp_cond.empty() ? result : temp_cond) << " goto L" << f.labels[1] << "\n";
+                outcode << "goto L" << f.labels[2] << "\n";
+                f.stage = 3;
+                return;
+            case 3:
+                temp_cond = "";
+                emit_label(outcode, f.labels[1]);
+                f.stage = 4;
+                push(node->body);
+                return;
+            case 4:
+                f.stage = 5;
+                if (node->update) push(node->update);
+                return;
+            default:
+                // Jump back to condition
+                outcode << "goto L" << f.labels[0] << "\n";
+                emit_label(outcode, f.labels[2]);
+                finish("");
+                return;
+            }
+        }
+        case AST_RETURN: {
+            const ReturnNode* node = static_cast<const ReturnNode*>(f.n);
+            if (f.stage == 0) {
+                if (!node->expr) {
+                    // Void return
+                    outcode << "return" << "\n";
+                    finish("");
+                    return;
+                }
+                // Check if returning a simple variable - use last assigned temp if available
+                const VarNode* var_node = ast_cast<VarNode>(node->expr);
+                if (var_node && !var_node->has_index()) {
+                    auto it = var_last_assigned_temp.find(var_node->name);
+                    if (it != var_last_assigned_temp.end()) {
+                        outcode << "return " << it->second << "\n";
+                        finish("");
+                        return;
+                    }
+                }
+                f.stage = 1;
+                push(node->expr);
+                return;
+            }
+            outcode << "return " << result << "\n";
+            finish("");
+            return;
+        }
+        case AST_VAR: {
+            const VarNode* var = static_cast<const VarNode*>(f.n);
+            if (f.stage == 0) {
+                f.a = variable(var->name);
+                if (var->index) {
+                    //array
+                    f.stage = 1;
+                    push(var->index);
+                    return;
+                }
+                // Check if we recently loaded this variable - reuse the temp if available
+                auto loaded = var_last_loaded_temp.find(var->name);
+                if (loaded != var_last_loaded_temp.end()) {
+                    finish(loaded->second);
+                    return;
+                }
+                // Function parameters already live in temps, use them directly
+                if (is_temp_name(f.a)) {
+                    finish(f.a);
+                    return;
+                }
+                // Load variable into a new temp before using it
+                string result_temp = new_temp();
+                outcode << result_temp << " = " << f.a << "\n";
+                var_last_loaded_temp[var->name] = result_temp;
+                finish(result_temp);
+                return;
+            }
+            string idx_temp = index_copy(result);
+            string result_temp = new_temp();
+            outcode << result_temp << " = " << f.a << "[" << idx_temp << "]" << "\n";
+            finish(result_temp);
+            return;
+        }
+        case AST_CONST: {
+            string const_temp = new_temp();
+            outcode << const_temp << " = " << static_cast<const ConstNode*>(f.n)->get_value() << "\n";
+            finish(const_temp);
+            return;
+        }
+        case AST_BINARY: {
+            const BinaryOpNode* node = static_cast<const BinaryOpNode*>(f.n);
+            switch (f.stage) {
+            case 0:
+                f.stage = 1;
+                push(node->left);
+                return;
+            case 1:
+                f.a = move(result);
+                f.stage = 2;
+                push(node->right);
+                return;
+            default: {
+                string result_temp = new_temp();
+                outcode << result_temp << " = " << f.a << " " << node->op << " " << result << "\n";
+                temp_cond = result_temp;
+                finish(result_temp);
+                return;
+            }
+            }
+        }
+        case AST_UNARY: {
+            const UnaryOpNode* node = static_cast<const UnaryOpNode*>(f.n);
+            if (f.stage == 0) {
+                f.stage = 1;
+                push(node->expr);
+                return;
+            }
+            string result_temp = new_temp();
+            outcode << result_temp << " = " << node->op << result << "\n";
+            finish(result_temp);
+            return;
+        }
+        case AST_ASSIGN: {
+            const AssignNode* node = static_cast<const AssignNode*>(f.n);
+            switch (f.stage) {
+            case 0:
+                // Generate code for right-hand side
+                f.stage = 1;
+                push(node->rhs);
+                return;
+            case 1: {
+                f.a = move(result);
+                if (node->lhs->has_index()) {
+                    // Get the base array variable (globals aren't in the map yet)
+                    f.b = variable(node->lhs->name);
+                    f.stage = 2;
+                    push(node->lhs->index);
+                    return;
+                }
+                // Parameters are already in temps, other variables are
+                // stored by name
+                const string& var_name = node->lhs->name;
+                outcode << variable(var_name) << " = " << f.a << "\n";
+                // Clear the last loaded temp since the variable was modified
+                var_last_loaded_temp.erase(var_name);
+                // Track the last assigned temp for return statements
+                var_last_assigned_temp[var_name] = f.a;
+                finish(f.a);
+                return;
+            }
+            default: {
+                string idx_temp = index_copy(result);
+                outcode << f.b << "[" << idx_temp << "] = " << f.a << "\n";
+                finish(f.a);
+                return;
+            }
+            }
+        }
+        case AST_CALL: {
+            const FuncCallNode* call = static_cast<const FuncCallNode*>(f.n);
+            // Generate code for each argument
+            if (f.stage == 0) f.args = arg_temps.size();
+            else arg_temps.push_back(move(result));
+            if (f.i < call->arguments.size()) {
+                f.stage = 1;
+                push(call->arguments[f.i++]);
+                return;
+            }
+            // Push parameters directly without creating extra temps
+            for (size_t i = f.args; i < arg_temps.size(); i++) outcode << "param " << arg_temps[i] << "\n";
+            string result_temp = new_temp();
+            outcode << result_temp << " = call " << call->func_name << ", " << arg_temps.size() - f.args << "\n";
+            arg_temps.resize(f.args);
+            finish(result_temp);
+            return;
+        }
+        default: // argument lists never get this far
+            finish("");
+            return;
+        }
+    }
+
+public:
+    AstLowering(ostream& out, map<string, string>& symbol_to_temp, int& temp_count, int& label_count)
+        : outcode(out), symbol_to_temp(symbol_to_temp), temp_count(temp_count), label_count(label_count) {}
+
+    // Code for n and everything under it; returns the temp holding its value
+    string lower(const ASTNode* n) {
+        push(n);
+        while (!frames.empty()) step();
+        return result;
+    }
 };
 
-#endif // AST_H
\ No newline at end of file
+string ast_generate(const ASTNode* n, ostream& outcode, map<string, string>& symbol_to_temp, int& temp_count,
+                    int& label_count) {
+    return AstLowering(outcode, symbol_to_temp, temp_count, label_count).lower(n);
+}
+
+#endif // AST_H
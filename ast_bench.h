@@ -0,0 +1,183 @@
+#ifndef AST_BENCH_H
+#define AST_BENCH_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "ast.h"
+#include "ast_visitor.h"
+#include "flat_ast.h"
+#include "three_addr_code.h"
+#include "compiler.h"
+
+using namespace std;
+
+// Parser globals, defined in the grammar file
+extern ProgramNode* ast_root;
+extern FlatAst flat_ast;
+
+// A valid source file with roughly `nodes` AST nodes, in functions of about
+// ten thousand nodes each so the big function case is covered
+string synthetic_ast_source(size_t nodes) {
+    const size_t per_group = 54; // flat nodes per loop group below
+    const size_t groups_per_function = 160;
+    size_t groups = max<size_t>(1, nodes / per_group);
+    size_t functions = (groups + groups_per_function - 1) / groups_per_function;
+
+    stringstream src;
+    for (size_t f = 0; f < functions; f++) {
+        src << "int f" << f << "(int a, int b) {\n"
+            << "\tint x, y, i;\n\tint arr[10];\n\tx = a;\n\ty = b;\n";
+        size_t count = min(groups_per_function, groups - f * groups_per_function);
+        for (size_t g = 0; g < count; g++) {
+            src << "\tfor (i = 0; i < " << g + 1 << "; i++) {\n"
+                << "\t\tx = x + a * (b - i);\n"
+                << "\t\tif (x > 100) { x = x - arr[i % 10]; } else { y = y + 1; }\n"
+                << "\t\tarr[i % 10] = x + y;\n"
+                << "\t}\n";
+        }
+        src << "\treturn x + y;\n}\n";
+    }
+    src << "int main() {\n\tint s;\n\ts = 0;\n";
+    for (size_t f = 0; f < functions; f++) src << "\ts = s + f" << f << "(" << f << ", 2);\n";
+    src << "\treturn s;\n}\n";
+    return src.str();
+}
+
+// ./compiler --bench-ast [-n NODES] [-r REPEAT] [file]
+// Parses a source (a synthetic one by default) into both AST forms and
+// compares building and lowering them
+int run_ast_bench(int argc, char *argv[])
+{
+    size_t nodes = 1000000;
+    int repeat = 5;
+    string path;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) nodes = max(1LL, atoll(argv[++i]));
+        else if (arg == "-r" && i + 1 < argc) repeat = max(1, atoi(argv[++i]));
+        else path = arg;
+    }
+
+    string source;
+    if (path.empty()) {
+        source = synthetic_ast_source(nodes);
+    } else {
+        ifstream in(path.c_str(), ios::binary);
+        if (!in) {
+            cout << "Couldn't open " << path << endl;
+            return 1;
+        }
+        stringstream ss;
+        ss << in.rdbuf();
+        source = ss.str();
+    }
+
+    CompileOptions options;
+    options.generate_log = false;
+
+    // Parse cost without and with the flat tree alongside
+    flat_ast.enabled = false;
+    CompileResult plain = compile(source, options);
+    flat_ast.enabled = true;
+    CompileResult both = compile(source, options);
+    flat_ast.enabled = false;
+    if (!both.ok) {
+        cout << "Compilation failed:\n" << both.errors;
+        return 1;
+    }
+    cout << "Source: " << source.size() << " bytes, " << both.stats.lines << " lines, " << flat_ast.size()
+         << " flat nodes, " << flat_ast.strings.size() << " distinct strings" << endl;
+    cout << "Parse: " << plain.stats.parse_seconds * 1000 << " ms with the node tree, "
+         << both.stats.parse_seconds * 1000 << " ms building the flat tree too" << endl;
+    cout << "Flat tree: " << flat_ast.bytes() / 1024 << " KiB, " << sizeof(FlatOperands) + 2 << " bytes per node" << endl;
+
+    // Lowering, best of REPEAT, into memory
+    double tree_best = 1e100, flat_best = 1e100;
+    string tree_code, flat_code;
+    for (int r = 0; r < repeat; r++) {
+        for (int form = 0; form < 2; form++) {
+            stringstream out;
+            temp_cond = "";
+            auto start = chrono::steady_clock::now();
+            if (form == 0) ThreeAddrCodeGenerator(ast_root, out).generate();
+            else ThreeAddrCodeGenerator(flat_ast, out).generate();
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            if (form == 0) {
+                tree_best = min(tree_best, seconds);
+                tree_code = out.str();
+            } else {
+                flat_best = min(flat_best, seconds);
+                flat_code = out.str();
+            }
+        }
+    }
+    cout << "Lowering to TAC, best of " << repeat << ": node tree " << tree_best * 1000 << " ms, flat tree "
+         << flat_best * 1000 << " ms";
+    if (flat_best > 0) cout << " (" << tree_best / flat_best << "x)";
+    cout << endl;
+    if (tree_code != flat_code || tree_code != both.tac) {
+        cout << "MISMATCH: the flat tree lowered to different code" << endl;
+        return 1;
+    }
+    cout << "Both trees give the same " << tree_code.size() << " bytes of TAC" << endl;
+
+    // A pure walk: node counts per kind, over the node tree with an explicit
+    // stack and over the flat tree's kind array. The variable x++ shares is
+    // counted once per parent in the node tree.
+    double walk_best = 1e100, scan_best = 1e100;
+    vector<size_t> tree_kinds(AST_KIND_COUNT), per_kind(FLAT_KIND_COUNT);
+    vector<ASTNode*> stack;
+    for (int r = 0; r < repeat; r++) {
+        auto start = chrono::steady_clock::now();
+        fill(tree_kinds.begin(), tree_kinds.end(), 0);
+        stack.assign(1, ast_root);
+        while (!stack.empty()) {
+            ASTNode* n = stack.back();
+            stack.pop_back();
+            tree_kinds[n->kind]++;
+            AstChildren::for_each(n, [&stack](ASTNode* child) { stack.push_back(child); });
+        }
+        walk_best = min(walk_best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+
+        start = chrono::steady_clock::now();
+        fill(per_kind.begin(), per_kind.end(), 0);
+        for (uint8_t kind : flat_ast.kinds) per_kind[kind]++;
+        scan_best = min(scan_best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    cout << "Kind census, best of " << repeat << ": node tree " << walk_best * 1e6 << " us, flat tree "
+         << scan_best * 1e6 << " us";
+    if (scan_best > 0) cout << " (" << walk_best / scan_best << "x)";
+    cout << endl;
+    const char* separator = "";
+    cout << "  node tree (";
+    for (int k = 0; k < AST_KIND_COUNT; k++) {
+        if (!tree_kinds[k]) continue;
+        cout << separator << ast_kind_name((AstKind)k) << "=" << tree_kinds[k];
+        separator = " ";
+    }
+    separator = "";
+    cout << ")" << endl << "  flat tree (";
+    for (int k = 0; k < FLAT_KIND_COUNT; k++) {
+        if (!per_kind[k]) continue;
+        cout << separator << flat_kind_name(k) << "=" << per_kind[k];
+        separator = " ";
+    }
+    cout << ")" << endl;
+
+    // Teardown: one free per node against a few for the flat tree
+    auto start = chrono::steady_clock::now();
+    ast_delete(ast_root);
+    ast_root = new ProgramNode();
+    double tree_teardown = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    flat_ast = FlatAst();
+    cout << "Teardown: node tree " << tree_teardown * 1e6 << " us, flat tree "
+         << chrono::duration<double>(chrono::steady_clock::now() - start).count() * 1e6 << " us" << endl;
+    return 0;
+}
+
+#endif // AST_BENCH_H
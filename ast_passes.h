@@ -0,0 +1,435 @@
+#ifndef AST_PASSES_H
+#define AST_PASSES_H
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include "ast.h"
+#include "ast_visitor.h"
+#include "flat_ast.h"
+#include "three_addr_code.h"
+
+using namespace std;
+
+// Passes over the AST after a clean parse, run in order by AstPassManager.
+//
+// Each pass has a name, can be switched on or off, and is timed. Analyses
+// write what they find to the log. Code generation is the last pass
+// ("tac"), so anything that rewrites the tree goes in front of it.
+
+struct AstPassContext {
+    ostream& log;
+    ostream& code;
+    const FlatAst* flat; // lower this instead of the node tree when set
+};
+
+class AstPass {
+public:
+    virtual ~AstPass() {}
+    virtual const char* name() const = 0;
+    virtual const char* description() const = 0;
+    virtual void run(ProgramNode* root, AstPassContext& ctx) = 0;
+    // Whether the pass changes the node tree. The flat tree is built by the
+    // parse and never sees such a change.
+    virtual bool rewrites_tree() const { return false; }
+};
+
+// Node counts per kind and the deepest nesting
+class AstStatsPass : public AstPass, public AstVisitor<AstStatsPass> {
+private:
+    size_t counts[AST_KIND_COUNT];
+    int depth = 0, max_depth = 0;
+
+public:
+    const char* name() const override { return "stats"; }
+    const char* description() const override { return "log node counts per kind and the tree depth"; }
+
+    void enter(ASTNode* n) {
+        counts[n->kind]++;
+        max_depth = max(max_depth, ++depth);
+    }
+    void leave(ASTNode*) { depth--; }
+
+    void run(ProgramNode* root, AstPassContext& ctx) override {
+        fill(counts, counts + AST_KIND_COUNT, 0);
+        depth = max_depth = 0;
+        visit(root);
+        size_t total = 0;
+        for (size_t c : counts) total += c;
+        ctx.log << "AST statistics: " << total << " nodes, depth " << max_depth << "\n";
+        for (int k = 0; k < AST_KIND_COUNT; k++) {
+            if (counts[k]) ctx.log << "  " << ast_kind_name((AstKind)k) << ": " << counts[k] << "\n";
+        }
+    }
+};
+
+// Indented tree, one node per line
+class AstDumpPass : public AstPass, public AstVisitor<AstDumpPass> {
+private:
+    ostream* out = NULL;
+    int depth = 0;
+
+    void line(const string& text) { *out << string(depth * 2, ' ') << text << "\n"; }
+
+public:
+    const char* name() const override { return "dump"; }
+    const char* description() const override { return "log the tree"; }
+
+    void enter(ASTNode* n) {
+        string text = ast_kind_name(n->kind);
+        switch (n->kind) {
+        case AST_FUNC_DECL: {
+            FuncDeclNode* f = static_cast<FuncDeclNode*>(n);
+            text += " " + f->get_return_type() + " " + f->get_name() + "(";
+            for (size_t i = 0; i < f->get_params().size(); i++) {
+                text += (i ? ", " : "") + f->get_params()[i].first + " " + f->get_params()[i].second;
+            }
+            text += ")";
+            break;
+        }
+        case AST_DECL: {
+            DeclNode* d = static_cast<DeclNode*>(n);
+            text += " " + d->get_type();
+            for (auto& var : d->get_vars()) {
+                text += " " + var.first;
+                if (var.second > 0) text += "[" + to_string(var.second) + "]";
+            }
+            break;
+        }
+        case AST_VAR: text += " " + static_cast<VarNode*>(n)->get_name(); break;
+        case AST_CONST: text += " " + static_cast<ConstNode*>(n)->get_value(); break;
+        case AST_BINARY: text += " " + static_cast<BinaryOpNode*>(n)->get_op(); break;
+        case AST_UNARY: text += " " + static_cast<UnaryOpNode*>(n)->get_op(); break;
+        case AST_CALL: text += " " + static_cast<FuncCallNode*>(n)->get_name(); break;
+        default: break;
+        }
+        if (n->kind >= AST_VAR) text += " : " + static_cast<ExprNode*>(n)->get_type();
+        line(text);
+        depth++;
+    }
+    void leave(ASTNode*) { depth--; }
+
+    void run(ProgramNode* root, AstPassContext& ctx) override {
+        out = &ctx.log;
+        depth = 0;
+        ctx.log << "AST:\n";
+        visit(root);
+    }
+};
+
+// Folds integer arithmetic, comparisons and logic on constants, bottom up.
+// Values are computed as 64-bit like the TAC executors do, and division or
+// modulus by zero is left for run time.
+class ConstantFoldPass : public AstPass, public AstVisitor<ConstantFoldPass> {
+private:
+    int folded = 0;
+
+    static bool int_value(ExprNode* e, long long& value) {
+        if (e->kind != AST_CONST || e->get_type() != "int") return false;
+        const string& text = static_cast<ConstNode*>(e)->get_value();
+        char* end;
+        errno = 0;
+        value = strtoll(text.c_str(), &end, 10);
+        return errno == 0 && !text.empty() && *end == '\0';
+    }
+
+    static bool apply(const string& op, long long x, long long y, long long& r) {
+        if (op == "+") r = (long long)((unsigned long long)x + (unsigned long long)y);
+        else if (op == "-") r = (long long)((unsigned long long)x - (unsigned long long)y);
+        else if (op == "*") r = (long long)((unsigned long long)x * (unsigned long long)y);
+        else if (op == "/" || op == "%") {
+            if (y == 0 || (x == LLONG_MIN && y == -1)) return false;
+            r = op == "/" ? x / y : x % y;
+        }
+        else if (op == "<") r = x < y;
+        else if (op == ">") r = x > y;
+        else if (op == "<=") r = x <= y;
+        else if (op == ">=") r = x >= y;
+        else if (op == "==") r = x == y;
+        else if (op == "!=") r = x != y;
+        else if (op == "&&") r = x && y;
+        else if (op == "||") r = x || y;
+        else return false;
+        return true;
+    }
+
+    ExprNode* fold(ExprNode* e) {
+        long long x, y, r;
+        if (e->kind == AST_BINARY) {
+            BinaryOpNode* b = static_cast<BinaryOpNode*>(e);
+            if (!int_value(b->get_left(), x) || !int_value(b->get_right(), y) || !apply(b->get_op(), x, y, r)) return e;
+        } else if (e->kind == AST_UNARY) {
+            UnaryOpNode* u = static_cast<UnaryOpNode*>(e);
+            if (!int_value(u->get_expr(), x)) return e;
+            if (u->get_op() == "-") r = (long long)(0ULL - (unsigned long long)x);
+            else if (u->get_op() == "+") r = x;
+            else if (u->get_op() == "!") r = !x;
+            else return e;
+        } else {
+            return e;
+        }
+        folded++;
+        ast_delete(e); // its operands are constants, which are never shared
+        return new ConstNode(to_string(r), "int");
+    }
+
+public:
+    const char* name() const override { return "fold"; }
+    const char* description() const override { return "fold constant integer expressions (node tree only)"; }
+    bool rewrites_tree() const override { return true; }
+
+    // Children are done first, so a whole constant subtree collapses
+    void leave(ASTNode* n) {
+        AstChildren::for_each_expr(n, [this](ExprNode*& slot) { slot = fold(slot); });
+    }
+
+    void run(ProgramNode* root, AstPassContext& ctx) override {
+        folded = 0;
+        visit(root);
+        ctx.log << "Constant folding: " << folded << " expressions folded\n";
+    }
+};
+
+// Hash-conses expressions into a DAG within straight-line code: a
+// subexpression equal to one already seen there becomes the same node, and
+// lowering computes it once and reuses its temp.
+//
+// Keys are built from the children once they're shared, so equal subtrees
+// get equal keys. A variable read is also keyed by how many times the
+// variable (or, for an element, its array) has been assigned so far, and by
+// how many calls there have been, since a call can change any global. A
+// read after a write gets a key of its own that way, and nothing has to be
+// evicted from the table. Each branch and loop part starts with an empty
+// table, because a temp computed in one isn't set on every path into the
+// next.
+class ExprDagPass : public AstPass, public AstVisitor<ExprDagPass> {
+private:
+    unordered_map<string, ExprNode*> table;
+    unordered_map<ExprNode*, ExprNode*> replaced; // duplicates, until their parent takes the shared node
+    unordered_map<string, int> writes;            // per variable, and "a[]" for any element of a
+    int calls = 0;
+    vector<ASTNode*> statements;    // being walked, innermost last
+    vector<VarNode*> targets;       // of the assignments being walked
+    size_t exprs = 0, duplicates = 0, shared = 0;
+    size_t per_kind[AST_KIND_COUNT];
+
+    static string id(const ExprNode* e) { return to_string((uintptr_t)e); }
+
+    string version(const string& name) { return to_string(writes[name]) + "." + to_string(calls); }
+
+    // Empty for nodes that are never shared: assignments, calls, and
+    // variables being assigned to (x++ reads its target too)
+    string key(ExprNode* e) {
+        switch (e->kind) {
+        case AST_VAR: {
+            VarNode* v = static_cast<VarNode*>(e);
+            if (find(targets.begin(), targets.end(), v) != targets.end()) return "";
+            if (v->has_index()) return "a " + v->get_name() + " " + version(v->get_name() + "[]") + " " + id(v->get_index());
+            return "v " + v->get_name() + " " + version(v->get_name());
+        }
+        case AST_CONST:
+            return "c " + static_cast<ConstNode*>(e)->get_value() + " " + e->get_type();
+        case AST_BINARY: {
+            BinaryOpNode* b = static_cast<BinaryOpNode*>(e);
+            return "b " + b->get_op() + " " + e->get_type() + " " + id(b->get_left()) + " " + id(b->get_right());
+        }
+        case AST_UNARY: {
+            UnaryOpNode* u = static_cast<UnaryOpNode*>(e);
+            return "u " + u->get_op() + " " + e->get_type() + " " + id(u->get_expr());
+        }
+        default:
+            return "";
+        }
+    }
+
+    // Whether n's children are the parts of a branch or a loop
+    static bool splits(const ASTNode* n) { return n->kind == AST_IF || n->kind == AST_WHILE || n->kind == AST_FOR; }
+
+public:
+    const char* name() const override { return "dag"; }
+    const char* description() const override { return "share equal expressions in straight-line code (node tree only)"; }
+    bool rewrites_tree() const override { return true; }
+
+    void enter(ASTNode* n) {
+        if (n->kind == AST_FUNC_DECL || splits(n)) table.clear();
+        if (StmtNode::classof(n)) {
+            if (!statements.empty() && splits(statements.back())) table.clear();
+            statements.push_back(n);
+        }
+        if (n->kind == AST_ASSIGN) targets.push_back(static_cast<AssignNode*>(n)->get_lhs());
+    }
+
+    void leave(ASTNode* n) {
+        // The children are done, so take their shared nodes
+        AstChildren::for_each_expr(n, [this](ExprNode*& slot) {
+            auto it = replaced.find(slot);
+            if (it == replaced.end()) return;
+            ExprNode* duplicate = slot;
+            slot = it->second;
+            replaced.erase(it);
+            ast_delete(duplicate);
+        });
+
+        if (StmtNode::classof(n)) {
+            statements.pop_back();
+            if (splits(n) || (!statements.empty() && splits(statements.back()))) table.clear();
+            return;
+        }
+        if (!ExprNode::classof(n)) return;
+
+        ExprNode* e = static_cast<ExprNode*>(n);
+        exprs++;
+        string k = key(e);
+        if (!k.empty()) {
+            // x++ on an element walks the element twice; the second time
+            // finds its own index already there
+            auto found = table.emplace(move(k), e);
+            if (!found.second && found.first->second != e) {
+                ExprNode* first = found.first->second;
+                if (first->extra_refs++ == 0) shared++;
+                replaced[e] = first;
+                duplicates++;
+                per_kind[e->kind]++;
+            }
+        }
+        // Writes come after everything they're computed from
+        if (e->kind == AST_ASSIGN) {
+            VarNode* lhs = targets.back();
+            targets.pop_back();
+            writes[lhs->has_index() ? lhs->get_name() + "[]" : lhs->get_name()]++;
+        } else if (e->kind == AST_CALL) {
+            calls++;
+        }
+    }
+
+    void run(ProgramNode* root, AstPassContext& ctx) override {
+        table.clear();
+        replaced.clear();
+        writes.clear();
+        calls = 0;
+        exprs = duplicates = shared = 0;
+        fill(per_kind, per_kind + AST_KIND_COUNT, 0);
+        visit(root);
+        ctx.log << "Expression DAG: " << exprs << " expression nodes, " << duplicates << " replaced by " << shared
+                << " shared nodes\n";
+        for (int k = 0; k < AST_KIND_COUNT; k++) {
+            if (per_kind[k]) ctx.log << "  " << ast_kind_name((AstKind)k) << ": " << per_kind[k] << " replaced\n";
+        }
+    }
+};
+
+// Three address code, from the node tree or the flat tree
+class TacGenPass : public AstPass {
+public:
+    const char* name() const override { return "tac"; }
+    const char* description() const override { return "generate three address code"; }
+
+    void run(ProgramNode* root, AstPassContext& ctx) override {
+        if (ctx.flat) ThreeAddrCodeGenerator(*ctx.flat, ctx.code).generate();
+        else ThreeAddrCodeGenerator(root, ctx.code).generate();
+    }
+};
+
+class AstPassManager {
+private:
+    struct Entry {
+        AstPass* pass;
+        bool enabled;
+        int runs;
+        double seconds;
+    };
+    vector<Entry> passes;
+
+public:
+    ~AstPassManager() {
+        for (Entry& e : passes) delete e.pass;
+    }
+
+    // Takes ownership; passes run in the order they were added
+    void add(AstPass* pass, bool enabled = true) { passes.push_back({pass, enabled, 0, 0}); }
+
+    // False if there's no pass by that name
+    bool set_enabled(const string& name, bool enabled) {
+        for (Entry& e : passes) {
+            if (name == e.pass->name()) {
+                e.enabled = enabled;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(ProgramNode* root, AstPassContext& ctx) {
+        for (Entry& e : passes) {
+            if (!e.enabled) continue;
+            auto start = chrono::steady_clock::now();
+            e.pass->run(root, ctx);
+            e.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            e.runs++;
+        }
+    }
+
+    void write_passes(ostream& out) const {
+        for (const Entry& e : passes) {
+            out << "  " << left << setw(8) << e.pass->name() << (e.enabled ? "on   " : "off  ") << e.pass->description()
+                << "\n";
+        }
+        out << right;
+    }
+
+    // The first pass that's on and rewrites the node tree, or NULL
+    const char* tree_rewriter() const {
+        for (const Entry& e : passes) {
+            if (e.enabled && e.pass->rewrites_tree()) return e.pass->name();
+        }
+        return NULL;
+    }
+
+    // The passes that are on, in order, e.g. "fold,tac"
+    string enabled_names() const {
+        string names;
+        for (const Entry& e : passes) {
+            if (!e.enabled) continue;
+            if (!names.empty()) names += ",";
+            names += e.pass->name();
+        }
+        return names;
+    }
+
+    // Time spent in each pass so far
+    void write_timing(ostream& out) const {
+        double total = 0;
+        for (const Entry& e : passes) total += e.seconds;
+        out << "Pass timing:\n";
+        for (const Entry& e : passes) {
+            if (!e.runs) continue;
+            out << "  " << left << setw(8) << e.pass->name() << right << setw(10) << fixed << setprecision(3)
+                << e.seconds * 1000 << " ms  " << setw(5) << setprecision(1) << 100 * e.seconds / max(total, 1e-12)
+                << "%  (" << e.runs << (e.runs == 1 ? " run)" : " runs)") << "\n";
+        }
+        out.unsetf(ios::fixed);
+        out << setprecision(6);
+    }
+};
+
+// The pipeline every compile goes through
+AstPassManager& ast_passes() {
+    static AstPassManager* passes = NULL;
+    if (!passes) {
+        passes = new AstPassManager();
+        passes->add(new ConstantFoldPass(), false);
+        passes->add(new ExprDagPass(), false);
+        passes->add(new AstStatsPass(), false);
+        passes->add(new AstDumpPass(), false);
+        passes->add(new TacGenPass());
+    }
+    return *passes;
+}
+
+#endif // AST_PASSES_H
@@ -0,0 +1,328 @@
+#ifndef AST_STRESS_H
+#define AST_STRESS_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "ast.h"
+#include "ast_visitor.h"
+#include "ast_passes.h"
+#include "flat_ast.h"
+#include "three_addr_code.h"
+#include "compiler.h"
+#include "tac_vm.h"
+
+using namespace std;
+
+// Pathologically nested programs, to check that nothing between the parser
+// and the VM recurses on the native stack.
+//
+// A shape is built as a node tree, a flat tree and, if asked, source text,
+// all at once. The trees are built directly, so they can be much deeper
+// than anything worth parsing: every grammar symbol keeps the text under it
+// for the log, which makes parsing quadratic in the nesting depth. The
+// source is parsed at a smaller depth instead, and has to give the same
+// code as the tree built alongside it.
+
+struct StressPart {
+    ASTNode* node;
+    uint32_t flat;
+    string text;
+};
+
+class StressBuilder {
+private:
+    bool with_text;
+
+    static ExprNode* expr(const StressPart& p) { return static_cast<ExprNode*>(p.node); }
+    static StmtNode* stmt(const StressPart& p) { return static_cast<StmtNode*>(p.node); }
+
+public:
+    FlatAst flat;
+
+    StressBuilder(bool with_text) : with_text(with_text) { flat.enabled = true; }
+
+    StressPart var(const string& name) {
+        return {new VarNode(name, "int"), flat.var(name, "int"), with_text ? name : ""};
+    }
+    StressPart num(long long value) {
+        string v = to_string(value);
+        return {new ConstNode(v, "int"), flat.constant(v, "int"), with_text ? v : ""};
+    }
+    StressPart binary(const string& op, const StressPart& l, const StressPart& r) {
+        return {new BinaryOpNode(op, expr(l), expr(r), "int"), flat.binary(op, l.flat, r.flat, "int"),
+                with_text ? "(" + l.text + " " + op + " " + r.text + ")" : ""};
+    }
+    StressPart unary(const string& op, const StressPart& e) {
+        return {new UnaryOpNode(op, expr(e), "int"), flat.unary(op, e.flat, "int"),
+                with_text ? op + "(" + e.text + ")" : ""};
+    }
+    StressPart assign(const string& name, const StressPart& rhs) {
+        return {new AssignNode(new VarNode(name, "int"), expr(rhs), "int"),
+                flat.assign(flat.var(name, "int"), rhs.flat, "int"), with_text ? name + " = " + rhs.text : ""};
+    }
+    StressPart expr_stmt(const StressPart& e) {
+        return {new ExprStmtNode(expr(e)), flat.expr_stmt(e.flat), with_text ? e.text + ";" : ""};
+    }
+    StressPart if_stmt(const StressPart& cond, const StressPart& then_stmt) {
+        return {new IfNode(expr(cond), stmt(then_stmt)), flat.if_stmt(cond.flat, then_stmt.flat),
+                with_text ? "if (" + cond.text + ") " + then_stmt.text : ""};
+    }
+    StressPart if_else(const StressPart& cond, const StressPart& then_stmt, const StressPart& else_stmt) {
+        return {new IfNode(expr(cond), stmt(then_stmt), stmt(else_stmt)),
+                flat.if_stmt(cond.flat, then_stmt.flat, else_stmt.flat),
+                with_text ? "if (" + cond.text + ") " + then_stmt.text + " else " + else_stmt.text : ""};
+    }
+    StressPart while_stmt(const StressPart& cond, const StressPart& body) {
+        return {new WhileNode(expr(cond), stmt(body)), flat.while_stmt(cond.flat, body.flat),
+                with_text ? "while (" + cond.text + ") " + body.text : ""};
+    }
+    StressPart return_stmt(const StressPart& e) {
+        return {new ReturnNode(expr(e)), flat.return_stmt(e.flat), with_text ? "return " + e.text + ";" : ""};
+    }
+    StressPart decl(const vector<string>& names) {
+        DeclNode* node = new DeclNode("int");
+        uint32_t flat_decl = flat.decl("int");
+        string text = "int ";
+        for (size_t i = 0; i < names.size(); i++) {
+            node->add_var(names[i]);
+            flat.append(flat_decl, flat.decl_var(names[i], 0));
+            text += (i ? ", " : "") + names[i];
+        }
+        return {node, flat_decl, with_text ? text + ";" : ""};
+    }
+    StressPart block(const vector<StressPart>& statements) {
+        BlockNode* node = new BlockNode();
+        uint32_t flat_block = flat.block();
+        string text = "{\n";
+        for (const StressPart& s : statements) {
+            node->add_statement(stmt(s));
+            flat.append(flat_block, s.flat);
+            if (with_text) text += s.text + "\n";
+        }
+        return {node, flat_block, with_text ? text + "}" : ""};
+    }
+
+    // int main() with the given body; the flat tree's root is set too
+    ProgramNode* program(const StressPart& body, string& source) {
+        FuncDeclNode* func = new FuncDeclNode("int", "main");
+        func->set_body(static_cast<BlockNode*>(body.node));
+        uint32_t flat_func = flat.func("int", "main");
+        flat.set_body(flat_func, body.flat);
+        ProgramNode* root = new ProgramNode();
+        root->add_unit(func);
+        flat.root = flat.program();
+        flat.append(flat.root, flat_func);
+        source = with_text ? "int main() " + body.text + "\n" : "";
+        return root;
+    }
+};
+
+struct StressShape {
+    const char* name;
+    const char* description;
+};
+
+const StressShape stress_shapes[] = {
+    {"chain", "x + 1 + 1 + ..., nested to the left"},
+    {"nested", "1 + (1 + (1 + ...)), nested to the right"},
+    {"unary", "-(-(-(...)))"},
+    {"if", "if (x < 1) if (x < 1) ..."},
+    {"else", "if ... else if ... else if ..."},
+    {"block", "{ { { ... } } }"},
+    {"while", "while (x < 1) while (x < 1) ..."},
+};
+
+// One of the shapes above nested `depth` deep, and what main returns
+ProgramNode* stress_program(StressBuilder& b, const string& shape, long long depth, long long& expected,
+                            string& source) {
+    vector<StressPart> body;
+    body.push_back(b.decl({"x", "y"}));
+    if (shape == "chain") {
+        StressPart e = b.var("x");
+        for (long long i = 0; i < depth; i++) e = b.binary("+", e, b.num(1));
+        body.push_back(b.expr_stmt(b.assign("x", b.num(0))));
+        body.push_back(b.expr_stmt(b.assign("x", e)));
+        expected = depth;
+    } else if (shape == "nested") {
+        StressPart e = b.num(0);
+        for (long long i = 0; i < depth; i++) e = b.binary("+", b.num(1), e);
+        body.push_back(b.expr_stmt(b.assign("x", e)));
+        expected = depth;
+    } else if (shape == "unary") {
+        StressPart e = b.num(1);
+        for (long long i = 0; i < depth; i++) e = b.unary("-", e);
+        body.push_back(b.expr_stmt(b.assign("x", e)));
+        expected = depth % 2 ? -1 : 1;
+    } else if (shape == "if") {
+        StressPart s = b.expr_stmt(b.assign("x", b.num(5)));
+        for (long long i = 0; i < depth; i++) s = b.if_stmt(b.binary("<", b.var("x"), b.num(1)), s);
+        body.push_back(b.expr_stmt(b.assign("x", b.num(0))));
+        body.push_back(s);
+        expected = 5;
+    } else if (shape == "else") {
+        // Only the innermost comparison holds
+        StressPart s = b.expr_stmt(b.assign("x", b.num(depth)));
+        for (long long i = depth - 1; i >= 0; i--)
+            s = b.if_else(b.binary("==", b.var("y"), b.num(i)), b.expr_stmt(b.assign("x", b.num(i))), s);
+        body.push_back(b.expr_stmt(b.assign("y", b.num(max(0LL, depth - 1)))));
+        body.push_back(s);
+        expected = max(0LL, depth - 1);
+    } else if (shape == "block") {
+        StressPart s = b.expr_stmt(b.assign("x", b.binary("+", b.var("x"), b.num(1))));
+        for (long long i = 0; i < depth; i++) s = b.block({s});
+        body.push_back(b.expr_stmt(b.assign("x", b.num(0))));
+        body.push_back(s);
+        expected = 1;
+    } else {
+        StressPart s = b.expr_stmt(b.assign("x", b.num(1)));
+        for (long long i = 0; i < depth; i++) s = b.while_stmt(b.binary("<", b.var("x"), b.num(1)), s);
+        body.push_back(b.expr_stmt(b.assign("x", b.num(0))));
+        body.push_back(s);
+        expected = 1;
+    }
+    body.push_back(b.return_stmt(b.var("x")));
+    return b.program(b.block(body), source);
+}
+
+// Loads TAC and runs main; false with a message if it fails or returns
+// something other than expected
+bool stress_run(const string& code, long long expected, string& error) {
+    TacProgram prog;
+    stringstream in(code);
+    TacLoader loader(prog);
+    if (!loader.load(in)) {
+        error = "couldn't load the code: " + loader.get_error();
+        return false;
+    }
+    TacVM vm(prog);
+    TacValue result;
+    if (!vm.run("main", result, error)) return false;
+    if (result.is_float || result.i != expected) {
+        error = "main returned " + tac_value_string(result) + ", expected " + to_string(expected);
+        return false;
+    }
+    return true;
+}
+
+double stress_seconds_since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// ./compiler --stress-depth [-d DEPTH] [-p PARSE_DEPTH] [shape...]
+// Builds each shape DEPTH deep and takes it through lowering (both trees),
+// the VM, a tree walk, sharing, constant folding and teardown; then parses
+// it at PARSE_DEPTH and checks the parser's tree lowers to the same code
+int run_depth_stress(int argc, char *argv[])
+{
+    long long depth = 100000, parse_depth = 2000;
+    vector<string> shapes;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-d" && i + 1 < argc) depth = max(1LL, atoll(argv[++i]));
+        else if (arg == "-p" && i + 1 < argc) parse_depth = max(0LL, atoll(argv[++i]));
+        else shapes.push_back(arg);
+    }
+    if (shapes.empty()) {
+        for (const StressShape& s : stress_shapes) shapes.push_back(s.name);
+    }
+    for (const string& shape : shapes) {
+        bool known = false;
+        for (const StressShape& s : stress_shapes) known = known || shape == s.name;
+        if (!known) {
+            cout << "Unknown shape " << shape << ", the shapes are:" << endl;
+            for (const StressShape& s : stress_shapes) cout << "  " << s.name << "  " << s.description << endl;
+            return 1;
+        }
+    }
+
+    int failures = 0;
+    for (const string& shape : shapes) {
+        cout << shape << ", " << depth << " deep:" << endl;
+        string error, source;
+        long long expected;
+
+        auto start = chrono::steady_clock::now();
+        StressBuilder built(false);
+        ProgramNode* root = stress_program(built, shape, depth, expected, source);
+        cout << "  built " << built.flat.size() << " nodes in " << stress_seconds_since(start) * 1000 << " ms" << endl;
+
+        stringstream tree_code, flat_code;
+        temp_cond = "";
+        start = chrono::steady_clock::now();
+        ThreeAddrCodeGenerator(root, tree_code).generate();
+        double tree_seconds = stress_seconds_since(start);
+        temp_cond = "";
+        start = chrono::steady_clock::now();
+        ThreeAddrCodeGenerator(built.flat, flat_code).generate();
+        double flat_seconds = stress_seconds_since(start);
+        bool same = tree_code.str() == flat_code.str();
+        cout << "  lowered in " << tree_seconds * 1000 << " ms (node tree), " << flat_seconds * 1000
+             << " ms (flat tree)" << (same ? "" : ", MISMATCH between the two") << endl;
+        if (!same) failures++;
+
+        start = chrono::steady_clock::now();
+        bool ran = stress_run(tree_code.str(), expected, error);
+        cout << "  ran in " << stress_seconds_since(start) * 1000 << " ms: "
+             << (ran ? "returned " + to_string(expected) : "FAILED: " + error) << endl;
+        if (!ran) failures++;
+
+        // A walk, then two rewrites of the whole tree, each followed by the
+        // code again: sharing turns it into a DAG, which folding and
+        // teardown have to cope with
+        AstStatsPass stats;
+        ExprDagPass dag;
+        ConstantFoldPass fold;
+        AstPass* passes[] = {&stats, &dag, &fold};
+        for (AstPass* pass : passes) {
+            stringstream log, code;
+            AstPassContext context = {log, code, NULL};
+            start = chrono::steady_clock::now();
+            pass->run(root, context);
+            double pass_seconds = stress_seconds_since(start);
+            string line;
+            getline(log, line);
+            cout << "  " << line << " (" << pass_seconds * 1000 << " ms)";
+            if (pass != &stats) {
+                ThreeAddrCodeGenerator(root, code).generate();
+                bool rewritten_ok = stress_run(code.str(), expected, error);
+                if (!rewritten_ok) failures++;
+                cout << (rewritten_ok ? ", code still right" : ", code FAILED: " + error);
+            }
+            cout << endl;
+        }
+
+        start = chrono::steady_clock::now();
+        ast_delete(root);
+        built.flat = FlatAst();
+        cout << "  freed in " << stress_seconds_since(start) * 1000 << " ms" << endl;
+
+        if (parse_depth == 0) continue;
+
+        // The same shape through the parser
+        StressBuilder parsed(true);
+        ProgramNode* small = stress_program(parsed, shape, parse_depth, expected, source);
+        stringstream small_code;
+        temp_cond = "";
+        ThreeAddrCodeGenerator(small, small_code).generate();
+        ast_delete(small);
+
+        CompileOptions options;
+        options.generate_log = false;
+        start = chrono::steady_clock::now();
+        CompileResult compiled = compile(source, options);
+        double parse_seconds = stress_seconds_since(start);
+        bool parsed_ok = compiled.ok && compiled.tac == small_code.str() && stress_run(compiled.tac, expected, error);
+        if (!compiled.ok) error = "compilation failed: " + compiled.errors;
+        else if (compiled.tac != small_code.str()) error = "the parsed tree lowered to different code";
+        cout << "  parsed " << source.size() << " bytes " << parse_depth << " deep in " << parse_seconds * 1000
+             << " ms: " << (parsed_ok ? "same code as the built tree" : "FAILED: " + error) << endl;
+        if (!parsed_ok) failures++;
+    }
+    cout << (failures ? to_string(failures) + " checks failed" : "All checks passed") << endl;
+    return failures ? 1 : 0;
+}
+
+#endif // AST_STRESS_H
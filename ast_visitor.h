@@ -0,0 +1,239 @@
+#ifndef AST_VISITOR_H
+#define AST_VISITOR_H
+
+#include <algorithm>
+#include <vector>
+#include "ast.h"
+
+using namespace std;
+
+// Traversal support for the node tree in ast.h.
+//
+// AstChildren is the one place that knows where each kind keeps its
+// children. AstVisitor dispatches on ASTNode::kind with a switch and calls
+// the derived class's visit_* method statically (CRTP), so there are no
+// virtual calls or dynamic_casts on the way down. The defaults just walk
+// the children; enter/leave run before and after every node for passes
+// that don't care about the kind.
+//
+// Neither the walk nor ast_delete recurses: both keep their own stack, so
+// a generated source nested a million deep is fine.
+
+inline const char* ast_kind_name(AstKind kind) {
+    static const char* const names[AST_KIND_COUNT] = {
+        "program", "function", "arguments", "block", "declaration", "expression statement", "if", "while",
+        "for", "return", "variable", "constant", "binary", "unary", "assignment", "call"};
+    return kind < AST_KIND_COUNT ? names[kind] : "?";
+}
+
+struct AstChildren {
+    // f(ASTNode*) for every child that is there, in evaluation order
+    template <class F>
+    static void for_each(ASTNode* n, F f) {
+        switch (n->kind) {
+        case AST_PROGRAM:
+            for (ASTNode* unit : static_cast<ProgramNode*>(n)->units) f(unit);
+            break;
+        case AST_FUNC_DECL:
+            if (static_cast<FuncDeclNode*>(n)->body) f(static_cast<FuncDeclNode*>(n)->body);
+            break;
+        case AST_ARGUMENTS:
+            for (ExprNode* arg : static_cast<ArgumentsNode*>(n)->get_arguments()) f(arg);
+            break;
+        case AST_BLOCK:
+            for (StmtNode* stmt : static_cast<BlockNode*>(n)->statements) f(stmt);
+            break;
+        case AST_EXPR_STMT:
+            if (static_cast<ExprStmtNode*>(n)->expr) f(static_cast<ExprStmtNode*>(n)->expr);
+            break;
+        case AST_IF: {
+            IfNode* node = static_cast<IfNode*>(n);
+            f(node->condition);
+            f(node->then_block);
+            if (node->else_block) f(node->else_block);
+            break;
+        }
+        case AST_WHILE:
+            f(static_cast<WhileNode*>(n)->condition);
+            f(static_cast<WhileNode*>(n)->body);
+            break;
+        case AST_FOR: {
+            ForNode* node = static_cast<ForNode*>(n);
+            if (node->init) f(node->init);
+            if (node->condition) f(node->condition);
+            f(node->body); // runs before the update
+            if (node->update) f(node->update);
+            break;
+        }
+        case AST_RETURN:
+            if (static_cast<ReturnNode*>(n)->expr) f(static_cast<ReturnNode*>(n)->expr);
+            break;
+        case AST_VAR:
+            if (static_cast<VarNode*>(n)->index) f(static_cast<VarNode*>(n)->index);
+            break;
+        case AST_BINARY:
+            f(static_cast<BinaryOpNode*>(n)->left);
+            f(static_cast<BinaryOpNode*>(n)->right);
+            break;
+        case AST_UNARY:
+            f(static_cast<UnaryOpNode*>(n)->expr);
+            break;
+        case AST_ASSIGN:
+            f(static_cast<AssignNode*>(n)->rhs);
+            f(static_cast<AssignNode*>(n)->lhs);
+            break;
+        case AST_CALL:
+            for (ExprNode* arg : static_cast<FuncCallNode*>(n)->arguments) f(arg);
+            break;
+        default: // declarations and constants are leaves
+            break;
+        }
+    }
+
+    // f(ExprNode*&) for every slot holding an expression, so a pass can
+    // put a different expression there. Assignment targets and the
+    // statement parts of a for header are left out.
+    template <class F>
+    static void for_each_expr(ASTNode* n, F f) {
+        switch (n->kind) {
+        case AST_EXPR_STMT:
+            if (static_cast<ExprStmtNode*>(n)->expr) f(static_cast<ExprStmtNode*>(n)->expr);
+            break;
+        case AST_IF:
+            f(static_cast<IfNode*>(n)->condition);
+            break;
+        case AST_WHILE:
+            f(static_cast<WhileNode*>(n)->condition);
+            break;
+        case AST_FOR:
+            if (static_cast<ForNode*>(n)->update) f(static_cast<ForNode*>(n)->update);
+            break;
+        case AST_RETURN:
+            if (static_cast<ReturnNode*>(n)->expr) f(static_cast<ReturnNode*>(n)->expr);
+            break;
+        case AST_VAR:
+            if (static_cast<VarNode*>(n)->index) f(static_cast<VarNode*>(n)->index);
+            break;
+        case AST_BINARY:
+            f(static_cast<BinaryOpNode*>(n)->left);
+            f(static_cast<BinaryOpNode*>(n)->right);
+            break;
+        case AST_UNARY:
+            f(static_cast<UnaryOpNode*>(n)->expr);
+            break;
+        case AST_ASSIGN:
+            f(static_cast<AssignNode*>(n)->rhs);
+            break;
+        case AST_CALL:
+            for (ExprNode*& arg : static_cast<FuncCallNode*>(n)->arguments) f(arg);
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+// Frees a tree. A node shared by x++ is freed once, through the addition,
+// and one ExprDagPass shared when its last parent lets go of it.
+void ast_delete(ASTNode* root) {
+    vector<ASTNode*> work;
+    if (root) work.push_back(root);
+    while (!work.empty()) {
+        ASTNode* n = work.back();
+        work.pop_back();
+        if (!n) continue;
+        if (n->extra_refs) {
+            n->extra_refs--;
+            continue;
+        }
+        AstChildren::for_each(n, [&work](ASTNode* child) { work.push_back(child); });
+        // for_each gives the assignment's target last
+        if (n->kind == AST_ASSIGN && static_cast<AssignNode*>(n)->shares_target()) work.pop_back();
+        delete n;
+    }
+}
+
+template <class Derived>
+class AstVisitor {
+private:
+    struct Pending {
+        ASTNode* n;
+        bool leaving; // enter and visit_* are done, leave is next
+    };
+    vector<Pending> pending;
+
+protected:
+    Derived& self() { return *static_cast<Derived*>(this); }
+
+    // enter, visit_*, and a leave marker under whatever children visit_*
+    // scheduled
+    void dispatch(ASTNode* n) {
+        self().enter(n);
+        pending.push_back({n, true});
+        switch (n->kind) {
+        case AST_PROGRAM: self().visit_program(static_cast<ProgramNode*>(n)); break;
+        case AST_FUNC_DECL: self().visit_func_decl(static_cast<FuncDeclNode*>(n)); break;
+        case AST_ARGUMENTS: self().visit_arguments(static_cast<ArgumentsNode*>(n)); break;
+        case AST_BLOCK: self().visit_block(static_cast<BlockNode*>(n)); break;
+        case AST_DECL: self().visit_decl(static_cast<DeclNode*>(n)); break;
+        case AST_EXPR_STMT: self().visit_expr_stmt(static_cast<ExprStmtNode*>(n)); break;
+        case AST_IF: self().visit_if(static_cast<IfNode*>(n)); break;
+        case AST_WHILE: self().visit_while(static_cast<WhileNode*>(n)); break;
+        case AST_FOR: self().visit_for(static_cast<ForNode*>(n)); break;
+        case AST_RETURN: self().visit_return(static_cast<ReturnNode*>(n)); break;
+        case AST_VAR: self().visit_var(static_cast<VarNode*>(n)); break;
+        case AST_CONST: self().visit_const(static_cast<ConstNode*>(n)); break;
+        case AST_BINARY: self().visit_binary(static_cast<BinaryOpNode*>(n)); break;
+        case AST_UNARY: self().visit_unary(static_cast<UnaryOpNode*>(n)); break;
+        case AST_ASSIGN: self().visit_assign(static_cast<AssignNode*>(n)); break;
+        case AST_CALL: self().visit_call(static_cast<FuncCallNode*>(n)); break;
+        default: break;
+        }
+    }
+
+public:
+    // Walks n's subtree. A visit_* method that calls this itself gets that
+    // child's whole subtree done on the spot.
+    void visit(ASTNode* n) {
+        if (!n) return;
+        size_t base = pending.size();
+        dispatch(n);
+        while (pending.size() > base) {
+            Pending p = pending.back();
+            pending.pop_back();
+            if (p.leaving) self().leave(p.n);
+            else if (p.n) dispatch(p.n);
+        }
+    }
+
+    // Schedules the children: they're walked after the visit_* method that
+    // asked for them returns, and before leave runs for n. Work that has to
+    // see the children done goes in leave.
+    void visit_children(ASTNode* n) {
+        size_t first = pending.size();
+        AstChildren::for_each(n, [this](ASTNode* child) { pending.push_back({child, false}); });
+        reverse(pending.begin() + first, pending.end());
+    }
+
+    void enter(ASTNode*) {}
+    void leave(ASTNode*) {}
+
+    void visit_program(ProgramNode* n) { self().visit_children(n); }
+    void visit_func_decl(FuncDeclNode* n) { self().visit_children(n); }
+    void visit_arguments(ArgumentsNode* n) { self().visit_children(n); }
+    void visit_block(BlockNode* n) { self().visit_children(n); }
+    void visit_decl(DeclNode* n) { self().visit_children(n); }
+    void visit_expr_stmt(ExprStmtNode* n) { self().visit_children(n); }
+    void visit_if(IfNode* n) { self().visit_children(n); }
+    void visit_while(WhileNode* n) { self().visit_children(n); }
+    void visit_for(ForNode* n) { self().visit_children(n); }
+    void visit_return(ReturnNode* n) { self().visit_children(n); }
+    void visit_var(VarNode* n) { self().visit_children(n); }
+    void visit_const(ConstNode* n) { self().visit_children(n); }
+    void visit_binary(BinaryOpNode* n) { self().visit_children(n); }
+    void visit_unary(UnaryOpNode* n) { self().visit_children(n); }
+    void visit_assign(AssignNode* n) { self().visit_children(n); }
+    void visit_call(FuncCallNode* n) { self().visit_children(n); }
+};
+
+#endif // AST_VISITOR_H
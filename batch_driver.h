@@ -0,0 +1,327 @@
+#ifndef BATCH_DRIVER_H
+#define BATCH_DRIVER_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Defined in the parser file
+extern bool scan_mapped;
+extern bool emit_bytecode;
+void reset_compiler_state();
+int compile_file(const char *input, const string& log_path, const string& error_path, const string& code_path, bool quiet);
+
+struct BatchJob {
+    string input;
+    string out_prefix; // input path mirrored under the output directory
+    long long bytes;
+};
+
+// One deque per worker. The parser keeps its state in globals, so workers are
+// forked processes and the deques live in a shared mapping. The owner takes
+// from the head (its largest files first), thieves take from the tail.
+struct WorkDeque {
+    atomic_flag busy;
+    int head;
+    int tail;
+
+    void lock() { while (busy.test_and_set(memory_order_acquire)) sched_yield(); }
+    void unlock() { busy.clear(memory_order_release); }
+};
+
+struct WorkerStats {
+    long long steals;
+};
+
+// results[] entry of a job no worker has finished
+const int JOB_PENDING = INT_MIN;
+
+class BatchDriver {
+private:
+    vector<BatchJob> jobs;
+    string out_dir;
+    int workers;
+
+    // Shared between the forked workers
+    void* shared;
+    size_t shared_size;
+    WorkDeque* deques;
+    WorkerStats* stats;
+    int* order;   // job indices, each worker owns a contiguous range
+    int* results; // errors per job, -1 if it couldn't be opened, JOB_PENDING if not done
+
+    bool take_job(int w, int& job, bool& stolen) {
+        WorkDeque& own = deques[w];
+        own.lock();
+        if (own.head < own.tail) {
+            job = order[own.head++];
+            own.unlock();
+            stolen = false;
+            return true;
+        }
+        own.unlock();
+
+        for (int k = 1; k < workers; k++) {
+            WorkDeque& victim = deques[(w + k) % workers];
+            victim.lock();
+            if (victim.head < victim.tail) {
+                job = order[--victim.tail];
+                victim.unlock();
+                stolen = true;
+                return true;
+            }
+            victim.unlock();
+        }
+        return false;
+    }
+
+    void work(int w) {
+        int job;
+        bool stolen;
+        while (take_job(w, job, stolen)) {
+            const BatchJob& j = jobs[job];
+            reset_compiler_state();
+            results[job] = compile_file(j.input.c_str(), j.out_prefix + ".log.txt",
+                                        j.out_prefix + ".error.txt", j.out_prefix + ".code.txt", true);
+            if (stolen) stats[w].steals++;
+        }
+    }
+
+    bool setup_shared() {
+        size_t n = jobs.size();
+        shared_size = sizeof(WorkDeque) * workers + sizeof(WorkerStats) * workers + sizeof(int) * n * 2;
+        shared = mmap(NULL, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (shared == MAP_FAILED) return false;
+
+        deques = (WorkDeque*)shared;
+        stats = (WorkerStats*)(deques + workers);
+        order = (int*)(stats + workers);
+        results = order + n;
+
+        // Largest files first, dealt round-robin so every deque starts with
+        // a similar amount of work and is itself sorted largest first
+        vector<int> by_size(n);
+        for (size_t i = 0; i < n; i++) by_size[i] = i;
+        stable_sort(by_size.begin(), by_size.end(), [this](int a, int b) {
+            return jobs[a].bytes > jobs[b].bytes;
+        });
+
+        int pos = 0;
+        for (int w = 0; w < workers; w++) {
+            new (&deques[w]) WorkDeque();
+            deques[w].busy.clear();
+            deques[w].head = pos;
+            for (size_t i = w; i < n; i += workers) order[pos++] = by_size[i];
+            deques[w].tail = pos;
+            stats[w].steals = 0;
+        }
+        for (size_t i = 0; i < n; i++) results[i] = JOB_PENDING;
+        return true;
+    }
+
+public:
+    BatchDriver(string dir, int num_workers) : out_dir(dir), workers(num_workers), shared(NULL), shared_size(0) {}
+
+    ~BatchDriver() {
+        if (shared && shared != MAP_FAILED) munmap(shared, shared_size);
+    }
+
+    void add_input(const string& path) {
+        struct stat st;
+        BatchJob job;
+        job.input = path;
+        job.bytes = stat(path.c_str(), &st) == 0 ? st.st_size : 0;
+        job.out_prefix = output_prefix(out_dir, path);
+        jobs.push_back(job);
+    }
+
+    // Where the outputs for path go: path mirrored under out_dir, so inputs
+    // in different directories never share outputs. "." and empty
+    // components are dropped. '%' is written %25, a ".." component %2E%2E
+    // and the root of an absolute path %2F, which keeps every output inside
+    // out_dir without two paths ending up at the same place.
+    static string output_prefix(const string& out_dir, const string& path) {
+        string prefix = out_dir;
+        if (!path.empty() && path[0] == '/') prefix += "/%2F";
+        size_t start = 0;
+        while (start <= path.size()) {
+            size_t slash = path.find('/', start);
+            if (slash == string::npos) slash = path.size();
+            string part = path.substr(start, slash - start);
+            start = slash + 1;
+            if (part.empty() || part == ".") continue;
+            prefix += '/';
+            if (part == "..") {
+                prefix += "%2E%2E";
+                continue;
+            }
+            for (char c : part) {
+                if (c == '%') prefix += "%25";
+                else prefix += c;
+            }
+        }
+        return prefix;
+    }
+
+    size_t size() const { return jobs.size(); }
+
+    int run() {
+        if (jobs.empty()) {
+            cout << "No input files given" << endl;
+            return 1;
+        }
+        if (workers > (int)jobs.size()) workers = jobs.size();
+
+        for (const BatchJob& job : jobs) {
+            string dir = job.out_prefix.substr(0, job.out_prefix.rfind('/'));
+            if (!make_dirs(dir)) {
+                cout << "Couldn't create " << dir << ": " << strerror(errno) << endl;
+                return 1;
+            }
+        }
+        if (!setup_shared()) {
+            cout << "Couldn't allocate the batch work queues" << endl;
+            return 1;
+        }
+
+        cout << "==== Batch: " << jobs.size() << " files on " << workers << " workers ====" << endl;
+        cout.flush();
+
+        auto start = chrono::steady_clock::now();
+
+        vector<pid_t> children;
+        for (int w = 0; w < workers; w++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                work(w);
+                _exit(0);
+            }
+            if (pid < 0) {
+                // Couldn't fork, the remaining deques get drained by stealing
+                break;
+            }
+            children.push_back(pid);
+        }
+        if (children.empty()) work(0);
+
+        // A worker that dies takes the job it was on with it; the others
+        // have stolen the rest of its deque by the time they finish
+        int crashed = 0;
+        for (pid_t pid : children) {
+            int status;
+            if (waitpid(pid, &status, 0) < 0) {
+                crashed++;
+            } else if (WIFSIGNALED(status)) {
+                cout << "Worker " << pid << " killed by signal " << WTERMSIG(status) << endl;
+                crashed++;
+            } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                cout << "Worker " << pid << " exited with status " << WEXITSTATUS(status) << endl;
+                crashed++;
+            }
+        }
+
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        long long files = 0, bytes = 0, steals = 0;
+        for (int w = 0; w < workers; w++) steals += stats[w].steals;
+        int with_errors = 0, unreadable = 0, unfinished = 0;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (results[i] == JOB_PENDING) {
+                cout << jobs[i].input << ": not compiled, its worker died" << endl;
+                unfinished++;
+            } else if (results[i] < 0) {
+                cout << jobs[i].input << ": couldn't open" << endl;
+                unreadable++;
+            } else {
+                files++;
+                bytes += jobs[i].bytes;
+                if (results[i] > 0) with_errors++;
+            }
+        }
+
+        cout << "Compiled " << files << " files (" << with_errors << " with errors), " << unreadable << " unreadable";
+        if (crashed) cout << ", " << unfinished << " lost with " << crashed << (crashed == 1 ? " failed worker" : " failed workers");
+        cout << ", outputs written to " << out_dir << endl;
+        cout << "Wall time: " << secs << " s" << endl;
+        if (secs > 0) {
+            cout << "Throughput: " << files / secs << " files/s, "
+                 << bytes / secs / (1024.0 * 1024.0) << " MB/s" << endl;
+        }
+        cout << "Steals: " << steals << endl;
+
+        return unreadable || unfinished || crashed ? 1 : 0;
+    }
+
+    // Creates path and any missing parents; false with errno set if path
+    // isn't a directory afterwards
+    static bool make_dirs(const string& path) {
+        for (size_t i = 1; i <= path.size(); i++) {
+            if (i == path.size() || path[i] == '/') {
+                mkdir(path.substr(0, i).c_str(), 0755);
+            }
+        }
+        struct stat st;
+        if (stat(path.c_str(), &st) < 0) return false;
+        if (!S_ISDIR(st.st_mode)) {
+            errno = ENOTDIR;
+            return false;
+        }
+        return true;
+    }
+};
+
+// ./compiler --batch [-j N] [-o DIR] [--manifest FILE] [--mmap] [--bytecode] file...
+int run_batch(int argc, char *argv[])
+{
+    int workers = sysconf(_SC_NPROCESSORS_ONLN);
+    string out_dir = "batch_out";
+    vector<string> inputs;
+
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        } else if (arg == "-o" && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if (arg == "--mmap") {
+            scan_mapped = true;
+        } else if (arg == "--bytecode") {
+            emit_bytecode = true;
+        } else if (arg == "--manifest" && i + 1 < argc) {
+            ifstream manifest(argv[++i]);
+            if (!manifest) {
+                cout << "Couldn't open manifest " << argv[i] << endl;
+                return 1;
+            }
+            string line;
+            while (getline(manifest, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (line.empty() || line[0] == '#') continue;
+                inputs.push_back(line);
+            }
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (workers < 1) workers = 1;
+
+    BatchDriver driver(out_dir, workers);
+    for (auto& in : inputs) driver.add_input(in);
+    return driver.run();
+}
+
+#endif // BATCH_DRIVER_H
@@ -0,0 +1,247 @@
+#ifndef COMPILE_CACHE_H
+#define COMPILE_CACHE_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "incremental.h"
+
+using namespace std;
+
+// Outputs of earlier compiles kept in a directory (--cache DIR), so that
+// compiling the same source again with the same settings is a file read.
+//
+// An entry is named after a hash of the source bytes, the settings that
+// change the output and the compiler, and holds every output file of that
+// compile. The hash only picks the file: the entry also keeps the source
+// and the settings, and a load that finds different ones is a miss, so a
+// collision can't hand back another file's outputs.
+//
+// Entries are written under a temporary name and renamed into place, so
+// another process sharing the directory sees a whole entry or none. A hit
+// touches the entry. A running total of the bytes stored is kept in the
+// directory's "usage" file; once it passes the bound the directory is
+// scanned and the entries used longest ago are removed.
+
+// Bumped when the entry format changes
+const char COMPILE_CACHE_MAGIC[4] = {'C', 'C', 'E', '2'};
+
+// Names the compiler in every key: a hash of the running binary, so jobs
+// running the same build share entries and a changed compiler doesn't
+// reuse old ones. Hashing the binary takes longer than a hit, so the hash
+// is remembered in dir under the binary's inode, size and mtime. The magic
+// above stands in if the binary can't be read.
+inline string compiler_identity(const string& dir) {
+    struct stat st;
+    if (stat("/proc/self/exe", &st) < 0) return string(COMPILE_CACHE_MAGIC, 4);
+    string memo = dir + "/compiler-" + to_string(st.st_dev) + "-" + to_string(st.st_ino) + "-" + to_string(st.st_size) +
+                  "-" + to_string(st.st_mtim.tv_sec) + "." + to_string(st.st_mtim.tv_nsec);
+    string identity;
+    if (ifstream(memo.c_str()) >> identity) return identity;
+
+    ifstream in("/proc/self/exe", ios::binary);
+    uint64_t hash = fnv1a("compiler");
+    vector<char> chunk(1 << 16);
+    while (in) {
+        in.read(chunk.data(), chunk.size());
+        hash = fnv1a(string_view(chunk.data(), in.gcount()), hash);
+    }
+    if (!in.eof()) return string(COMPILE_CACHE_MAGIC, 4);
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+    string temp = memo + ".tmp." + to_string(getpid());
+    ofstream(temp.c_str(), ios::trunc) << hex << "\n";
+    if (rename(temp.c_str(), memo.c_str()) < 0) unlink(temp.c_str());
+    return hex;
+}
+
+struct CachedOutput {
+    string name; // file name, as written by the compile
+    string bytes;
+};
+
+class CompileCache {
+private:
+    string dir;
+    size_t max_bytes;
+    string compiler; // compiler_identity, once open
+
+    string entry_path(const string& key) const { return dir + "/" + key + ".entry"; }
+    string usage_path() const { return dir + "/usage"; }
+
+    // Bytes stored so far by the running total, or -1 if there isn't one
+    long long read_usage() const {
+        ifstream in(usage_path().c_str());
+        long long bytes = -1;
+        if (!(in >> bytes)) return -1;
+        return bytes;
+    }
+
+    // Several processes may update the total at once; a lost update only
+    // delays the next scan, which writes the true figure
+    void write_usage(long long bytes) const {
+        string temp = usage_path() + ".tmp." + to_string(getpid());
+        ofstream(temp.c_str(), ios::trunc) << bytes << "\n";
+        if (rename(temp.c_str(), usage_path().c_str()) < 0) unlink(temp.c_str());
+    }
+
+    string settings_with_compiler(const string& settings) const { return settings + ";compiler=" + compiler; }
+
+    static void put_bytes(string& out, string_view bytes) {
+        put32(out, bytes.size());
+        out.append(bytes);
+    }
+
+    static bool get_bytes(string_view& in, string_view& bytes) {
+        uint32_t size;
+        if (!get32(in, size) || in.size() < size) return false;
+        bytes = in.substr(0, size);
+        in.remove_prefix(size);
+        return true;
+    }
+
+    static void put32(string& out, uint32_t n) { out.append((const char*)&n, 4); }
+
+    static bool get32(string_view& in, uint32_t& n) {
+        if (in.size() < 4) return false;
+        memcpy(&n, in.data(), 4);
+        in.remove_prefix(4);
+        return true;
+    }
+
+public:
+    CompileCache(size_t max_bytes = 256u << 20) : max_bytes(max_bytes) {}
+
+    // Creates the directory if needed; false with a message if it can't
+    bool open(const string& path, string& error) {
+        dir = path;
+        while (dir.size() > 1 && dir.back() == '/') dir.pop_back();
+        if (mkdir(dir.c_str(), 0777) < 0 && errno != EEXIST) {
+            error = "couldn't create " + dir + ": " + strerror(errno);
+            return false;
+        }
+        struct stat st;
+        if (stat(dir.c_str(), &st) < 0 || !S_ISDIR(st.st_mode)) {
+            error = dir + " isn't a directory";
+            return false;
+        }
+        compiler = compiler_identity(dir);
+        return true;
+    }
+
+    void set_max_bytes(size_t bytes) { max_bytes = bytes; }
+
+    // The entry's file name; load checks the entry really is for this
+    // source and these settings
+    string key(string_view source, const string& settings) const {
+        uint64_t h[2] = {fnv1a("source"), fnv1a("settings")};
+        string full = settings_with_compiler(settings);
+        for (int i = 0; i < 2; i++) {
+            h[i] = fnv1a(source, h[i]);
+            h[i] = fnv1a(full, fnv1a(string_view("\0", 1), h[i]));
+        }
+        char hex[33];
+        snprintf(hex, sizeof(hex), "%016llx%016llx", (unsigned long long)h[0], (unsigned long long)h[1]);
+        return hex;
+    }
+
+    // The outputs stored under key for source and settings, and the
+    // compile's result code
+    bool load(const string& key, string_view source, const string& settings, vector<CachedOutput>& outputs, int& result) {
+        string path = entry_path(key);
+        ifstream in(path.c_str(), ios::binary);
+        if (!in) return false;
+        stringstream ss;
+        ss << in.rdbuf();
+        string data = ss.str();
+        string_view rest = data;
+        uint32_t count, code;
+        if (rest.size() < 4 || memcmp(rest.data(), COMPILE_CACHE_MAGIC, 4) != 0) return false;
+        rest.remove_prefix(4);
+        string_view stored_source, stored_settings;
+        if (!get_bytes(rest, stored_source) || !get_bytes(rest, stored_settings)) return false;
+        if (stored_source != source || stored_settings != settings_with_compiler(settings)) return false;
+        if (!get32(rest, code) || !get32(rest, count)) return false;
+        outputs.clear();
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t name_size, size;
+            if (!get32(rest, name_size) || !get32(rest, size) || rest.size() < (size_t)name_size + size) return false;
+            outputs.push_back({string(rest.substr(0, name_size)), string(rest.substr(name_size, size))});
+            rest.remove_prefix((size_t)name_size + size);
+        }
+        if (!rest.empty()) return false;
+        result = (int32_t)code;
+        utimes(path.c_str(), NULL); // most recently used now
+        return true;
+    }
+
+    // Stores outputs under key for source and settings; false with a
+    // message if it can't
+    bool store(const string& key, string_view source, const string& settings, const vector<CachedOutput>& outputs,
+               int result, string& error) {
+        string data(COMPILE_CACHE_MAGIC, 4);
+        put_bytes(data, source);
+        put_bytes(data, settings_with_compiler(settings));
+        put32(data, (uint32_t)result);
+        put32(data, outputs.size());
+        for (const CachedOutput& output : outputs) {
+            put32(data, output.name.size());
+            put32(data, output.bytes.size());
+            data += output.name;
+            data += output.bytes;
+        }
+
+        string temp = dir + "/" + key + ".tmp." + to_string(getpid());
+        ofstream out(temp.c_str(), ios::binary | ios::trunc);
+        out.write(data.data(), data.size());
+        out.close();
+        if (!out || rename(temp.c_str(), entry_path(key).c_str()) < 0) {
+            error = "couldn't write the cache entry in " + dir;
+            unlink(temp.c_str());
+            return false;
+        }
+        long long usage = read_usage();
+        if (usage < 0 || usage + (long long)data.size() > (long long)max_bytes) evict();
+        else write_usage(usage + data.size());
+        return true;
+    }
+
+    // Removes the entries used longest ago until the directory is back
+    // under its bound
+    void evict() {
+        DIR* d = opendir(dir.c_str());
+        if (!d) return;
+        vector<pair<long long, pair<string, size_t>>> entries; // last use, path and size
+        size_t total = 0;
+        while (struct dirent* e = readdir(d)) {
+            string name = e->d_name;
+            if (name.size() < 6 || name.compare(name.size() - 6, 6, ".entry") != 0) continue;
+            string path = dir + "/" + name;
+            struct stat st;
+            if (stat(path.c_str(), &st) < 0) continue;
+            entries.push_back({st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec, {path, (size_t)st.st_size}});
+            total += st.st_size;
+        }
+        closedir(d);
+        if (total > max_bytes) {
+            sort(entries.begin(), entries.end());
+            for (size_t i = 0; i < entries.size() && total > max_bytes; i++) {
+                if (unlink(entries[i].second.first.c_str()) == 0) total -= entries[i].second.second;
+            }
+        }
+        write_usage(total);
+    }
+};
+
+#endif // COMPILE_CACHE_H
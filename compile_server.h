@@ -0,0 +1,372 @@
+#ifndef COMPILE_SERVER_H
+#define COMPILE_SERVER_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "compiler.h"
+
+using namespace std;
+
+// Wire format, every integer is a host-order uint32:
+//   request:  options_len, options, source_len, source
+//   response: errors, code_len, code, error_len, error text, log_len, log
+// Options are "key=value" lines. The only one right now is log=0, which
+// skips building the (large) log.
+
+// Longest options, source or reply text either side accepts; a longer
+// length is a broken or hostile peer, not something to allocate for
+const uint32_t MAX_CHUNK = 256u << 20;
+
+struct CompileReply {
+    int errors;
+    string code;
+    string error_text;
+    string log;
+};
+
+bool write_all(int fd, const void* data, size_t len) {
+    const char* p = (const char*)data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t len) {
+    char* p = (char*)data;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool write_chunk(int fd, const string& s) {
+    uint32_t len = s.size();
+    return write_all(fd, &len, sizeof(len)) && write_all(fd, s.data(), s.size());
+}
+
+bool read_chunk(int fd, string& s) {
+    uint32_t len;
+    if (!read_all(fd, &len, sizeof(len)) || len > MAX_CHUNK) return false;
+    s.resize(len);
+    return len == 0 || read_all(fd, &s[0], len);
+}
+
+bool read_whole_file(const string& path, string& contents) {
+    ifstream in(path.c_str(), ios::binary);
+    if (!in) return false;
+    stringstream ss;
+    ss << in.rdbuf();
+    contents = ss.str();
+    return true;
+}
+
+int connect_server(const string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool request_compile(int fd, const string& options, const string& source, CompileReply& reply) {
+    if (!write_chunk(fd, options) || !write_chunk(fd, source)) return false;
+    uint32_t errors;
+    if (!read_all(fd, &errors, sizeof(errors))) return false;
+    reply.errors = (int)errors;
+    return read_chunk(fd, reply.code) && read_chunk(fd, reply.error_text) && read_chunk(fd, reply.log);
+}
+
+static volatile sig_atomic_t server_stop = 0;
+void on_server_signal(int) { server_stop = 1; }
+
+// A client of the server. The socket is non-blocking: in holds the bytes
+// of requests read so far, out the replies not yet written.
+struct ServerConnection {
+    int fd;
+    string in;
+    string out;
+};
+
+// Long-lived compiler process. The parser isn't reentrant, so requests go
+// through compile() one at a time, but sockets are only read and written
+// as far as they're ready, so a slow client doesn't hold up the others.
+class CompileServer {
+private:
+    string path;
+    int listen_fd;
+    vector<ServerConnection> conns;
+    long long served;
+
+    // Length of the whole request at the front of in, 0 if it hasn't all
+    // arrived, -1 if a length is over MAX_CHUNK
+    static long long request_size(const string& in) {
+        size_t at = 0;
+        for (int part = 0; part < 2; part++) {
+            uint32_t len;
+            if (in.size() < at + sizeof(len)) return 0;
+            memcpy(&len, in.data() + at, sizeof(len));
+            if (len > MAX_CHUNK) return -1;
+            at += sizeof(len) + len;
+        }
+        return in.size() < at ? 0 : (long long)at;
+    }
+
+    // Compiles every whole request in c.in, queueing the replies; false if
+    // the client sent a bad length
+    bool handle_requests(ServerConnection& c) {
+        for (;;) {
+            long long size = request_size(c.in);
+            if (size < 0) return false;
+            if (size == 0) return true;
+            uint32_t options_len;
+            memcpy(&options_len, c.in.data(), sizeof(options_len));
+            string_view request(c.in.data(), size);
+            string_view options = request.substr(sizeof(uint32_t), options_len);
+            string source(request.substr(2 * sizeof(uint32_t) + options_len));
+
+            CompileOptions opts;
+            opts.generate_log = options.find("log=0") == string_view::npos;
+
+            CompileResult result = compile(source, opts);
+            served++;
+            c.in.erase(0, size);
+
+            uint32_t status = (uint32_t)result.stats.errors;
+            c.out.append((const char*)&status, sizeof(status));
+            for (const string* text : {&result.tac, &result.errors, &result.log}) {
+                uint32_t len = text->size();
+                c.out.append((const char*)&len, sizeof(len));
+                c.out += *text;
+            }
+        }
+    }
+
+    // Reads what has arrived and answers it; false once c should be closed
+    bool on_readable(ServerConnection& c) {
+        char buffer[1 << 16];
+        ssize_t n = read(c.fd, buffer, sizeof(buffer));
+        if (n < 0) return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+        if (n == 0) return false;
+        c.in.append(buffer, n);
+        return handle_requests(c) && on_writable(c);
+    }
+
+    // Writes as much of the queued replies as the socket takes
+    bool on_writable(ServerConnection& c) {
+        size_t done = 0;
+        while (done < c.out.size()) {
+            ssize_t n = write(c.fd, c.out.data() + done, c.out.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (n <= 0) return false;
+            done += n;
+        }
+        c.out.erase(0, done);
+        return true;
+    }
+
+public:
+    CompileServer(string socket_path) : path(socket_path), listen_fd(-1), served(0) {}
+
+    ~CompileServer() {
+        for (auto& c : conns) close(c.fd);
+        if (listen_fd >= 0) {
+            close(listen_fd);
+            unlink(path.c_str());
+        }
+    }
+
+    int run() {
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(path.c_str());
+        if (listen_fd < 0 || ::bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 64) < 0) {
+            cout << "Couldn't listen on " << path << ": " << strerror(errno) << endl;
+            return 1;
+        }
+
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_server_signal;
+        sigaction(SIGINT, &sa, NULL);
+        sigaction(SIGTERM, &sa, NULL);
+        signal(SIGPIPE, SIG_IGN);
+
+        cout << "Compile server listening on " << path << endl;
+
+        vector<pollfd> fds;
+        while (!server_stop) {
+            // A client with replies queued isn't read from until it takes
+            // them
+            fds.assign(1, {listen_fd, POLLIN, 0});
+            for (auto& c : conns) fds.push_back({c.fd, (short)(c.out.empty() ? POLLIN : POLLOUT), 0});
+            if (poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (size_t i = conns.size(); i-- > 0;) {
+                short revents = fds[i + 1].revents;
+                if (!revents) continue;
+                bool keep;
+                if (revents & POLLOUT) keep = on_writable(conns[i]);
+                else if (revents & POLLIN) keep = on_readable(conns[i]);
+                else keep = false;
+                if (!keep) {
+                    close(conns[i].fd);
+                    conns.erase(conns.begin() + i);
+                }
+            }
+            if (fds[0].revents & POLLIN) {
+                int client = accept(listen_fd, NULL, NULL);
+                if (client >= 0) {
+                    fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+                    conns.push_back({client, "", ""});
+                }
+            }
+        }
+
+        cout << "Compile server stopped after " << served << " requests" << endl;
+        return 0;
+    }
+};
+
+// ./compiler --client SOCKET file
+// Writes log.txt, error.txt and code.txt just like compiling directly
+int run_client(int argc, char *argv[])
+{
+    if (argc != 4) {
+        cout << "Usage: " << argv[0] << " --client SOCKET file" << endl;
+        return 1;
+    }
+    string source;
+    if (!read_whole_file(argv[3], source)) {
+        cout << "Couldn't open file" << endl;
+        return 1;
+    }
+    int fd = connect_server(argv[2]);
+    if (fd < 0) {
+        cout << "Couldn't connect to " << argv[2] << endl;
+        return 1;
+    }
+    CompileReply reply;
+    bool ok = request_compile(fd, "", source, reply);
+    close(fd);
+    if (!ok) {
+        cout << "Compile server closed the connection" << endl;
+        return 1;
+    }
+
+    ofstream("log.txt", ios::trunc) << reply.log;
+    ofstream("error.txt", ios::trunc) << reply.error_text;
+    ofstream("code.txt", ios::trunc) << reply.code;
+    cout << "Compiled with " << reply.errors << " errors. Output written to code.txt" << endl;
+    return 0;
+}
+
+// ./compiler --loadgen SOCKET file [-n REQUESTS] [-c CONNECTIONS]
+// Replays the same file against the server and reports latency percentiles
+int run_loadgen(int argc, char *argv[])
+{
+    if (argc < 4) {
+        cout << "Usage: " << argv[0] << " --loadgen SOCKET file [-n REQUESTS] [-c CONNECTIONS]" << endl;
+        return 1;
+    }
+    string sock = argv[2];
+    int requests = 1000, connections = 1;
+    for (int i = 4; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "-n") requests = atoi(argv[i + 1]);
+        else if (arg == "-c") connections = atoi(argv[i + 1]);
+    }
+    if (connections < 1) connections = 1;
+
+    string source;
+    if (!read_whole_file(argv[3], source)) {
+        cout << "Couldn't open file" << endl;
+        return 1;
+    }
+
+    vector<vector<double>> latencies(connections);
+    vector<int> failures(connections, 0);
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+
+    for (int c = 0; c < connections; c++) {
+        int count = requests / connections + (c < requests % connections ? 1 : 0);
+        threads.emplace_back([&, c, count]() {
+            int fd = connect_server(sock);
+            if (fd < 0) {
+                failures[c] = count;
+                return;
+            }
+            CompileReply reply;
+            for (int i = 0; i < count; i++) {
+                auto t0 = chrono::steady_clock::now();
+                if (!request_compile(fd, "log=0", source, reply)) {
+                    failures[c] += count - i;
+                    break;
+                }
+                latencies[c].push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - t0).count());
+            }
+            close(fd);
+        });
+    }
+    for (auto& t : threads) t.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<double> all;
+    int failed = 0;
+    for (int c = 0; c < connections; c++) {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        failed += failures[c];
+    }
+    if (all.empty()) {
+        cout << "No requests completed" << endl;
+        return 1;
+    }
+    sort(all.begin(), all.end());
+    auto pct = [&all](double p) { return all[min(all.size() - 1, (size_t)(p / 100.0 * all.size()))]; };
+    double sum = 0;
+    for (double v : all) sum += v;
+
+    cout << "Requests: " << all.size() << " ok, " << failed << " failed, "
+         << connections << " connections" << endl;
+    cout << "Throughput: " << all.size() / secs << " requests/s" << endl;
+    cout << "Latency (us): mean " << sum / all.size() << ", p50 " << pct(50) << ", p90 " << pct(90)
+         << ", p99 " << pct(99) << ", p99.9 " << pct(99.9) << ", max " << all.back() << endl;
+    return failed ? 1 : 0;
+}
+
+#endif // COMPILE_SERVER_H
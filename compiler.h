@@ -0,0 +1,51 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+// Public interface of the compiler library (libcompiler.a, see script.sh).
+// This is the only header an embedding program needs; the parser internals
+// stay inside the library.
+
+#include <ostream>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+struct CompileOptions {
+    bool generate_log = true; // the log is by far the largest output
+    bool generate_bytecode = false; // fill CompileResult::bytecode, needs code_sink unset
+
+    // Optional caller-provided sinks. When one is set that output is written
+    // straight to it and the matching CompileResult string stays empty.
+    ostream* code_sink = nullptr;
+    ostream* error_sink = nullptr;
+    ostream* log_sink = nullptr;
+};
+
+struct CompileStats {
+    size_t source_bytes = 0;
+    int lines = 0;
+    int errors = 0;
+    double parse_seconds = 0;
+    double codegen_seconds = 0;
+};
+
+struct CompileResult {
+    bool ok = false; // no errors and code was generated
+    string tac;
+    string bytecode; // binary TAC, see tac_bytecode.h
+    string errors;
+    string log;
+    CompileStats stats;
+};
+
+// Compiles source held in memory. Calls are serialized internally because the
+// generated parser keeps its state in globals.
+CompileResult compile(string_view source, const CompileOptions& options = CompileOptions());
+
+// Same, but scans the caller's buffer in place with no copy. The last two of
+// the `size` bytes must be '\0', and the buffer must be writable because the
+// scanner temporarily NUL-terminates each token inside it.
+CompileResult compile_in_place(char* buffer, size_t size, const CompileOptions& options = CompileOptions());
+
+#endif // COMPILER_H
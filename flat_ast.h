@@ -0,0 +1,579 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+#include "ast.h"
+
+using namespace std;
+
+// Data oriented alternative to the node tree in ast.h.
+//
+// Every node is one slot in a few parallel arrays: its kind, its type and
+// a fixed record of 32-bit operands (a string id and up to three children).
+// Lists (units, statements, parameters, declared names, call arguments) are
+// threaded through the `next` operand, so appending never moves anything.
+// A for loop keeps its three header expressions in `extra`. Names, literals
+// and operators are interned once in `strings`.
+//
+// The grammar actions build it next to the node tree when `enabled` is set,
+// and FlatTacWriter lowers it to exactly the same TAC as AstLowering.
+// Shared subtrees (x++ reuses its variable) are just two references to one
+// index, and the whole thing is freed by clearing a handful of vectors.
+
+const uint32_t FLAT_NONE = UINT32_MAX;
+
+enum FlatKind : uint8_t {
+    FLAT_PROGRAM,   // a: first unit, c: last unit
+    FLAT_FUNC,      // str: name, a/c: first/last parameter, b: body
+    FLAT_PARAM,     // str: name
+    FLAT_BLOCK,     // a/c: first/last statement
+    FLAT_DECL,      // a/c: first/last declared name
+    FLAT_DECL_VAR,  // str: name, a: array size (0 for plain variables)
+    FLAT_EXPR_STMT, // a: expression or FLAT_NONE
+    FLAT_IF,        // a: condition, b: then, c: else or FLAT_NONE
+    FLAT_WHILE,     // a: condition, b: body
+    FLAT_FOR,       // a: init, condition and update at extra[a..a+2], b: body
+    FLAT_RETURN,    // a: expression
+    FLAT_VAR,       // str: name, a: index or FLAT_NONE
+    FLAT_CONST,     // str: literal
+    FLAT_BINARY,    // str: operator, a, b: operands
+    FLAT_UNARY,     // str: operator, a: operand
+    FLAT_ASSIGN,    // a: target variable, b: value
+    FLAT_CALL,      // str: function, a: first argument
+    FLAT_ARGS,      // a/c: first/last argument, only while parsing
+    FLAT_KIND_COUNT
+};
+
+enum FlatType : uint8_t {
+    FLAT_TYPE_NONE, FLAT_TYPE_INT, FLAT_TYPE_FLOAT, FLAT_TYPE_VOID, FLAT_TYPE_ERROR
+};
+
+inline uint8_t flat_type_of(const string& type) {
+    if (type == "int") return FLAT_TYPE_INT;
+    if (type == "float") return FLAT_TYPE_FLOAT;
+    if (type == "void") return FLAT_TYPE_VOID;
+    if (type == "error") return FLAT_TYPE_ERROR;
+    return FLAT_TYPE_NONE;
+}
+
+inline const char* flat_type_name(uint8_t type) {
+    static const char* const names[] = {"", "int", "float", "void", "error"};
+    return names[type];
+}
+
+inline const char* flat_kind_name(uint8_t kind) {
+    static const char* const names[FLAT_KIND_COUNT] = {
+        "program", "func", "param", "block", "decl", "decl_var", "expr_stmt", "if", "while", "for",
+        "return", "var", "const", "binary", "unary", "assign", "call", "args"};
+    return kind < FLAT_KIND_COUNT ? names[kind] : "?";
+}
+
+struct FlatOperands {
+    uint32_t str, a, b, c, next;
+};
+
+// Read-only access to a flat tree wherever its arrays are: in a FlatAst
+// being built, or in a file mapped by FlatAstFile (flat_ast_file.h)
+struct FlatView {
+    const uint8_t* kinds;
+    const uint8_t* types;
+    const FlatOperands* ops;
+    const uint32_t* extra;
+    const string* strings;
+    size_t count;
+    uint32_t root;
+
+    size_t size() const { return count; }
+    const string& str(uint32_t n) const { return strings[ops[n].str]; }
+};
+
+class FlatAst {
+private:
+    unordered_map<string, uint32_t> string_ids;
+
+    uint32_t node(uint8_t kind, uint8_t type, uint32_t str, uint32_t a = FLAT_NONE, uint32_t b = FLAT_NONE,
+                  uint32_t c = FLAT_NONE) {
+        if (!enabled) return FLAT_NONE;
+        kinds.push_back(kind);
+        types.push_back(type);
+        ops.push_back({str, a, b, c, FLAT_NONE});
+        return kinds.size() - 1;
+    }
+
+public:
+    bool enabled = false; // the builders do nothing while this is off
+    uint32_t root = FLAT_NONE;
+
+    vector<uint8_t> kinds;
+    vector<uint8_t> types;
+    vector<FlatOperands> ops;
+    vector<uint32_t> extra;
+    vector<string> strings;
+
+    size_t size() const { return kinds.size(); }
+
+    size_t bytes() const {
+        size_t total = kinds.capacity() + types.capacity() + ops.capacity() * sizeof(FlatOperands) +
+                       extra.capacity() * sizeof(uint32_t) + strings.capacity() * sizeof(string);
+        for (const string& s : strings) total += s.capacity() + 1;
+        return total;
+    }
+
+    void clear() {
+        kinds.clear();
+        types.clear();
+        ops.clear();
+        extra.clear();
+        strings.clear();
+        string_ids.clear();
+        root = FLAT_NONE;
+    }
+
+    uint32_t intern(const string& s) {
+        if (!enabled) return FLAT_NONE;
+        auto it = string_ids.find(s);
+        if (it != string_ids.end()) return it->second;
+        strings.push_back(s);
+        string_ids[s] = strings.size() - 1;
+        return strings.size() - 1;
+    }
+
+    const string& str(uint32_t n) const { return strings[ops[n].str]; }
+
+    FlatView view() const {
+        return {kinds.data(), types.data(), ops.data(), extra.data(), strings.data(), kinds.size(), root};
+    }
+
+    // Adds child at the end of the list held by a/c of list
+    void append(uint32_t list, uint32_t child) {
+        if (list == FLAT_NONE || child == FLAT_NONE) return;
+        FlatOperands& l = ops[list];
+        if (l.a == FLAT_NONE) l.a = child;
+        else ops[l.c].next = child;
+        l.c = child;
+    }
+
+    // Builders, called from the grammar actions
+    uint32_t program() { return node(FLAT_PROGRAM, FLAT_TYPE_NONE, FLAT_NONE); }
+    uint32_t func(const string& return_type, const string& name) {
+        return node(FLAT_FUNC, flat_type_of(return_type), intern(name));
+    }
+    uint32_t param(const string& type, const string& name) {
+        return node(FLAT_PARAM, flat_type_of(type), intern(name));
+    }
+    void set_body(uint32_t func, uint32_t body) {
+        if (func != FLAT_NONE) ops[func].b = body;
+    }
+    uint32_t block() { return node(FLAT_BLOCK, FLAT_TYPE_NONE, FLAT_NONE); }
+    uint32_t decl(const string& type) { return node(FLAT_DECL, flat_type_of(type), FLAT_NONE); }
+    uint32_t decl_var(const string& name, int array_size) {
+        return node(FLAT_DECL_VAR, FLAT_TYPE_NONE, intern(name), array_size);
+    }
+    uint32_t expr_stmt(uint32_t expr) { return node(FLAT_EXPR_STMT, FLAT_TYPE_NONE, FLAT_NONE, expr); }
+    uint32_t if_stmt(uint32_t cond, uint32_t then_stmt, uint32_t else_stmt = FLAT_NONE) {
+        return node(FLAT_IF, FLAT_TYPE_NONE, FLAT_NONE, cond, then_stmt, else_stmt);
+    }
+    uint32_t while_stmt(uint32_t cond, uint32_t body) {
+        return node(FLAT_WHILE, FLAT_TYPE_NONE, FLAT_NONE, cond, body);
+    }
+    uint32_t for_stmt(uint32_t init, uint32_t cond, uint32_t update, uint32_t body) {
+        if (!enabled) return FLAT_NONE;
+        uint32_t header = extra.size();
+        extra.push_back(init);
+        extra.push_back(cond);
+        extra.push_back(update);
+        return node(FLAT_FOR, FLAT_TYPE_NONE, FLAT_NONE, header, body);
+    }
+    uint32_t return_stmt(uint32_t expr) { return node(FLAT_RETURN, FLAT_TYPE_NONE, FLAT_NONE, expr); }
+    uint32_t var(const string& name, const string& type, uint32_t index = FLAT_NONE) {
+        return node(FLAT_VAR, flat_type_of(type), intern(name), index);
+    }
+    uint32_t constant(const string& value, const string& type) {
+        return node(FLAT_CONST, flat_type_of(type), intern(value));
+    }
+    uint32_t binary(const string& op, uint32_t left, uint32_t right, const string& type) {
+        return node(FLAT_BINARY, flat_type_of(type), intern(op), left, right);
+    }
+    uint32_t unary(const string& op, uint32_t expr, const string& type) {
+        return node(FLAT_UNARY, flat_type_of(type), intern(op), expr);
+    }
+    uint32_t assign(uint32_t lhs, uint32_t rhs, const string& type) {
+        return node(FLAT_ASSIGN, flat_type_of(type), FLAT_NONE, lhs, rhs);
+    }
+    uint32_t args() { return node(FLAT_ARGS, FLAT_TYPE_NONE, FLAT_NONE); }
+    uint32_t call(const string& name, const string& type, uint32_t args) {
+        uint32_t first = args == FLAT_NONE ? FLAT_NONE : ops[args].a;
+        return node(FLAT_CALL, flat_type_of(type), intern(name), first);
+    }
+};
+
+// Lowers a flat tree to TAC. It is a port of AstLowering in ast.h (including
+// its temp reuse and its stack of frames in place of recursion), so both
+// trees give the same text at any depth.
+class FlatTacWriter {
+private:
+    struct Frame {
+        uint32_t n;
+        int stage;
+        uint32_t next; // next child, for nodes with a list of them
+        int labels[3];
+        string a, b;   // temps held across children
+        size_t args;   // where a call's argument temps start in arg_temps
+        Frame(uint32_t node) : n(node), stage(0), next(FLAT_NONE), args(0) {}
+    };
+
+    FlatView ast;
+    ostream& outcode;
+    map<string, string>& symbol_to_temp;
+    int& temp_count;
+    int& label_count;
+    vector<Frame> frames;
+    vector<string> arg_temps; // of the calls being lowered, innermost last
+    string result;
+
+    string new_temp() { return "t" + to_string(temp_count++); }
+
+    const string& variable(const string& name) {
+        auto it = symbol_to_temp.find(name);
+        if (it == symbol_to_temp.end()) it = symbol_to_temp.insert(make_pair(name, name)).first;
+        return it->second;
+    }
+
+    string index_copy(const string& idx_temp) {
+        string idx_result = new_temp();
+        outcode << idx_result << " = " << idx_temp << "\n";
+        return idx_result;
+    }
+
+    static bool is_temp_name(const string& s) {
+        if (s.length() <= 1 || s[0] != 't') return false;
+        for (size_t i = 1; i < s.length(); i++) {
+            if (!isdigit(s[i])) return false;
+        }
+        return true;
+    }
+
+    void push(uint32_t n) { frames.push_back(Frame(n)); }
+
+    void finish(string temp) {
+        result = move(temp);
+        frames.pop_back();
+    }
+
+    // Pushes the next child of a list, false at the end of it
+    bool push_next(Frame& f) {
+        if (f.next == FLAT_NONE) return false;
+        uint32_t child = f.next;
+        f.next = ast.ops[child].next;
+        push(child);
+        return true;
+    }
+
+    void step() {
+        Frame& f = frames.back();
+        uint32_t n = f.n;
+        const FlatOperands& o = ast.ops[n];
+        switch (ast.kinds[n]) {
+        case FLAT_PROGRAM:
+        case FLAT_BLOCK:
+            if (f.stage == 0) {
+                f.stage = 1;
+                f.next = o.a;
+            }
+            if (!push_next(f)) finish("");
+            return;
+        case FLAT_FUNC:
+            if (f.stage == 0) {
+                symbol_to_temp.clear();
+                var_last_loaded_temp.clear();
+                var_last_assigned_temp.clear();
+                outcode << "// Function: " << flat_type_name(ast.types[n]) << " " << ast.str(n) << "(";
+                for (uint32_t p = o.a; p != FLAT_NONE; p = ast.ops[p].next) {
+                    outcode << flat_type_name(ast.types[p]) << " " << ast.str(p);
+                    if (ast.ops[p].next != FLAT_NONE) outcode << ", ";
+                }
+                outcode << ")" << "\n";
+                for (uint32_t p = o.a; p != FLAT_NONE; p = ast.ops[p].next) {
+                    string temp_var = new_temp();
+                    symbol_to_temp[ast.str(p)] = temp_var;
+                    outcode << temp_var << " = " << ast.str(p) << "\n";
+                }
+                f.stage = 1;
+                if (o.b != FLAT_NONE) push(o.b);
+                return;
+            }
+            outcode << "\n";
+            finish("");
+            return;
+        case FLAT_DECL:
+            for (uint32_t v = o.a; v != FLAT_NONE; v = ast.ops[v].next) {
+                const string& name = ast.str(v);
+                variable(name);
+                outcode << "// Declaration: " << flat_type_name(ast.types[n]) << " " << name;
+                if (ast.ops[v].a > 0) outcode << "[" << ast.ops[v].a << "]";
+                outcode << "\n";
+            }
+            finish("");
+            return;
+        case FLAT_EXPR_STMT:
+            if (f.stage == 0) {
+                f.stage = 1;
+                if (o.a != FLAT_NONE) push(o.a);
+                return;
+            }
+            finish("");
+            return;
+        case FLAT_IF:
+            switch (f.stage) {
+            case 0:
+                f.stage = 1;
+                push(o.a);
+                return;
+            case 1:
+                f.labels[0] = label_count++;
+                f.labels[1] = label_count++;
+                outcode << "if " << result << " goto L" << f.labels[0] << "\n";
+                outcode << "goto L" << f.labels[1] << "\n";
+                emit_label(outcode, f.labels[0]);
+                f.stage = 2;
+                push(o.b);
+                return;
+            case 2:
+                f.labels[2] = label_count++;
+                outcode << "goto L" << f.labels[2] << "\n";
+                emit_label(outcode, f.labels[1]);
+                f.stage = 3;
+                if (o.c != FLAT_NONE) push(o.c);
+                return;
+            default:
+                emit_label(outcode, f.labels[2]);
+                finish("");
+                return;
+            }
+        case FLAT_WHILE:
+            switch (f.stage) {
+            case 0:
+                f.labels[0] = label_count++;
+                f.labels[1] = label_count++;
+                f.labels[2] = label_count++;
+                emit_label(outcode, f.labels[0]);
+                f.stage = 1;
+                push(o.a);
+                return;
+            case 1:
+                outcode << "if " << result << " goto L" << f.labels[1] << "\n";
+                outcode << "goto L" << f.labels[2] << "\n";
+                emit_label(outcode, f.labels[1]);
+                f.stage = 2;
+                push(o.b);
+                return;
+            default:
+                outcode << "goto L" << f.labels[0] << "\n";
+                emit_label(outcode, f.labels[2]);
+                finish("");
+                return;
+            }
+        case FLAT_FOR: {
+            uint32_t init = ast.extra[o.a], cond = ast.extra[o.a + 1], update = ast.extra[o.a + 2];
+            switch (f.stage) {
+            case 0:
+                f.stage = 1;
+                if (init != FLAT_NONE) push(init);
+                return;
+            case 1:
+                f.labels[0] = label_count++;
+                f.labels[1] = label_count++;
+                f.labels[2] = label_count++;
+                emit_label(outcode, f.labels[0]);
+                f.stage = 3;
+                if (cond != FLAT_NONE) {
+                    // The condition comes from an expression statement
+                    uint32_t cond_expr = ast.kinds[cond] == FLAT_EXPR_STMT ? ast.ops[cond].a : cond;
+                    if (cond_expr != FLAT_NONE) {
+                        temp_cond = "";
+                        f.stage = 2;
+                        push(cond_expr);
+                        return;
+                    }
+                    outcode << "if  goto L" << f.labels[1] << "\n";
+                    outcode << "goto L" << f.labels[2] << "\n";
+                }
+                return;
+            case 2:
+                outcode << "if " << (temp_cond.empty() ? result : temp_cond) << " goto L" << f.labels[1] << "\n";
+                outcode << "goto L" << f.labels[2] << "\n";
+                f.stage = 3;
+                return;
+            case 3:
+                temp_cond = "";
+                emit_label(outcode, f.labels[1]);
+                f.stage = 4;
+                push(o.b);
+                return;
+            case 4:
+                f.stage = 5;
+                if (update != FLAT_NONE) push(update);
+                return;
+            default:
+                outcode << "goto L" << f.labels[0] << "\n";
+                emit_label(outcode, f.labels[2]);
+                finish("");
+                return;
+            }
+        }
+        case FLAT_RETURN:
+            if (f.stage == 0) {
+                if (o.a == FLAT_NONE) {
+                    outcode << "return" << "\n";
+                    finish("");
+                    return;
+                }
+                if (ast.kinds[o.a] == FLAT_VAR && ast.ops[o.a].a == FLAT_NONE) {
+                    auto it = var_last_assigned_temp.find(ast.str(o.a));
+                    if (it != var_last_assigned_temp.end()) {
+                        outcode << "return " << it->second << "\n";
+                        finish("");
+                        return;
+                    }
+                }
+                f.stage = 1;
+                push(o.a);
+                return;
+            }
+            outcode << "return " << result << "\n";
+            finish("");
+            return;
+        case FLAT_VAR: {
+            const string& name = ast.str(n);
+            if (f.stage == 0) {
+                f.a = variable(name);
+                if (o.a != FLAT_NONE) {
+                    f.stage = 1;
+                    push(o.a);
+                    return;
+                }
+                auto loaded = var_last_loaded_temp.find(name);
+                if (loaded != var_last_loaded_temp.end()) {
+                    finish(loaded->second);
+                    return;
+                }
+                if (is_temp_name(f.a)) {
+                    finish(f.a);
+                    return;
+                }
+                string result_temp = new_temp();
+                outcode << result_temp << " = " << f.a << "\n";
+                var_last_loaded_temp[name] = result_temp;
+                finish(result_temp);
+                return;
+            }
+            string idx_temp = index_copy(result);
+            string result_temp = new_temp();
+            outcode << result_temp << " = " << f.a << "[" << idx_temp << "]" << "\n";
+            finish(result_temp);
+            return;
+        }
+        case FLAT_CONST: {
+            string const_temp = new_temp();
+            outcode << const_temp << " = " << ast.str(n) << "\n";
+            finish(const_temp);
+            return;
+        }
+        case FLAT_BINARY:
+            switch (f.stage) {
+            case 0:
+                f.stage = 1;
+                push(o.a);
+                return;
+            case 1:
+                f.a = move(result);
+                f.stage = 2;
+                push(o.b);
+                return;
+            default: {
+                string result_temp = new_temp();
+                outcode << result_temp << " = " << f.a << " " << ast.str(n) << " " << result << "\n";
+                temp_cond = result_temp;
+                finish(result_temp);
+                return;
+            }
+            }
+        case FLAT_UNARY: {
+            if (f.stage == 0) {
+                f.stage = 1;
+                push(o.a);
+                return;
+            }
+            string result_temp = new_temp();
+            outcode << result_temp << " = " << ast.str(n) << result << "\n";
+            finish(result_temp);
+            return;
+        }
+        case FLAT_ASSIGN:
+            switch (f.stage) {
+            case 0:
+                f.stage = 1;
+                push(o.b);
+                return;
+            case 1: {
+                f.a = move(result);
+                const string& name = ast.str(o.a);
+                if (ast.ops[o.a].a != FLAT_NONE) {
+                    f.b = variable(name);
+                    f.stage = 2;
+                    push(ast.ops[o.a].a);
+                    return;
+                }
+                outcode << variable(name) << " = " << f.a << "\n";
+                var_last_loaded_temp.erase(name);
+                var_last_assigned_temp[name] = f.a;
+                finish(f.a);
+                return;
+            }
+            default: {
+                string idx_temp = index_copy(result);
+                outcode << f.b << "[" << idx_temp << "] = " << f.a << "\n";
+                finish(f.a);
+                return;
+            }
+            }
+        case FLAT_CALL: {
+            if (f.stage == 0) {
+                f.stage = 1;
+                f.next = o.a;
+                f.args = arg_temps.size();
+            } else {
+                arg_temps.push_back(move(result));
+            }
+            if (push_next(f)) return;
+            for (size_t i = f.args; i < arg_temps.size(); i++) outcode << "param " << arg_temps[i] << "\n";
+            string result_temp = new_temp();
+            outcode << result_temp << " = call " << ast.str(n) << ", " << arg_temps.size() - f.args << "\n";
+            arg_temps.resize(f.args);
+            finish(result_temp);
+            return;
+        }
+        default:
+            finish("");
+            return;
+        }
+    }
+
+public:
+    FlatTacWriter(const FlatView& ast, ostream& out, map<string, string>& symbol_to_temp, int& temp_count,
+                  int& label_count)
+        : ast(ast), outcode(out), symbol_to_temp(symbol_to_temp), temp_count(temp_count), label_count(label_count) {}
+
+    string lower(uint32_t n) {
+        push(n);
+        while (!frames.empty()) step();
+        return result;
+    }
+};
+
+#endif // FLAT_AST_H
@@ -0,0 +1,270 @@
+#ifndef FLAT_AST_FILE_H
+#define FLAT_AST_FILE_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "flat_ast.h"
+
+using namespace std;
+
+// A flat tree saved to disk, so a source can be parsed once and lowered
+// any number of times later (--emit-ast and --from-ast).
+//
+// The file is the FlatAst arrays as they are in memory, in native byte
+// order, after a fixed header:
+//
+//   header
+//   kinds     uint8[nodes]
+//   types     uint8[nodes], then zeros up to a multiple of 4
+//   ops       FlatOperands[nodes]
+//   extra     uint32[extra]
+//   offsets   uint32[strings + 1], where each string starts in the text
+//   text      the strings back to back
+//
+// FlatAstFile maps it read-only and lowers straight from the mapping, so
+// loading costs no allocation per node. The interned strings are the
+// exception: there's one std::string per distinct string, since lowering
+// looks names up in string maps.
+
+const char FLAT_AST_MAGIC[4] = {'F', 'A', 'S', 'T'};
+const uint32_t FLAT_AST_VERSION = 1;
+
+struct FlatAstFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t nodes;
+    uint32_t extra;
+    uint32_t strings;
+    uint32_t text_bytes;
+    uint32_t root;
+    uint32_t operand_bytes; // sizeof(FlatOperands) when written
+};
+
+inline size_t flat_ast_align4(size_t n) { return (n + 3) & ~(size_t)3; }
+
+// Writes ast to path; false with a message if it can't
+bool save_flat_ast(const FlatAst& ast, const string& path, string& error) {
+    FlatAstFileHeader header;
+    memcpy(header.magic, FLAT_AST_MAGIC, 4);
+    header.version = FLAT_AST_VERSION;
+    header.nodes = ast.size();
+    header.extra = ast.extra.size();
+    header.strings = ast.strings.size();
+    header.root = ast.root;
+    header.operand_bytes = sizeof(FlatOperands);
+
+    vector<uint32_t> offsets;
+    offsets.reserve(ast.strings.size() + 1);
+    size_t text_bytes = 0;
+    for (const string& s : ast.strings) {
+        offsets.push_back(text_bytes);
+        text_bytes += s.size();
+    }
+    offsets.push_back(text_bytes);
+    if (text_bytes > UINT32_MAX) {
+        error = "strings too long to save";
+        return false;
+    }
+    header.text_bytes = text_bytes;
+
+    ofstream out(path.c_str(), ios::binary | ios::trunc);
+    if (!out) {
+        error = "couldn't open " + path + " for writing";
+        return false;
+    }
+    static const char zeros[4] = {0, 0, 0, 0};
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)ast.kinds.data(), ast.kinds.size());
+    out.write((const char*)ast.types.data(), ast.types.size());
+    out.write(zeros, flat_ast_align4(2 * ast.size()) - 2 * ast.size());
+    out.write((const char*)ast.ops.data(), ast.ops.size() * sizeof(FlatOperands));
+    out.write((const char*)ast.extra.data(), ast.extra.size() * sizeof(uint32_t));
+    out.write((const char*)offsets.data(), offsets.size() * sizeof(uint32_t));
+    for (const string& s : ast.strings) out.write(s.data(), s.size());
+    out.close();
+    if (!out) {
+        error = "couldn't write " + path;
+        return false;
+    }
+    return true;
+}
+
+class FlatAstFile {
+private:
+    void* base;
+    size_t file_size;
+    vector<string> strings;
+    FlatView tree;
+
+    bool fail(string& error, const string& why) {
+        error = why;
+        close();
+        return false;
+    }
+
+    bool node_ref(uint32_t child) const { return child == FLAT_NONE || child < tree.count; }
+
+    // Operand checks for one node, so that lowering, which trusts the
+    // tree, never reads out of bounds
+    bool check_node(uint32_t n) const {
+        uint8_t kind = tree.kinds[n];
+        const FlatOperands& o = tree.ops[n];
+        if (kind >= FLAT_KIND_COUNT || tree.types[n] > FLAT_TYPE_ERROR) return false;
+        bool named = kind == FLAT_FUNC || kind == FLAT_PARAM || kind == FLAT_DECL_VAR || kind == FLAT_VAR ||
+                     kind == FLAT_CONST || kind == FLAT_BINARY || kind == FLAT_UNARY || kind == FLAT_CALL;
+        if (named ? o.str >= strings.size() : o.str != FLAT_NONE && o.str >= strings.size()) return false;
+        if (!node_ref(o.b) || !node_ref(o.c) || !node_ref(o.next)) return false;
+        if (kind == FLAT_FOR) {
+            if (o.a == FLAT_NONE || (size_t)o.a + 3 > extra_count()) return false;
+            for (int i = 0; i < 3; i++) {
+                if (!node_ref(tree.extra[o.a + i])) return false;
+            }
+        } else if (kind != FLAT_DECL_VAR && !node_ref(o.a)) {
+            return false;
+        }
+        switch (kind) {
+        case FLAT_IF:
+        case FLAT_WHILE:
+        case FLAT_BINARY:
+            return o.a != FLAT_NONE && o.b != FLAT_NONE;
+        case FLAT_FOR:
+            return o.b != FLAT_NONE;
+        case FLAT_UNARY:
+            return o.a != FLAT_NONE;
+        case FLAT_ASSIGN:
+            return o.a != FLAT_NONE && o.b != FLAT_NONE && tree.kinds[o.a] == FLAT_VAR;
+        // Parameter and declared name lists are printed by name, so they
+        // can't hold anything else
+        case FLAT_FUNC:
+        case FLAT_PARAM:
+            return (kind == FLAT_FUNC ? o.a : o.next) == FLAT_NONE ||
+                   tree.kinds[kind == FLAT_FUNC ? o.a : o.next] == FLAT_PARAM;
+        case FLAT_DECL:
+        case FLAT_DECL_VAR:
+            return (kind == FLAT_DECL ? o.a : o.next) == FLAT_NONE ||
+                   tree.kinds[kind == FLAT_DECL ? o.a : o.next] == FLAT_DECL_VAR;
+        default:
+            return true;
+        }
+    }
+
+    size_t extra_count() const { return header().extra; }
+
+    const FlatAstFileHeader& header() const { return *(const FlatAstFileHeader*)base; }
+
+    // The n-th link out of n: a, b, c, next, then a for loop's header
+    uint32_t link(uint32_t n, int i) const {
+        const FlatOperands& o = tree.ops[n];
+        switch (i) {
+        case 0: return tree.kinds[n] == FLAT_FOR || tree.kinds[n] == FLAT_DECL_VAR ? FLAT_NONE : o.a;
+        case 1: return o.b;
+        case 2: return o.c;
+        case 3: return o.next;
+        default: return tree.kinds[n] == FLAT_FOR ? tree.extra[o.a + i - 4] : FLAT_NONE;
+        }
+    }
+
+    // Lowering follows every link without looking back, so a cycle would
+    // never end. Depth first from the root with an explicit stack; shared
+    // nodes (x++) are fine, a link back to a node still on the path isn't.
+    bool acyclic() const {
+        const int links = 7;
+        vector<uint8_t> state(tree.count, 0); // 0 unseen, 1 on the path, 2 done
+        vector<pair<uint32_t, int>> path;
+        path.push_back(make_pair(tree.root, 0));
+        state[tree.root] = 1;
+        while (!path.empty()) {
+            pair<uint32_t, int>& top = path.back();
+            if (top.second == links) {
+                state[top.first] = 2;
+                path.pop_back();
+                continue;
+            }
+            uint32_t child = link(top.first, top.second++);
+            if (child == FLAT_NONE || state[child] == 2) continue;
+            if (state[child] == 1) return false;
+            state[child] = 1;
+            path.push_back(make_pair(child, 0));
+        }
+        return true;
+    }
+
+public:
+    FlatAstFile() : base(NULL), file_size(0), tree() {}
+    ~FlatAstFile() { close(); }
+
+    // Maps and checks a file written by save_flat_ast; false with a message
+    // if it isn't one
+    bool open(const string& path, string& error) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return fail(error, "couldn't open " + path);
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(FlatAstFileHeader)) {
+            ::close(fd);
+            return fail(error, path + " is too short to be a saved tree");
+        }
+        file_size = st.st_size;
+        void* region = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (region == MAP_FAILED) return fail(error, "couldn't map " + path);
+        base = region;
+
+        const FlatAstFileHeader& h = header();
+        if (memcmp(h.magic, FLAT_AST_MAGIC, 4) != 0) return fail(error, path + " isn't a saved tree");
+        if (h.version != FLAT_AST_VERSION || h.operand_bytes != sizeof(FlatOperands)) {
+            return fail(error, path + " was saved by a different version");
+        }
+        size_t kinds_at = sizeof(FlatAstFileHeader);
+        size_t ops_at = kinds_at + flat_ast_align4(2 * (size_t)h.nodes);
+        size_t extra_at = ops_at + (size_t)h.nodes * sizeof(FlatOperands);
+        size_t offsets_at = extra_at + (size_t)h.extra * sizeof(uint32_t);
+        size_t text_at = offsets_at + ((size_t)h.strings + 1) * sizeof(uint32_t);
+        if (text_at + h.text_bytes != file_size) return fail(error, path + " is truncated or has extra bytes");
+
+        const char* bytes = (const char*)base;
+        const uint32_t* offsets = (const uint32_t*)(bytes + offsets_at);
+        strings.reserve(h.strings);
+        for (uint32_t i = 0; i < h.strings; i++) {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > h.text_bytes) {
+                return fail(error, path + " has a bad string table");
+            }
+            strings.emplace_back(bytes + text_at + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+
+        tree.kinds = (const uint8_t*)(bytes + kinds_at);
+        tree.types = tree.kinds + h.nodes;
+        tree.ops = (const FlatOperands*)(bytes + ops_at);
+        tree.extra = (const uint32_t*)(bytes + extra_at);
+        tree.strings = strings.data();
+        tree.count = h.nodes;
+        tree.root = h.root;
+        if (tree.root >= tree.count) return fail(error, path + " has no root");
+        for (uint32_t n = 0; n < tree.count; n++) {
+            if (!check_node(n)) return fail(error, path + ": node " + to_string(n) + " is malformed");
+        }
+        if (!acyclic()) return fail(error, path + " has a cycle");
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(base, file_size);
+        base = NULL;
+        file_size = 0;
+        strings.clear();
+        tree = FlatView();
+    }
+
+    // Valid while the file is open
+    const FlatView& view() const { return tree; }
+    size_t bytes() const { return file_size; }
+};
+
+#endif // FLAT_AST_FILE_H
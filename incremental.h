@@ -0,0 +1,350 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+#include "compiler.h"
+
+using namespace std;
+
+// Per-function incremental compilation, for sources that are compiled again
+// after every small edit.
+//
+// The source is split into its top-level units on the scanner's tokens.
+// Each function gets a key: a hash of its tokens, and of how every name it
+// mentions is declared at global scope at that point (by an earlier unit,
+// or not at all). The parser fills the global scope table in source order,
+// so that is all of the global scope a function can see. A function whose
+// key is in the cache isn't parsed or lowered again. It's replaced by a stub
+// with an empty body and the same number of newlines, so the functions
+// after it still see its signature and keep their line numbers. The rest
+// is compiled as usual, which also checks the global declarations. The
+// code is then put back together from the cache and the new compile.
+//
+// Temps and labels are numbered across the whole program. Cached code is
+// kept numbered from t0 and L0 and shifted into place, so the result is
+// the same text a full compile gives.
+
+enum SourceTokenKind : uint8_t {
+    SRC_TYPE, SRC_ID, SRC_LPAREN, SRC_RPAREN, SRC_LCURL, SRC_RCURL, SRC_SEMICOLON, SRC_OTHER
+};
+
+struct SourceToken {
+    uint8_t kind;
+    uint32_t begin, end; // bytes of the source
+};
+
+// Defined in the parser file: the scanner's tokens for source
+bool lex_source(string_view source, vector<SourceToken>& tokens);
+
+inline uint64_t fnv1a(string_view bytes, uint64_t hash = 14695981039346656037ULL) {
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+struct SourceUnit {
+    bool function;
+    size_t first, last;      // tokens [first, last)
+    size_t body;             // a function's opening brace
+    uint64_t declaration;    // hash of the header or the variable declaration
+};
+
+// The top-level units, or false if the tokens don't split cleanly. The
+// parser is left to report whatever is wrong then.
+bool split_source_units(const vector<SourceToken>& tokens, vector<SourceUnit>& units) {
+    units.clear();
+    size_t i = 0, n = tokens.size();
+    while (i < n) {
+        if (tokens[i].kind != SRC_TYPE || i + 2 >= n || tokens[i + 1].kind != SRC_ID) return false;
+        SourceUnit unit = {false, i, 0, 0, 0};
+        size_t j = i + 2;
+        if (tokens[j].kind == SRC_LPAREN) {
+            while (j < n && tokens[j].kind != SRC_RPAREN) j++;
+            if (j + 1 >= n || tokens[j + 1].kind != SRC_LCURL) return false;
+            unit.function = true;
+            unit.body = ++j;
+            int depth = 0;
+            for (; j < n; j++) {
+                if (tokens[j].kind == SRC_LCURL) depth++;
+                else if (tokens[j].kind == SRC_RCURL && --depth == 0) break;
+            }
+            if (j == n) return false;
+        } else {
+            while (j < n && tokens[j].kind != SRC_SEMICOLON) j++;
+            if (j == n) return false;
+        }
+        unit.last = j + 1;
+        units.push_back(unit);
+        i = j + 1;
+    }
+    return true;
+}
+
+struct IncrementalStats {
+    size_t functions = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+    bool split = false; // false if the source couldn't be split, so nothing was cached
+};
+
+class IncrementalCompiler {
+private:
+    struct CachedFunction {
+        string code; // numbered from t0 and L0
+        int temps, labels;
+        uint64_t last_used;
+    };
+
+    unordered_map<uint64_t, CachedFunction> cache;
+    size_t capacity;
+    uint64_t clock = 0;
+    size_t total_hits = 0, total_misses = 0;
+
+    // Numbers after `prefix` at the start of a word, as in t12 or L3
+    template <class F>
+    static void for_each_number(string_view code, char prefix, F f) {
+        for (size_t i = 0; i < code.size(); i++) {
+            if (code[i] != prefix || (i > 0 && (isalnum((unsigned char)code[i - 1]) || code[i - 1] == '_'))) continue;
+            size_t j = i + 1;
+            while (j < code.size() && isdigit((unsigned char)code[j])) j++;
+            if (j == i + 1 || (j < code.size() && (isalnum((unsigned char)code[j]) || code[j] == '_'))) continue;
+            f(i, j, atoi(string(code.substr(i + 1, j - i - 1)).c_str()));
+            i = j - 1;
+        }
+    }
+
+    // Smallest number used and how many, as a range from the smallest
+    static void number_range(string_view code, char prefix, int& first, int& count) {
+        int low = INT32_MAX, high = -1;
+        for_each_number(code, prefix, [&](size_t, size_t, int n) {
+            low = min(low, n);
+            high = max(high, n);
+        });
+        first = high < 0 ? 0 : low;
+        count = high < 0 ? 0 : high - low + 1;
+    }
+
+    // Shifts every temp by temp_shift and every label by label_shift
+    static string renumber(string_view code, int temp_shift, int label_shift) {
+        if (temp_shift == 0 && label_shift == 0) return string(code);
+        string out;
+        out.reserve(code.size() + code.size() / 8);
+        size_t done = 0;
+        vector<pair<size_t, pair<size_t, int>>> numbers; // position, end and new value
+        for_each_number(code, 't', [&](size_t at, size_t end, int n) { numbers.push_back({at, {end, n + temp_shift}}); });
+        for_each_number(code, 'L', [&](size_t at, size_t end, int n) { numbers.push_back({at, {end, n + label_shift}}); });
+        sort(numbers.begin(), numbers.end());
+        for (auto& number : numbers) {
+            out.append(code.substr(done, number.first + 1 - done)); // through the prefix
+            out += to_string(number.second.second);
+            done = number.second.first;
+        }
+        out.append(code.substr(done));
+        return out;
+    }
+
+    // Key for units[u]: its tokens, and the global declaration behind every
+    // name it uses
+    uint64_t function_key(string_view source, const vector<SourceToken>& tokens, const vector<SourceUnit>& units,
+                          size_t u, const unordered_map<string_view, size_t>& declared) {
+        const SourceUnit& unit = units[u];
+        uint64_t hash = fnv1a("function");
+        vector<string_view> names;
+        for (size_t t = unit.first; t < unit.last; t++) {
+            string_view text = source.substr(tokens[t].begin, tokens[t].end - tokens[t].begin);
+            hash = fnv1a(text, fnv1a(string_view("\0", 1), hash));
+            if (tokens[t].kind == SRC_ID) names.push_back(text);
+        }
+        sort(names.begin(), names.end());
+        names.erase(unique(names.begin(), names.end()), names.end());
+        for (string_view name : names) {
+            auto it = declared.find(name);
+            uint64_t declaration = it == declared.end() ? 0 : units[it->second].declaration;
+            hash = fnv1a(name, fnv1a(string_view("\0", 1), hash));
+            hash = fnv1a(string_view((const char*)&declaration, sizeof(declaration)), hash);
+        }
+        return hash;
+    }
+
+    void evict() {
+        if (cache.size() <= capacity) return;
+        // Oldest first, down to three quarters full
+        vector<pair<uint64_t, uint64_t>> ages;
+        for (auto& entry : cache) ages.push_back({entry.second.last_used, entry.first});
+        sort(ages.begin(), ages.end());
+        for (size_t i = 0; i < ages.size() && cache.size() > capacity * 3 / 4; i++) cache.erase(ages[i].second);
+    }
+
+public:
+    IncrementalCompiler(size_t capacity = 4096) : capacity(max<size_t>(1, capacity)) {}
+
+    size_t size() const { return cache.size(); }
+    size_t hits() const { return total_hits; }
+    size_t misses() const { return total_misses; }
+    double hit_rate() const { return total_hits + total_misses ? (double)total_hits / (total_hits + total_misses) : 0; }
+
+    // Same result as compile(source) without the log
+    CompileResult compile(string_view source, IncrementalStats* stats = NULL) {
+        CompileOptions options;
+        options.generate_log = false;
+        IncrementalStats local;
+        IncrementalStats& s = stats ? *stats : local;
+        s = IncrementalStats();
+
+        vector<SourceToken> tokens;
+        vector<SourceUnit> units;
+        if (!lex_source(source, tokens) || !split_source_units(tokens, units)) return ::compile(source, options);
+        // A variable named like a temp or a label would be renumbered with them
+        for (const SourceToken& t : tokens) {
+            if (t.kind == SRC_ID && (source[t.begin] == 't' || source[t.begin] == 'L') && t.end - t.begin > 1 &&
+                all_of(source.begin() + t.begin + 1, source.begin() + t.end, [](char c) { return isdigit((unsigned char)c); })) {
+                return ::compile(source, options);
+            }
+        }
+        s.split = true;
+
+        // Keys, and the source with every cached function stubbed out
+        unordered_map<string_view, size_t> declared; // global name -> unit, so far
+        vector<uint64_t> keys;
+        vector<bool> cached;
+        string reduced;
+        size_t copied = 0;
+        for (size_t u = 0; u < units.size(); u++) {
+            SourceUnit& unit = units[u];
+            size_t header_end = unit.function ? unit.body : unit.last;
+            string_view header = source.substr(tokens[unit.first].begin, tokens[header_end - 1].end - tokens[unit.first].begin);
+            unit.declaration = fnv1a(header);
+            if (unit.function) {
+                uint64_t key = function_key(source, tokens, units, u, declared);
+                bool hit = cache.count(key) > 0;
+                keys.push_back(key);
+                cached.push_back(hit);
+                s.functions++;
+                if (hit) {
+                    uint32_t open = tokens[unit.body].begin, close = tokens[unit.last - 1].end;
+                    reduced.append(source.substr(copied, open - copied));
+                    reduced += "{";
+                    reduced.append(count(source.begin() + open, source.begin() + close, '\n'), '\n');
+                    reduced += "}";
+                    copied = close;
+                }
+            }
+            for (size_t t = unit.first + 1; t < header_end; t++) {
+                if (tokens[t].kind == SRC_ID && (unit.function ? t == unit.first + 1 : true)) {
+                    declared[source.substr(tokens[t].begin, tokens[t].end - tokens[t].begin)] = u;
+                }
+            }
+        }
+        reduced.append(source.substr(copied));
+
+        CompileResult result = ::compile(reduced, options);
+        for (bool hit : cached) {
+            if (hit) s.hits++;
+            else s.misses++;
+        }
+        total_hits += s.hits;
+        total_misses += s.misses;
+        clock++;
+        if (!result.ok) return result;
+
+        // Function blocks run from "// Function:" to the blank line after
+        // them; the lines around them (header, global declarations, footer)
+        // come from the new compile as they are
+        string code;
+        code.reserve(result.tac.size());
+        string_view tac = result.tac;
+        size_t f = 0, at = 0;
+        int temps = 0, labels = 0;
+        while (at < tac.size()) {
+            size_t end = tac.find('\n', at);
+            end = end == string_view::npos ? tac.size() : end + 1;
+            if (tac.compare(at, 13, "// Function: ") != 0) {
+                code.append(tac.substr(at, end - at));
+                at = end;
+                continue;
+            }
+            size_t block_end = tac.find("\n\n", at);
+            block_end = block_end == string_view::npos ? tac.size() : block_end + 2;
+            if (f == keys.size()) return ::compile(source, options); // stubs and blocks out of step
+            CachedFunction* entry;
+            if (cached[f]) {
+                entry = &cache[keys[f]];
+            } else {
+                string_view block = tac.substr(at, block_end - at);
+                int first_temp, first_label;
+                CachedFunction fresh;
+                number_range(block, 't', first_temp, fresh.temps);
+                number_range(block, 'L', first_label, fresh.labels);
+                fresh.code = renumber(block, -first_temp, -first_label);
+                entry = &(cache[keys[f]] = move(fresh));
+            }
+            entry->last_used = clock;
+            code += renumber(entry->code, temps, labels);
+            temps += entry->temps;
+            labels += entry->labels;
+            f++;
+            at = block_end;
+        }
+        if (f != keys.size()) return ::compile(source, options);
+        result.tac = move(code);
+        evict();
+        return result;
+    }
+};
+
+// ./compiler --incremental FILE...
+// Compiles each file in turn through one cache, as successive versions of
+// a source being edited, and checks each result against a full compile
+int run_incremental(int argc, char *argv[])
+{
+    IncrementalCompiler incremental;
+    CompileOptions options;
+    options.generate_log = false;
+    double incremental_total = 0, full_total = 0;
+    int mismatches = 0;
+    for (int i = 2; i < argc; i++) {
+        ifstream in(argv[i], ios::binary);
+        if (!in) {
+            cout << "Couldn't open " << argv[i] << endl;
+            return 1;
+        }
+        stringstream ss;
+        ss << in.rdbuf();
+        string source = ss.str();
+
+        IncrementalStats stats;
+        auto start = chrono::steady_clock::now();
+        CompileResult result = incremental.compile(source, &stats);
+        double incremental_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        start = chrono::steady_clock::now();
+        CompileResult full = compile(source, options);
+        double full_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        incremental_total += incremental_seconds;
+        full_total += full_seconds;
+
+        bool same = result.ok == full.ok && result.tac == full.tac && result.errors == full.errors;
+        if (!same) mismatches++;
+        cout << argv[i] << ": ";
+        if (stats.split) cout << stats.functions << " functions, " << stats.hits << " cached, " << stats.misses << " compiled";
+        else cout << "not split, compiled whole";
+        cout << "; " << incremental_seconds * 1000 << " ms against " << full_seconds * 1000 << " ms for a full compile"
+             << (result.ok ? "" : " (has errors)") << (same ? "" : ", MISMATCH with the full compile") << endl;
+    }
+    cout << "Hits " << incremental.hits() << ", misses " << incremental.misses() << " (" << incremental.hit_rate() * 100
+         << "% hit rate), " << incremental.size() << " functions cached; " << incremental_total * 1000 << " ms in all against "
+         << full_total * 1000 << " ms" << endl;
+    return mismatches ? 1 : 0;
+}
+
+#endif // INCREMENTAL_H
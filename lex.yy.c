@@ -795,7 +795,7 @@ case 20:
 YY_RULE_SETUP
 #line 52 "22101088_22101357.l"
 {
-                symbol_info *s = new symbol_info((string)yytext,"ADDOP");
+                symbol_info *s = new symbol_info(yytext, yyleng, "ADDOP");
                 yylval = (YYSTYPE)s;
                 return ADDOP;
 		    }
@@ -804,7 +804,7 @@ case 21:
 YY_RULE_SETUP
 #line 57 "22101088_22101357.l"
 {
-                symbol_info *s = new symbol_info((string)yytext,"MULOP");
+                symbol_info *s = new symbol_info(yytext, yyleng, "MULOP");
                 yylval = (YYSTYPE)s;
                 return MULOP;
             }
@@ -823,7 +823,7 @@ case 24:
 YY_RULE_SETUP
 #line 64 "22101088_22101357.l"
 {
-                symbol_info *s = new symbol_info((string)yytext,"RELOP");
+                symbol_info *s = new symbol_info(yytext, yyleng, "RELOP");
                 yylval = (YYSTYPE)s;
                 return RELOP;
             }
@@ -837,7 +837,7 @@ case 26:
 YY_RULE_SETUP
 #line 71 "22101088_22101357.l"
 {
-		   	symbol_info *s = new symbol_info((string)yytext,"LOGICOP");
+		   	symbol_info *s = new symbol_info(yytext, yyleng, "LOGICOP");
 			yylval = (YYSTYPE)s;
 			return LOGICOP;
 		    }
@@ -891,7 +891,7 @@ case 36:
 YY_RULE_SETUP
 #line 87 "22101088_22101357.l"
 {
-                symbol_info *s = new symbol_info((string)yytext,"ID");
+                symbol_info *s = new symbol_info(yytext, yyleng, "ID");
                 yylval = (YYSTYPE)s;
                 return ID;
             }
@@ -900,7 +900,7 @@ case 37:
 YY_RULE_SETUP
 #line 92 "22101088_22101357.l"
 {
-                symbol_info *s = new symbol_info((string)yytext,"INT");
+                symbol_info *s = new symbol_info(yytext, yyleng, "INT");
                 yylval = (YYSTYPE)s;
                 return CONST_INT;
             }
@@ -909,7 +909,7 @@ case 38:
 YY_RULE_SETUP
 #line 97 "22101088_22101357.l"
 {
-                symbol_info *s = new symbol_info((string)yytext,"FLOAT");
+                symbol_info *s = new symbol_info(yytext, yyleng, "FLOAT");
                 yylval = (YYSTYPE)s;
                 return CONST_FLOAT;
             }
@@ -0,0 +1,74 @@
+#ifndef MAPPED_SOURCE_H
+#define MAPPED_SOURCE_H
+
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// A source file mapped into memory so flex can scan it in place with
+// yy_scan_buffer instead of copying it through YY_INPUT.
+//
+// yy_scan_buffer wants two NUL bytes after the text and writes into the
+// buffer while scanning, so the file is mapped private (copy-on-write) over
+// an anonymous region that is two bytes longer than the file. The bytes past
+// EOF are zero either way: the tail of the file's last page is zero filled by
+// mmap and the next page, if needed, is anonymous.
+class MappedSource {
+private:
+    char* base;
+    size_t file_size;
+    size_t mapped_size;
+
+public:
+    MappedSource() : base(NULL), file_size(0), mapped_size(0) {}
+
+    ~MappedSource() { close(); }
+
+    bool open(const char* path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            ::close(fd);
+            return false;
+        }
+        file_size = st.st_size;
+
+        size_t page = sysconf(_SC_PAGESIZE);
+        mapped_size = (file_size + 2 + page - 1) / page * page;
+        void* region = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        if (file_size > 0 && mmap(region, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            munmap(region, mapped_size);
+            ::close(fd);
+            return false;
+        }
+        ::close(fd);
+
+        madvise(region, mapped_size, MADV_SEQUENTIAL);
+        base = (char*)region;
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(base, mapped_size);
+        base = NULL;
+        file_size = mapped_size = 0;
+    }
+
+    char* data() { return base; }
+    size_t size() const { return file_size; }
+
+    // What to hand to yy_scan_buffer: the text plus its two NUL bytes
+    size_t scan_size() const { return file_size + 2; }
+};
+
+#endif // MAPPED_SOURCE_H
@@ -0,0 +1,183 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Output side of the compiler: a streambuf that outlog/outerror/outcode are
+// attached to. Text collects in large buffers taken from a pool shared by all
+// streams; a full buffer is parked instead of written, and parked buffers go
+// out together in a single writev once enough of them pile up, on flush() or
+// on close(). Nothing is written per line, so the number of syscalls depends
+// on the output size only.
+//
+// The sink can be a file descriptor, a string or any other streambuf.
+class OutputBuffer : public streambuf {
+private:
+    static const size_t BUFFER_SIZE = 256 * 1024;
+    static const size_t MAX_PARKED = 16; // writev once 4 MiB is waiting
+
+    enum SinkKind { NO_SINK, FD_SINK, STRING_SINK, STREAM_SINK };
+
+    SinkKind kind;
+    int fd;
+    string* text;
+    streambuf* next;
+
+    vector<char> current;
+    vector<vector<char>> parked;
+    size_t writes; // syscalls issued, for diagnostics
+
+    static vector<vector<char>>& pool() {
+        static vector<vector<char>> free_buffers;
+        return free_buffers;
+    }
+
+    static vector<char> take_buffer() {
+        vector<vector<char>>& p = pool();
+        if (p.empty()) return vector<char>(BUFFER_SIZE);
+        vector<char> b = move(p.back());
+        p.pop_back();
+        return b;
+    }
+
+    static void give_back(vector<char>& b) {
+        if (b.size() == BUFFER_SIZE) pool().push_back(move(b));
+        b = vector<char>();
+    }
+
+    void start_buffer() {
+        if (current.empty()) current = take_buffer();
+        setp(current.data(), current.data() + current.size());
+    }
+
+    size_t used() const { return pptr() - pbase(); }
+
+    // Writes the parked buffers plus the used part of the current one
+    bool drain() {
+        bool ok = true;
+        if (kind == FD_SINK) {
+            vector<iovec> iov;
+            for (auto& b : parked) iov.push_back({b.data(), b.size()});
+            if (used() > 0) iov.push_back({pbase(), used()});
+            ok = write_iov(iov);
+        } else {
+            for (auto& b : parked) ok = emit(b.data(), b.size()) && ok;
+            if (used() > 0) ok = emit(pbase(), used()) && ok;
+        }
+        for (auto& b : parked) give_back(b);
+        parked.clear();
+        if (!current.empty()) setp(current.data(), current.data() + current.size());
+        return ok;
+    }
+
+    bool emit(const char* data, size_t len) {
+        if (kind == STRING_SINK) text->append(data, len);
+        else if (kind == STREAM_SINK) return next->sputn(data, len) == (streamsize)len;
+        return true;
+    }
+
+    bool write_iov(vector<iovec>& iov) {
+        size_t first = 0;
+        while (first < iov.size()) {
+            int count = min(iov.size() - first, (size_t)IOV_MAX);
+            ssize_t n = writev(fd, &iov[first], count);
+            writes++;
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return false;
+            // Skip what was written, possibly part way into an entry
+            while (first < iov.size() && (size_t)n >= iov[first].iov_len) {
+                n -= iov[first].iov_len;
+                first++;
+            }
+            if (first < iov.size()) {
+                iov[first].iov_base = (char*)iov[first].iov_base + n;
+                iov[first].iov_len -= n;
+            }
+        }
+        return true;
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (kind == NO_SINK) return traits_type::eof();
+        if (pptr() == epptr()) {
+            if (kind == FD_SINK) {
+                parked.push_back(move(current));
+                current = take_buffer();
+                setp(current.data(), current.data() + current.size());
+                if (parked.size() >= MAX_PARKED && !drain()) return traits_type::eof();
+            } else if (!drain()) {
+                return traits_type::eof();
+            }
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override { return flush() ? 0 : -1; }
+
+public:
+    OutputBuffer() : kind(NO_SINK), fd(-1), text(NULL), next(NULL), writes(0) {}
+
+    ~OutputBuffer() { close(); }
+
+    bool open(const string& path) {
+        close();
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        kind = FD_SINK;
+        start_buffer();
+        return true;
+    }
+
+    void attach(string* sink) {
+        close();
+        kind = STRING_SINK;
+        text = sink;
+        start_buffer();
+    }
+
+    void attach(streambuf* sink) {
+        close();
+        kind = STREAM_SINK;
+        next = sink;
+        start_buffer();
+    }
+
+    // Explicit flush point
+    bool flush() {
+        if (kind == NO_SINK) return true;
+        bool ok = drain();
+        if (kind == STREAM_SINK) ok = next->pubsync() == 0 && ok;
+        return ok;
+    }
+
+    // Flushes, detaches from the sink and returns the buffers to the pool
+    bool close() {
+        bool ok = flush();
+        if (kind == FD_SINK) ok = ::close(fd) == 0 && ok;
+        give_back(current);
+        setp(NULL, NULL);
+        kind = NO_SINK;
+        fd = -1;
+        text = NULL;
+        next = NULL;
+        return ok;
+    }
+
+    size_t syscalls() const { return writes; }
+};
+
+#endif // OUTPUT_BUFFER_H
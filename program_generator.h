@@ -0,0 +1,279 @@
+#ifndef PROGRAM_GENERATOR_H
+#define PROGRAM_GENERATOR_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+using namespace std;
+
+// Valid programs of any size for benchmark and stress runs (--generate).
+//
+// Everything is an int, so the type rules never get in the way. The
+// programs also run to completion, so they can go through --run as well
+// as be compiled:
+//   - every assignment is reduced % 1000 and products are of a value
+//     under 100 and a digit, so nothing overflows;
+//   - divisors are (e % 5 + 6), never zero;
+//   - array indexes are constants or loop counters % size;
+//   - loops count down reserved counters the body never assigns;
+//   - a function calls only functions before it, once and outside any
+//     loop, and main calls the last one, so the run is linear in size.
+// The source is written as it's generated, so gigabyte outputs don't need
+// gigabytes of memory.
+
+struct GeneratorOptions {
+    size_t functions = 100;
+    size_t statements = 20;  // per function, not counting nested ones
+    int depth = 3;           // nesting of if/for/while
+    int expression = 6;      // operators per expression, at most
+    int array_percent = 20;  // of assignments, that go to an array element
+    int identifiers = 8;     // int locals per function
+    int globals = 4;
+    int loop_count = 3;      // iterations of each loop
+    unsigned long long bytes = 0; // keep adding functions until this size, if set
+    uint64_t seed = 1;
+};
+
+class ProgramGenerator {
+private:
+    GeneratorOptions opt;
+    mt19937_64 rng;
+    ostream& out;
+    unsigned long long written = 0;
+    vector<int> params; // parameter count of each function so far
+    int array_size = 10;
+
+    size_t pick(size_t n) { return n ? rng() % n : 0; }
+    bool chance(int percent) { return (int)pick(100) < percent; }
+
+    void emit(const string& text) {
+        out << text;
+        written += text.size();
+    }
+
+    void indent(int level) { emit(string(level, '\t')); }
+
+    // A name to read from: a local, a parameter or a global
+    string value(int nparams) {
+        size_t n = opt.identifiers + nparams + opt.globals;
+        size_t k = pick(n);
+        if (k < (size_t)opt.identifiers) return "v" + to_string(k);
+        k -= opt.identifiers;
+        if (k < (size_t)nparams) return "p" + to_string(k);
+        return "g" + to_string(k - nparams);
+    }
+
+    // A name to assign: never a loop counter
+    string target(int nparams) {
+        if (opt.globals && chance(10)) return "g" + to_string(pick(opt.globals));
+        if (nparams && chance(10)) return "p" + to_string(pick(nparams));
+        return "v" + to_string(pick(opt.identifiers));
+    }
+
+    string array_index(int loops) {
+        if (loops && chance(60)) return "c" + to_string(pick(loops)) + " % " + to_string(array_size);
+        return to_string(pick(array_size));
+    }
+
+    // An expression with up to `ops` operators
+    string expression(int ops, int nparams, int loops) {
+        if (ops <= 0) {
+            if (chance(25)) return to_string(pick(100));
+            if (chance(15)) return "a" + to_string(pick(2)) + "[" + array_index(loops) + "]";
+            if (loops && chance(20)) return "c" + to_string(pick(loops));
+            return value(nparams);
+        }
+        int left = pick(ops);
+        int right = ops - 1 - left;
+        switch (pick(8)) {
+        case 0: return "(" + expression(left, nparams, loops) + " - " + expression(right, nparams, loops) + ")";
+        case 1: return "(" + expression(ops - 1, nparams, loops) + ") % 100 * " + to_string(pick(9) + 1);
+        case 2: return "(" + expression(left, nparams, loops) + " / (" + expression(right, nparams, loops) + " % 5 + 6))";
+        case 3: return "(" + expression(left, nparams, loops) + " % (" + expression(right, nparams, loops) + " % 5 + 6))";
+        case 4: return "(" + expression(left, nparams, loops) + (chance(50) ? " < " : " == ") + expression(right, nparams, loops) + ")";
+        case 5: return "-(" + expression(ops - 1, nparams, loops) + ")"; // "--" would scan as a decrement
+        default: return "(" + expression(left, nparams, loops) + " + " + expression(right, nparams, loops) + ")";
+        }
+    }
+
+    string condition(int nparams, int loops) {
+        string c = expression(max(0, opt.expression / 2 - 1), nparams, loops) + (chance(50) ? " > " : " <= ") +
+                   expression(0, nparams, loops);
+        if (chance(25)) c += (chance(50) ? " && " : " || ") + expression(0, nparams, loops) + " != 0";
+        return c;
+    }
+
+    void assignment(int level, int nparams, int loops) {
+        indent(level);
+        string lhs = chance(opt.array_percent) ? "a" + to_string(pick(2)) + "[" + array_index(loops) + "]" : target(nparams);
+        emit(lhs + " = " + expression(pick(opt.expression + 1), nparams, loops) + " % 1000;\n");
+    }
+
+    // One statement at nesting `level`; loops is how many loop counters
+    // are live here
+    void statement(int level, int nparams, int loops) {
+        int nest = level - 1 < opt.depth ? pick(4) : 0;
+        switch (nest) {
+        case 1: {
+            indent(level);
+            emit("if (" + condition(nparams, loops) + ") {\n");
+            block(level + 1, nparams, loops);
+            indent(level);
+            if (chance(50)) {
+                emit("} else {\n");
+                block(level + 1, nparams, loops);
+                indent(level);
+            }
+            emit("}\n");
+            break;
+        }
+        case 2: {
+            string c = "c" + to_string(loops);
+            indent(level);
+            emit("for (" + c + " = 0; " + c + " < " + to_string(opt.loop_count) + "; " + c + "++) {\n");
+            block(level + 1, nparams, loops + 1);
+            indent(level);
+            emit("}\n");
+            break;
+        }
+        case 3: {
+            string c = "c" + to_string(loops);
+            indent(level);
+            emit(c + " = " + to_string(opt.loop_count) + ";\n");
+            indent(level);
+            emit("while (" + c + " > 0) {\n");
+            block(level + 1, nparams, loops + 1);
+            indent(level + 1);
+            emit(c + " = " + c + " - 1;\n");
+            indent(level);
+            emit("}\n");
+            break;
+        }
+        default:
+            assignment(level, nparams, loops);
+            break;
+        }
+    }
+
+    void block(int level, int nparams, int loops) {
+        size_t n = 1 + pick(3);
+        for (size_t i = 0; i < n; i++) statement(level, nparams, loops);
+    }
+
+    void function(size_t f) {
+        int nparams = pick(4);
+        emit("int f" + to_string(f) + "(");
+        for (int p = 0; p < nparams; p++) emit(string(p ? ", " : "") + "int p" + to_string(p));
+        emit(") {\n\tint ");
+        for (int v = 0; v < opt.identifiers; v++) emit("v" + to_string(v) + ", ");
+        for (int c = 0; c < opt.depth; c++) emit("c" + to_string(c) + ", ");
+        emit("a0[" + to_string(array_size) + "], a1[" + to_string(array_size) + "];\n");
+        for (int v = 0; v < opt.identifiers; v++) emit("\tv" + to_string(v) + " = " + to_string(pick(100)) + ";\n");
+        for (int a = 0; a < 2; a++) {
+            for (int i = 0; i < array_size; i++) emit("\ta" + to_string(a) + "[" + to_string(i) + "] = " + to_string(i) + ";\n");
+        }
+        if (!params.empty()) {
+            size_t callee = pick(params.size());
+            emit("\tv0 = f" + to_string(callee) + "(");
+            for (int p = 0; p < params[callee]; p++) emit(string(p ? ", " : "") + expression(pick(3), nparams, 0) + " % 1000");
+            emit(") % 1000;\n");
+        }
+        for (size_t s = 0; s < opt.statements; s++) statement(1, nparams, 0);
+        emit("\treturn " + expression(pick(opt.expression + 1), nparams, 0) + " % 1000;\n}\n");
+        params.push_back(nparams);
+    }
+
+public:
+    ProgramGenerator(const GeneratorOptions& options, ostream& out) : opt(options), rng(options.seed), out(out) {
+        opt.identifiers = max(1, opt.identifiers);
+        opt.depth = max(0, opt.depth);
+        opt.globals = max(0, opt.globals);
+    }
+
+    // Writes the whole program; the number of functions besides main
+    size_t generate() {
+        if (opt.globals) {
+            emit("int ");
+            for (int g = 0; g < opt.globals; g++) emit(string(g ? ", " : "") + "g" + to_string(g));
+            emit(";\n");
+        }
+        size_t f = 0;
+        while (opt.bytes ? written < opt.bytes : f < opt.functions) function(f++);
+        emit("int main() {\n\tint r;\n");
+        for (int g = 0; g < opt.globals; g++) emit("\tg" + to_string(g) + " = " + to_string(g + 1) + ";\n");
+        if (f) {
+            emit("\tr = f" + to_string(f - 1) + "(");
+            for (int p = 0; p < params[f - 1]; p++) emit(string(p ? ", " : "") + to_string(p + 1));
+            emit(");\n");
+        } else {
+            emit("\tr = 0;\n");
+        }
+        emit("\treturn r;\n}\n");
+        return f;
+    }
+
+    unsigned long long bytes() const { return written; }
+};
+
+// "64", "512K", "10M", "1G"
+inline unsigned long long parse_byte_size(const string& text) {
+    char* end;
+    unsigned long long n = strtoull(text.c_str(), &end, 10);
+    switch (*end) {
+    case 'k': case 'K': return n << 10;
+    case 'm': case 'M': return n << 20;
+    case 'g': case 'G': return n << 30;
+    default: return n;
+    }
+}
+
+// ./compiler --generate [-f FUNCTIONS] [-s STATEMENTS] [-d DEPTH] [-e OPERATORS]
+//                       [-a ARRAY_PERCENT] [-i IDENTIFIERS] [-g GLOBALS]
+//                       [--size BYTES] [--seed N] [-o FILE]
+int run_generate(int argc, char *argv[])
+{
+    GeneratorOptions options;
+    string path = "generated.c";
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string arg = argv[i], value = argv[i + 1];
+        if (arg == "-f") options.functions = strtoul(value.c_str(), NULL, 10);
+        else if (arg == "-s") options.statements = strtoul(value.c_str(), NULL, 10);
+        else if (arg == "-d") options.depth = atoi(value.c_str());
+        else if (arg == "-e") options.expression = atoi(value.c_str());
+        else if (arg == "-a") options.array_percent = atoi(value.c_str());
+        else if (arg == "-i") options.identifiers = atoi(value.c_str());
+        else if (arg == "-g") options.globals = atoi(value.c_str());
+        else if (arg == "--size") options.bytes = parse_byte_size(value);
+        else if (arg == "--seed") options.seed = strtoull(value.c_str(), NULL, 10);
+        else if (arg == "-o") path = value;
+        else {
+            cout << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    ofstream out(path.c_str(), ios::binary | ios::trunc);
+    if (!out) {
+        cout << "Couldn't open " << path << " for writing" << endl;
+        return 1;
+    }
+    auto start = chrono::steady_clock::now();
+    ProgramGenerator generator(options, out);
+    size_t functions = generator.generate();
+    out.close();
+    if (!out) {
+        cout << "Couldn't write " << path << endl;
+        return 1;
+    }
+    cout << "Wrote " << path << ": " << generator.bytes() << " bytes, " << functions << " functions and main, in "
+         << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+    return 0;
+}
+
+#endif // PROGRAM_GENERATOR_H
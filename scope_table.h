@@ -178,7 +178,7 @@ public:
         }
     }
 
-    void Print_scope(ofstream& outlog)
+    void Print_scope(ostream& outlog)
     {
     	string s = "";
     	s+="ScopeTable # "+to_string(ID)+"\n";
@@ -10,6 +10,9 @@ echo 'Generated the scanner C file'
 g++ -fpermissive -w -c -o l.o lex.yy.c
 echo 'Generated the scanner object file'
 g++ y.o l.o -o compiler
+g++ -w -DCOMPILER_LIBRARY -c -o y_lib.o y.tab.c
+ar rcs libcompiler.a y_lib.o l.o
+echo 'Generated the compiler library (libcompiler.a, interface in compiler.h)'
 echo 'All ready, running the compiler...'
 
 # Run the compiler on the input file
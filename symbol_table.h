@@ -15,19 +15,19 @@ public:
     {
         scope_size = n;
     }
-    void enter_scope(ofstream& outlog)
+    void enter_scope(ostream& outlog)
     {
         ID+=1;
         scope_table *new_scope = new scope_table(scope_size, ID);
         new_scope->set_prnt(curr_scope);
         curr_scope = new_scope;
-        outlog<<"New ScopeTable with ID "<<curr_scope->getID()<<" created"<<endl<<endl;
+        outlog<<"New ScopeTable with ID "<<curr_scope->getID()<<" created"<<"\n\n";
         //if(new_scope->getID() != "1")cout<<curr_scope->getID()<<" "<<(curr_scope->get_prnt())->getID()<<endl;
     }
 
-    void exit_scope(ofstream& outlog)
+    void exit_scope(ostream& outlog)
     {
-    	outlog<<"Scopetable with ID "<<curr_scope->getID()<<" removed"<<endl<<endl;
+    	outlog<<"Scopetable with ID "<<curr_scope->getID()<<" removed"<<"\n\n";
         scope_table *buffer = curr_scope;
         curr_scope = curr_scope->get_prnt();
         delete buffer;
@@ -69,9 +69,9 @@ public:
         //curr_scope->Print_scope();
     }
 
-    void Print_all_scope(ofstream& outlog)
+    void Print_all_scope(ostream& outlog)
     {
-        outlog<<"################################"<<endl<<endl;
+        outlog<<"################################"<<"\n\n";
         scope_table *buffer = curr_scope;
 
         while(buffer!=NULL)
@@ -79,7 +79,7 @@ public:
             buffer->Print_scope(outlog);
             buffer = buffer->get_prnt();
         }
-        outlog<<"################################"<<endl<<endl;
+        outlog<<"################################"<<"\n\n";
     }
 
     ~symbol_table()
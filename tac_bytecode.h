@@ -0,0 +1,446 @@
+#ifndef TAC_BYTECODE_H
+#define TAC_BYTECODE_H
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "tac_vm.h"
+#include "mapped_source.h"
+
+using namespace std;
+
+// Binary form of a decoded TacProgram (code.bin), so executors and caches can
+// skip parsing the TAC text.
+//
+// Everything is fixed width and little endian as the host writes it. A string
+// is a u32 length and its bytes. A count is a u32, followed by the records it
+// counts. Instructions go on disk exactly as TacInstr is laid out in memory,
+// so the code of a function is loaded with one memcpy.
+//
+//   header   "TACB" u32 version, u32 functions, i32 global_frame_size
+//   globals  count, {string name, u8 kind}
+//            count, {i32 slot, i32 base, i32 size, u32 kind}   global arrays
+//   function string name, string return_type
+//            count, {i32 slot, u8 kind}                      parameters
+//            count, {string name, u8 kind}                   slots
+//            count, {i32 slot, i32 base, i32 size, u32 kind} arrays
+//            i32 frame_size
+//            count, TacInstr[count], i32 lines[count]         code
+//            count, {i64 bits, u32 is_float, u32 0}          constant pool
+//            count, {string name, i32 index}                 label table
+
+static const char TAC_BYTECODE_MAGIC[4] = {'T', 'A', 'C', 'B'};
+static const uint32_t TAC_BYTECODE_VERSION = 1;
+
+static_assert(sizeof(TacInstr) == 20, "code.bin stores TacInstr as is");
+
+class TacBytecodeWriter {
+private:
+    string& out;
+
+    void raw(const void* p, size_t n) { out.append((const char*)p, n); }
+    void u8(uint8_t v) { raw(&v, 1); }
+    void u32(uint32_t v) { raw(&v, 4); }
+    void i32(int32_t v) { raw(&v, 4); }
+    void str(const string& s) {
+        u32(s.size());
+        raw(s.data(), s.size());
+    }
+
+    void arrays(const vector<TacArray>& list) {
+        u32(list.size());
+        for (auto& a : list) {
+            i32(a.slot);
+            i32(a.base);
+            i32(a.size);
+            u32(a.kind);
+        }
+    }
+
+    void function(const TacFunction& fn) {
+        str(fn.name);
+        str(fn.return_type);
+
+        u32(fn.param_slots.size());
+        for (size_t i = 0; i < fn.param_slots.size(); i++) {
+            i32(fn.param_slots[i]);
+            u8(fn.param_kinds[i]);
+        }
+
+        u32(fn.slot_names.size());
+        for (size_t i = 0; i < fn.slot_names.size(); i++) {
+            str(fn.slot_names[i]);
+            u8(fn.slot_kinds[i]);
+        }
+
+        arrays(fn.arrays);
+        i32(fn.frame_size);
+
+        u32(fn.code.size());
+        // Padding bytes are zeroed so the same program always gives the same file
+        for (const TacInstr& in : fn.code) {
+            TacInstr clean;
+            memset(&clean, 0, sizeof clean);
+            clean.op = in.op;
+            clean.kind = in.kind;
+            clean.dst = in.dst;
+            clean.a = in.a;
+            clean.b = in.b;
+            clean.c = in.c;
+            raw(&clean, sizeof clean);
+        }
+        for (size_t i = 0; i < fn.code.size(); i++) i32(i < fn.lines.size() ? fn.lines[i] : 0);
+
+        u32(fn.constants.size());
+        for (const TacValue& v : fn.constants) {
+            int64_t bits;
+            memcpy(&bits, &v.i, sizeof bits);
+            raw(&bits, sizeof bits);
+            u32(v.is_float);
+            u32(0);
+        }
+
+        u32(fn.labels.size());
+        for (auto& l : fn.labels) {
+            str(l.first);
+            i32(l.second);
+        }
+    }
+
+public:
+    TacBytecodeWriter(string& buffer) : out(buffer) {}
+
+    void write(const TacProgram& prog) {
+        raw(TAC_BYTECODE_MAGIC, 4);
+        u32(TAC_BYTECODE_VERSION);
+        u32(prog.functions.size());
+        i32(prog.global_frame_size);
+
+        u32(prog.global_names.size());
+        for (size_t i = 0; i < prog.global_names.size(); i++) {
+            str(prog.global_names[i]);
+            u8(prog.global_kinds[i]);
+        }
+        arrays(prog.global_arrays);
+
+        for (const TacFunction& fn : prog.functions) function(fn);
+    }
+};
+
+class TacBytecodeReader {
+private:
+    const char* pos;
+    const char* end;
+    string error;
+
+    bool take(void* dst, size_t n) {
+        if ((size_t)(end - pos) < n) {
+            if (error.empty()) error = "truncated bytecode";
+            pos = end;
+            memset(dst, 0, n);
+            return false;
+        }
+        memcpy(dst, pos, n);
+        pos += n;
+        return true;
+    }
+    uint8_t u8() { uint8_t v; take(&v, 1); return v; }
+    uint32_t u32() { uint32_t v; take(&v, 4); return v; }
+    int32_t i32() { int32_t v; take(&v, 4); return v; }
+    string str() {
+        uint32_t n = u32();
+        if ((size_t)(end - pos) < n) {
+            if (error.empty()) error = "truncated bytecode";
+            pos = end;
+            return string();
+        }
+        string s(pos, n);
+        pos += n;
+        return s;
+    }
+
+    // Counts are checked against what is left so a corrupt file can't make
+    // us allocate gigabytes
+    uint32_t count(size_t min_record) {
+        uint32_t n = u32();
+        if ((size_t)(end - pos) / min_record < n) {
+            if (error.empty()) error = "corrupt bytecode";
+            pos = end;
+            return 0;
+        }
+        return n;
+    }
+
+    void arrays(vector<TacArray>& list) {
+        list.resize(count(16));
+        for (auto& a : list) {
+            a.slot = i32();
+            a.base = i32();
+            a.size = i32();
+            a.kind = u32();
+        }
+    }
+
+    void function(TacFunction& fn) {
+        fn.name = str();
+        fn.return_type = str();
+
+        uint32_t n = count(5);
+        fn.param_slots.resize(n);
+        fn.param_kinds.resize(n);
+        for (uint32_t i = 0; i < n; i++) {
+            fn.param_slots[i] = i32();
+            fn.param_kinds[i] = u8();
+        }
+
+        n = count(5);
+        fn.slot_names.resize(n);
+        fn.slot_kinds.resize(n);
+        for (uint32_t i = 0; i < n; i++) {
+            fn.slot_names[i] = str();
+            fn.slot_kinds[i] = u8();
+        }
+
+        arrays(fn.arrays);
+        fn.frame_size = i32();
+
+        n = count(sizeof(TacInstr) + 4);
+        fn.code.resize(n);
+        fn.lines.resize(n);
+        take(fn.code.data(), n * sizeof(TacInstr));
+        take(fn.lines.data(), n * sizeof(int32_t));
+
+        n = count(16);
+        fn.constants.resize(n);
+        for (TacValue& v : fn.constants) {
+            int64_t bits;
+            take(&bits, sizeof bits);
+            memcpy(&v.i, &bits, sizeof bits);
+            v.is_float = u32() != 0;
+            u32();
+        }
+
+        n = count(8);
+        for (uint32_t i = 0; i < n; i++) {
+            string name = str();
+            fn.labels[name] = i32();
+        }
+    }
+
+    // A frame is its named slots followed by the cells of its arrays, as
+    // end_function lays it out; the backends size kind tables by it
+    static bool valid_frame(int frame, size_t slots, const vector<TacArray>& arrays) {
+        int64_t cells = slots;
+        for (const TacArray& arr : arrays) {
+            if (arr.size < 0 || arr.base < (int64_t)slots || (int64_t)arr.base + arr.size > frame) return false;
+            cells += arr.size;
+        }
+        return cells == frame;
+    }
+
+    // Operands index into frames, pools and the function table, so make sure
+    // they are in range before anything executes them
+    bool validate(const TacProgram& prog) {
+        int nfuncs = prog.functions.size();
+        int nglobals = prog.global_kinds.size();
+        if (!valid_frame(prog.global_frame_size, nglobals, prog.global_arrays)) return false;
+        for (const TacFunction& fn : prog.functions) {
+            int frame = fn.frame_size;
+            int code_size = fn.code.size();
+            int nconsts = fn.constants.size();
+            if (!valid_frame(frame, fn.slot_kinds.size(), fn.arrays)) return false;
+            auto slot = [frame](int s) { return s >= 0 && s < frame; };
+            // Start and length of an indexed run of cells, in 64 bits so
+            // the end can't wrap
+            auto cells = [](int start, int count, int size) {
+                return start >= 0 && count >= 0 && (int64_t)start + count <= size;
+            };
+            for (int s : fn.param_slots) {
+                if (!slot(s)) return false;
+            }
+            for (const TacInstr& in : fn.code) {
+                bool ok = true;
+                switch (in.op) {
+                case TAC_NOP: case TAC_RET_VOID: break;
+                case TAC_CONST: ok = slot(in.dst) && in.a >= 0 && in.a < nconsts; break;
+                case TAC_COPY: case TAC_NEG: case TAC_NOT: ok = slot(in.dst) && slot(in.a); break;
+                case TAC_GET_GLOBAL: ok = slot(in.dst) && in.a >= 0 && in.a < nglobals; break;
+                case TAC_SET_GLOBAL: ok = slot(in.a) && in.dst >= 0 && in.dst < nglobals; break;
+                case TAC_LOAD_INDEX: case TAC_STORE_INDEX:
+                    ok = slot(in.dst) && slot(in.b) && cells(in.a, in.c, frame);
+                    break;
+                case TAC_LOAD_GINDEX: case TAC_STORE_GINDEX:
+                    ok = slot(in.dst) && slot(in.b) && cells(in.a, in.c, prog.global_frame_size);
+                    break;
+                case TAC_PARAM: case TAC_RET: ok = slot(in.a); break;
+                case TAC_CALL: ok = slot(in.dst) && in.a >= 0 && in.a < nfuncs && in.b >= 0; break;
+                case TAC_IF: case TAC_IF_FALSE: ok = slot(in.a) && in.dst >= 0 && in.dst <= code_size; break;
+                case TAC_GOTO: ok = in.dst >= 0 && in.dst <= code_size; break;
+                default:
+                    if (in.op >= TAC_ADD && in.op <= TAC_OR) ok = slot(in.dst) && slot(in.a) && slot(in.b);
+                    else ok = false;
+                    break;
+                }
+                if (!ok || in.kind > KIND_FLOAT) return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    TacBytecodeReader(const char* data, size_t size) : pos(data), end(data + size) {}
+
+    bool read(TacProgram& prog) {
+        char magic[4];
+        if (!take(magic, 4) || memcmp(magic, TAC_BYTECODE_MAGIC, 4) != 0) {
+            error = "not a TAC bytecode file";
+            return false;
+        }
+        uint32_t version = u32();
+        if (version != TAC_BYTECODE_VERSION) {
+            error = "unsupported bytecode version " + to_string(version);
+            return false;
+        }
+        uint32_t nfuncs = u32();
+        prog.global_frame_size = i32();
+
+        uint32_t n = count(5);
+        prog.global_names.resize(n);
+        prog.global_kinds.resize(n);
+        for (uint32_t i = 0; i < n; i++) {
+            prog.global_names[i] = str();
+            prog.global_kinds[i] = u8();
+        }
+        arrays(prog.global_arrays);
+
+        if ((size_t)(end - pos) / 8 < nfuncs) {
+            error = "corrupt bytecode";
+            return false;
+        }
+        prog.functions.resize(nfuncs);
+        for (uint32_t f = 0; f < nfuncs && error.empty(); f++) {
+            function(prog.functions[f]);
+            prog.function_index[prog.functions[f].name] = f;
+        }
+        if (!error.empty()) return false;
+        if (!validate(prog)) {
+            error = "bytecode operand out of range";
+            return false;
+        }
+        return true;
+    }
+
+    const string& get_error() const { return error; }
+};
+
+inline string tac_bytecode(const TacProgram& prog) {
+    string out;
+    TacBytecodeWriter(out).write(prog);
+    return out;
+}
+
+// Decodes TAC text and returns its bytecode, empty if the text doesn't load
+string tac_text_to_bytecode(const string& text, string& error) {
+    TacProgram prog;
+    stringstream code(text);
+    TacLoader loader(prog);
+    if (!loader.load(code)) {
+        error = loader.get_error();
+        return string();
+    }
+    return tac_bytecode(prog);
+}
+
+bool save_tac_bytecode(const string& bytecode, const string& path, string& error) {
+    ofstream out(path.c_str(), ios::binary);
+    out.write(bytecode.data(), bytecode.size());
+    out.close();
+    if (!out) {
+        error = "couldn't write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool load_tac_bytecode(const char* data, size_t size, TacProgram& prog, string& error) {
+    TacBytecodeReader reader(data, size);
+    if (!reader.read(prog)) {
+        error = reader.get_error();
+        return false;
+    }
+    return true;
+}
+
+bool load_tac_bytecode_file(const string& path, TacProgram& prog, string& error) {
+    MappedSource file;
+    if (!file.open(path.c_str())) {
+        error = "couldn't open " + path;
+        return false;
+    }
+    return load_tac_bytecode(file.data(), file.size(), prog, error);
+}
+
+// ./compiler --bench-load file [-n REPEAT]
+// Compares loading a program from TAC text against loading its bytecode
+int run_load_bench(int argc, char *argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " --bench-load file [-n REPEAT]" << endl;
+        return 1;
+    }
+    int repeat = 20;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "-n") repeat = max(1, atoi(argv[i + 1]));
+    }
+
+    // Text form of the program, compiling it first if given a source file
+    string path = argv[2];
+    ifstream in(path.c_str(), ios::binary);
+    if (!in) {
+        cout << "Couldn't open " << path << endl;
+        return 1;
+    }
+    stringstream ss;
+    ss << in.rdbuf();
+    string text = ss.str();
+    if (path.size() > 2 && path.compare(path.size() - 2, 2, ".c") == 0) {
+        CompileOptions options;
+        options.generate_log = false;
+        text = compile(text, options).tac;
+    }
+
+    TacProgram prog;
+    stringstream code(text);
+    TacLoader first_load(prog);
+    if (!first_load.load(code)) {
+        cout << "Couldn't load TAC: " << first_load.get_error() << endl;
+        return 1;
+    }
+    string bytecode = tac_bytecode(prog);
+    string error;
+
+    double text_best = 1e100, binary_best = 1e100;
+    for (int r = 0; r < repeat; r++) {
+        auto start = chrono::steady_clock::now();
+        TacProgram from_text;
+        stringstream code(text);
+        TacLoader loader(from_text);
+        loader.load(code);
+        auto mid = chrono::steady_clock::now();
+        TacProgram from_binary;
+        load_tac_bytecode(bytecode.data(), bytecode.size(), from_binary, error);
+        auto stop = chrono::steady_clock::now();
+        text_best = min(text_best, chrono::duration<double>(mid - start).count());
+        binary_best = min(binary_best, chrono::duration<double>(stop - mid).count());
+    }
+
+    size_t instrs = 0;
+    for (auto& fn : prog.functions) instrs += fn.code.size();
+    cout << prog.functions.size() << " functions, " << instrs << " instructions" << endl;
+    cout << "text:     " << text.size() << " bytes, best of " << repeat << ": " << text_best * 1000 << " ms" << endl;
+    cout << "bytecode: " << bytecode.size() << " bytes, best of " << repeat << ": " << binary_best * 1000 << " ms" << endl;
+    if (binary_best > 0) cout << "speedup: " << text_best / binary_best << "x" << endl;
+    return 0;
+}
+
+#endif // TAC_BYTECODE_H
@@ -0,0 +1,337 @@
+#ifndef TAC_C_BACKEND_H
+#define TAC_C_BACKEND_H
+
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "tac_vm.h"
+#include "tac_native.h"
+#include "batch_driver.h"
+
+using namespace std;
+
+// C backend: turns each TAC function into straight-line C with gotos and
+// leaves the optimizing to the system compiler.
+//
+// Scalar slots become locals typed by tac_infer_slot_kinds (long long or
+// double). Arrays become local arrays, and globals become fields of one
+// tac_globals struct. Mixed int/float arithmetic and conversions go through
+// C's usual arithmetic conversions, which are exactly the VM's (truncating
+// float -> int). Array bounds and integer division by zero call
+// __builtin_trap, where the VM reports an error. The generated main() is the
+// same harness as the assembly backend's: it runs tac_main argv[1] times and
+// prints "<result> <ns>".
+
+class TacCEmitter {
+private:
+    const TacProgram& prog;
+    stringstream out;
+    string error;
+
+    const TacFunction* fn;
+    vector<uint8_t> kinds;
+
+    static const char* ctype(uint8_t kind) { return kind == KIND_FLOAT ? "double" : "long long"; }
+
+    string return_type(const TacFunction& f) const { return ctype(tac_value_kind(tac_kind_of(f.return_type))); }
+    string slot(int s) const { return "s" + to_string(s); }
+    string cells(int base) const { return "c" + to_string(base); }
+    string global(int g) const { return "tac_globals.g" + to_string(g); }
+
+    static string literal(const TacValue& v) {
+        char buf[64];
+        if (v.is_float) {
+            if (isnan(v.f)) return "(0.0 / 0.0)";
+            if (isinf(v.f)) return v.f > 0 ? "(1.0 / 0.0)" : "(-1.0 / 0.0)";
+            snprintf(buf, sizeof buf, "%a", v.f); // exact
+        } else if (v.i == LLONG_MIN) {
+            return "(-9223372036854775807LL - 1)";
+        } else {
+            snprintf(buf, sizeof buf, "%lldLL", v.i);
+        }
+        return buf;
+    }
+
+    void prototype(const TacFunction& f) {
+        out << "static " << return_type(f) << " tac_" << f.name << "(";
+        for (size_t k = 0; k < f.param_slots.size(); k++) {
+            out << (k ? ", " : "") << ctype(tac_value_kind(f.param_kinds[k])) << " p" << k;
+        }
+        if (f.param_slots.empty()) out << "void";
+        out << ")";
+    }
+
+    // Frame layout: scalar slots and arrays, by base
+    template <class Visit>
+    static void frame_entries(int size, const vector<TacArray>& arrays, Visit visit) {
+        vector<const TacArray*> at(size, NULL);
+        for (auto& arr : arrays) {
+            if (arr.base >= 0 && arr.base < size) at[arr.base] = &arr;
+        }
+        for (int s = 0; s < size; s++) {
+            visit(s, at[s]);
+            if (at[s]) s += at[s]->size - 1;
+        }
+    }
+
+    // Opens a block with the checked index in i
+    string check_index(const TacInstr& in) const {
+        return "\t{ long long i = " + slot(in.b) + "; if ((unsigned long long)i >= " + to_string(in.c) +
+               "ULL) __builtin_trap(); ";
+    }
+
+    bool function(const TacFunction& f) {
+        fn = &f;
+        kinds = tac_infer_slot_kinds(prog, f);
+        int ncode = f.code.size();
+
+        vector<bool> target(ncode + 1, false);
+        for (const TacInstr& in : f.code) {
+            if (tac_is_jump(in.op)) target[in.dst] = true;
+        }
+
+        out << "\n";
+        prototype(f);
+        out << "\n{\n";
+        frame_entries(f.frame_size, f.arrays, [&](int s, const TacArray* arr) {
+            if (arr) out << "\t" << ctype(tac_value_kind(arr->kind)) << " " << cells(s) << "[" << arr->size << "] = {0};\n";
+            else out << "\t" << ctype(kinds[s]) << " " << slot(s) << " = 0;\n";
+        });
+        for (size_t k = 0; k < f.param_slots.size(); k++) out << "\t" << slot(f.param_slots[k]) << " = p" << k << ";\n";
+
+        for (int pc = 0; pc < ncode; pc++) {
+            const TacInstr& in = f.code[pc];
+            if (target[pc]) out << "L" << pc << ":;\n";
+            string d = slot(in.dst), a = slot(in.a), b = slot(in.b);
+            switch (in.op) {
+            case TAC_NOP:
+            case TAC_PARAM:
+                break;
+            case TAC_CONST:
+                out << "\t" << d << " = " << literal(f.constants[in.a]) << ";\n";
+                break;
+            case TAC_COPY:
+                out << "\t" << d << " = " << a << ";\n";
+                break;
+            case TAC_GET_GLOBAL:
+                out << "\t" << d << " = " << global(in.a) << ";\n";
+                break;
+            case TAC_SET_GLOBAL:
+                out << "\t" << global(in.dst) << " = " << a << ";\n";
+                break;
+            case TAC_ADD: case TAC_SUB: case TAC_MUL: case TAC_DIV: {
+                static const char* const ops[] = {"+", "-", "*", "/"};
+                bool is_float = kinds[in.a] == KIND_FLOAT || kinds[in.b] == KIND_FLOAT;
+                if (in.op == TAC_DIV && !is_float) {
+                    // LLONG_MIN / -1 traps even with -fwrapv, so -1 negates
+                    out << "\tif (" << b << " == 0) __builtin_trap();\n";
+                    out << "\t" << d << " = " << b << " == -1 ? -" << a << " : " << a << " / " << b << ";\n";
+                    break;
+                }
+                out << "\t" << d << " = " << a << " " << ops[in.op - TAC_ADD] << " " << b << ";\n";
+                break;
+            }
+            case TAC_MOD:
+                out << "\tif ((long long)" << b << " == 0) __builtin_trap();\n";
+                out << "\t" << d << " = (long long)" << b << " == -1 ? 0 : (long long)" << a << " % (long long)" << b << ";\n";
+                break;
+            case TAC_LT: case TAC_GT: case TAC_LE: case TAC_GE: case TAC_EQ: case TAC_NE: {
+                static const char* const ops[] = {"<", ">", "<=", ">=", "==", "!="};
+                out << "\t" << d << " = " << a << " " << ops[in.op - TAC_LT] << " " << b << ";\n";
+                break;
+            }
+            case TAC_AND:
+            case TAC_OR:
+                out << "\t" << d << " = (" << a << " != 0) " << (in.op == TAC_AND ? "&" : "|") << " (" << b << " != 0);\n";
+                break;
+            case TAC_NEG:
+                out << "\t" << d << " = -" << a << ";\n";
+                break;
+            case TAC_NOT:
+                out << "\t" << d << " = !" << a << ";\n";
+                break;
+            case TAC_LOAD_INDEX:
+                out << check_index(in) << d << " = " << cells(in.a) << "[i]; }\n";
+                break;
+            case TAC_STORE_INDEX:
+                out << check_index(in) << cells(in.a) << "[i] = " << d << "; }\n";
+                break;
+            case TAC_LOAD_GINDEX:
+                out << check_index(in) << d << " = " << global(in.a) << "[i]; }\n";
+                break;
+            case TAC_STORE_GINDEX:
+                out << check_index(in) << global(in.a) << "[i] = " << d << "; }\n";
+                break;
+            case TAC_CALL: {
+                const TacFunction& callee = prog.functions[in.a];
+                if ((size_t)in.b != callee.param_slots.size() || pc < in.b) {
+                    error = f.name + " calls " + callee.name + " with " + to_string(in.b) + " arguments";
+                    return false;
+                }
+                out << "\t" << d << " = tac_" << callee.name << "(";
+                for (int k = 0; k < in.b; k++) {
+                    const TacInstr& p = f.code[pc - in.b + k];
+                    if (p.op != TAC_PARAM) {
+                        error = "params of the call to " + callee.name + " in " + f.name + " aren't next to it";
+                        return false;
+                    }
+                    out << (k ? ", " : "") << slot(p.a);
+                }
+                out << ");\n";
+                break;
+            }
+            case TAC_RET:
+                out << "\treturn " << a << ";\n";
+                break;
+            case TAC_RET_VOID:
+                out << "\treturn 0;\n";
+                break;
+            case TAC_IF:
+                out << "\tif (" << a << ") goto L" << in.dst << ";\n";
+                break;
+            case TAC_IF_FALSE:
+                out << "\tif (!" << a << ") goto L" << in.dst << ";\n";
+                break;
+            case TAC_GOTO:
+                out << "\tgoto L" << in.dst << ";\n";
+                break;
+            default:
+                error = "unsupported opcode " + to_string(in.op) + " in " + f.name;
+                return false;
+            }
+        }
+        if (target[ncode]) out << "L" << ncode << ":;\n";
+        out << "\treturn 0;\n}\n";
+        return true;
+    }
+
+    void entry_stub(const TacFunction& entry) {
+        bool float_result = tac_kind_of(entry.return_type) == KIND_FLOAT;
+        out << "\nint main(int argc, char** argv)\n{\n"
+            << "\tint runs = argc > 1 ? atoi(argv[1]) : 1;\n"
+            << "\tif (runs < 1) runs = 1;\n"
+            << "\tlong long best = LLONG_MAX;\n"
+            << "\t" << return_type(entry) << " result = 0;\n"
+            << "\tfor (int r = 0; r < runs; r++) {\n"
+            << "\t\tstruct timespec t0, t1;\n"
+            << "\t\tmemset(&tac_globals, 0, sizeof tac_globals);\n"
+            << "\t\t__asm__ volatile(\"\" ::: \"memory\");\n"
+            << "\t\tclock_gettime(CLOCK_MONOTONIC, &t0);\n"
+            << "\t\tresult = tac_" << entry.name << "();\n"
+            << "\t\tclock_gettime(CLOCK_MONOTONIC, &t1);\n"
+            << "\t\tlong long ns = (t1.tv_sec - t0.tv_sec) * 1000000000LL + (t1.tv_nsec - t0.tv_nsec);\n"
+            << "\t\tif (ns < best) best = ns;\n"
+            << "\t}\n"
+            << "\tprintf(\"" << (float_result ? "%.17g" : "%lld") << " %lld\\n\", result, best);\n"
+            << "\treturn 0;\n}\n";
+    }
+
+public:
+    TacCEmitter(const TacProgram& p) : prog(p), fn(NULL) {}
+
+    // C for the whole program, with a main() that runs entry
+    bool emit(string& text, const string& entry) {
+        out.str("");
+        out << "/* Generated from TAC */\n"
+            << "#include <limits.h>\n#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n#include <time.h>\n\n";
+
+        out << "struct {\n\tchar unused;\n";
+        frame_entries(prog.global_frame_size, prog.global_arrays, [&](int g, const TacArray* arr) {
+            if (arr) {
+                out << "\t" << ctype(tac_value_kind(arr->kind)) << " g" << g << "[" << arr->size << "];\n";
+            } else {
+                uint8_t kind = (size_t)g < prog.global_kinds.size() ? prog.global_kinds[g] : (uint8_t)KIND_INT;
+                out << "\t" << ctype(tac_value_kind(kind)) << " g" << g << ";\n";
+            }
+        });
+        out << "} tac_globals;\n\n";
+
+        for (auto& f : prog.functions) {
+            prototype(f);
+            out << ";\n";
+        }
+        for (auto& f : prog.functions) {
+            if (!function(f)) return false;
+        }
+
+        int e = prog.find_function(entry);
+        if (e < 0 || !prog.functions[e].param_slots.empty()) {
+            error = "no entry function " + entry + " without parameters";
+            return false;
+        }
+        entry_stub(prog.functions[e]);
+        text = out.str();
+        return true;
+    }
+
+    const string& get_error() const { return error; }
+};
+
+// ./compiler --native-c [-o DIR] [-n REPEAT] [-O LEVEL] file...
+// Builds each program through C and the system compiler, runs it and
+// checks the result and speed against the interpreter
+int run_native_c(int argc, char *argv[])
+{
+    string out_dir = "native_out";
+    string opt = "2";
+    int repeat = 5;
+    vector<string> inputs;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) out_dir = argv[++i];
+        else if (arg == "-n" && i + 1 < argc) repeat = max(1, atoi(argv[++i]));
+        else if (arg == "-O" && i + 1 < argc) opt = argv[++i];
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) {
+        cout << "Usage: " << argv[0] << " --native-c [-o DIR] [-n REPEAT] [-O LEVEL] file..." << endl;
+        return 1;
+    }
+    BatchDriver::make_dirs(out_dir);
+
+    int failures = 0;
+    for (const string& input : inputs) {
+        string name = input.substr(input.find_last_of('/') + 1);
+        name = name.substr(0, name.find('.'));
+        string c_path = out_dir + "/" + name + "_tac.c";
+        string exe_path = out_dir + "/" + name + "_c";
+        cout << "== " << input << endl;
+
+        TacProgram prog;
+        string error, text;
+        if (!load_tac_program(input, prog, error)) {
+            cout << "   couldn't load: " << error << endl;
+            failures++;
+            continue;
+        }
+        TacCEmitter emitter(prog);
+        if (!emitter.emit(text, "main")) {
+            cout << "   backend: " << emitter.get_error() << endl;
+            failures++;
+            continue;
+        }
+        ofstream(c_path.c_str()) << text;
+
+        // -fwrapv: integer overflow wraps, as it does in the VM
+        string output;
+        auto start = chrono::steady_clock::now();
+        if (!capture_command("gcc -O" + opt + " -fwrapv -w -o " + shell_quote(exe_path) + " " +
+                             shell_quote(c_path) + " 2>&1", output)) {
+            cout << "   gcc failed:\n" << output;
+            failures++;
+            continue;
+        }
+        cout << "   gcc -O" << opt << ": " << chrono::duration<double>(chrono::steady_clock::now() - start).count() * 1000
+             << " ms" << endl;
+
+        if (!check_native_run(prog, exe_path, repeat, "C")) failures++;
+    }
+    cout << inputs.size() - failures << "/" << inputs.size() << " programs matched" << endl;
+    return failures ? 1 : 0;
+}
+
+#endif // TAC_C_BACKEND_H
@@ -0,0 +1,179 @@
+#ifndef TAC_CENSUS_H
+#define TAC_CENSUS_H
+
+#include <algorithm>
+#include <iomanip>
+#include "tac_vm.h"
+#include "tac_threaded.h"
+
+using namespace std;
+
+// Opcode sequence census over a corpus of programs.
+//
+// Every window of 2 to 4 instructions that the threaded executor could fuse
+// into one dispatch is counted, both statically (occurrences in the code)
+// and dynamically (how often the window ran, from a TacVM profile). A
+// window can't have a jump target past its first instruction, and only its
+// last instruction may transfer control, except that a conditional jump
+// may be followed by the goto of a two way branch. The superinstructions in
+// ThreadedTacVM were picked from this table.
+
+inline const char* tac_op_name(uint8_t op) {
+    static const char* const names[TAC_OP_COUNT] = {
+        "nop", "const", "copy", "get_global", "set_global",
+        "add", "sub", "mul", "div", "mod",
+        "lt", "gt", "le", "ge", "eq", "ne", "and", "or", "neg", "not",
+        "load_index", "store_index", "load_gindex", "store_gindex",
+        "param", "call", "ret", "ret_void", "if", "goto", "if_false"};
+    return op < TAC_OP_COUNT ? names[op] : "?";
+}
+
+inline bool tac_ends_block(uint8_t op) {
+    return tac_is_jump(op) || op == TAC_CALL || op == TAC_RET || op == TAC_RET_VOID;
+}
+
+struct TacCensusEntry {
+    long long occurrences = 0; // in the code
+    long long executions = 0;  // times the window ran
+};
+
+class TacCensus {
+public:
+    map<string, TacCensusEntry> windows;
+    long long total_instructions = 0; // executed, over every program
+    long long total_static = 0;
+    int programs = 0;
+
+    void add(const TacProgram& prog, const TacProfile& profile) {
+        programs++;
+        for (size_t f = 0; f < prog.functions.size(); f++) {
+            const TacFunction& fn = prog.functions[f];
+            const vector<long long>* counts = f < profile.counts.size() ? &profile.counts[f] : NULL;
+            vector<char> leader(fn.code.size() + 1, 0);
+            for (const TacInstr& in : fn.code) {
+                if (tac_is_jump(in.op)) leader[in.dst] = 1;
+            }
+            total_static += fn.code.size();
+            for (size_t pc = 0; pc < fn.code.size(); pc++) {
+                long long runs = counts && pc < counts->size() ? (*counts)[pc] : 0;
+                total_instructions += runs;
+                string key = tac_op_name(fn.code[pc].op);
+                for (size_t n = 1; n < 4 && pc + n < fn.code.size(); n++) {
+                    uint8_t prev = fn.code[pc + n - 1].op;
+                    uint8_t op = fn.code[pc + n].op;
+                    if (leader[pc + n]) break;
+                    bool two_way = (prev == TAC_IF || prev == TAC_IF_FALSE) && op == TAC_GOTO;
+                    if (tac_ends_block(prev) && !two_way) break;
+                    key += " ";
+                    key += tac_op_name(op);
+                    TacCensusEntry& e = windows[key];
+                    e.occurrences++;
+                    e.executions += runs;
+                    if (two_way) break;
+                }
+            }
+        }
+    }
+
+    // Windows by dispatches they'd save if fused, the top ones per length
+    void write(ostream& out, int top) const {
+        out << "Census of " << programs << " programs, " << total_static << " instructions, "
+            << total_instructions << " executed\n";
+        for (int length = 2; length <= 4; length++) {
+            vector<pair<long long, string>> ranked;
+            for (auto& w : windows) {
+                if (count(w.first.begin(), w.first.end(), ' ') + 1 != length) continue;
+                ranked.push_back(make_pair(w.second.executions * (length - 1), w.first));
+            }
+            sort(ranked.rbegin(), ranked.rend());
+            out << "\n" << length << " instruction windows (executions, share of dispatches saved if fused, occurrences)\n";
+            for (int i = 0; i < top && i < (int)ranked.size(); i++) {
+                const TacCensusEntry& e = windows.at(ranked[i].second);
+                out << "  " << setw(12) << e.executions << "  " << setw(6) << fixed << setprecision(2)
+                    << 100.0 * ranked[i].first / max(1LL, total_instructions) << "%  " << setw(6) << e.occurrences
+                    << "  " << ranked[i].second << "\n";
+                out.unsetf(ios::fixed);
+                out << setprecision(6);
+            }
+        }
+    }
+};
+
+// ./compiler --census [--top N] [-n REPEAT] file...
+// Counts fusable opcode windows over the given programs, then runs each one
+// on the threaded executor with and without superinstructions
+int run_census(int argc, char *argv[])
+{
+    int top = 10, repeat = 5;
+    vector<string> inputs;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--top" && i + 1 < argc) top = max(1, atoi(argv[++i]));
+        else if (arg == "-n" && i + 1 < argc) repeat = max(1, atoi(argv[++i]));
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) {
+        cout << "Usage: " << argv[0] << " --census [--top N] [-n REPEAT] file..." << endl;
+        return 1;
+    }
+
+    TacCensus census;
+    vector<TacProgram> programs(inputs.size());
+    vector<bool> loaded(inputs.size(), false);
+    for (size_t p = 0; p < inputs.size(); p++) {
+        string error;
+        if (!load_tac_program(inputs[p], programs[p], error)) {
+            cout << inputs[p] << ": couldn't load: " << error << endl;
+            continue;
+        }
+        loaded[p] = true;
+        TacProfile profile;
+        TacVM vm(programs[p]);
+        vm.profile = &profile;
+        TacValue result;
+        if (programs[p].find_function("main") >= 0 && !vm.run("main", result, error))
+            cout << inputs[p] << ": runtime error: " << error << " (counted up to there)" << endl;
+        census.add(programs[p], profile);
+    }
+    census.write(cout, top);
+
+    // Dispatches and time on the threaded executor, plain and fused
+    cout << "\nThreaded executor, best of " << repeat << " (plain -> superinstructions)\n";
+    long long plain_total = 0, fused_total = 0;
+    int failures = 0;
+    for (size_t p = 0; p < inputs.size(); p++) {
+        if (!loaded[p] || programs[p].find_function("main") < 0) continue;
+        TacValue results[2];
+        string errors[2];
+        bool oks[2];
+        TacRunStats best[2];
+        size_t formed = 0;
+        for (int fused = 0; fused < 2; fused++) {
+            ThreadedTacVM vm(programs[p]);
+            vm.fuse = fused;
+            best[fused].seconds = 1e100;
+            for (int r = 0; r < repeat; r++) {
+                oks[fused] = vm.run("main", results[fused], errors[fused]);
+                if (vm.stats.seconds < best[fused].seconds) best[fused] = vm.stats;
+            }
+            formed = vm.superinstructions;
+        }
+        bool same = oks[0] == oks[1] && (oks[0] ? results[0].is_float == results[1].is_float &&
+                                                      results[0].i == results[1].i
+                                                : errors[0] == errors[1]) &&
+                    best[0].instructions == best[1].instructions;
+        if (!same) failures++;
+        plain_total += best[0].dispatches;
+        fused_total += best[1].dispatches;
+        cout << "  " << inputs[p] << ": " << formed << " superinstructions, " << best[0].dispatches << " -> "
+             << best[1].dispatches << " dispatches (-"
+             << 100.0 * (best[0].dispatches - best[1].dispatches) / max(1LL, best[0].dispatches) << "%), "
+             << best[0].seconds * 1000 << " -> " << best[1].seconds * 1000 << " ms"
+             << (same ? "" : "  MISMATCH: " + (oks[1] ? tac_value_string(results[1]) : errors[1])) << "\n";
+    }
+    cout << "Total: " << plain_total << " -> " << fused_total << " dispatches (-"
+         << 100.0 * (plain_total - fused_total) / max(1LL, plain_total) << "%)" << endl;
+    return failures ? 1 : 0;
+}
+
+#endif // TAC_CENSUS_H
@@ -0,0 +1,742 @@
+#ifndef TAC_JIT_H
+#define TAC_JIT_H
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "tac_vm.h"
+#include "tac_threaded.h"
+#include "tac_native.h"
+
+using namespace std;
+
+// In-process JIT: encodes x86-64 machine code for a TacProgram straight into
+// an mmap'd buffer (written, then flipped to read+execute) and calls it. No
+// assembler is involved.
+//
+// Slot kinds come from tac_infer_slot_kinds, like the assembly backend. Every
+// slot lives in the function's frame. Jitted functions use their own calling
+// convention. The caller converts the arguments to the callee's parameter
+// kinds and stores them in an outgoing area in its frame. It passes a pointer
+// to that area in rdi. The result comes back in rax, as raw bits for floats.
+//
+// The host enters through a trampoline that saves its callee-saved registers
+// and stack pointer. Runtime errors (array bounds, division by zero, stack
+// exhaustion, step budget) jump to a stub that restores that stack pointer and
+// returns an error status, so a bad program can't take the host down. Loop
+// heads and function entries each use up one unit of the step budget.
+//
+// Programs the encoder can't handle are reported by compile(), and callers
+// fall back to the interpreter.
+
+struct TacJitContext {
+    uint64_t saved_rsp;
+    int64_t status;
+    uint64_t stack_limit;
+    int64_t budget;
+};
+
+enum TacJitStatus { JIT_OK, JIT_BOUNDS, JIT_DIV_ZERO, JIT_STACK, JIT_STEPS };
+
+class TacJit {
+private:
+    // x86 condition codes
+    enum { CC_B = 2, CC_AE = 3, CC_E = 4, CC_NE = 5, CC_BE = 6, CC_A = 7, CC_S = 8,
+           CC_P = 10, CC_NP = 11, CC_L = 12, CC_GE = 13, CC_LE = 14, CC_G = 15 };
+
+    struct Mem {
+        int base;
+        int index; // scaled by 8, -1 for none
+        int32_t disp;
+    };
+
+    struct Fixup {
+        size_t at;  // rel32 field
+        int target; // instruction index, or function index for calls
+    };
+
+    const TacProgram& prog;
+    TacJitContext ctx;
+    vector<int64_t> globals;
+    void* buffer;
+    size_t buffer_size;
+    string error;
+
+    vector<uint8_t> code;
+    vector<size_t> fn_offset;
+    vector<Fixup> call_fixups;
+    size_t err_stub[5];
+
+    // Current function
+    const TacFunction* fn;
+    vector<uint8_t> kinds;
+    int frame_bytes;
+    vector<size_t> pc_offset;
+    vector<Fixup> jump_fixups;
+
+    // ---- encoding ----
+
+    void byte(uint8_t b) { code.push_back(b); }
+    void u32(uint32_t v) { for (int k = 0; k < 4; k++) byte(v >> (8 * k)); }
+    void u64(uint64_t v) { for (int k = 0; k < 8; k++) byte(v >> (8 * k)); }
+    void patch32(size_t at, uint32_t v) { for (int k = 0; k < 4; k++) code[at + k] = v >> (8 * k); }
+
+    // prefix, REX, opcode, then a [base + index*8 + disp32] operand
+    void op(uint8_t prefix, bool w, initializer_list<uint8_t> opcode, int reg, const Mem& m) {
+        if (prefix) byte(prefix);
+        int x = m.index >= 0 ? m.index : 0;
+        uint8_t rex = 0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((x & 8) ? 2 : 0) | ((m.base & 8) ? 1 : 0);
+        if (rex != 0x40) byte(rex);
+        for (uint8_t b : opcode) byte(b);
+        if (m.index >= 0) {
+            byte(0x80 | ((reg & 7) << 3) | 4);
+            byte(0xC0 | ((m.index & 7) << 3) | (m.base & 7));
+        } else if ((m.base & 7) == RSP) {
+            byte(0x80 | ((reg & 7) << 3) | 4);
+            byte(0x24);
+        } else {
+            byte(0x80 | ((reg & 7) << 3) | (m.base & 7));
+        }
+        u32(m.disp);
+    }
+
+    // Same with a register as the r/m operand
+    void op_rr(uint8_t prefix, bool w, initializer_list<uint8_t> opcode, int reg, int rm) {
+        if (prefix) byte(prefix);
+        uint8_t rex = 0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+        if (rex != 0x40) byte(rex);
+        for (uint8_t b : opcode) byte(b);
+        byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+    }
+
+    void mov_load(int r, const Mem& m) { op(0, true, {0x8B}, r, m); }
+    void mov_store(const Mem& m, int r) { op(0, true, {0x89}, r, m); }
+    void mov_imm64(int r, uint64_t v) {
+        byte(0x48 | ((r & 8) ? 1 : 0));
+        byte(0xB8 + (r & 7));
+        u64(v);
+    }
+    void mov_ptr(int r, const void* p) { mov_imm64(r, (uint64_t)p); }
+    void movsd_load(int x, const Mem& m) { op(0xF2, false, {0x0F, 0x10}, x, m); }
+    void movsd_store(const Mem& m, int x) { op(0xF2, false, {0x0F, 0x11}, x, m); }
+    void pxor(int x, int y) { op_rr(0x66, false, {0x0F, 0xEF}, x, y); }
+    void movq_to_xmm(int x, int r) { op_rr(0x66, true, {0x0F, 0x6E}, x, r); }
+    void movq_from_xmm(int r, int x) { op_rr(0x66, true, {0x0F, 0x7E}, x, r); }
+    void setcc(int cc, int r8) { op_rr(0, false, {0x0F, (uint8_t)(0x90 + cc)}, 0, r8); }
+    void movzx_eax_al() { op_rr(0, false, {0x0F, 0xB6}, RAX, RAX); }
+    void push(int r) { if (r & 8) byte(0x41); byte(0x50 + (r & 7)); }
+    void pop(int r) { if (r & 8) byte(0x41); byte(0x58 + (r & 7)); }
+
+    size_t jcc(int cc) {
+        byte(0x0F);
+        byte(0x80 + cc);
+        u32(0);
+        return code.size() - 4;
+    }
+    size_t jmp() {
+        byte(0xE9);
+        u32(0);
+        return code.size() - 4;
+    }
+    void bind(size_t at, size_t target) { patch32(at, (uint32_t)(target - (at + 4))); }
+
+    // ---- slots ----
+
+    Mem slot(int s) const { return {RBP, -1, 8 * s - frame_bytes}; }
+    Mem out_arg(int k) const { return {RBP, -1, 8 * (fn->frame_size + k) - frame_bytes}; }
+
+    void load_int(int s, int r) {
+        if (kinds[s] == KIND_INT) mov_load(r, slot(s));
+        else op(0xF2, true, {0x0F, 0x2C}, r, slot(s)); // cvttsd2si
+    }
+    void load_float(int s, int x) {
+        if (kinds[s] == KIND_FLOAT) {
+            movsd_load(x, slot(s));
+        } else {
+            pxor(x, x);
+            op(0xF2, true, {0x0F, 0x2A}, x, slot(s)); // cvtsi2sd
+        }
+    }
+    void store_int(int r, int s) {
+        if (kinds[s] == KIND_INT) {
+            mov_store(slot(s), r);
+        } else {
+            pxor(15, 15);
+            op_rr(0xF2, true, {0x0F, 0x2A}, 15, r);
+            movsd_store(slot(s), 15);
+        }
+    }
+    void store_float(int x, int s) {
+        if (kinds[s] == KIND_FLOAT) {
+            movsd_store(slot(s), x);
+        } else {
+            op_rr(0xF2, true, {0x0F, 0x2C}, R11, x);
+            mov_store(slot(s), R11);
+        }
+    }
+
+    void copy_value(const Mem& from, uint8_t from_kind, const Mem& to, uint8_t to_kind) {
+        if (from_kind == to_kind) {
+            mov_load(R11, from);
+            mov_store(to, R11);
+        } else if (to_kind == KIND_FLOAT) {
+            pxor(15, 15);
+            op(0xF2, true, {0x0F, 0x2A}, 15, from);
+            movsd_store(to, 15);
+        } else {
+            op(0xF2, true, {0x0F, 0x2C}, R11, from);
+            mov_store(to, R11);
+        }
+    }
+
+    // byte register r8 (al or cl) = slot s is non-zero; clobbers dl, xmm15
+    void truthy(int s, int r8) {
+        if (kinds[s] == KIND_INT) {
+            op(0, true, {0x83}, 7, slot(s)); // cmp qword [slot], 0
+            byte(0);
+            setcc(CC_NE, r8);
+        } else {
+            pxor(15, 15);
+            op(0x66, false, {0x0F, 0x2E}, 15, slot(s)); // ucomisd xmm15, [slot]
+            setcc(CC_NE, r8);
+            setcc(CC_P, RDX);
+            op_rr(0, false, {0x08}, RDX, r8); // or r8, dl
+        }
+    }
+
+    void fail_if(int cc, int status) { bind(jcc(cc), err_stub[status]); }
+
+    // ---- instructions ----
+
+    void constant(const TacValue& v, int s) {
+        int64_t bits;
+        if (kinds[s] == KIND_FLOAT) {
+            double d = v.as_float();
+            memcpy(&bits, &d, sizeof bits);
+        } else {
+            bits = tac_convert(v, KIND_INT).i;
+        }
+        if (bits >= INT32_MIN && bits <= INT32_MAX) {
+            op(0, true, {0xC7}, 0, slot(s));
+            u32((uint32_t)bits);
+        } else {
+            mov_imm64(R11, bits);
+            mov_store(slot(s), R11);
+        }
+    }
+
+    void arith(const TacInstr& in) {
+        bool is_float = kinds[in.a] == KIND_FLOAT || kinds[in.b] == KIND_FLOAT;
+        if (is_float && in.op != TAC_MOD) {
+            static const uint8_t ops[] = {0x58, 0x5C, 0x59, 0x5E}; // add sub mul div
+            load_float(in.a, 0);
+            load_float(in.b, 1);
+            op_rr(0xF2, false, {0x0F, ops[in.op - TAC_ADD]}, 0, 1);
+            store_float(0, in.dst);
+            return;
+        }
+        load_int(in.a, RAX);
+        load_int(in.b, RCX);
+        switch (in.op) {
+        case TAC_ADD: op_rr(0, true, {0x01}, RCX, RAX); break;
+        case TAC_SUB: op_rr(0, true, {0x29}, RCX, RAX); break;
+        case TAC_MUL: op_rr(0, true, {0x0F, 0xAF}, RAX, RCX); break;
+        case TAC_DIV:
+        case TAC_MOD:
+        {
+            op_rr(0, true, {0x85}, RCX, RCX);
+            fail_if(CC_E, JIT_DIV_ZERO);
+            // idiv faults on LLONG_MIN / -1, so -1 negates (wrapping) or
+            // gives a remainder of 0 without dividing
+            op_rr(0, true, {0x83}, 7, RCX);   // cmp rcx, -1
+            byte(0xFF);
+            size_t divide = jcc(CC_NE);
+            if (in.op == TAC_DIV) op_rr(0, true, {0xF7}, 3, RAX); // neg rax
+            else op_rr(0, false, {0x31}, RAX, RAX);               // xor eax, eax
+            size_t done = jmp();
+            bind(divide, code.size());
+            byte(0x48);
+            byte(0x99);                       // cqo
+            op_rr(0, true, {0xF7}, 7, RCX);   // idiv rcx
+            if (in.op == TAC_MOD) op_rr(0, true, {0x89}, RDX, RAX);
+            bind(done, code.size());
+            break;
+        }
+        }
+        store_int(RAX, in.dst);
+    }
+
+    void compare(const TacInstr& in) {
+        if (kinds[in.a] == KIND_FLOAT || kinds[in.b] == KIND_FLOAT) {
+            load_float(in.a, 0);
+            load_float(in.b, 1);
+            auto ucomisd = [this](int x, int y) { op_rr(0x66, false, {0x0F, 0x2E}, x, y); };
+            switch (in.op) {
+            case TAC_GT: ucomisd(0, 1); setcc(CC_A, RAX); break;
+            case TAC_GE: ucomisd(0, 1); setcc(CC_AE, RAX); break;
+            case TAC_LT: ucomisd(1, 0); setcc(CC_A, RAX); break;
+            case TAC_LE: ucomisd(1, 0); setcc(CC_AE, RAX); break;
+            case TAC_EQ:
+                ucomisd(0, 1);
+                setcc(CC_E, RAX);
+                setcc(CC_NP, RCX);
+                op_rr(0, false, {0x20}, RCX, RAX); // and al, cl
+                break;
+            case TAC_NE:
+                ucomisd(0, 1);
+                setcc(CC_NE, RAX);
+                setcc(CC_P, RCX);
+                op_rr(0, false, {0x08}, RCX, RAX); // or al, cl
+                break;
+            }
+        } else {
+            static const int ccs[] = {CC_L, CC_G, CC_LE, CC_GE, CC_E, CC_NE};
+            load_int(in.a, RAX);
+            load_int(in.b, RCX);
+            op_rr(0, true, {0x39}, RCX, RAX); // cmp rax, rcx
+            setcc(ccs[in.op - TAC_LT], RAX);
+        }
+        movzx_eax_al();
+        store_int(RAX, in.dst);
+    }
+
+    void index(const TacInstr& in) {
+        load_int(in.b, RAX);
+        op_rr(0, true, {0x81}, 7, RAX); // cmp rax, size
+        u32(in.c);
+        fail_if(CC_AE, JIT_BOUNDS);
+    }
+
+    bool call(const TacInstr& in, int pc) {
+        const TacFunction& callee = prog.functions[in.a];
+        if ((size_t)in.b != callee.param_slots.size() || pc < in.b) {
+            error = fn->name + " calls " + callee.name + " with " + to_string(in.b) + " arguments";
+            return false;
+        }
+        for (int k = 0; k < in.b; k++) {
+            const TacInstr& p = fn->code[pc - in.b + k];
+            if (p.op != TAC_PARAM) {
+                error = "params of the call to " + callee.name + " in " + fn->name + " aren't next to it";
+                return false;
+            }
+            copy_value(slot(p.a), kinds[p.a], out_arg(k), tac_value_kind(callee.param_kinds[k]));
+        }
+        op(0, true, {0x8D}, RDI, out_arg(0)); // lea rdi, [out area]
+        byte(0xE8);
+        u32(0);
+        call_fixups.push_back({code.size() - 4, in.a});
+
+        if (tac_kind_of(callee.return_type) == KIND_FLOAT) {
+            movq_to_xmm(0, RAX);
+            store_float(0, in.dst);
+        } else {
+            store_int(RAX, in.dst);
+        }
+        return true;
+    }
+
+    void use_budget() {
+        mov_ptr(RCX, &ctx);
+        op(0, true, {0xFF}, 1, Mem{RCX, -1, (int32_t)offsetof(TacJitContext, budget)}); // dec
+        fail_if(CC_S, JIT_STEPS);
+    }
+
+    bool function(int f) {
+        fn = &prog.functions[f];
+        kinds = tac_infer_slot_kinds(prog, *fn);
+        int out_words = 1;
+        for (const TacInstr& in : fn->code) {
+            if (in.op == TAC_CALL) out_words = max(out_words, in.b);
+        }
+        if ((long long)fn->frame_size + out_words > (1 << 24)) {
+            error = fn->name + " has too large a frame";
+            return false;
+        }
+        frame_bytes = (8 * (fn->frame_size + out_words) + 15) / 16 * 16;
+
+        int ncode = fn->code.size();
+        vector<bool> loop_head(ncode + 1, false);
+        for (int pc = 0; pc < ncode; pc++) {
+            const TacInstr& in = fn->code[pc];
+            if (tac_is_jump(in.op) && in.dst <= pc) loop_head[in.dst] = true;
+        }
+
+        fn_offset[f] = code.size();
+        pc_offset.assign(ncode + 1, 0);
+        jump_fixups.clear();
+
+        push(RBP);
+        op_rr(0, true, {0x89}, RSP, RBP); // mov rbp, rsp
+        op_rr(0, true, {0x81}, 5, RSP);   // sub rsp, frame
+        u32(frame_bytes);
+        mov_ptr(RCX, &ctx);
+        op(0, true, {0x3B}, RSP, Mem{RCX, -1, (int32_t)offsetof(TacJitContext, stack_limit)}); // cmp rsp, limit
+        fail_if(CC_B, JIT_STACK);
+        use_budget();
+
+        // Zero the frame, then copy the arguments in
+        op(0, true, {0x8D}, R11, Mem{RBP, -1, -frame_bytes});
+        size_t zero_loop = code.size();
+        op(0, true, {0xC7}, 0, Mem{R11, -1, 0});
+        u32(0);
+        op_rr(0, true, {0x83}, 0, R11); // add r11, 8
+        byte(8);
+        op_rr(0, true, {0x39}, RBP, R11); // cmp r11, rbp
+        bind(jcc(CC_NE), zero_loop);
+        for (size_t k = 0; k < fn->param_slots.size(); k++) {
+            int s = fn->param_slots[k];
+            copy_value(Mem{RDI, -1, (int32_t)(8 * k)}, tac_value_kind(fn->param_kinds[k]), slot(s), kinds[s]);
+        }
+
+        uint8_t ret_kind = tac_kind_of(fn->return_type);
+        vector<size_t> returns;
+        for (int pc = 0; pc < ncode; pc++) {
+            const TacInstr& in = fn->code[pc];
+            pc_offset[pc] = code.size();
+            if (loop_head[pc]) use_budget();
+            switch (in.op) {
+            case TAC_NOP:
+            case TAC_PARAM:
+                break;
+            case TAC_CONST:
+                constant(fn->constants[in.a], in.dst);
+                break;
+            case TAC_COPY:
+                copy_value(slot(in.a), kinds[in.a], slot(in.dst), kinds[in.dst]);
+                break;
+            case TAC_GET_GLOBAL:
+                mov_ptr(RCX, globals.data());
+                copy_value(Mem{RCX, -1, 8 * in.a}, tac_value_kind(prog.global_kinds[in.a]), slot(in.dst), kinds[in.dst]);
+                break;
+            case TAC_SET_GLOBAL:
+                mov_ptr(RCX, globals.data());
+                copy_value(slot(in.a), kinds[in.a], Mem{RCX, -1, 8 * in.dst}, tac_value_kind(prog.global_kinds[in.dst]));
+                break;
+            case TAC_ADD: case TAC_SUB: case TAC_MUL: case TAC_DIV: case TAC_MOD:
+                arith(in);
+                break;
+            case TAC_LT: case TAC_GT: case TAC_LE: case TAC_GE: case TAC_EQ: case TAC_NE:
+                compare(in);
+                break;
+            case TAC_AND: case TAC_OR:
+                truthy(in.a, RAX);
+                truthy(in.b, RCX);
+                op_rr(0, false, {(uint8_t)(in.op == TAC_AND ? 0x20 : 0x08)}, RCX, RAX);
+                movzx_eax_al();
+                store_int(RAX, in.dst);
+                break;
+            case TAC_NOT:
+                truthy(in.a, RAX);
+                op_rr(0, false, {0x80}, 6, RAX); // xor al, 1
+                byte(1);
+                movzx_eax_al();
+                store_int(RAX, in.dst);
+                break;
+            case TAC_NEG:
+                mov_load(RAX, slot(in.a));
+                if (kinds[in.a] == KIND_FLOAT) {
+                    op_rr(0, true, {0x0F, 0xBA}, 7, RAX); // btc rax, 63
+                    byte(63);
+                    movq_to_xmm(0, RAX);
+                    store_float(0, in.dst);
+                } else {
+                    op_rr(0, true, {0xF7}, 3, RAX);       // neg rax
+                    store_int(RAX, in.dst);
+                }
+                break;
+            case TAC_LOAD_INDEX:
+                index(in);
+                copy_value(Mem{RBP, RAX, 8 * in.a - frame_bytes}, tac_value_kind(in.kind), slot(in.dst), kinds[in.dst]);
+                break;
+            case TAC_STORE_INDEX:
+                index(in);
+                copy_value(slot(in.dst), kinds[in.dst], Mem{RBP, RAX, 8 * in.a - frame_bytes}, tac_value_kind(in.kind));
+                break;
+            case TAC_LOAD_GINDEX:
+                index(in);
+                mov_ptr(RCX, globals.data());
+                copy_value(Mem{RCX, RAX, 8 * in.a}, tac_value_kind(in.kind), slot(in.dst), kinds[in.dst]);
+                break;
+            case TAC_STORE_GINDEX:
+                index(in);
+                mov_ptr(RCX, globals.data());
+                copy_value(slot(in.dst), kinds[in.dst], Mem{RCX, RAX, 8 * in.a}, tac_value_kind(in.kind));
+                break;
+            case TAC_CALL:
+                if (!call(in, pc)) return false;
+                break;
+            case TAC_RET:
+                if (ret_kind == KIND_FLOAT) {
+                    load_float(in.a, 0);
+                    movq_from_xmm(RAX, 0);
+                } else {
+                    load_int(in.a, RAX);
+                }
+                returns.push_back(jmp());
+                break;
+            case TAC_RET_VOID:
+                op_rr(0, false, {0x31}, RAX, RAX); // xor eax, eax
+                returns.push_back(jmp());
+                break;
+            case TAC_IF:
+            case TAC_IF_FALSE:
+                truthy(in.a, RAX);
+                op_rr(0, false, {0x84}, RAX, RAX); // test al, al
+                jump_fixups.push_back({jcc(in.op == TAC_IF ? CC_NE : CC_E), in.dst});
+                break;
+            case TAC_GOTO:
+                jump_fixups.push_back({jmp(), in.dst});
+                break;
+            default:
+                error = "unsupported opcode " + to_string(in.op) + " in " + fn->name;
+                return false;
+            }
+        }
+
+        // Falling off the end returns zero
+        pc_offset[ncode] = code.size();
+        op_rr(0, false, {0x31}, RAX, RAX);
+        for (size_t at : returns) bind(at, code.size());
+        byte(0xC9); // leave
+        byte(0xC3); // ret
+
+        for (auto& fix : jump_fixups) bind(fix.at, pc_offset[fix.target]);
+        return true;
+    }
+
+    // tramp(args, fn): enters jitted code and is where errors unwind to
+    void trampoline() {
+        static const int saved[] = {RBP, RBX, R12, R13, R14, R15};
+        for (int r : saved) push(r);
+        op_rr(0, true, {0x83}, 5, RSP); // sub rsp, 8
+        byte(8);
+        mov_ptr(RCX, &ctx.saved_rsp);
+        mov_store(Mem{RCX, -1, 0}, RSP);
+        op_rr(0, false, {0xFF}, 2, RSI); // call rsi
+        size_t exit = code.size();
+        op_rr(0, true, {0x83}, 0, RSP);  // add rsp, 8
+        byte(8);
+        for (int k = 5; k >= 0; k--) pop(saved[k]);
+        byte(0xC3);
+
+        // Error stubs: status in eax, back to the host's stack
+        size_t common = code.size();
+        mov_ptr(RCX, &ctx.saved_rsp);
+        mov_load(RSP, Mem{RCX, -1, 0});
+        mov_ptr(RCX, &ctx.status);
+        op(0, false, {0x89}, RAX, Mem{RCX, -1, 0});
+        bind(jmp(), exit);
+        for (int status = JIT_BOUNDS; status <= JIT_STEPS; status++) {
+            err_stub[status] = code.size();
+            byte(0xB8); // mov eax, status
+            u32(status);
+            bind(jmp(), common);
+        }
+    }
+
+    void release() {
+        if (buffer) munmap(buffer, buffer_size);
+        buffer = NULL;
+        buffer_size = 0;
+    }
+
+public:
+    long long max_steps;
+    double compile_seconds;
+    size_t code_bytes;
+
+    TacJit(const TacProgram& p)
+        : prog(p), globals(max(1, p.global_frame_size)), buffer(NULL), buffer_size(0),
+          fn(NULL), frame_bytes(0), max_steps(1000000000LL), compile_seconds(0), code_bytes(0) {
+        memset(&ctx, 0, sizeof ctx);
+    }
+
+    ~TacJit() { release(); }
+
+    // Compiles entry and every function it can reach. False if the program
+    // can't be jitted; get_error() says why
+    bool compile(const string& entry) {
+        auto start = chrono::steady_clock::now();
+        release();
+        code.clear();
+        call_fixups.clear();
+        fn_offset.assign(prog.functions.size(), 0);
+
+        int f = prog.find_function(entry);
+        if (f < 0) {
+            error = "no function named " + entry;
+            return false;
+        }
+        vector<bool> reached(prog.functions.size(), false);
+        vector<int> work = {f};
+        reached[f] = true;
+        while (!work.empty()) {
+            const TacFunction& cur = prog.functions[work.back()];
+            work.pop_back();
+            for (const TacInstr& in : cur.code) {
+                if (in.op == TAC_CALL && !reached[in.a]) {
+                    reached[in.a] = true;
+                    work.push_back(in.a);
+                }
+            }
+        }
+
+        trampoline();
+        for (size_t k = 0; k < prog.functions.size(); k++) {
+            if (reached[k] && !function(k)) return false;
+        }
+        for (auto& fix : call_fixups) bind(fix.at, fn_offset[fix.target]);
+
+        size_t page = sysconf(_SC_PAGESIZE);
+        buffer_size = (code.size() + page - 1) / page * page;
+        buffer = mmap(NULL, buffer_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buffer == MAP_FAILED) {
+            buffer = NULL;
+            error = "couldn't map a code buffer";
+            return false;
+        }
+        memcpy(buffer, code.data(), code.size());
+        if (mprotect(buffer, buffer_size, PROT_READ | PROT_EXEC) != 0) {
+            release();
+            error = "couldn't make the code buffer executable";
+            return false;
+        }
+        code_bytes = code.size();
+        code.clear();
+        compile_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    bool run(const string& entry, TacValue& result, string& run_error) {
+        int f = prog.find_function(entry);
+        if (!buffer || f < 0 || fn_offset[f] == 0 || !prog.functions[f].param_slots.empty()) {
+            run_error = buffer ? entry + " wasn't compiled as an entry function" : "not compiled";
+            return false;
+        }
+
+        // Stop well above the end of this thread's stack
+        static thread_local uint64_t stack_limit = 0;
+        if (!stack_limit) {
+            pthread_attr_t attr;
+            void* stack_low = NULL;
+            size_t stack_size = 0;
+            if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+                pthread_attr_getstack(&attr, &stack_low, &stack_size);
+                pthread_attr_destroy(&attr);
+            }
+            stack_limit = (uint64_t)stack_low + 256 * 1024;
+        }
+        ctx.stack_limit = stack_limit;
+        ctx.status = JIT_OK;
+        ctx.budget = max_steps;
+        fill(globals.begin(), globals.end(), 0);
+
+        typedef int64_t (*Trampoline)(const int64_t* args, const void* target);
+        Trampoline tramp = (Trampoline)buffer;
+        int64_t bits = tramp(NULL, (const char*)buffer + fn_offset[f]);
+
+        static const char* const messages[] = {"", "array index out of bounds", "division by zero",
+                                               "stack overflow", "step budget exhausted"};
+        if (ctx.status != JIT_OK) {
+            run_error = messages[ctx.status];
+            return false;
+        }
+        result = TacValue();
+        if (tac_kind_of(prog.functions[f].return_type) == KIND_FLOAT) {
+            memcpy(&result.f, &bits, sizeof bits);
+            result.is_float = true;
+        } else {
+            result.i = bits;
+        }
+        return true;
+    }
+
+    const string& get_error() const { return error; }
+};
+
+// ./compiler --jit [-n REPEAT] file...
+// Compile+run latency of the JIT against the interpreter, falling back to
+// the interpreter for programs the JIT can't take
+int run_jit_bench(int argc, char *argv[])
+{
+    int repeat = 5;
+    vector<string> inputs;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) repeat = max(1, atoi(argv[++i]));
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) {
+        cout << "Usage: " << argv[0] << " --jit [-n REPEAT] file..." << endl;
+        return 1;
+    }
+
+    int failures = 0;
+    for (const string& input : inputs) {
+        cout << "== " << input << endl;
+        TacProgram prog;
+        string error;
+        if (!load_tac_program(input, prog, error)) {
+            cout << "   couldn't load: " << error << endl;
+            failures++;
+            continue;
+        }
+
+        // Interpreter: decode + run (stack allocation excluded), best of REPEAT
+        TacValue expected;
+        string vm_error;
+        bool vm_ok = true;
+        double vm_best = 1e100;
+        long long instructions = 0;
+        for (int r = 0; r < repeat && vm_ok; r++) {
+            ThreadedTacVM vm(prog);
+            auto start = chrono::steady_clock::now();
+            vm_ok = vm.run("main", expected, vm_error);
+            vm_best = min(vm_best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            instructions = vm.stats.instructions;
+        }
+
+        // JIT: compile + run, best of REPEAT
+        TacValue got;
+        string jit_error;
+        bool jit_ok = true;
+        double jit_best = 1e100, compile_best = 1e100;
+        size_t code_bytes = 0;
+        for (int r = 0; r < repeat && jit_ok; r++) {
+            auto start = chrono::steady_clock::now();
+            TacJit jit(prog);
+            if (!jit.compile("main")) {
+                cout << "   falling back to the interpreter: " << jit.get_error() << endl;
+                jit_best = 0;
+                break;
+            }
+            jit_ok = jit.run("main", got, jit_error);
+            jit_best = min(jit_best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+            compile_best = min(compile_best, jit.compile_seconds);
+            code_bytes = jit.code_bytes;
+        }
+        if (jit_best == 0) {
+            cout << "   result: interpreter " << (vm_ok ? tac_value_string(expected) : vm_error)
+                 << " in " << vm_best * 1e6 << " us" << endl;
+            if (!vm_ok) failures++;
+            continue;
+        }
+
+        // A runtime error counts as a match if both report one
+        bool same = vm_ok == jit_ok && (!vm_ok || (got.is_float == expected.is_float &&
+                                                   (got.is_float ? got.f == expected.f : got.i == expected.i)));
+        if (!same || !vm_ok) failures++;
+        cout << "   result: jit " << (jit_ok ? tac_value_string(got) : jit_error) << ", interpreter "
+             << (vm_ok ? tac_value_string(expected) : vm_error) << (same ? "  [match]" : "  [MISMATCH]") << endl;
+        cout << "   best of " << repeat << ": jit " << jit_best * 1e6 << " us (compile " << compile_best * 1e6
+             << " us, " << code_bytes << " bytes), interpreter " << vm_best * 1e6 << " us ("
+             << instructions << " instructions), " << vm_best / jit_best << "x" << endl;
+    }
+    return failures ? 1 : 0;
+}
+
+#endif // TAC_JIT_H
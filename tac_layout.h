@@ -0,0 +1,410 @@
+#ifndef TAC_LAYOUT_H
+#define TAC_LAYOUT_H
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "tac_vm.h"
+#include "tac_profile.h"
+
+using namespace std;
+
+// Profile-guided block layout over the TAC text.
+//
+// The block order IfNode/WhileNode/ForNode emit follows the source. This pass
+// takes the edge counts of a TacProfile and rewrites each function's blocks
+// as chains. Starting at the entry, each block is followed by its hottest
+// successor that hasn't been placed yet. When a chain ends, the next one
+// starts at the hottest unplaced block. Blocks that never ran go last, in
+// their original order.
+//
+// The fix-ups at block ends are done on the text:
+//   if c goto X   X placed next           -> ifFalse c goto F (F = old fall-through)
+//                 neither X nor F next    -> followed by goto F
+//   goto X        X placed next           -> dropped
+//   falls into F  F not placed next       -> goto F (return at the end)
+// When F is a block holding just a goto, the ifFalse jumps straight to that
+// goto's target.
+//
+// Each instruction's line comes from TacFunction::lines, so the rewritten
+// text is the original lines in a new order. The loader looks declarations
+// up as it reads, so declarations move to the top of the function. A
+// function is left alone if hoisting them could change what a name refers
+// to: a name declared twice, or one that shadows a parameter or global.
+
+struct TacLayoutStats {
+    int functions = 0;  // functions reordered
+    int inverted = 0;   // ifs turned into ifFalse
+    int gotos_removed = 0;
+    int gotos_added = 0;
+    long long taken_before = 0; // taken jumps the profiled run made
+    long long taken_after = 0;  // and would make with the new layout
+    long long executed_delta = 0; // instructions added minus removed
+};
+
+class TacBlockLayout {
+private:
+    const TacProgram& prog;
+    const TacProfile& profile;
+    TacProfileReport report;
+
+    vector<string> lines;
+    vector<string> out;
+
+    static string trim(const string& s) {
+        size_t b = s.find_first_not_of(" \t\r");
+        if (b == string::npos) return "";
+        size_t e = s.find_last_not_of(" \t\r");
+        return s.substr(b, e - b + 1);
+    }
+
+    static bool is_label(const string& t) { return !t.empty() && t.back() == ':' && t.compare(0, 2, "//") != 0; }
+
+    // Declared name of "// Declaration: int a[10]"
+    static string declared_name(const string& t) {
+        stringstream ds(trim(t.substr(2)).substr(12));
+        string type, decl;
+        ds >> type >> decl;
+        return decl.substr(0, decl.find('['));
+    }
+
+    // Parameter names from "// Function: int f(int a, float b)"
+    static vector<string> param_names(const string& header) {
+        vector<string> names;
+        size_t lp = header.find('('), rp = header.rfind(')');
+        if (lp == string::npos || rp == string::npos || rp < lp) return names;
+        stringstream ps(header.substr(lp + 1, rp - lp - 1));
+        string param;
+        while (getline(ps, param, ',')) {
+            stringstream ws(param);
+            string type, name;
+            if (ws >> type >> name) names.push_back(name);
+        }
+        return names;
+    }
+
+    // Lays out function f, whose text is lines [begin, end)
+    void function(int f, int begin, int end) {
+        const TacFunction& fn = prog.functions[f];
+        int ncode = fn.code.size();
+        int first_block = report.function_blocks[f];
+        int nblocks = (f + 1 < (int)report.function_blocks.size() ? report.function_blocks[f + 1]
+                                                                   : (int)report.blocks.size()) - first_block;
+        auto copy_unchanged = [&]() {
+            for (int i = begin; i < end; i++) out.push_back(lines[i]);
+            for (int pc = 0; pc < ncode; pc++) {
+                if (fn.code[pc].op == TAC_GOTO) stats.taken_after += profile.counts[f][pc];
+                else if (tac_is_jump(fn.code[pc].op)) stats.taken_after += profile.taken[f][pc];
+            }
+        };
+        if (ncode == 0 || (int)fn.lines.size() != ncode || nblocks == 0 || profile.counts[f][0] == 0) {
+            copy_unchanged();
+            return;
+        }
+
+        // Sort the function's lines: header, hoisted declarations, blocks
+        vector<int> line_pc(end - begin, -1);
+        for (int pc = 0; pc < ncode; pc++) {
+            int i = fn.lines[pc] - 1;
+            if (i >= begin && i < end && line_pc[i - begin] < 0) line_pc[i - begin] = pc;
+        }
+        set<string> names;
+        for (const string& p : param_names(lines[begin])) names.insert(p);
+        vector<int> declarations;
+        vector<vector<int>> block_lines(nblocks);
+        vector<int> pending; // comments waiting for the next instruction
+        int header_end = begin + 1;
+        bool in_header = true;
+        for (int i = begin + 1; i < end; i++) {
+            string t = trim(lines[i]);
+            if (t.empty()) continue;
+            if (t.compare(0, 2, "//") == 0) {
+                if (trim(t.substr(2)).compare(0, 12, "Declaration:") == 0) {
+                    string name = declared_name(t);
+                    bool global = find(prog.global_names.begin(), prog.global_names.end(), name) != prog.global_names.end();
+                    if (!names.insert(name).second || global) {
+                        copy_unchanged();
+                        return;
+                    }
+                    if (!in_header) declarations.push_back(i);
+                    else header_end = i + 1;
+                } else if (in_header) {
+                    header_end = i + 1;
+                } else {
+                    pending.push_back(i);
+                }
+                continue;
+            }
+            in_header = false;
+            if (is_label(t)) continue; // labels are re-emitted per block
+            int pc = line_pc[i - begin];
+            if (pc < 0) {
+                pending.push_back(i); // no instructions of its own
+                continue;
+            }
+            int b = block_of(f, pc) - first_block;
+            for (int p : pending) block_lines[b].push_back(p);
+            pending.clear();
+            block_lines[b].push_back(i);
+        }
+
+        // Labels by position; blocks that become jump targets may need one
+        vector<vector<string>> labels_at(ncode + 1);
+        for (auto& l : fn.labels) labels_at[l.second].push_back(l.first);
+        int fresh = 0;
+        auto label_for = [&](int pc) {
+            if (labels_at[pc].empty()) {
+                string name;
+                do name = "LB" + to_string(fresh++); while (fn.labels.count(name));
+                labels_at[pc].push_back(name);
+            }
+            return labels_at[pc][0];
+        };
+
+        vector<int> order = chains(first_block, nblocks);
+        bool changed = false;
+        for (int k = 0; k < nblocks; k++) changed |= order[k] != k;
+        if (!changed) {
+            copy_unchanged();
+            return;
+        }
+
+        // Plan the block ends first so every label needed is known
+        const int END = -1;
+        struct Tail {
+            int rewrite_line = -1; // line of an if to turn around
+            string rewrite;
+            bool drop_goto = false;
+            int goto_pc = -2;      // pc to jump to after the block, -2 for none
+            bool return_after = false;
+        };
+        vector<Tail> tails(nblocks);
+        vector<long long> bypassed(nblocks, 0); // runs of a lone goto an ifFalse now skips
+        auto pc_block = [&](int pc) { return pc >= ncode ? END : block_of(f, pc) - first_block; };
+        auto lone_goto = [&](int pc) {
+            if (pc >= ncode || fn.code[pc].op != TAC_GOTO) return false;
+            const TacBlock& blk = report.blocks[first_block + pc_block(pc)];
+            return blk.first == pc && blk.last == pc;
+        };
+        for (int k = 0; k < nblocks; k++) {
+            int b = order[k];
+            int next = k + 1 < nblocks ? order[k + 1] : END;
+            const TacBlock& blk = report.blocks[first_block + b];
+            const TacInstr& in = fn.code[blk.last];
+            int fall = pc_block(blk.last + 1);
+            Tail& t = tails[b];
+            if (in.op == TAC_IF || in.op == TAC_IF_FALSE) {
+                int target = pc_block(in.dst);
+                if (fall == next) {
+                    // already falls through
+                } else if (target == next && target != END) {
+                    // Jump where it used to fall through
+                    int to_pc = blk.last + 1;
+                    if (lone_goto(to_pc)) {
+                        bypassed[pc_block(to_pc)] += profile.counts[f][blk.last] - profile.taken[f][blk.last];
+                        to_pc = fn.code[to_pc].dst;
+                    }
+                    string line = trim(lines[fn.lines[blk.last] - 1]);
+                    size_t skip = in.op == TAC_IF ? 3 : 8, g = line.find(" goto ");
+                    t.rewrite_line = fn.lines[blk.last] - 1;
+                    t.rewrite = string(in.op == TAC_IF ? "ifFalse " : "if ") + trim(line.substr(skip, g - skip)) +
+                                " goto " + label_for(to_pc);
+                    stats.inverted++;
+                } else {
+                    t.goto_pc = blk.last + 1;
+                    stats.gotos_added++;
+                }
+            } else if (in.op == TAC_GOTO) {
+                if (pc_block(in.dst) == next && next != END) {
+                    t.drop_goto = true;
+                    stats.gotos_removed++;
+                }
+            } else if (in.op != TAC_RET && in.op != TAC_RET_VOID && fall != next) {
+                if (fall == END) {
+                    t.return_after = true;
+                } else {
+                    t.goto_pc = blk.last + 1;
+                    stats.gotos_added++;
+                }
+            }
+            if (t.goto_pc >= 0) label_for(t.goto_pc);
+        }
+
+        // What the profiled run would have done with this layout
+        for (int b = 0; b < nblocks; b++) {
+            const TacBlock& blk = report.blocks[first_block + b];
+            const TacInstr& in = fn.code[blk.last];
+            const Tail& t = tails[b];
+            long long n = profile.counts[f][blk.last];
+            long long taken = profile.taken[f][blk.last];
+            if (in.op == TAC_IF || in.op == TAC_IF_FALSE) {
+                if (t.rewrite_line >= 0) {
+                    stats.taken_after += n - taken;
+                } else if (t.goto_pc >= 0) {
+                    stats.taken_after += n;
+                    stats.executed_delta += n - taken;
+                } else {
+                    stats.taken_after += taken;
+                }
+            } else if (in.op == TAC_GOTO) {
+                if (t.drop_goto) {
+                    stats.executed_delta -= n;
+                } else {
+                    stats.taken_after += n - bypassed[b];
+                    stats.executed_delta -= bypassed[b];
+                }
+            } else {
+                if (t.goto_pc >= 0) stats.taken_after += n;
+                if (t.goto_pc >= 0 || t.return_after) stats.executed_delta += n;
+            }
+        }
+
+        // Emit
+        for (int i = begin; i < header_end; i++) out.push_back(lines[i]);
+        for (int i : declarations) out.push_back(lines[i]);
+        for (int k = 0; k < nblocks; k++) {
+            int b = order[k];
+            const TacBlock& blk = report.blocks[first_block + b];
+            for (const string& l : labels_at[blk.first]) out.push_back(l + ":");
+            const Tail& t = tails[b];
+            int goto_line = fn.code[blk.last].op == TAC_GOTO ? fn.lines[blk.last] - 1 : -1;
+            for (int i : block_lines[b]) {
+                if (i == t.rewrite_line) out.push_back(t.rewrite);
+                else if (!(t.drop_goto && i == goto_line)) out.push_back(lines[i]);
+            }
+            if (t.goto_pc >= 0) out.push_back("goto " + labels_at[t.goto_pc][0]);
+            if (t.return_after) out.push_back("return");
+        }
+        for (const string& l : labels_at[ncode]) out.push_back(l + ":");
+        for (int i : pending) out.push_back(lines[i]);
+        stats.functions++;
+    }
+
+    int block_of(int f, int pc) const {
+        int lo = report.function_blocks[f];
+        int hi = f + 1 < (int)report.function_blocks.size() ? report.function_blocks[f + 1] : report.blocks.size();
+        while (hi - lo > 1) {
+            int mid = (lo + hi) / 2;
+            if (report.blocks[mid].first <= pc) lo = mid;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // Block order for the function whose blocks start at first_block: hot
+    // chains from the entry, cold blocks last
+    vector<int> chains(int first_block, int nblocks) const {
+        vector<vector<const TacEdge*>> succ(nblocks);
+        for (const TacEdge& e : report.edges) {
+            if (e.from >= first_block && e.from < first_block + nblocks && e.to >= 0) succ[e.from - first_block].push_back(&e);
+        }
+        vector<bool> placed(nblocks, false);
+        vector<int> order;
+        int cur = 0;
+        while (cur >= 0) {
+            placed[cur] = true;
+            order.push_back(cur);
+            const TacEdge* best = NULL;
+            for (const TacEdge* e : succ[cur]) {
+                if (!placed[e->to - first_block] && e->count > 0 && (!best || e->count > best->count)) best = e;
+            }
+            if (best) {
+                cur = best->to - first_block;
+                continue;
+            }
+            cur = -1;
+            for (int b = 0; b < nblocks; b++) {
+                long long count = report.blocks[first_block + b].count;
+                if (!placed[b] && count > 0 && (cur < 0 || count > report.blocks[first_block + cur].count)) cur = b;
+            }
+        }
+        for (int b = 0; b < nblocks; b++) {
+            if (!placed[b]) order.push_back(b);
+        }
+        return order;
+    }
+
+public:
+    TacLayoutStats stats;
+
+    TacBlockLayout(const TacProgram& p, const TacProfile& prof) : prog(p), profile(prof), report(p, prof) {}
+
+    // text is the TAC prog was loaded from
+    string apply(const string& text) {
+        lines.clear();
+        out.clear();
+        stats = TacLayoutStats();
+        stats.taken_before = report.taken_jumps();
+
+        stringstream in(text);
+        string line;
+        while (getline(in, line)) lines.push_back(line);
+
+        // A function runs from its "// Function:" line to the blank line after it
+        int f = 0;
+        for (int i = 0; i < (int)lines.size();) {
+            string t = trim(lines[i]);
+            if (t.compare(0, 2, "//") == 0 && trim(t.substr(2)).compare(0, 9, "Function:") == 0 &&
+                f < (int)prog.functions.size()) {
+                int end = i + 1;
+                while (end < (int)lines.size() && !trim(lines[end]).empty() &&
+                       trim(lines[end]).find("// Function:") != 0) {
+                    end++;
+                }
+                function(f++, i, end);
+                i = end;
+            } else {
+                out.push_back(lines[i++]);
+            }
+        }
+
+        string result;
+        for (const string& l : out) result += l + "\n";
+        return result;
+    }
+};
+
+// Rewrites the TAC file at code_path in place with the layout profile_path
+// calls for. summary describes what changed
+bool layout_tac_file(const string& code_path, const string& profile_path, string& summary, string& error) {
+    ifstream in(code_path.c_str(), ios::binary);
+    if (!in) {
+        error = "couldn't open " + code_path;
+        return false;
+    }
+    stringstream ss;
+    ss << in.rdbuf();
+    string text = ss.str();
+    in.close();
+
+    TacProgram prog;
+    stringstream code(text);
+    TacLoader loader(prog);
+    if (!loader.load(code)) {
+        error = loader.get_error();
+        return false;
+    }
+    TacProfile profile;
+    if (!load_tac_profile(prog, profile_path, profile, error)) return false;
+
+    TacBlockLayout layout(prog, profile);
+    string laid_out = layout.apply(text);
+    ofstream out(code_path.c_str(), ios::binary);
+    if (!out || !(out << laid_out)) {
+        error = "couldn't write " + code_path;
+        return false;
+    }
+
+    const TacLayoutStats& st = layout.stats;
+    stringstream s;
+    s << st.functions << " functions reordered, " << st.inverted << " branches inverted, " << st.gotos_removed
+      << " gotos removed, " << st.gotos_added << " added; taken jumps " << st.taken_before << " -> "
+      << st.taken_after << ", instructions executed " << (st.executed_delta >= 0 ? "+" : "") << st.executed_delta;
+    summary = s.str();
+    return true;
+}
+
+#endif // TAC_LAYOUT_H
@@ -0,0 +1,763 @@
+#ifndef TAC_NATIVE_H
+#define TAC_NATIVE_H
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "tac_vm.h"
+#include "tac_threaded.h"
+#include "tac_regalloc.h"
+#include "batch_driver.h"
+
+using namespace std;
+
+// Native backend: lowers a TacProgram to x86-64 System V assembly for the GNU
+// assembler (AT&T syntax).
+//
+// The executors are dynamically typed, but native code needs a static type
+// for every slot, so tac_infer_slot_kinds works one out: a slot is float if
+// it is declared float or if any instruction can leave a float in it, and int
+// otherwise. Scalar slots get registers from TacRegisterAllocator, and the
+// rest, array cells included, live in the function's stack frame. Globals
+// live in one tac_globals block laid out like the VM's global frame.
+// Functions are emitted as tac_<name> so they can't clash with libc, and a
+// small main() runs tac_main, times it and prints "<result> <ns>".
+//
+// Runtime errors the VM reports (array bounds) trap with ud2 instead.
+
+// Kind a value of this declared kind has at run time
+inline uint8_t tac_value_kind(uint8_t kind) {
+    return kind == KIND_FLOAT ? KIND_FLOAT : KIND_INT;
+}
+
+// KIND_INT or KIND_FLOAT for every frame entry of fn, array cells included
+vector<uint8_t> tac_infer_slot_kinds(const TacProgram& prog, const TacFunction& fn) {
+    vector<uint8_t> kinds(fn.frame_size, KIND_INT);
+    for (size_t s = 0; s < fn.slot_kinds.size(); s++) kinds[s] = tac_value_kind(fn.slot_kinds[s]);
+    for (auto& arr : fn.arrays) {
+        for (int k = 0; k < arr.size; k++) kinds[arr.base + k] = tac_value_kind(arr.kind);
+    }
+
+    // Only ever widens int -> float, so this settles
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const TacInstr& in : fn.code) {
+            uint8_t k;
+            switch (in.op) {
+            case TAC_CONST: k = fn.constants[in.a].is_float ? KIND_FLOAT : KIND_INT; break;
+            case TAC_COPY: k = in.kind == KIND_ANY ? kinds[in.a] : in.kind; break;
+            case TAC_GET_GLOBAL:
+                k = (size_t)in.a < prog.global_kinds.size() ? tac_value_kind(prog.global_kinds[in.a]) : (uint8_t)KIND_INT;
+                break;
+            case TAC_ADD: case TAC_SUB: case TAC_MUL: case TAC_DIV:
+                k = (kinds[in.a] == KIND_FLOAT || kinds[in.b] == KIND_FLOAT) ? KIND_FLOAT : KIND_INT;
+                break;
+            case TAC_NEG: k = kinds[in.a]; break;
+            case TAC_LOAD_INDEX: case TAC_LOAD_GINDEX: k = tac_value_kind(in.kind); break;
+            case TAC_CALL: k = tac_value_kind(tac_kind_of(prog.functions[in.a].return_type)); break;
+            case TAC_MOD: case TAC_LT: case TAC_GT: case TAC_LE: case TAC_GE: case TAC_EQ: case TAC_NE:
+            case TAC_AND: case TAC_OR: case TAC_NOT:
+                k = KIND_INT;
+                break;
+            default:
+                continue; // doesn't write a slot
+            }
+            if (k == KIND_FLOAT && kinds[in.dst] != KIND_FLOAT) {
+                kinds[in.dst] = KIND_FLOAT;
+                changed = true;
+            }
+        }
+    }
+    return kinds;
+}
+
+class TacAsmEmitter {
+private:
+    const TacProgram& prog;
+    ostringstream out;
+    string error;
+
+    const TacFunction* fn;
+    int fn_index;
+    vector<uint8_t> kinds;
+    TacAllocation alloc;
+    int frame_bytes;
+    int div_labels = 0; // numbers the labels around each integer divide
+
+    static const char* const INT_ARGS[6];
+
+    void ins(const string& text) { out << "\t" << text << "\n"; }
+
+    string label(int pc) const { return ".L" + to_string(fn_index) + "_" + to_string(pc); }
+    string ret_label() const { return ".L" + to_string(fn_index) + "_ret"; }
+
+    static string reg_name(int reg, bool is_float) {
+        static const char* const names[16] = {"%rax", "%rcx", "%rdx", "%rbx", "%rsp", "%rbp", "%rsi", "%rdi",
+                                              "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15"};
+        return is_float ? "%xmm" + to_string(reg) : names[reg];
+    }
+    static bool is_reg(const string& operand) { return operand[0] == '%'; }
+    static bool is_xmm(const string& operand) { return operand.compare(0, 4, "%xmm") == 0; }
+
+    // Operand for a slot: its register, or its place in the frame
+    string slot(int s) const {
+        if (alloc.in_register(s)) return reg_name(alloc.reg[s], alloc.is_float[s]);
+        return to_string(8 * s - frame_bytes) + "(%rbp)";
+    }
+    string global(int g) const { return "tac_globals+" + to_string(8 * g) + "(%rip)"; }
+
+    // Reads slot s as an int / a float into a register
+    void load_int(int s, const string& reg) {
+        if (kinds[s] == KIND_INT) ins("movq " + slot(s) + ", " + reg);
+        else ins("cvttsd2siq " + slot(s) + ", " + reg);
+    }
+    void load_float(int s, const string& xmm) {
+        if (kinds[s] == KIND_FLOAT) {
+            ins(string(is_xmm(slot(s)) ? "movapd " : "movsd ") + slot(s) + ", " + xmm);
+        } else {
+            ins("pxor " + xmm + ", " + xmm);
+            ins("cvtsi2sdq " + slot(s) + ", " + xmm);
+        }
+    }
+
+    // Writes an int / a float to slot s, converting to the slot's kind
+    void store_int(const string& reg, int s) {
+        if (kinds[s] == KIND_INT) {
+            ins("movq " + reg + ", " + slot(s));
+        } else {
+            ins("pxor %xmm15, %xmm15");
+            ins("cvtsi2sdq " + reg + ", %xmm15");
+            ins("movsd %xmm15, " + slot(s));
+        }
+    }
+    void store_float(const string& xmm, int s) {
+        if (kinds[s] == KIND_FLOAT) {
+            ins(string(is_xmm(slot(s)) ? "movapd " : "movsd ") + xmm + ", " + slot(s));
+        } else {
+            ins("cvttsd2siq " + xmm + ", %r11");
+            ins("movq %r11, " + slot(s));
+        }
+    }
+
+    // Moves a value between two operands, converting between kinds
+    void copy_value(const string& from, uint8_t from_kind, const string& to, uint8_t to_kind) {
+        if (from == to && from_kind == to_kind) return;
+        if (from_kind == to_kind && is_xmm(from) && is_xmm(to)) {
+            ins("movapd " + from + ", " + to);
+        } else if (from_kind == to_kind && (is_reg(from) || is_reg(to))) {
+            ins("movq " + from + ", " + to);
+        } else if (from_kind == to_kind) {
+            ins("movq " + from + ", %r11");
+            ins("movq %r11, " + to);
+        } else if (to_kind == KIND_FLOAT) {
+            ins("pxor %xmm15, %xmm15");
+            ins("cvtsi2sdq " + from + ", %xmm15");
+            ins("movsd %xmm15, " + to);
+        } else {
+            ins("cvttsd2siq " + from + ", %r11");
+            ins("movq %r11, " + to);
+        }
+    }
+
+    // Sets the byte register to 1 if slot s is non-zero (clobbers %dl, %xmm15)
+    void truthy(int s, const string& byte_reg) {
+        if (kinds[s] == KIND_INT) {
+            if (is_reg(slot(s))) ins("testq " + slot(s) + ", " + slot(s));
+            else ins("cmpq $0, " + slot(s));
+            ins("setne " + byte_reg);
+        } else {
+            ins("pxor %xmm15, %xmm15");
+            ins("ucomisd " + slot(s) + ", %xmm15");
+            ins("setne " + byte_reg);
+            ins("setp %dl");
+            ins("orb %dl, " + byte_reg);
+        }
+    }
+
+    void constant(const TacValue& v, int s) {
+        long long bits;
+        if (kinds[s] == KIND_FLOAT) {
+            double d = v.as_float();
+            memcpy(&bits, &d, sizeof bits);
+        } else {
+            bits = tac_convert(v, KIND_INT).i;
+        }
+        if (bits >= INT32_MIN && bits <= INT32_MAX && !is_xmm(slot(s))) {
+            ins("movq $" + to_string(bits) + ", " + slot(s));
+        } else {
+            ins("movabsq $" + to_string(bits) + ", %r11");
+            ins("movq %r11, " + slot(s));
+        }
+    }
+
+    void arith(const TacInstr& in) {
+        bool is_float = kinds[in.a] == KIND_FLOAT || kinds[in.b] == KIND_FLOAT;
+        if (is_float && in.op != TAC_MOD) {
+            static const char* const ops[] = {"addsd", "subsd", "mulsd", "divsd"};
+            load_float(in.a, "%xmm0");
+            load_float(in.b, "%xmm1");
+            ins(string(ops[in.op - TAC_ADD]) + " %xmm1, %xmm0");
+            store_float("%xmm0", in.dst);
+            return;
+        }
+        load_int(in.a, "%rax");
+        string b = "%rcx";
+        if (kinds[in.b] == KIND_INT) b = slot(in.b);
+        else load_int(in.b, b);
+        switch (in.op) {
+        case TAC_ADD: ins("addq " + b + ", %rax"); break;
+        case TAC_SUB: ins("subq " + b + ", %rax"); break;
+        case TAC_MUL: ins("imulq " + b + ", %rax"); break;
+        case TAC_DIV:
+        case TAC_MOD: {
+            // idivq faults on LLONG_MIN / -1, so -1 negates (wrapping) or
+            // gives a remainder of 0 without dividing
+            string divide = ".Ldiv" + to_string(div_labels), done = ".Ldiv" + to_string(div_labels) + "_done";
+            div_labels++;
+            ins("cmpq $-1, " + b);
+            ins("jne " + divide);
+            ins(in.op == TAC_DIV ? "negq %rax" : "xorl %eax, %eax");
+            ins("jmp " + done);
+            out << divide << ":\n";
+            ins("cqto");
+            ins("idivq " + b);
+            if (in.op == TAC_MOD) ins("movq %rdx, %rax");
+            out << done << ":\n";
+            break;
+        }
+        }
+        store_int("%rax", in.dst);
+    }
+
+    void compare(const TacInstr& in) {
+        if (kinds[in.a] == KIND_FLOAT || kinds[in.b] == KIND_FLOAT) {
+            load_float(in.a, "%xmm0");
+            load_float(in.b, "%xmm1");
+            // Unordered (NaN) compares false, except !=
+            switch (in.op) {
+            case TAC_GT: ins("ucomisd %xmm1, %xmm0"); ins("seta %al"); break;
+            case TAC_GE: ins("ucomisd %xmm1, %xmm0"); ins("setae %al"); break;
+            case TAC_LT: ins("ucomisd %xmm0, %xmm1"); ins("seta %al"); break;
+            case TAC_LE: ins("ucomisd %xmm0, %xmm1"); ins("setae %al"); break;
+            case TAC_EQ: ins("ucomisd %xmm1, %xmm0"); ins("sete %al"); ins("setnp %cl"); ins("andb %cl, %al"); break;
+            case TAC_NE: ins("ucomisd %xmm1, %xmm0"); ins("setne %al"); ins("setp %cl"); ins("orb %cl, %al"); break;
+            }
+        } else {
+            static const char* const sets[] = {"setl", "setg", "setle", "setge", "sete", "setne"};
+            load_int(in.a, "%rax");
+            string b = "%rcx";
+            if (kinds[in.b] == KIND_INT) b = slot(in.b);
+            else load_int(in.b, b);
+            ins("cmpq " + b + ", %rax");
+            ins(string(sets[in.op - TAC_LT]) + " %al");
+        }
+        ins("movzbl %al, %eax");
+        store_int("%rax", in.dst);
+    }
+
+    // Index in %rax, checked against the array size
+    void index(const TacInstr& in) {
+        load_int(in.b, "%rax");
+        ins("cmpq $" + to_string(in.c) + ", %rax");
+        ins("jae .Ltac_trap");
+    }
+
+    string local_cell(int base) const { return to_string(8 * base - frame_bytes) + "(%rbp,%rax,8)"; }
+    string global_cell(int base) const { return to_string(8 * base) + "(%rcx,%rax,8)"; }
+
+    bool call(const TacInstr& in, int pc) {
+        const TacFunction& callee = prog.functions[in.a];
+        int argc = in.b;
+        if ((size_t)argc != callee.param_slots.size()) {
+            error = fn->name + " calls " + callee.name + " with " + to_string(argc) + " arguments";
+            return false;
+        }
+        // The generated code puts the params right before their call
+        if (pc < argc) {
+            error = "call to " + callee.name + " in " + fn->name + " without its params";
+            return false;
+        }
+        vector<int> args;
+        for (int k = 0; k < argc; k++) {
+            const TacInstr& p = fn->code[pc - argc + k];
+            if (p.op != TAC_PARAM) {
+                error = "params of the call to " + callee.name + " in " + fn->name + " aren't next to it";
+                return false;
+            }
+            args.push_back(p.a);
+        }
+
+        // System V: ints in six registers, floats in eight, the rest on the stack
+        vector<int> in_int, in_float, on_stack;
+        for (int k = 0; k < argc; k++) {
+            bool is_float = callee.param_kinds[k] == KIND_FLOAT;
+            if (is_float && in_float.size() < 8) in_float.push_back(k);
+            else if (!is_float && in_int.size() < 6) in_int.push_back(k);
+            else on_stack.push_back(k);
+        }
+        int pad = on_stack.size() % 2;
+        if (pad) ins("subq $8, %rsp");
+        for (size_t k = on_stack.size(); k-- > 0;) {
+            int arg = on_stack[k];
+            if (callee.param_kinds[arg] == KIND_FLOAT) {
+                load_float(args[arg], "%xmm15");
+                ins("movq %xmm15, %r11");
+            } else {
+                load_int(args[arg], "%r11");
+            }
+            ins("pushq %r11");
+        }
+        for (size_t k = 0; k < in_int.size(); k++) load_int(args[in_int[k]], INT_ARGS[k]);
+        for (size_t k = 0; k < in_float.size(); k++) load_float(args[in_float[k]], "%xmm" + to_string(k));
+
+        ins("call tac_" + callee.name);
+        if (!on_stack.empty()) ins("addq $" + to_string(8 * (on_stack.size() + pad)) + ", %rsp");
+
+        if (tac_kind_of(callee.return_type) == KIND_FLOAT) store_float("%xmm0", in.dst);
+        else store_int("%rax", in.dst);
+        return true;
+    }
+
+    bool function(int f) {
+        fn = &prog.functions[f];
+        fn_index = f;
+        kinds = tac_infer_slot_kinds(prog, *fn);
+        if (use_registers) {
+            alloc = TacRegisterAllocator(*fn, kinds).allocate();
+        } else {
+            alloc = TacAllocation();
+            alloc.reg.assign(fn->frame_size, -1);
+        }
+        stats.push_back(make_pair(fn->name, alloc.stats));
+        // Callee-saved registers are kept at the top of the frame
+        int saved_bytes = 8 * alloc.saved.size();
+        frame_bytes = (8 * fn->frame_size + saved_bytes + 15) / 16 * 16;
+
+        vector<bool> is_target(fn->code.size() + 1, false);
+        for (const TacInstr& in : fn->code) {
+            if (tac_is_jump(in.op)) is_target[in.dst] = true;
+        }
+
+        string name = "tac_" + fn->name;
+        out << "\n\t.globl " << name << "\n\t.type " << name << ", @function\n" << name << ":\n";
+        ins("pushq %rbp");
+        ins("movq %rsp, %rbp");
+        if (frame_bytes > 0) {
+            ins("subq $" + to_string(frame_bytes) + ", %rsp");
+            // Frames start zeroed, like the VM's
+            ins("leaq -" + to_string(frame_bytes) + "(%rbp), %r11");
+            out << "1:\n";
+            ins("movq $0, (%r11)");
+            ins("addq $8, %r11");
+            ins("cmpq %rbp, %r11");
+            ins("jne 1b");
+        }
+        for (size_t k = 0; k < alloc.saved.size(); k++) {
+            ins("movq " + reg_name(alloc.saved[k], false) + ", " + to_string(-8 * (int)(k + 1)) + "(%rbp)");
+        }
+
+        // Parameters into their slots
+        int ints = 0, floats = 0, stacked = 0;
+        for (size_t k = 0; k < fn->param_slots.size(); k++) {
+            int s = fn->param_slots[k];
+            if (fn->param_kinds[k] == KIND_FLOAT && floats < 8) {
+                store_float("%xmm" + to_string(floats++), s);
+            } else if (fn->param_kinds[k] != KIND_FLOAT && ints < 6) {
+                store_int(INT_ARGS[ints++], s);
+            } else {
+                string from = to_string(16 + 8 * stacked++) + "(%rbp)";
+                copy_value(from, tac_value_kind(fn->param_kinds[k]), slot(s), kinds[s]);
+            }
+        }
+
+        // Registers standing in for zeroed frame slots, once the incoming
+        // arguments are out of the way
+        for (int s : alloc.zeroed) {
+            if (!alloc.in_register(s)) continue;
+            if (alloc.is_float[s]) ins("pxor " + slot(s) + ", " + slot(s));
+            else ins("xorq " + slot(s) + ", " + slot(s));
+        }
+
+        uint8_t ret_kind = tac_kind_of(fn->return_type);
+        for (size_t pc = 0; pc < fn->code.size(); pc++) {
+            const TacInstr& in = fn->code[pc];
+            if (is_target[pc]) out << label(pc) << ":\n";
+            switch (in.op) {
+            case TAC_NOP:
+            case TAC_PARAM: // loaded by the call
+                break;
+            case TAC_CONST:
+                constant(fn->constants[in.a], in.dst);
+                break;
+            case TAC_COPY:
+                copy_value(slot(in.a), kinds[in.a], slot(in.dst), kinds[in.dst]);
+                break;
+            case TAC_GET_GLOBAL:
+                copy_value(global(in.a), tac_value_kind(prog.global_kinds[in.a]), slot(in.dst), kinds[in.dst]);
+                break;
+            case TAC_SET_GLOBAL:
+                copy_value(slot(in.a), kinds[in.a], global(in.dst), tac_value_kind(prog.global_kinds[in.dst]));
+                break;
+            case TAC_ADD: case TAC_SUB: case TAC_MUL: case TAC_DIV: case TAC_MOD:
+                arith(in);
+                break;
+            case TAC_LT: case TAC_GT: case TAC_LE: case TAC_GE: case TAC_EQ: case TAC_NE:
+                compare(in);
+                break;
+            case TAC_AND: case TAC_OR:
+                truthy(in.a, "%al");
+                truthy(in.b, "%cl");
+                ins(string(in.op == TAC_AND ? "andb" : "orb") + " %cl, %al");
+                ins("movzbl %al, %eax");
+                store_int("%rax", in.dst);
+                break;
+            case TAC_NOT:
+                truthy(in.a, "%al");
+                ins("xorb $1, %al");
+                ins("movzbl %al, %eax");
+                store_int("%rax", in.dst);
+                break;
+            case TAC_NEG:
+                if (kinds[in.a] == KIND_FLOAT) {
+                    ins("movq " + slot(in.a) + ", %rax");
+                    ins("btcq $63, %rax");
+                    ins("movq %rax, %xmm0");
+                    store_float("%xmm0", in.dst);
+                } else {
+                    ins("movq " + slot(in.a) + ", %rax");
+                    ins("negq %rax");
+                    store_int("%rax", in.dst);
+                }
+                break;
+            case TAC_LOAD_INDEX:
+                index(in);
+                copy_value(local_cell(in.a), tac_value_kind(in.kind), slot(in.dst), kinds[in.dst]);
+                break;
+            case TAC_STORE_INDEX:
+                index(in);
+                copy_value(slot(in.dst), kinds[in.dst], local_cell(in.a), tac_value_kind(in.kind));
+                break;
+            case TAC_LOAD_GINDEX:
+                index(in);
+                ins("leaq tac_globals(%rip), %rcx");
+                copy_value(global_cell(in.a), tac_value_kind(in.kind), slot(in.dst), kinds[in.dst]);
+                break;
+            case TAC_STORE_GINDEX:
+                index(in);
+                ins("leaq tac_globals(%rip), %rcx");
+                copy_value(slot(in.dst), kinds[in.dst], global_cell(in.a), tac_value_kind(in.kind));
+                break;
+            case TAC_CALL:
+                if (!call(in, pc)) return false;
+                break;
+            case TAC_RET:
+                if (ret_kind == KIND_FLOAT) load_float(in.a, "%xmm0");
+                else load_int(in.a, "%rax");
+                ins("jmp " + ret_label());
+                break;
+            case TAC_RET_VOID:
+                ins("xorl %eax, %eax");
+                ins("pxor %xmm0, %xmm0");
+                ins("jmp " + ret_label());
+                break;
+            case TAC_IF:
+                if (kinds[in.a] == KIND_INT) {
+                    if (is_reg(slot(in.a))) ins("testq " + slot(in.a) + ", " + slot(in.a));
+                    else ins("cmpq $0, " + slot(in.a));
+                    ins("jne " + label(in.dst));
+                } else {
+                    ins("pxor %xmm15, %xmm15");
+                    ins("ucomisd " + slot(in.a) + ", %xmm15");
+                    ins("jne " + label(in.dst));
+                    ins("jp " + label(in.dst));
+                }
+                break;
+            case TAC_IF_FALSE:
+                if (kinds[in.a] == KIND_INT) {
+                    if (is_reg(slot(in.a))) ins("testq " + slot(in.a) + ", " + slot(in.a));
+                    else ins("cmpq $0, " + slot(in.a));
+                    ins("je " + label(in.dst));
+                } else {
+                    // Zero and not NaN
+                    ins("pxor %xmm15, %xmm15");
+                    ins("ucomisd " + slot(in.a) + ", %xmm15");
+                    ins("jp 1f");
+                    ins("je " + label(in.dst));
+                    out << "1:\n";
+                }
+                break;
+            case TAC_GOTO:
+                ins("jmp " + label(in.dst));
+                break;
+            default:
+                error = "unsupported opcode " + to_string(in.op) + " in " + fn->name;
+                return false;
+            }
+        }
+
+        // Falling off the end returns zero
+        if (is_target[fn->code.size()]) out << label(fn->code.size()) << ":\n";
+        ins("xorl %eax, %eax");
+        ins("pxor %xmm0, %xmm0");
+        out << ret_label() << ":\n";
+        for (size_t k = 0; k < alloc.saved.size(); k++) {
+            ins("movq " + to_string(-8 * (int)(k + 1)) + "(%rbp), " + reg_name(alloc.saved[k], false));
+        }
+        ins("leave");
+        ins("ret");
+        out << "\t.size " << name << ", .-" << name << "\n";
+        return true;
+    }
+
+    // main(): runs tac_main argv[1] times on fresh globals and prints the
+    // result and the fastest run in nanoseconds
+    void entry_stub(const TacFunction& entry) {
+        bool float_result = tac_kind_of(entry.return_type) == KIND_FLOAT;
+        int global_words = max(1, prog.global_frame_size);
+        out << "\n\t.section .rodata\n";
+        out << ".Lfmt:\n\t.string \"" << (float_result ? "%.17g" : "%lld") << " %lld\\n\"\n";
+        out << "\t.text\n\t.globl main\n\t.type main, @function\nmain:\n";
+        ins("pushq %rbp");
+        ins("movq %rsp, %rbp");
+        ins("pushq %rbx");            // runs left
+        ins("pushq %r12");            // best time
+        ins("pushq %r13");            // result
+        ins("subq $40, %rsp");        // two timespecs
+        ins("movl $1, %ebx");
+        ins("cmpl $2, %edi");
+        ins("jl 1f");
+        ins("movq 8(%rsi), %rdi");
+        ins("call atoi@PLT");
+        ins("movl %eax, %ebx");
+        ins("cmpl $1, %ebx");
+        ins("jge 1f");
+        ins("movl $1, %ebx");
+        out << "1:\n";
+        ins("movabsq $9223372036854775807, %r12");
+        out << "2:\n";
+        ins("leaq tac_globals(%rip), %rdi");
+        ins("movl $" + to_string(global_words) + ", %ecx");
+        ins("xorl %eax, %eax");
+        ins("rep stosq");
+        ins("movl $1, %edi");         // CLOCK_MONOTONIC
+        ins("movq %rsp, %rsi");
+        ins("call clock_gettime@PLT");
+        ins("call tac_" + entry.name);
+        if (float_result) ins("movq %xmm0, %r13");
+        else ins("movq %rax, %r13");
+        ins("movl $1, %edi");
+        ins("leaq 16(%rsp), %rsi");
+        ins("call clock_gettime@PLT");
+        ins("movq 16(%rsp), %rax");
+        ins("subq (%rsp), %rax");
+        ins("imulq $1000000000, %rax, %rax");
+        ins("addq 24(%rsp), %rax");
+        ins("subq 8(%rsp), %rax");
+        ins("cmpq %r12, %rax");
+        ins("cmovlq %rax, %r12");
+        ins("decl %ebx");
+        ins("jnz 2b");
+        ins("leaq .Lfmt(%rip), %rdi");
+        if (float_result) {
+            ins("movq %r13, %xmm0");
+            ins("movq %r12, %rsi");
+            ins("movl $1, %eax");
+        } else {
+            ins("movq %r13, %rsi");
+            ins("movq %r12, %rdx");
+            ins("xorl %eax, %eax");
+        }
+        ins("call printf@PLT");
+        ins("xorl %eax, %eax");
+        ins("addq $40, %rsp");
+        ins("popq %r13");
+        ins("popq %r12");
+        ins("popq %rbx");
+        ins("popq %rbp");
+        ins("ret");
+        out << "\t.size main, .-main\n";
+    }
+
+public:
+    bool use_registers;
+    vector<pair<string, TacAllocStats>> stats; // per function, in emit order
+
+    TacAsmEmitter(const TacProgram& p) : prog(p), fn(NULL), fn_index(0), frame_bytes(0), use_registers(true) {}
+
+    // Assembly for the whole program; with an entry name, also a main() that runs it
+    bool emit(string& text, const string& entry = "") {
+        out.str("");
+        stats.clear();
+        out << "# Generated from three address code\n\t.text\n";
+        for (size_t f = 0; f < prog.functions.size(); f++) {
+            if (!function(f)) return false;
+        }
+        out << "\n.Ltac_trap:\n\tud2\n";
+
+        if (!entry.empty()) {
+            int e = prog.find_function(entry);
+            if (e < 0 || !prog.functions[e].param_slots.empty()) {
+                error = "no entry function " + entry + " without parameters";
+                return false;
+            }
+            entry_stub(prog.functions[e]);
+        }
+
+        out << "\n\t.bss\n\t.align 8\n\t.globl tac_globals\ntac_globals:\n\t.zero "
+            << 8 * max(1, prog.global_frame_size) << "\n";
+        out << "\t.section .note.GNU-stack,\"\",@progbits\n";
+        text = out.str();
+        return true;
+    }
+
+    const string& get_error() const { return error; }
+};
+
+const char* const TacAsmEmitter::INT_ARGS[6] = {"%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
+
+// Runs a command and returns what it printed, false if it didn't exit cleanly
+bool capture_command(const string& command, string& output) {
+    FILE* p = popen(command.c_str(), "r");
+    if (!p) return false;
+    char buf[4096];
+    size_t n;
+    output.clear();
+    while ((n = fread(buf, 1, sizeof buf, p)) > 0) output.append(buf, n);
+    return pclose(p) == 0;
+}
+
+string shell_quote(const string& s) {
+    string q = "'";
+    for (char c : s) {
+        if (c == '\'') q += "'\\''";
+        else q += c;
+    }
+    return q + "'";
+}
+
+// Runs a built program REPEAT times and checks its result and speed against
+// the interpreter. label names the backend in the report
+bool check_native_run(const TacProgram& prog, const string& exe_path, int repeat, const string& label)
+{
+    ThreadedTacVM vm(prog);
+    TacValue expected;
+    string error, output;
+    double vm_best = 1e100;
+    bool vm_ok = true;
+    for (int r = 0; r < repeat && vm_ok; r++) {
+        vm_ok = vm.run("main", expected, error);
+        vm_best = min(vm_best, vm.stats.seconds);
+    }
+
+    bool ran = capture_command(shell_quote(exe_path) + " " + to_string(repeat) + " 2>&1", output);
+    stringstream result(output);
+    string native_value;
+    long long native_ns = 0;
+    result >> native_value >> native_ns;
+
+    if (!vm_ok) {
+        cout << "   interpreter: " << error << endl;
+        cout << "   " << label << ": " << (ran ? "returned " + native_value : "crashed") << endl;
+        return false;
+    }
+    if (!ran) {
+        cout << "   " << label << " binary failed, interpreter returned " << tac_value_string(expected) << endl;
+        return false;
+    }
+
+    bool same;
+    if (expected.is_float) same = strtod(native_value.c_str(), NULL) == expected.f;
+    else same = native_value == to_string(expected.i);
+
+    cout << "   result: " << label << " " << native_value << ", interpreter " << tac_value_string(expected)
+         << (same ? "  [match]" : "  [MISMATCH]") << endl;
+    cout << "   best of " << repeat << ": " << label << " " << native_ns / 1e6 << " ms, interpreter "
+         << vm_best * 1000 << " ms (" << vm.stats.instructions << " instructions)";
+    if (native_ns > 0) cout << ", " << vm_best * 1e9 / native_ns << "x";
+    cout << endl;
+    return same;
+}
+
+// ./compiler --native [-o DIR] [-n REPEAT] [--no-regalloc] [--stats] file...
+// Builds each program natively, runs it and checks the result and speed
+// against the interpreter
+int run_native(int argc, char *argv[])
+{
+    string out_dir = "native_out";
+    int repeat = 5;
+    bool use_registers = true, show_stats = false;
+    vector<string> inputs;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) out_dir = argv[++i];
+        else if (arg == "-n" && i + 1 < argc) repeat = max(1, atoi(argv[++i]));
+        else if (arg == "--no-regalloc") use_registers = false;
+        else if (arg == "--stats") show_stats = true;
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) {
+        cout << "Usage: " << argv[0] << " --native [-o DIR] [-n REPEAT] [--no-regalloc] [--stats] file..." << endl;
+        return 1;
+    }
+    BatchDriver::make_dirs(out_dir);
+
+    int failures = 0;
+    for (const string& input : inputs) {
+        string name = input.substr(input.find_last_of('/') + 1);
+        name = name.substr(0, name.find('.'));
+        string asm_path = out_dir + "/" + name + ".s";
+        string exe_path = out_dir + "/" + name;
+        cout << "== " << input << endl;
+
+        TacProgram prog;
+        string error, text;
+        if (!load_tac_program(input, prog, error)) {
+            cout << "   couldn't load: " << error << endl;
+            failures++;
+            continue;
+        }
+        TacAsmEmitter emitter(prog);
+        emitter.use_registers = use_registers;
+        if (!emitter.emit(text, "main")) {
+            cout << "   backend: " << emitter.get_error() << endl;
+            failures++;
+            continue;
+        }
+        TacAllocStats total;
+        for (auto& fs : emitter.stats) {
+            const TacAllocStats& st = fs.second;
+            if (show_stats) {
+                cout << "   " << fs.first << ": " << st.intervals << " intervals, " << st.in_registers
+                     << " in registers, " << st.spilled << " spilled (" << st.spill_stores << " stores, "
+                     << st.reloads << " reloads), " << st.callee_saved << " callee-saved" << endl;
+            }
+            total.intervals += st.intervals;
+            total.in_registers += st.in_registers;
+            total.spilled += st.spilled;
+            total.spill_stores += st.spill_stores;
+            total.reloads += st.reloads;
+        }
+        if (use_registers) {
+            cout << "   registers: " << total.in_registers << "/" << total.intervals << " intervals, "
+                 << total.spilled << " spilled, " << total.spill_stores << " spill stores, "
+                 << total.reloads << " reloads" << endl;
+        }
+        ofstream(asm_path.c_str()) << text;
+
+        string output;
+        if (!capture_command("gcc -o " + shell_quote(exe_path) + " " + shell_quote(asm_path) + " 2>&1", output)) {
+            cout << "   gcc failed:\n" << output;
+            failures++;
+            continue;
+        }
+
+        if (!check_native_run(prog, exe_path, repeat, "native")) failures++;
+    }
+    cout << inputs.size() - failures << "/" << inputs.size() << " programs matched" << endl;
+    return failures ? 1 : 0;
+}
+
+#endif // TAC_NATIVE_H
@@ -0,0 +1,379 @@
+#ifndef TAC_PROFILE_H
+#define TAC_PROFILE_H
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "tac_vm.h"
+#include "compiler.h"
+
+using namespace std;
+
+// Reports over a TacProfile: basic blocks and edge frequencies rebuilt from
+// the per-instruction counts, a hot-path report and an annotated copy of the
+// TAC text.
+//
+// TacVM only counts instructions, taken ifs and calls. Everything else
+// follows from those: a block runs as often as its first instruction, an if
+// falls through count - taken times, and a goto or a fall into the next
+// block carries the count of the block's last instruction.
+
+struct TacBlock {
+    int function;
+    int first, last; // instruction range, inclusive
+    string name;     // label, or function+offset
+    long long count;
+};
+
+struct TacEdge {
+    int from, to; // block indices, to is -1 for a return
+    long long count;
+};
+
+class TacProfileReport {
+private:
+    const TacProgram& prog;
+    const TacProfile& profile;
+
+public:
+    vector<TacBlock> blocks;
+    vector<TacEdge> edges;
+    vector<int> function_blocks; // first block of each function
+    vector<long long> self_instructions;
+
+    TacProfileReport(const TacProgram& p, const TacProfile& prof) : prog(p), profile(prof) {
+        for (size_t f = 0; f < prog.functions.size(); f++) add_function(f);
+    }
+
+private:
+    void add_function(int f) {
+        const TacFunction& fn = prog.functions[f];
+        const vector<long long>& counts = profile.counts[f];
+        int ncode = fn.code.size();
+        function_blocks.push_back(blocks.size());
+        self_instructions.push_back(0);
+        for (long long c : counts) self_instructions.back() += c;
+        if (ncode == 0) return;
+
+        vector<bool> leader(ncode + 1, false);
+        leader[0] = true;
+        for (int pc = 0; pc < ncode; pc++) {
+            const TacInstr& in = fn.code[pc];
+            if (tac_is_jump(in.op)) leader[in.dst] = true;
+            if (tac_is_jump(in.op) || in.op == TAC_RET || in.op == TAC_RET_VOID) leader[pc + 1] = true;
+        }
+        vector<string> label_at(ncode + 1);
+        for (auto& l : fn.labels) {
+            if (l.second <= ncode) label_at[l.second] = l.first;
+        }
+
+        int base = blocks.size();
+        vector<int> block_of(ncode + 1, -1);
+        for (int pc = 0; pc < ncode; pc++) {
+            if (leader[pc]) {
+                string name = label_at[pc].empty() ? fn.name + "+" + to_string(pc) : fn.name + ":" + label_at[pc];
+                blocks.push_back({f, pc, pc, name, counts[pc]});
+            }
+            blocks.back().last = pc;
+            block_of[pc] = blocks.size() - 1;
+        }
+
+        for (int b = base; b < (int)blocks.size(); b++) {
+            const TacBlock& blk = blocks[b];
+            const TacInstr& in = fn.code[blk.last];
+            long long n = counts[blk.last];
+            // Falling off the end of the function is a return
+            int next = blk.last + 1 < ncode ? block_of[blk.last + 1] : -1;
+            auto target = [&](int pc) { return pc < ncode ? block_of[pc] : -1; };
+            if (in.op == TAC_IF || in.op == TAC_IF_FALSE) {
+                long long t = profile.taken[f][blk.last];
+                edges.push_back({b, target(in.dst), t});
+                edges.push_back({b, next, n - t});
+            } else if (in.op == TAC_GOTO) {
+                edges.push_back({b, target(in.dst), n});
+            } else if (in.op == TAC_RET || in.op == TAC_RET_VOID) {
+                edges.push_back({b, -1, n});
+            } else {
+                edges.push_back({b, next, n});
+            }
+        }
+    }
+
+    string block_name(int b) const { return b < 0 ? "(return)" : blocks[b].name; }
+
+    static string percent(long long part, long long whole) {
+        char buf[32];
+        snprintf(buf, sizeof buf, "%5.1f%%", whole ? 100.0 * part / whole : 0.0);
+        return buf;
+    }
+
+public:
+    // Heaviest path from the function's entry: follow the most frequent edge
+    // until the path leaves the function or comes back on itself
+    vector<int> hot_path(int f) const {
+        vector<int> path;
+        int b = function_blocks[f];
+        vector<bool> seen(blocks.size(), false);
+        while (b >= 0 && b < (int)blocks.size() && blocks[b].function == f && !seen[b] && blocks[b].count > 0) {
+            seen[b] = true;
+            path.push_back(b);
+            const TacEdge* best = NULL;
+            for (const TacEdge& e : edges) {
+                if (e.from == b && (!best || e.count > best->count)) best = &e;
+            }
+            if (!best || best->count == 0) break;
+            b = best->to;
+        }
+        if (b >= 0 && b < (int)blocks.size() && seen[b]) path.push_back(b); // closes a loop
+        return path;
+    }
+
+    // Jumps that transferred control: taken ifs and every goto
+    long long taken_jumps() const {
+        long long n = 0;
+        for (size_t f = 0; f < prog.functions.size(); f++) {
+            const TacFunction& fn = prog.functions[f];
+            for (size_t pc = 0; pc < fn.code.size(); pc++) {
+                if (fn.code[pc].op == TAC_GOTO) n += profile.counts[f][pc];
+                else if (tac_is_jump(fn.code[pc].op)) n += profile.taken[f][pc];
+            }
+        }
+        return n;
+    }
+
+    void write(ostream& out, int top) const {
+        long long total = 0;
+        for (long long n : self_instructions) total += n;
+        out << "Executed " << total << " instructions, " << taken_jumps() << " taken jumps" << endl;
+
+        vector<int> fns;
+        for (size_t f = 0; f < prog.functions.size(); f++) {
+            if (self_instructions[f] > 0) fns.push_back(f);
+        }
+        sort(fns.begin(), fns.end(), [&](int a, int b) { return self_instructions[a] > self_instructions[b]; });
+        out << "\nFunctions (calls, instructions executed)" << endl;
+        for (int f : fns) {
+            out << "  " << percent(self_instructions[f], total) << "  " << prog.functions[f].name << ": "
+                << profile.calls[f] << " calls, " << self_instructions[f] << " instructions" << endl;
+        }
+
+        vector<int> order;
+        for (size_t b = 0; b < blocks.size(); b++) {
+            if (blocks[b].count > 0) order.push_back(b);
+        }
+        auto weight = [&](int b) { return blocks[b].count * (blocks[b].last - blocks[b].first + 1); };
+        sort(order.begin(), order.end(), [&](int a, int b) { return weight(a) > weight(b); });
+        out << "\nHot blocks (executions x size)" << endl;
+        for (size_t k = 0; k < order.size() && (int)k < top; k++) {
+            const TacBlock& blk = blocks[order[k]];
+            out << "  " << percent(weight(order[k]), total) << "  " << blk.name << " [" << blk.first << ".."
+                << blk.last << "]: " << blk.count << " x " << blk.last - blk.first + 1 << endl;
+        }
+
+        vector<const TacEdge*> hot_edges;
+        for (const TacEdge& e : edges) {
+            if (e.count > 0) hot_edges.push_back(&e);
+        }
+        sort(hot_edges.begin(), hot_edges.end(), [](const TacEdge* a, const TacEdge* b) { return a->count > b->count; });
+        out << "\nHot edges" << endl;
+        for (size_t k = 0; k < hot_edges.size() && (int)k < top; k++) {
+            out << "  " << hot_edges[k]->count << "  " << block_name(hot_edges[k]->from) << " -> "
+                << block_name(hot_edges[k]->to) << endl;
+        }
+
+        out << "\nHot paths" << endl;
+        for (size_t k = 0; k < fns.size() && (int)k < top; k++) {
+            vector<int> path = hot_path(fns[k]);
+            out << "  " << prog.functions[fns[k]].name << ":";
+            for (size_t i = 0; i < path.size(); i++) out << (i ? " -> " : " ") << blocks[path[i]].name;
+            out << endl;
+        }
+    }
+
+    // The TAC text with the execution count of each line in a left column.
+    // A line that became several instructions shows its first one's count
+    void annotate(const string& text, ostream& out) const {
+        vector<long long> line_count;
+        vector<bool> has_count;
+        auto mark = [&](int line, long long n) {
+            if (line <= 0) return;
+            if ((int)line_count.size() <= line) {
+                line_count.resize(line + 1, 0);
+                has_count.resize(line + 1, false);
+            }
+            if (!has_count[line]) {
+                line_count[line] = n;
+                has_count[line] = true;
+            }
+        };
+        for (size_t f = 0; f < prog.functions.size(); f++) {
+            const TacFunction& fn = prog.functions[f];
+            for (size_t pc = 0; pc < fn.code.size() && pc < fn.lines.size(); pc++) mark(fn.lines[pc], profile.counts[f][pc]);
+        }
+
+        stringstream in(text);
+        string line;
+        char buf[32];
+        for (int n = 1; getline(in, line); n++) {
+            if (n < (int)has_count.size() && has_count[n]) snprintf(buf, sizeof buf, "%12lld | ", line_count[n]);
+            else snprintf(buf, sizeof buf, "%12s | ", "");
+            out << buf << line << "\n";
+        }
+    }
+};
+
+// Profile file: a header line, then per function its name, instruction
+// count and calls, followed by "pc count taken" for every instruction that ran
+bool save_tac_profile(const TacProgram& prog, const TacProfile& profile, const string& path, string& error) {
+    ofstream out(path.c_str());
+    if (!out) {
+        error = "couldn't write " + path;
+        return false;
+    }
+    out << "tacprofile 1\n";
+    for (size_t f = 0; f < prog.functions.size(); f++) {
+        out << "function " << prog.functions[f].name << " " << profile.counts[f].size() << " " << profile.calls[f] << "\n";
+        for (size_t pc = 0; pc < profile.counts[f].size(); pc++) {
+            if (profile.counts[f][pc]) out << pc << " " << profile.counts[f][pc] << " " << profile.taken[f][pc] << "\n";
+        }
+    }
+    out << "end\n";
+    return true;
+}
+
+// Fails unless the profile was taken from this same program
+bool load_tac_profile(const TacProgram& prog, const string& path, TacProfile& profile, string& error) {
+    ifstream in(path.c_str());
+    string word;
+    int version = 0;
+    if (!(in >> word >> version) || word != "tacprofile" || version != 1) {
+        error = path + " isn't a profile";
+        return false;
+    }
+    profile.reset(prog);
+    int f = -1;
+    while (in >> word && word != "end") {
+        if (word == "function") {
+            string name;
+            size_t size;
+            long long calls;
+            in >> name >> size >> calls;
+            f = prog.find_function(name);
+            if (!in || f < 0 || size != prog.functions[f].code.size()) {
+                error = "profile doesn't match this program (function " + name + ")";
+                return false;
+            }
+            profile.calls[f] = calls;
+            continue;
+        }
+        size_t pc = strtoull(word.c_str(), NULL, 10);
+        long long count, taken;
+        if (!(in >> count >> taken) || f < 0 || pc >= profile.counts[f].size()) {
+            error = "bad profile entry in " + path;
+            return false;
+        }
+        profile.counts[f][pc] = count;
+        profile.taken[f][pc] = taken;
+    }
+    if (word != "end") {
+        error = path + " is truncated";
+        return false;
+    }
+    return true;
+}
+
+// ./compiler --profile file [--entry NAME] [--top N] [--annotate OUT] [--save PROFILE]
+// Runs a program under the profiling VM and prints a hot-path report. file
+// is TAC text or a source file; --annotate writes the TAC with counts and
+// --save the counts themselves, for --pgo
+int run_profile(int argc, char *argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " --profile file [--entry NAME] [--top N] [--annotate OUT] [--save PROFILE]" << endl;
+        return 1;
+    }
+    string path = argv[2], entry = "main", annotate_path, save_path;
+    int top = 10;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--entry") entry = argv[i + 1];
+        else if (arg == "--top") top = max(1, atoi(argv[i + 1]));
+        else if (arg == "--annotate") annotate_path = argv[i + 1];
+        else if (arg == "--save") save_path = argv[i + 1];
+    }
+
+    ifstream file(path.c_str(), ios::binary);
+    if (!file) {
+        cout << "Couldn't open " << path << endl;
+        return 1;
+    }
+    stringstream ss;
+    ss << file.rdbuf();
+    string text = ss.str();
+    if (text.compare(0, 4, "TACB") == 0) {
+        cout << "Profiling needs TAC text or a source file, not bytecode" << endl;
+        return 1;
+    }
+    if (path.size() > 2 && path.compare(path.size() - 2, 2, ".c") == 0) {
+        CompileOptions options;
+        options.generate_log = false;
+        CompileResult compiled = compile(text, options);
+        if (!compiled.ok) {
+            cout << "Compilation failed:\n" << compiled.errors;
+            return 1;
+        }
+        text = compiled.tac;
+    }
+
+    TacProgram prog;
+    stringstream code(text);
+    TacLoader loader(prog);
+    if (!loader.load(code)) {
+        cout << "Couldn't load TAC: " << loader.get_error() << endl;
+        return 1;
+    }
+
+    // One plain run for the overhead figure, then the profiled one
+    TacValue result;
+    string error;
+    TacVM plain(prog);
+    plain.run(entry, result, error);
+    double plain_seconds = plain.stats.seconds;
+
+    TacProfile profile;
+    TacVM vm(prog);
+    vm.profile = &profile;
+    bool ok = vm.run(entry, result, error);
+    if (ok) cout << entry << " returned " << tac_value_string(result) << endl;
+    else cout << "Runtime error: " << error << " (profile up to there)" << endl;
+    cout << "Profiled run " << vm.stats.seconds * 1000 << " ms, plain run " << plain_seconds * 1000 << " ms";
+    if (plain_seconds > 0) cout << " (" << vm.stats.seconds / plain_seconds << "x)";
+    cout << "\n" << endl;
+
+    TacProfileReport report(prog, profile);
+    report.write(cout, top);
+
+    if (!annotate_path.empty()) {
+        ofstream out(annotate_path.c_str());
+        if (!out) {
+            cout << "Couldn't write " << annotate_path << endl;
+            return 1;
+        }
+        report.annotate(text, out);
+        cout << "\nAnnotated TAC written to " << annotate_path << endl;
+    }
+    if (!save_path.empty()) {
+        if (!save_tac_profile(prog, profile, save_path, error)) {
+            cout << error << endl;
+            return 1;
+        }
+        cout << "\nProfile written to " << save_path << endl;
+    }
+    return ok ? 0 : 1;
+}
+
+#endif // TAC_PROFILE_H
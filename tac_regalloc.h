@@ -0,0 +1,320 @@
+#ifndef TAC_REGALLOC_H
+#define TAC_REGALLOC_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "tac_vm.h"
+
+using namespace std;
+
+// Linear-scan register allocation for the native backend (Poletto & Sarkar).
+//
+// Liveness is solved per instruction over the TAC control flow graph. Each
+// scalar slot then gets one interval from its first to its last live point.
+// Array cells always stay in memory. The intervals are scanned in start order. When
+// no register is free, the interval with the lowest spill cost is spilled
+// whole, whether it is an active one or the new one. Cost is the number of
+// uses and defs, each weighted by 10^loop depth, so values in inner loops
+// are the last ones to go to memory.
+//
+// Which registers an interval may use depends on the calls it overlaps:
+//   rbx r12-r15         callee-saved, anything (saved in the prologue)
+//   r10, xmm8-xmm14     caller-saved, not live across a call
+//   rdi rsi r8 r9,      argument registers, only for intervals that don't
+//   xmm2-xmm7           touch a call at all and aren't parameters
+// rax rcx rdx r11 and xmm0 xmm1 xmm15 are the code generator's scratch.
+// Call arguments are treated as live up to the call itself, so the argument
+// moves never read a register another argument has already overwritten.
+
+enum X86Reg {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15
+};
+
+struct TacLiveInterval {
+    int slot;
+    int start, end;
+    bool is_float;
+    bool is_param;
+    double weight;
+    int reg; // -1 when spilled
+};
+
+struct TacAllocStats {
+    int intervals = 0;
+    int in_registers = 0;
+    int spilled = 0;
+    int spill_stores = 0; // static count of defs of spilled slots
+    int reloads = 0;      // static count of uses of spilled slots
+    int callee_saved = 0;
+};
+
+struct TacAllocation {
+    vector<int> reg;        // per frame entry: register number or -1
+    vector<bool> is_float;  // register class of reg (xmm vs general)
+    vector<int> saved;      // callee-saved registers to preserve
+    vector<int> zeroed;     // slots read before any write, start at zero
+    TacAllocStats stats;
+
+    bool in_register(int s) const { return s < (int)reg.size() && reg[s] >= 0; }
+};
+
+// Scalar slots an instruction reads, and the one it writes
+inline void tac_uses_defs(const TacInstr& in, int uses[2], int& nuses, int& def) {
+    nuses = 0;
+    def = -1;
+    switch (in.op) {
+    case TAC_CONST: case TAC_GET_GLOBAL: case TAC_CALL:
+        def = in.dst;
+        break;
+    case TAC_COPY: case TAC_NEG: case TAC_NOT:
+        uses[nuses++] = in.a;
+        def = in.dst;
+        break;
+    case TAC_SET_GLOBAL: case TAC_PARAM: case TAC_RET: case TAC_IF: case TAC_IF_FALSE:
+        uses[nuses++] = in.a;
+        break;
+    case TAC_LOAD_INDEX: case TAC_LOAD_GINDEX:
+        uses[nuses++] = in.b;
+        def = in.dst;
+        break;
+    case TAC_STORE_INDEX: case TAC_STORE_GINDEX:
+        uses[nuses++] = in.dst;
+        uses[nuses++] = in.b;
+        break;
+    default:
+        if (in.op >= TAC_ADD && in.op <= TAC_OR) {
+            uses[nuses++] = in.a;
+            uses[nuses++] = in.b;
+            def = in.dst;
+        }
+        break;
+    }
+}
+
+class TacRegisterAllocator {
+private:
+    const TacFunction& fn;
+    const vector<uint8_t>& kinds;
+    int nslots; // scalar slots; array cells come after them
+    int ncode;
+
+    typedef vector<uint64_t> Bits;
+
+    static bool test(const Bits& b, int i) { return (b[i >> 6] >> (i & 63)) & 1; }
+    static void set(Bits& b, int i) { b[i >> 6] |= 1ULL << (i & 63); }
+    static void clear(Bits& b, int i) { b[i >> 6] &= ~(1ULL << (i & 63)); }
+
+    void successors(int pc, int succ[2], int& n) const {
+        const TacInstr& in = fn.code[pc];
+        n = 0;
+        if (in.op == TAC_RET || in.op == TAC_RET_VOID) return;
+        if (in.op == TAC_GOTO) {
+            succ[n++] = in.dst;
+            return;
+        }
+        succ[n++] = pc + 1;
+        if ((in.op == TAC_IF || in.op == TAC_IF_FALSE) && in.dst != pc + 1) succ[n++] = in.dst;
+    }
+
+    bool scalar(int s) const { return s >= 0 && s < nslots; }
+
+    // live_in per instruction, plus live_in of the implicit return at the end
+    vector<Bits> liveness() const {
+        int words = (nslots + 63) / 64;
+        vector<Bits> live_in(ncode + 1, Bits(words, 0));
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int pc = ncode - 1; pc >= 0; pc--) {
+                Bits live(words, 0);
+                int succ[2], nsucc;
+                successors(pc, succ, nsucc);
+                for (int k = 0; k < nsucc; k++) {
+                    const Bits& s = live_in[succ[k]];
+                    for (int w = 0; w < words; w++) live[w] |= s[w];
+                }
+                int uses[2], nuses, def;
+                tac_uses_defs(fn.code[pc], uses, nuses, def);
+                if (scalar(def)) clear(live, def);
+                for (int k = 0; k < nuses; k++) {
+                    if (scalar(uses[k])) set(live, uses[k]);
+                }
+                if (live != live_in[pc]) {
+                    live_in[pc] = live;
+                    changed = true;
+                }
+            }
+        }
+        return live_in;
+    }
+
+    vector<int> loop_depths() const {
+        vector<int> depth(ncode + 1, 0);
+        for (int pc = 0; pc < ncode; pc++) {
+            const TacInstr& in = fn.code[pc];
+            if (tac_is_jump(in.op) && in.dst <= pc) {
+                for (int k = in.dst; k <= pc; k++) depth[k]++;
+            }
+        }
+        return depth;
+    }
+
+public:
+    TacRegisterAllocator(const TacFunction& f, const vector<uint8_t>& slot_kinds)
+        : fn(f), kinds(slot_kinds), nslots(f.slot_names.size()), ncode(f.code.size()) {}
+
+    TacAllocation allocate() {
+        TacAllocation result;
+        result.reg.assign(fn.frame_size, -1);
+        result.is_float.assign(fn.frame_size, false);
+
+        vector<Bits> live_in = liveness();
+        vector<int> depth = loop_depths();
+
+        vector<TacLiveInterval> intervals(nslots);
+        for (int s = 0; s < nslots; s++) {
+            intervals[s] = {s, -1, -1, kinds[s] == KIND_FLOAT, false, 0, -1};
+        }
+        auto touch = [&](int s, int pc) {
+            TacLiveInterval& iv = intervals[s];
+            if (iv.start < 0 || pc < iv.start) iv.start = pc;
+            if (pc > iv.end) iv.end = pc;
+        };
+
+        vector<int> calls;
+        for (int pc = 0; pc <= ncode; pc++) {
+            for (int s = 0; s < nslots; s++) {
+                if (test(live_in[pc], s)) touch(s, pc);
+            }
+            if (pc == ncode) break;
+            const TacInstr& in = fn.code[pc];
+            int uses[2], nuses, def;
+            tac_uses_defs(in, uses, nuses, def);
+            double w = pow(10.0, min(depth[pc], 6));
+            if (scalar(def)) {
+                touch(def, pc);
+                intervals[def].weight += w;
+            }
+            for (int k = 0; k < nuses; k++) {
+                if (scalar(uses[k])) intervals[uses[k]].weight += w;
+            }
+            if (in.op == TAC_CALL) {
+                calls.push_back(pc);
+                // Arguments stay live until the call reads them
+                for (int k = 1; k <= in.b && pc - k >= 0; k++) {
+                    const TacInstr& p = fn.code[pc - k];
+                    if (p.op == TAC_PARAM && scalar(p.a)) touch(p.a, pc);
+                }
+            }
+        }
+        for (int s : fn.param_slots) {
+            if (scalar(s)) {
+                intervals[s].is_param = true;
+                if (intervals[s].start >= 0) intervals[s].start = 0;
+            }
+        }
+        for (int s = 0; s < nslots; s++) {
+            if (test(live_in[0], s) && !intervals[s].is_param) result.zeroed.push_back(s);
+        }
+
+        // Calls strictly inside / anywhere in [start, end]
+        auto crosses_call = [&](const TacLiveInterval& iv) {
+            auto it = upper_bound(calls.begin(), calls.end(), iv.start);
+            return it != calls.end() && *it < iv.end;
+        };
+        auto touches_call = [&](const TacLiveInterval& iv) {
+            auto it = lower_bound(calls.begin(), calls.end(), iv.start);
+            return it != calls.end() && *it <= iv.end;
+        };
+
+        vector<TacLiveInterval*> order;
+        for (auto& iv : intervals) {
+            if (iv.start >= 0) order.push_back(&iv);
+        }
+        sort(order.begin(), order.end(), [](const TacLiveInterval* a, const TacLiveInterval* b) {
+            return a->start != b->start ? a->start < b->start : a->slot < b->slot;
+        });
+
+        // Cheapest first: caller-saved before callee-saved
+        static const int int_regs[] = {RDI, RSI, R8, R9, R10, RBX, R12, R13, R14, R15};
+        static const int float_regs[] = {2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14};
+        auto allowed = [&](const TacLiveInterval& iv, int reg) {
+            bool arg_reg = iv.is_float ? reg < 8 : (reg == RDI || reg == RSI || reg == R8 || reg == R9);
+            bool callee_saved = !iv.is_float && (reg == RBX || reg >= R12);
+            if (arg_reg) return !iv.is_param && !touches_call(iv);
+            if (callee_saved) return true;
+            return !crosses_call(iv);
+        };
+
+        bool int_busy[16] = {false}, float_busy[16] = {false};
+        vector<TacLiveInterval*> active;
+        for (TacLiveInterval* cur : order) {
+            // Expire. A register last read at pc can take a value first written at pc
+            bool defined_here = !test(live_in[cur->start], cur->slot);
+            for (size_t k = 0; k < active.size();) {
+                if (active[k]->end < cur->start || (active[k]->end == cur->start && defined_here)) {
+                    (active[k]->is_float ? float_busy : int_busy)[active[k]->reg] = false;
+                    active.erase(active.begin() + k);
+                } else {
+                    k++;
+                }
+            }
+
+            bool* busy = cur->is_float ? float_busy : int_busy;
+            const int* regs = cur->is_float ? float_regs : int_regs;
+            int nregs = cur->is_float ? 13 : 10;
+            for (int k = 0; k < nregs && cur->reg < 0; k++) {
+                if (!busy[regs[k]] && allowed(*cur, regs[k])) cur->reg = regs[k];
+            }
+            if (cur->reg < 0) {
+                // Take the register of the cheapest active interval it could use
+                TacLiveInterval* victim = NULL;
+                for (TacLiveInterval* a : active) {
+                    if (a->is_float != cur->is_float || !allowed(*cur, a->reg)) continue;
+                    if (!victim || a->weight < victim->weight) victim = a;
+                }
+                if (victim && victim->weight < cur->weight) {
+                    cur->reg = victim->reg;
+                    victim->reg = -1;
+                    active.erase(find(active.begin(), active.end(), victim));
+                }
+            }
+            if (cur->reg >= 0) {
+                busy[cur->reg] = true;
+                active.push_back(cur);
+            }
+        }
+
+        TacAllocStats& st = result.stats;
+        bool saved[16] = {false};
+        for (TacLiveInterval* iv : order) {
+            st.intervals++;
+            if (iv->reg >= 0) {
+                st.in_registers++;
+                result.reg[iv->slot] = iv->reg;
+                result.is_float[iv->slot] = iv->is_float;
+                if (!iv->is_float && (iv->reg == RBX || iv->reg >= R12)) saved[iv->reg] = true;
+            } else {
+                st.spilled++;
+            }
+        }
+        for (int r = 0; r < 16; r++) {
+            if (saved[r]) result.saved.push_back(r);
+        }
+        st.callee_saved = result.saved.size();
+
+        for (const TacInstr& in : fn.code) {
+            int uses[2], nuses, def;
+            tac_uses_defs(in, uses, nuses, def);
+            if (scalar(def) && result.reg[def] < 0) st.spill_stores++;
+            for (int k = 0; k < nuses; k++) {
+                if (scalar(uses[k]) && result.reg[uses[k]] < 0) st.reloads++;
+            }
+        }
+        return result;
+    }
+};
+
+#endif // TAC_REGALLOC_H
@@ -0,0 +1,557 @@
+#ifndef TAC_THREADED_H
+#define TAC_THREADED_H
+
+#include "tac_vm.h"
+
+using namespace std;
+
+// Direct-threaded executor for a TacProgram (GCC/Clang computed goto).
+//
+// Each function is pre-decoded into a dense array of ThreadedInstr. Every
+// entry has the address of its handler label, its already resolved operand
+// slots, and for jumps a pointer to the target instruction. So dispatch is one
+// indirect jump with no opcode switch and no label lookup. Copies are
+// split by conversion kind at decode time, and every function ends with a
+// sentinel "fell off the end" instruction, so there's no bounds check on
+// the instruction pointer.
+//
+// The step limit is only checked on jumps and calls, which is enough to stop
+// runaway loops and recursion.
+//
+// Frequent straight line sequences are fused into superinstructions at
+// decode time (the patterns come from the --census table in tac_census.h):
+//   t = x; k = C; r = t + k; x' = r     increment in place, the i++ form
+//   t = a < b; if t goto L [; goto M]   compare and branch, any comparison
+//   t = x; r = a[t]  /  t = x; a[t] = v  indexed access with its index copy
+//   t = x; k = C                         operand loads
+// The fused handler sits on the first instruction and reads its operands
+// from the entries after it, which stay decoded as they were. Every store
+// of the original sequence is still done, so nothing else changes. A
+// sequence is never fused across a jump target, and stats count the real
+// instructions with the saved dispatches on the side.
+
+struct ThreadedInstr {
+    const void* handler;
+    union {
+        const ThreadedInstr* target; // jumps
+        long long kind;              // conversions on stores
+    };
+    int32_t dst, a, b, c;
+};
+
+struct ThreadedFunction {
+    const TacFunction* src;
+    vector<ThreadedInstr> code;
+};
+
+class ThreadedTacVM {
+private:
+    const TacProgram& prog;
+    vector<ThreadedFunction> funcs;
+    vector<TacValue> stack;
+    vector<TacValue> globals;
+    vector<TacValue> args;
+
+    struct CallRecord {
+        const ThreadedFunction* fn;
+        const ThreadedInstr* ip;
+        TacValue* fp;
+        int dst;
+    };
+
+    // Handler numbering used while decoding, the actual addresses are
+    // filled in from inside run() where the labels live
+    enum Handler {
+        H_NOP, H_CONST, H_COPY, H_COPY_INT, H_COPY_FLOAT, H_GET_GLOBAL, H_SET_GLOBAL,
+        H_ADD, H_SUB, H_MUL, H_DIV, H_MOD,
+        H_LT, H_GT, H_LE, H_GE, H_EQ, H_NE, H_AND, H_OR, H_NEG, H_NOT,
+        H_LOAD_INDEX, H_STORE_INDEX, H_LOAD_GINDEX, H_STORE_GINDEX,
+        H_PARAM, H_CALL, H_RET, H_RET_VOID, H_IF, H_GOTO, H_IF_FALSE, H_END,
+        // superinstructions
+        H_INC, H_COPY_CONST, H_COPY_LOAD_INDEX, H_COPY_STORE_INDEX, H_COPY_LOAD_GINDEX, H_COPY_STORE_GINDEX,
+        H_LT_IF, H_LT_IF_FALSE, H_LT_IF_GOTO, H_GT_IF, H_GT_IF_FALSE, H_GT_IF_GOTO,
+        H_LE_IF, H_LE_IF_FALSE, H_LE_IF_GOTO, H_GE_IF, H_GE_IF_FALSE, H_GE_IF_GOTO,
+        H_EQ_IF, H_EQ_IF_FALSE, H_EQ_IF_GOTO, H_NE_IF, H_NE_IF_FALSE, H_NE_IF_GOTO,
+        H_COUNT
+    };
+
+    static int handler_for(const TacInstr& in) {
+        static const int by_op[TAC_OP_COUNT] = {
+            H_NOP, H_CONST, H_COPY, H_GET_GLOBAL, H_SET_GLOBAL,
+            H_ADD, H_SUB, H_MUL, H_DIV, H_MOD,
+            H_LT, H_GT, H_LE, H_GE, H_EQ, H_NE, H_AND, H_OR, H_NEG, H_NOT,
+            H_LOAD_INDEX, H_STORE_INDEX, H_LOAD_GINDEX, H_STORE_GINDEX,
+            H_PARAM, H_CALL, H_RET, H_RET_VOID, H_IF, H_GOTO, H_IF_FALSE};
+        if (in.op == TAC_COPY && in.kind == KIND_INT) return H_COPY_INT;
+        if (in.op == TAC_COPY && in.kind == KIND_FLOAT) return H_COPY_FLOAT;
+        return by_op[in.op];
+    }
+
+    void decode(const void* const* handlers) {
+        funcs.resize(prog.functions.size());
+        for (size_t f = 0; f < prog.functions.size(); f++) {
+            const TacFunction& src = prog.functions[f];
+            ThreadedFunction& tf = funcs[f];
+            tf.src = &src;
+            tf.code.resize(src.code.size() + 1);
+            for (size_t i = 0; i < src.code.size(); i++) {
+                const TacInstr& in = src.code[i];
+                ThreadedInstr& t = tf.code[i];
+                t.handler = handlers[handler_for(in)];
+                t.kind = in.kind;
+                t.dst = in.dst;
+                t.a = in.a;
+                t.b = in.b;
+                t.c = in.c;
+                if (tac_is_jump(in.op)) t.target = &tf.code[in.dst];
+            }
+            ThreadedInstr& end = tf.code.back();
+            end.handler = handlers[H_END];
+            end.kind = KIND_ANY;
+            end.dst = end.a = end.b = end.c = 0;
+            if (fuse) fuse_function(src, tf, handlers);
+        }
+    }
+
+    // Length of the superinstruction starting at pc and its handler, 0 if
+    // none matches. The longest pattern wins.
+    static int match_super(const vector<TacInstr>& code, size_t pc, int& handler) {
+        size_t left = code.size() - pc;
+        const TacInstr* in = &code[pc];
+        if (left >= 4 && in[0].op == TAC_COPY && in[1].op == TAC_CONST && in[2].op == TAC_ADD &&
+            in[3].op == TAC_COPY && in[2].a == in[0].dst && in[2].b == in[1].dst && in[3].a == in[2].dst) {
+            handler = H_INC;
+            return 4;
+        }
+        if (left >= 2 && in[0].op >= TAC_LT && in[0].op <= TAC_NE &&
+            (in[1].op == TAC_IF || in[1].op == TAC_IF_FALSE) && in[1].a == in[0].dst) {
+            handler = H_LT_IF + (in[0].op - TAC_LT) * 3;
+            if (in[1].op == TAC_IF_FALSE) {
+                handler += 1;
+                return 2;
+            }
+            if (left >= 3 && in[2].op == TAC_GOTO) {
+                handler += 2;
+                return 3;
+            }
+            return 2;
+        }
+        if (left >= 2 && in[0].op == TAC_COPY) {
+            static const int indexed[4] = {H_COPY_LOAD_INDEX, H_COPY_STORE_INDEX, H_COPY_LOAD_GINDEX, H_COPY_STORE_GINDEX};
+            if (in[1].op >= TAC_LOAD_INDEX && in[1].op <= TAC_STORE_GINDEX && in[1].b == in[0].dst) {
+                handler = indexed[in[1].op - TAC_LOAD_INDEX];
+                return 2;
+            }
+            if (in[1].op == TAC_CONST) {
+                handler = H_COPY_CONST;
+                return 2;
+            }
+        }
+        return 0;
+    }
+
+    void fuse_function(const TacFunction& src, ThreadedFunction& tf, const void* const* handlers) {
+        vector<char> leader(src.code.size() + 1, 0);
+        for (const TacInstr& in : src.code) {
+            if (tac_is_jump(in.op)) leader[in.dst] = 1;
+        }
+        for (size_t pc = 0; pc < src.code.size();) {
+            int handler = 0;
+            int length = match_super(src.code, pc, handler);
+            for (int k = 1; k < length; k++) {
+                if (leader[pc + k]) length = 0;
+            }
+            if (length == 0) {
+                pc++;
+                continue;
+            }
+            tf.code[pc].handler = handlers[handler];
+            superinstructions++;
+            pc += length;
+        }
+    }
+
+public:
+    long long max_steps;
+    size_t max_depth;
+    bool fuse;                 // form superinstructions, read at the first run
+    size_t superinstructions;  // how many were formed
+    TacRunStats stats;
+
+    ThreadedTacVM(const TacProgram& p, size_t stack_values = 1 << 22)
+        : prog(p), stack(stack_values), max_steps(1000000000LL), max_depth(100000), fuse(true), superinstructions(0) {}
+
+    bool run(const string& entry, TacValue& result, string& error) {
+        static const void* const handlers[H_COUNT] = {
+            &&op_nop, &&op_const, &&op_copy, &&op_copy_int, &&op_copy_float, &&op_get_global, &&op_set_global,
+            &&op_add, &&op_sub, &&op_mul, &&op_div, &&op_mod,
+            &&op_lt, &&op_gt, &&op_le, &&op_ge, &&op_eq, &&op_ne, &&op_and, &&op_or, &&op_neg, &&op_not,
+            &&op_load_index, &&op_store_index, &&op_load_gindex, &&op_store_gindex,
+            &&op_param, &&op_call, &&op_ret, &&op_ret_void, &&op_if, &&op_goto, &&op_if_false, &&op_end,
+            &&op_inc, &&op_copy_const, &&op_copy_load_index, &&op_copy_store_index, &&op_copy_load_gindex, &&op_copy_store_gindex,
+            &&op_lt_if, &&op_lt_if_false, &&op_lt_if_goto, &&op_gt_if, &&op_gt_if_false, &&op_gt_if_goto,
+            &&op_le_if, &&op_le_if_false, &&op_le_if_goto, &&op_ge_if, &&op_ge_if_false, &&op_ge_if_goto,
+            &&op_eq_if, &&op_eq_if_false, &&op_eq_if_goto, &&op_ne_if, &&op_ne_if_false, &&op_ne_if_goto};
+
+        if (funcs.empty()) decode(handlers);
+
+        int f = prog.find_function(entry);
+        if (f < 0) {
+            error = "no function named " + entry;
+            return false;
+        }
+        const ThreadedFunction* fn = &funcs[f];
+        if (!fn->src->param_slots.empty()) {
+            error = entry + " takes parameters";
+            return false;
+        }
+        if ((size_t)fn->src->frame_size > stack.size()) {
+            error = "stack overflow";
+            return false;
+        }
+
+        globals.assign(prog.global_frame_size, TacValue());
+        args.clear();
+        stats = TacRunStats();
+        auto start = chrono::steady_clock::now();
+
+        vector<CallRecord> frames;
+        TacValue* fp = stack.data();
+        TacValue* const stack_end = stack.data() + stack.size();
+        TacValue* const gp = globals.data();
+        fill(fp, fp + fn->src->frame_size, TacValue());
+        const TacValue* consts = fn->src->constants.data();
+        const ThreadedInstr* ip = fn->code.data();
+        long long steps = 0;
+        long long saved = 0; // dispatches saved by superinstructions
+        long long budget = max_steps;
+        bool ok = true;
+        TacValue value;
+        result = TacValue();
+
+#define DISPATCH() do { steps++; goto *ip->handler; } while (0)
+#define NEXT() do { ip++; DISPATCH(); } while (0)
+#define JUMP(to) do { ip = (to); if (steps >= budget) goto step_limit; DISPATCH(); } while (0)
+#define FAIL(msg) do { error = (msg); ok = false; goto done; } while (0)
+// Runs the rest of an n instruction superinstruction's count
+#define FUSED_NEXT(n) do { steps += (n) - 1; saved += (n) - 1; ip += (n); DISPATCH(); } while (0)
+#define FUSED_JUMP(n, to) do { steps += (n) - 1; saved += (n) - 1; JUMP(to); } while (0)
+#define DO_ARITH(OP, INT_OP, in)                                   \
+        {                                                          \
+            const TacValue& x = fp[(in).a];                        \
+            const TacValue& y = fp[(in).b];                        \
+            TacValue r;                                            \
+            if (x.is_float | y.is_float) {                         \
+                r.f = x.as_float() OP y.as_float();                \
+                r.is_float = true;                                 \
+            } else {                                               \
+                r.i = INT_OP(x.i, y.i);                            \
+            }                                                      \
+            fp[(in).dst] = r;                                      \
+        }
+#define DO_COMPARE(OP, in)                                         \
+        {                                                          \
+            const TacValue& x = fp[(in).a];                        \
+            const TacValue& y = fp[(in).b];                        \
+            TacValue r;                                            \
+            if (x.is_float | y.is_float) r.i = x.as_float() OP y.as_float(); \
+            else r.i = x.i OP y.i;                                 \
+            fp[(in).dst] = r;                                      \
+        }
+#define ARITH(OP, INT_OP) { DO_ARITH(OP, INT_OP, ip[0]) NEXT(); }
+#define COMPARE(OP) { DO_COMPARE(OP, ip[0]) NEXT(); }
+// compare, if [, goto] for one comparison
+#define COMPARE_BRANCH(NAME, OP)                                   \
+    op_##NAME##_if:                                                \
+        DO_COMPARE(OP, ip[0])                                      \
+        if (fp[ip[1].a].truthy()) FUSED_JUMP(2, ip[1].target);     \
+        FUSED_NEXT(2);                                             \
+    op_##NAME##_if_false:                                          \
+        DO_COMPARE(OP, ip[0])                                      \
+        if (!fp[ip[1].a].truthy()) FUSED_JUMP(2, ip[1].target);    \
+        FUSED_NEXT(2);                                             \
+    op_##NAME##_if_goto:                                           \
+        DO_COMPARE(OP, ip[0])                                      \
+        if (fp[ip[1].a].truthy()) FUSED_JUMP(2, ip[1].target);     \
+        FUSED_JUMP(3, ip[2].target);
+
+        DISPATCH();
+
+    op_nop:
+        NEXT();
+    op_const:
+        fp[ip->dst] = consts[ip->a];
+        NEXT();
+    op_copy:
+        fp[ip->dst] = fp[ip->a];
+        NEXT();
+    op_copy_int:
+        fp[ip->dst] = tac_convert(fp[ip->a], KIND_INT);
+        NEXT();
+    op_copy_float:
+        fp[ip->dst] = tac_convert(fp[ip->a], KIND_FLOAT);
+        NEXT();
+    op_get_global:
+        fp[ip->dst] = gp[ip->a];
+        NEXT();
+    op_set_global:
+        gp[ip->dst] = tac_convert(fp[ip->a], ip->kind);
+        NEXT();
+    op_add: ARITH(+, tac_int_add)
+    op_sub: ARITH(-, tac_int_sub)
+    op_mul: ARITH(*, tac_int_mul)
+    op_div:
+        if (!fp[ip->a].is_float && !fp[ip->b].is_float && fp[ip->b].i == 0) FAIL("division by zero in " + fn->src->name);
+        ARITH(/, tac_int_div)
+    op_mod: {
+        TacValue x = tac_convert(fp[ip->a], KIND_INT);
+        TacValue y = tac_convert(fp[ip->b], KIND_INT);
+        if (y.i == 0) FAIL("modulus by zero in " + fn->src->name);
+        TacValue r;
+        r.i = tac_int_mod(x.i, y.i);
+        fp[ip->dst] = r;
+        NEXT();
+    }
+    op_lt: COMPARE(<)
+    op_gt: COMPARE(>)
+    op_le: COMPARE(<=)
+    op_ge: COMPARE(>=)
+    op_eq: COMPARE(==)
+    op_ne: COMPARE(!=)
+    op_and: {
+        TacValue r;
+        r.i = fp[ip->a].truthy() && fp[ip->b].truthy();
+        fp[ip->dst] = r;
+        NEXT();
+    }
+    op_or: {
+        TacValue r;
+        r.i = fp[ip->a].truthy() || fp[ip->b].truthy();
+        fp[ip->dst] = r;
+        NEXT();
+    }
+    op_neg: {
+        TacValue r = fp[ip->a];
+        if (r.is_float) r.f = -r.f;
+        else r.i = tac_int_sub(0, r.i);
+        fp[ip->dst] = r;
+        NEXT();
+    }
+    op_not: {
+        TacValue r;
+        r.i = !fp[ip->a].truthy();
+        fp[ip->dst] = r;
+        NEXT();
+    }
+    op_load_index: {
+        long long idx = tac_convert(fp[ip->b], KIND_INT).i;
+        if (idx < 0 || idx >= ip->c) FAIL("array index " + to_string(idx) + " out of bounds in " + fn->src->name);
+        fp[ip->dst] = fp[ip->a + idx];
+        NEXT();
+    }
+    op_store_index: {
+        long long idx = tac_convert(fp[ip->b], KIND_INT).i;
+        if (idx < 0 || idx >= ip->c) FAIL("array index " + to_string(idx) + " out of bounds in " + fn->src->name);
+        fp[ip->a + idx] = tac_convert(fp[ip->dst], ip->kind);
+        NEXT();
+    }
+    op_load_gindex: {
+        long long idx = tac_convert(fp[ip->b], KIND_INT).i;
+        if (idx < 0 || idx >= ip->c) FAIL("array index " + to_string(idx) + " out of bounds in " + fn->src->name);
+        fp[ip->dst] = gp[ip->a + idx];
+        NEXT();
+    }
+    op_store_gindex: {
+        long long idx = tac_convert(fp[ip->b], KIND_INT).i;
+        if (idx < 0 || idx >= ip->c) FAIL("array index " + to_string(idx) + " out of bounds in " + fn->src->name);
+        gp[ip->a + idx] = tac_convert(fp[ip->dst], ip->kind);
+        NEXT();
+    }
+    op_param:
+        args.push_back(fp[ip->a]);
+        NEXT();
+    op_call: {
+        const ThreadedFunction* callee = &funcs[ip->a];
+        const TacFunction* csrc = callee->src;
+        if ((size_t)ip->b != csrc->param_slots.size() || args.size() < (size_t)ip->b)
+            FAIL("call to " + csrc->name + " with " + to_string(ip->b) + " arguments");
+        TacValue* callee_fp = fp + fn->src->frame_size;
+        if (callee_fp + csrc->frame_size > stack_end || frames.size() >= max_depth)
+            FAIL("stack overflow calling " + csrc->name);
+        frames.push_back({fn, ip + 1, fp, ip->dst});
+        fill(callee_fp, callee_fp + csrc->frame_size, TacValue());
+        size_t first = args.size() - ip->b;
+        for (int k = 0; k < ip->b; k++) {
+            callee_fp[csrc->param_slots[k]] = tac_convert(args[first + k], csrc->param_kinds[k]);
+        }
+        args.resize(first);
+        stats.calls++;
+        fn = callee;
+        fp = callee_fp;
+        consts = csrc->constants.data();
+        JUMP(fn->code.data());
+    }
+    op_ret:
+        value = tac_convert(fp[ip->a], tac_kind_of(fn->src->return_type));
+        goto do_return;
+    op_end:
+        steps--; // the sentinel isn't a real instruction
+    op_ret_void:
+        value = TacValue();
+    do_return: {
+        if (frames.empty()) {
+            result = value;
+            goto done;
+        }
+        CallRecord& ret = frames.back();
+        fn = ret.fn;
+        fp = ret.fp;
+        ip = ret.ip;
+        fp[ret.dst] = value;
+        frames.pop_back();
+        consts = fn->src->constants.data();
+        DISPATCH();
+    }
+    op_if:
+        if (fp[ip->a].truthy()) JUMP(ip->target);
+        NEXT();
+    op_goto:
+        JUMP(ip->target);
+    op_if_false:
+        if (!fp[ip->a].truthy()) JUMP(ip->target);
+        NEXT();
+
+    op_inc:
+        fp[ip[0].dst] = tac_convert(fp[ip[0].a], ip[0].kind);
+        fp[ip[1].dst] = consts[ip[1].a];
+        DO_ARITH(+, tac_int_add, ip[2])
+        fp[ip[3].dst] = tac_convert(fp[ip[3].a], ip[3].kind);
+        FUSED_NEXT(4);
+    op_copy_const:
+        fp[ip[0].dst] = tac_convert(fp[ip[0].a], ip[0].kind);
+        fp[ip[1].dst] = consts[ip[1].a];
+        FUSED_NEXT(2);
+    op_copy_load_index: {
+        fp[ip[0].dst] = tac_convert(fp[ip[0].a], ip[0].kind);
+        steps++; // counted before the check, like the unfused load
+        saved++;
+        long long idx = tac_convert(fp[ip[1].b], KIND_INT).i;
+        if (idx < 0 || idx >= ip[1].c) FAIL("array index " + to_string(idx) + " out of bounds in " + fn->src->name);
+        fp[ip[1].dst] = fp[ip[1].a + idx];
+        ip += 2;
+        DISPATCH();
+    }
+    op_copy_store_index: {
+        fp[ip[0].dst] = tac_convert(fp[ip[0].a], ip[0].kind);
+        steps++;
+        saved++;
+        long long idx = tac_convert(fp[ip[1].b], KIND_INT).i;
+        if (idx < 0 || idx >= ip[1].c) FAIL("array index " + to_string(idx) + " out of bounds in " + fn->src->name);
+        fp[ip[1].a + idx] = tac_convert(fp[ip[1].dst], ip[1].kind);
+        ip += 2;
+        DISPATCH();
+    }
+    op_copy_load_gindex: {
+        fp[ip[0].dst] = tac_convert(fp[ip[0].a], ip[0].kind);
+        steps++;
+        saved++;
+        long long idx = tac_convert(fp[ip[1].b], KIND_INT).i;
+        if (idx < 0 || idx >= ip[1].c) FAIL("array index " + to_string(idx) + " out of bounds in " + fn->src->name);
+        fp[ip[1].dst] = gp[ip[1].a + idx];
+        ip += 2;
+        DISPATCH();
+    }
+    op_copy_store_gindex: {
+        fp[ip[0].dst] = tac_convert(fp[ip[0].a], ip[0].kind);
+        steps++;
+        saved++;
+        long long idx = tac_convert(fp[ip[1].b], KIND_INT).i;
+        if (idx < 0 || idx >= ip[1].c) FAIL("array index " + to_string(idx) + " out of bounds in " + fn->src->name);
+        gp[ip[1].a + idx] = tac_convert(fp[ip[1].dst], ip[1].kind);
+        ip += 2;
+        DISPATCH();
+    }
+    COMPARE_BRANCH(lt, <)
+    COMPARE_BRANCH(gt, >)
+    COMPARE_BRANCH(le, <=)
+    COMPARE_BRANCH(ge, >=)
+    COMPARE_BRANCH(eq, ==)
+    COMPARE_BRANCH(ne, !=)
+
+    step_limit:
+        error = "step limit of " + to_string(max_steps) + " instructions reached in " + fn->src->name;
+        ok = false;
+    done:
+#undef DISPATCH
+#undef NEXT
+#undef JUMP
+#undef FAIL
+#undef ARITH
+#undef COMPARE
+#undef FUSED_NEXT
+#undef FUSED_JUMP
+#undef DO_ARITH
+#undef DO_COMPARE
+#undef COMPARE_BRANCH
+
+        stats.instructions = steps;
+        stats.dispatches = steps - saved;
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return ok;
+    }
+};
+
+// ./compiler --bench-dispatch file [-n REPEAT]
+// Runs the program with both executors and compares dispatch speed
+int run_dispatch_bench(int argc, char *argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " --bench-dispatch file [-n REPEAT]" << endl;
+        return 1;
+    }
+    int repeat = 20;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "-n") repeat = max(1, atoi(argv[i + 1]));
+    }
+
+    TacProgram prog;
+    string error;
+    if (!load_tac_program(argv[2], prog, error)) {
+        cout << "Couldn't load TAC: " << error << endl;
+        return 1;
+    }
+
+    TacVM switch_vm(prog);
+    ThreadedTacVM threaded_vm(prog);
+    TacValue switch_result, threaded_result;
+    double switch_best = 1e100, threaded_best = 1e100;
+    long long switch_instrs = 0, threaded_instrs = 0, threaded_dispatches = 0;
+
+    for (int r = 0; r < repeat; r++) {
+        if (!switch_vm.run("main", switch_result, error)) {
+            cout << "Runtime error (switch): " << error << endl;
+            return 1;
+        }
+        if (!threaded_vm.run("main", threaded_result, error)) {
+            cout << "Runtime error (threaded): " << error << endl;
+            return 1;
+        }
+        switch_best = min(switch_best, switch_vm.stats.seconds);
+        threaded_best = min(threaded_best, threaded_vm.stats.seconds);
+        switch_instrs = switch_vm.stats.instructions;
+        threaded_instrs = threaded_vm.stats.instructions;
+        threaded_dispatches = threaded_vm.stats.dispatches;
+    }
+
+    cout << "main returned " << tac_value_string(switch_result) << " (switch), "
+         << tac_value_string(threaded_result) << " (threaded)" << endl;
+    cout << "switch:   " << switch_instrs << " instructions, best of " << repeat << ": " << switch_best * 1000
+         << " ms, " << switch_best * 1e9 / max(1LL, switch_instrs) << " ns/instr" << endl;
+    cout << "threaded: " << threaded_instrs << " instructions in " << threaded_dispatches << " dispatches ("
+         << threaded_vm.superinstructions << " superinstructions), best of " << repeat << ": " << threaded_best * 1000
+         << " ms, " << threaded_best * 1e9 / max(1LL, threaded_instrs) << " ns/instr" << endl;
+    if (threaded_best > 0) cout << "speedup: " << switch_best / threaded_best << "x" << endl;
+    return 0;
+}
+
+#endif // TAC_THREADED_H
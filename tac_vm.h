@@ -0,0 +1,959 @@
+#ifndef TAC_VM_H
+#define TAC_VM_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include "compiler.h"
+
+using namespace std;
+
+// Executor for the three address code written by ThreeAddrCodeGenerator.
+//
+// The text is decoded once into a TacProgram: every name in a function gets a
+// dense slot number, labels become instruction indices and literals go to a
+// per-function constant pool. A frame is one contiguous block of TacValues,
+// the named/temp slots followed by the cells of the function's arrays.
+//
+// Globals are only touched by copies and array accesses in the generated
+// code, so they get their own opcodes and every other operand is a plain
+// frame slot.
+
+enum TacOp : uint8_t {
+    TAC_NOP,
+    TAC_CONST,       // dst = constants[a]
+    TAC_COPY,        // dst = a, converted to kind
+    TAC_GET_GLOBAL,  // dst = globals[a]
+    TAC_SET_GLOBAL,  // globals[dst] = a, converted to kind
+    TAC_ADD, TAC_SUB, TAC_MUL, TAC_DIV, TAC_MOD,
+    TAC_LT, TAC_GT, TAC_LE, TAC_GE, TAC_EQ, TAC_NE,
+    TAC_AND, TAC_OR,
+    TAC_NEG, TAC_NOT,
+    TAC_LOAD_INDEX,   // dst = frame[a + b], c is the array size
+    TAC_STORE_INDEX,  // frame[a + b] = dst, converted to kind
+    TAC_LOAD_GINDEX,  // same on the global frame
+    TAC_STORE_GINDEX,
+    TAC_PARAM,        // push a
+    TAC_CALL,         // dst = call functions[a] with the last b params
+    TAC_RET,          // return a
+    TAC_RET_VOID,
+    TAC_IF,           // if a goto dst
+    TAC_GOTO,         // goto dst
+    TAC_IF_FALSE,     // ifFalse a goto dst
+    TAC_OP_COUNT
+};
+
+enum TacKind : uint8_t {
+    KIND_ANY,   // temps just take whatever they are given
+    KIND_INT,
+    KIND_FLOAT
+};
+
+struct TacValue {
+    union {
+        long long i;
+        double f;
+    };
+    bool is_float;
+
+    TacValue() : i(0), is_float(false) {}
+
+    double as_float() const { return is_float ? f : (double)i; }
+    bool truthy() const { return is_float ? f != 0 : i != 0; }
+};
+
+struct TacInstr {
+    uint8_t op;
+    uint8_t kind;
+    int32_t dst, a, b, c;
+};
+
+struct TacArray {
+    int slot;
+    int base; // offset of the first cell in the frame
+    int size;
+    uint8_t kind;
+};
+
+struct TacFunction {
+    string name;
+    string return_type;
+    vector<int> param_slots;
+    vector<uint8_t> param_kinds;
+
+    vector<string> slot_names;
+    vector<uint8_t> slot_kinds;
+    vector<TacArray> arrays;
+    int frame_size = 0;
+
+    vector<TacInstr> code;
+    vector<int> lines; // line in the TAC text each instruction came from
+    vector<TacValue> constants;
+    map<string, int> labels;
+};
+
+struct TacProgram {
+    vector<TacFunction> functions;
+    map<string, int> function_index;
+
+    // The global frame: named globals then their array cells
+    vector<string> global_names;
+    vector<uint8_t> global_kinds;
+    vector<TacArray> global_arrays;
+    int global_frame_size = 0;
+
+    int find_function(const string& name) const {
+        auto it = function_index.find(name);
+        return it == function_index.end() ? -1 : it->second;
+    }
+};
+
+inline TacValue tac_convert(TacValue v, uint8_t kind) {
+    if (kind == KIND_INT && v.is_float) {
+        v.i = (long long)v.f;
+        v.is_float = false;
+    } else if (kind == KIND_FLOAT && !v.is_float) {
+        v.f = (double)v.i;
+        v.is_float = true;
+    }
+    return v;
+}
+
+// Integer arithmetic wraps around, as it does in the machine backends,
+// rather than overflowing, which C++ leaves undefined
+inline long long tac_int_add(long long a, long long b) { return (long long)((unsigned long long)a + (unsigned long long)b); }
+inline long long tac_int_sub(long long a, long long b) { return (long long)((unsigned long long)a - (unsigned long long)b); }
+inline long long tac_int_mul(long long a, long long b) { return (long long)((unsigned long long)a * (unsigned long long)b); }
+
+// b isn't 0. LLONG_MIN / -1 doesn't fit and traps on x86, so dividing by
+// -1 negates with wraparound instead
+inline long long tac_int_div(long long a, long long b) { return b == -1 ? tac_int_sub(0, a) : a / b; }
+inline long long tac_int_mod(long long a, long long b) { return b == -1 ? 0 : a % b; }
+
+inline uint8_t tac_kind_of(const string& type) {
+    if (type == "int") return KIND_INT;
+    if (type == "float") return KIND_FLOAT;
+    return KIND_ANY;
+}
+
+// Instructions with a jump target in dst
+inline bool tac_is_jump(uint8_t op) {
+    return op == TAC_IF || op == TAC_GOTO || op == TAC_IF_FALSE;
+}
+
+inline bool tac_is_literal(const string& s) {
+    return !s.empty() && (isdigit(s[0]) || s[0] == '.' || (s[0] == '-' && s.size() > 1 && (isdigit(s[1]) || s[1] == '.')));
+}
+
+inline TacValue tac_literal(const string& s) {
+    TacValue v;
+    if (s.find_first_of(".eE") != string::npos) {
+        v.f = strtod(s.c_str(), NULL);
+        v.is_float = true;
+    } else {
+        v.i = strtoll(s.c_str(), NULL, 10);
+    }
+    return v;
+}
+
+// Turns code.txt text into a TacProgram
+class TacLoader {
+private:
+    TacProgram& prog;
+    TacFunction* fn;
+    map<string, int> slot_index;
+    map<string, int> global_index;
+    map<string, int> array_index;        // name -> fn->arrays entry
+    map<string, int> global_array_index; // name -> prog.global_arrays entry
+    vector<pair<int, string>> jump_fixups;
+
+    struct CallFixup {
+        int function;
+        int instr;
+        string callee;
+    };
+    vector<CallFixup> call_fixups;
+    int line_no;
+    string error;
+
+    static string trim(const string& s) {
+        size_t b = s.find_first_not_of(" \t\r");
+        if (b == string::npos) return "";
+        size_t e = s.find_last_not_of(" \t\r");
+        return s.substr(b, e - b + 1);
+    }
+
+    bool fail(const string& msg) {
+        error = "line " + to_string(line_no) + ": " + msg;
+        return false;
+    }
+
+    void emit(uint8_t op, int dst = 0, int a = 0, int b = 0, int c = 0, uint8_t kind = KIND_ANY) {
+        TacInstr in;
+        in.op = op;
+        in.kind = kind;
+        in.dst = dst;
+        in.a = a;
+        in.b = b;
+        in.c = c;
+        fn->code.push_back(in);
+        fn->lines.push_back(line_no);
+    }
+
+    int new_slot(const string& name, uint8_t kind) {
+        int s = fn->slot_names.size();
+        fn->slot_names.push_back(name);
+        fn->slot_kinds.push_back(kind);
+        if (!name.empty()) slot_index[name] = s;
+        return s;
+    }
+
+    int add_constant(TacValue v) {
+        fn->constants.push_back(v);
+        return fn->constants.size() - 1;
+    }
+
+    bool is_global(const string& name) const {
+        return !slot_index.count(name) && global_index.count(name);
+    }
+
+    // Frame slot of a local name, created on first use (temps)
+    int local(const string& name) {
+        auto it = slot_index.find(name);
+        if (it != slot_index.end()) return it->second;
+        return new_slot(name, KIND_ANY);
+    }
+
+    // Any operand as a frame slot; globals and literals are first
+    // materialized into a scratch slot
+    int operand(const string& name) {
+        if (tac_is_literal(name)) {
+            int s = new_slot("", KIND_ANY);
+            emit(TAC_CONST, s, add_constant(tac_literal(name)));
+            return s;
+        }
+        if (is_global(name)) {
+            int s = new_slot("", KIND_ANY);
+            emit(TAC_GET_GLOBAL, s, global_index[name]);
+            return s;
+        }
+        return local(name);
+    }
+
+    void declare(const string& type, const string& decl) {
+        uint8_t kind = tac_kind_of(type);
+        size_t br = decl.find('[');
+        string name = br == string::npos ? decl : decl.substr(0, br);
+        int size = br == string::npos ? 0 : atoi(decl.c_str() + br + 1);
+
+        if (!fn) {
+            int g;
+            if (global_index.count(name)) g = global_index[name];
+            else {
+                g = prog.global_names.size();
+                prog.global_names.push_back(name);
+                prog.global_kinds.push_back(kind);
+                global_index[name] = g;
+            }
+            prog.global_kinds[g] = kind;
+            if (size > 0) {
+                TacArray arr = {g, 0, size, kind};
+                global_array_index[name] = prog.global_arrays.size();
+                prog.global_arrays.push_back(arr);
+            }
+            return;
+        }
+
+        // Nested scopes are flattened: a redeclaration reuses the slot and
+        // later copies into it convert to the newest type
+        int s = local(name);
+        fn->slot_kinds[s] = kind;
+        if (size > 0) {
+            auto it = array_index.find(name);
+            if (it == array_index.end()) {
+                TacArray arr = {s, 0, size, kind};
+                array_index[name] = fn->arrays.size();
+                fn->arrays.push_back(arr);
+            } else {
+                fn->arrays[it->second].size = max(fn->arrays[it->second].size, size);
+                fn->arrays[it->second].kind = kind;
+            }
+        }
+    }
+
+    bool begin_function(const string& header) {
+        // "int name(int a, float b)"
+        size_t sp = header.find(' ');
+        size_t lp = header.find('(');
+        size_t rp = header.rfind(')');
+        if (sp == string::npos || lp == string::npos || rp == string::npos || lp < sp) return fail("bad function header");
+
+        prog.functions.push_back(TacFunction());
+        fn = &prog.functions.back();
+        fn->return_type = header.substr(0, sp);
+        fn->name = trim(header.substr(sp + 1, lp - sp - 1));
+        prog.function_index[fn->name] = prog.functions.size() - 1;
+        slot_index.clear();
+        array_index.clear();
+        jump_fixups.clear();
+
+        stringstream params(header.substr(lp + 1, rp - lp - 1));
+        string param;
+        while (getline(params, param, ',')) {
+            stringstream ps(param);
+            string type, name;
+            ps >> type >> name;
+            if (name.empty()) continue;
+            uint8_t kind = tac_kind_of(type);
+            fn->param_slots.push_back(new_slot(name, kind));
+            fn->param_kinds.push_back(kind);
+        }
+        return true;
+    }
+
+    bool end_function() {
+        if (!fn) return true;
+        for (auto& fix : jump_fixups) {
+            auto it = fn->labels.find(fix.second);
+            if (it == fn->labels.end()) return fail("undefined label " + fix.second + " in " + fn->name);
+            fn->code[fix.first].dst = it->second;
+        }
+        // Array cells go after the slots
+        int cell = fn->slot_names.size();
+        for (auto& arr : fn->arrays) {
+            arr.base = cell;
+            cell += arr.size;
+        }
+        fn->frame_size = cell;
+        for (auto& in : fn->code) {
+            if (in.op == TAC_LOAD_INDEX || in.op == TAC_STORE_INDEX) in.a = fn->arrays[in.a].base;
+        }
+        fn = NULL;
+        return true;
+    }
+
+    // "name[index]" -> array access pieces
+    bool split_index(const string& s, string& name, string& index) {
+        size_t lb = s.find('[');
+        size_t rb = s.rfind(']');
+        if (lb == string::npos || rb == string::npos || rb < lb) return false;
+        name = trim(s.substr(0, lb));
+        index = trim(s.substr(lb + 1, rb - lb - 1));
+        return true;
+    }
+
+    bool array_access(bool store, const string& name, const string& index, int value_slot) {
+        int idx = operand(index);
+        if (!slot_index.count(name) && global_array_index.count(name)) {
+            TacArray& arr = prog.global_arrays[global_array_index[name]];
+            emit(store ? TAC_STORE_GINDEX : TAC_LOAD_GINDEX, value_slot, global_array_index[name], idx, arr.size, arr.kind);
+            return true;
+        }
+        auto it = array_index.find(name);
+        if (it == array_index.end()) return fail(name + " is not an array");
+        TacArray& arr = fn->arrays[it->second];
+        emit(store ? TAC_STORE_INDEX : TAC_LOAD_INDEX, value_slot, it->second, idx, arr.size, arr.kind);
+        return true;
+    }
+
+    bool assignment(const string& lhs, const string& rhs) {
+        string name, index;
+
+        // a[i] = t
+        if (split_index(lhs, name, index)) {
+            return array_access(true, name, index, operand(rhs));
+        }
+
+        // t = call f, n
+        if (rhs.compare(0, 5, "call ") == 0) {
+            size_t comma = rhs.find(',');
+            if (comma == string::npos) return fail("bad call");
+            string callee = trim(rhs.substr(5, comma - 5));
+            int argc = atoi(rhs.c_str() + comma + 1);
+            emit(TAC_CALL, local(lhs), 0, argc);
+            call_fixups.push_back({(int)prog.functions.size() - 1, (int)fn->code.size() - 1, callee});
+            return true;
+        }
+
+        stringstream ss(rhs);
+        vector<string> parts;
+        string part;
+        while (ss >> part) parts.push_back(part);
+
+        if (parts.size() == 3) {
+            static const map<string, uint8_t> binary_ops = {
+                {"+", TAC_ADD}, {"-", TAC_SUB}, {"*", TAC_MUL}, {"/", TAC_DIV}, {"%", TAC_MOD},
+                {"<", TAC_LT}, {">", TAC_GT}, {"<=", TAC_LE}, {">=", TAC_GE}, {"==", TAC_EQ}, {"!=", TAC_NE},
+                {"&&", TAC_AND}, {"||", TAC_OR}};
+            auto op = binary_ops.find(parts[1]);
+            if (op == binary_ops.end()) return fail("unknown operator " + parts[1]);
+            int a = operand(parts[0]);
+            int b = operand(parts[2]);
+            return store_result(lhs, op->second, a, b);
+        }
+        if (parts.size() != 1) return fail("can't decode '" + rhs + "'");
+
+        string src = parts[0];
+        if (split_index(src, name, index)) {
+            if (is_global(lhs)) {
+                int s = new_slot("", KIND_ANY);
+                if (!array_access(false, name, index, s)) return false;
+                emit(TAC_SET_GLOBAL, global_index[lhs], s, 0, 0, prog.global_kinds[global_index[lhs]]);
+                return true;
+            }
+            return array_access(false, name, index, local(lhs));
+        }
+        if ((src[0] == '-' || src[0] == '!' || src[0] == '+') && src.size() > 1 && !tac_is_literal(src)) {
+            int a = operand(src.substr(1));
+            if (src[0] == '+') return copy(lhs, a);
+            return store_result(lhs, src[0] == '-' ? TAC_NEG : TAC_NOT, a, 0);
+        }
+        if (tac_is_literal(src) && !is_global(lhs)) {
+            int d = local(lhs);
+            TacValue v = tac_convert(tac_literal(src), fn->slot_kinds[d]);
+            emit(TAC_CONST, d, add_constant(v));
+            return true;
+        }
+        return copy(lhs, operand(src));
+    }
+
+    bool copy(const string& lhs, int src) {
+        if (is_global(lhs)) {
+            int g = global_index[lhs];
+            emit(TAC_SET_GLOBAL, g, src, 0, 0, prog.global_kinds[g]);
+        } else {
+            int d = local(lhs);
+            emit(TAC_COPY, d, src, 0, 0, fn->slot_kinds[d]);
+        }
+        return true;
+    }
+
+    bool store_result(const string& lhs, uint8_t op, int a, int b) {
+        if (is_global(lhs)) {
+            int s = new_slot("", KIND_ANY);
+            emit(op, s, a, b);
+            return copy(lhs, s);
+        }
+        int d = local(lhs);
+        if (fn->slot_kinds[d] == KIND_ANY) {
+            emit(op, d, a, b);
+            return true;
+        }
+        // Typed variable: compute into a scratch slot, then convert
+        int s = new_slot("", KIND_ANY);
+        emit(op, s, a, b);
+        return copy(lhs, s);
+    }
+
+    bool line(string text) {
+        text = trim(text);
+        if (text.empty()) {
+            // FuncDeclNode ends every function with a blank line
+            return end_function();
+        }
+        if (text.compare(0, 2, "//") == 0) {
+            string body = trim(text.substr(2));
+            if (body.compare(0, 9, "Function:") == 0) {
+                if (!end_function()) return false;
+                return begin_function(trim(body.substr(9)));
+            }
+            if (body.compare(0, 12, "Declaration:") == 0) {
+                stringstream ds(body.substr(12));
+                string type, decl;
+                ds >> type >> decl;
+                declare(type, decl);
+            }
+            return true;
+        }
+        if (!fn) return fail("code outside of a function");
+
+        if (text.back() == ':') {
+            fn->labels[text.substr(0, text.size() - 1)] = fn->code.size();
+            return true;
+        }
+        if (text.compare(0, 5, "goto ") == 0) {
+            emit(TAC_GOTO);
+            jump_fixups.push_back(make_pair((int)fn->code.size() - 1, trim(text.substr(5))));
+            return true;
+        }
+        bool if_false = text.compare(0, 8, "ifFalse ") == 0;
+        if (text.compare(0, 3, "if ") == 0 || if_false) {
+            size_t g = text.find(" goto ");
+            if (g == string::npos) return fail("bad if");
+            size_t skip = if_false ? 8 : 3;
+            string cond = trim(text.substr(skip, g - skip));
+            if (cond.empty()) return fail("if without a condition");
+            int c = operand(cond);
+            emit(if_false ? TAC_IF_FALSE : TAC_IF, 0, c);
+            jump_fixups.push_back(make_pair((int)fn->code.size() - 1, trim(text.substr(g + 6))));
+            return true;
+        }
+        if (text.compare(0, 6, "param ") == 0) {
+            emit(TAC_PARAM, 0, operand(trim(text.substr(6))));
+            return true;
+        }
+        if (text == "return") {
+            emit(TAC_RET_VOID);
+            return true;
+        }
+        if (text.compare(0, 7, "return ") == 0) {
+            emit(TAC_RET, 0, operand(trim(text.substr(7))));
+            return true;
+        }
+        size_t eq = text.find(" = ");
+        if (eq == string::npos) return fail("can't decode '" + text + "'");
+        return assignment(trim(text.substr(0, eq)), trim(text.substr(eq + 3)));
+    }
+
+public:
+    TacLoader(TacProgram& p) : prog(p), fn(NULL), line_no(0) {}
+
+    bool load(istream& in) {
+        string text;
+        while (getline(in, text)) {
+            line_no++;
+            if (!line(text)) return false;
+        }
+        if (!end_function()) return false;
+
+        // Calls can refer to functions defined later in the file
+        for (auto& fix : call_fixups) {
+            TacFunction& caller = prog.functions[fix.function];
+            int callee = prog.find_function(fix.callee);
+            if (callee < 0) {
+                error = "call to undefined function " + fix.callee + " in " + caller.name;
+                return false;
+            }
+            caller.code[fix.instr].a = callee;
+        }
+
+        int cell = prog.global_names.size();
+        for (auto& arr : prog.global_arrays) {
+            arr.base = cell;
+            cell += arr.size;
+        }
+        prog.global_frame_size = cell;
+        for (auto& f : prog.functions) {
+            for (auto& in : f.code) {
+                if (in.op == TAC_LOAD_GINDEX || in.op == TAC_STORE_GINDEX) in.a = prog.global_arrays[in.a].base;
+            }
+        }
+        return true;
+    }
+
+    const string& get_error() const { return error; }
+};
+
+struct TacRunStats {
+    long long instructions = 0;
+    long long dispatches = 0; // less than instructions when some were fused
+    long long calls = 0;
+    double seconds = 0;
+};
+
+// Execution counts recorded by TacVM when it has a profile attached
+struct TacProfile {
+    vector<vector<long long>> counts; // per function, per instruction
+    vector<vector<long long>> taken;  // per function, per instruction: ifs that jumped
+    vector<long long> calls;          // per function
+
+    void reset(const TacProgram& prog) {
+        counts.assign(prog.functions.size(), vector<long long>());
+        taken.assign(prog.functions.size(), vector<long long>());
+        for (size_t f = 0; f < prog.functions.size(); f++) {
+            counts[f].assign(prog.functions[f].code.size(), 0);
+            taken[f].assign(prog.functions[f].code.size(), 0);
+        }
+        calls.assign(prog.functions.size(), 0);
+    }
+};
+
+// Switch-dispatched interpreter over a decoded TacProgram
+class TacVM {
+private:
+    const TacProgram& prog;
+    vector<TacValue> stack;   // all frames, allocated once
+    vector<TacValue> globals;
+    vector<TacValue> args;
+
+    struct CallRecord {
+        const TacFunction* fn;
+        int pc;
+        TacValue* fp;
+        int dst;
+    };
+
+    // Profiling is a template parameter so plain runs don't pay for it
+    template <bool PROFILE>
+    bool execute(int f, TacValue& result, string& error) {
+        const TacFunction* fn = &prog.functions[f];
+        long long* counts = NULL;
+        long long* taken = NULL;
+        if (PROFILE) {
+            profile->reset(prog);
+            profile->calls[f] = 1;
+        }
+#define TAC_PROFILE_FUNCTION()                                                 \
+        if (PROFILE) {                                                       \
+            counts = profile->counts[fn - prog.functions.data()].data();     \
+            taken = profile->taken[fn - prog.functions.data()].data();       \
+        }
+        TAC_PROFILE_FUNCTION()
+
+        globals.assign(prog.global_frame_size, TacValue());
+        args.clear();
+        stats = TacRunStats();
+        auto start = chrono::steady_clock::now();
+
+        vector<CallRecord> frames;
+        TacValue* fp = stack.data();
+        TacValue* stack_end = stack.data() + stack.size();
+        fill(fp, fp + fn->frame_size, TacValue());
+        const TacInstr* code = fn->code.data();
+        const TacValue* consts = fn->constants.data();
+        int pc = 0;
+        int code_size = fn->code.size();
+        long long steps = 0;
+        result = TacValue();
+        bool ok = true;
+
+        while (true) {
+            if (pc >= code_size) {
+                // Fell off the end: same as a void return
+                TacValue none;
+                if (frames.empty()) {
+                    result = none;
+                    break;
+                }
+                CallRecord& ret = frames.back();
+                fn = ret.fn;
+                fp = ret.fp;
+                pc = ret.pc;
+                fp[ret.dst] = none;
+                frames.pop_back();
+                code = fn->code.data();
+                consts = fn->constants.data();
+                code_size = fn->code.size();
+                TAC_PROFILE_FUNCTION()
+                continue;
+            }
+            if (steps == max_steps) {
+                error = "step limit of " + to_string(max_steps) + " instructions reached in " + fn->name;
+                ok = false;
+                break;
+            }
+            steps++;
+            if (PROFILE) counts[pc]++;
+            const TacInstr& in = code[pc++];
+            switch (in.op) {
+            case TAC_NOP:
+                break;
+            case TAC_CONST:
+                fp[in.dst] = consts[in.a];
+                break;
+            case TAC_COPY:
+                fp[in.dst] = tac_convert(fp[in.a], in.kind);
+                break;
+            case TAC_GET_GLOBAL:
+                fp[in.dst] = globals[in.a];
+                break;
+            case TAC_SET_GLOBAL:
+                globals[in.dst] = tac_convert(fp[in.a], in.kind);
+                break;
+
+#define TAC_ARITH(OP, INT_OP)                                                \
+                {                                                            \
+                    const TacValue& x = fp[in.a];                            \
+                    const TacValue& y = fp[in.b];                            \
+                    TacValue r;                                              \
+                    if (x.is_float | y.is_float) {                           \
+                        r.f = x.as_float() OP y.as_float();                  \
+                        r.is_float = true;                                   \
+                    } else {                                                 \
+                        r.i = INT_OP(x.i, y.i);                              \
+                    }                                                        \
+                    fp[in.dst] = r;                                          \
+                }
+#define TAC_COMPARE(OP)                                                      \
+                {                                                            \
+                    const TacValue& x = fp[in.a];                            \
+                    const TacValue& y = fp[in.b];                            \
+                    TacValue r;                                              \
+                    if (x.is_float | y.is_float) r.i = x.as_float() OP y.as_float(); \
+                    else r.i = x.i OP y.i;                                   \
+                    fp[in.dst] = r;                                          \
+                }
+
+            case TAC_ADD: TAC_ARITH(+, tac_int_add) break;
+            case TAC_SUB: TAC_ARITH(-, tac_int_sub) break;
+            case TAC_MUL: TAC_ARITH(*, tac_int_mul) break;
+            case TAC_DIV: {
+                const TacValue& y = fp[in.b];
+                if (!y.is_float && !fp[in.a].is_float && y.i == 0) {
+                    error = "division by zero in " + fn->name;
+                    ok = false;
+                    break;
+                }
+                TAC_ARITH(/, tac_int_div)
+                break;
+            }
+            case TAC_MOD: {
+                TacValue x = tac_convert(fp[in.a], KIND_INT);
+                TacValue y = tac_convert(fp[in.b], KIND_INT);
+                if (y.i == 0) {
+                    error = "modulus by zero in " + fn->name;
+                    ok = false;
+                    break;
+                }
+                TacValue r;
+                r.i = tac_int_mod(x.i, y.i);
+                fp[in.dst] = r;
+                break;
+            }
+            case TAC_LT: TAC_COMPARE(<) break;
+            case TAC_GT: TAC_COMPARE(>) break;
+            case TAC_LE: TAC_COMPARE(<=) break;
+            case TAC_GE: TAC_COMPARE(>=) break;
+            case TAC_EQ: TAC_COMPARE(==) break;
+            case TAC_NE: TAC_COMPARE(!=) break;
+#undef TAC_ARITH
+#undef TAC_COMPARE
+            case TAC_AND: {
+                TacValue r;
+                r.i = fp[in.a].truthy() && fp[in.b].truthy();
+                fp[in.dst] = r;
+                break;
+            }
+            case TAC_OR: {
+                TacValue r;
+                r.i = fp[in.a].truthy() || fp[in.b].truthy();
+                fp[in.dst] = r;
+                break;
+            }
+            case TAC_NEG: {
+                TacValue r = fp[in.a];
+                if (r.is_float) r.f = -r.f;
+                else r.i = tac_int_sub(0, r.i);
+                fp[in.dst] = r;
+                break;
+            }
+            case TAC_NOT: {
+                TacValue r;
+                r.i = !fp[in.a].truthy();
+                fp[in.dst] = r;
+                break;
+            }
+            case TAC_LOAD_INDEX:
+            case TAC_STORE_INDEX:
+            case TAC_LOAD_GINDEX:
+            case TAC_STORE_GINDEX: {
+                TacValue idx = tac_convert(fp[in.b], KIND_INT);
+                if (idx.i < 0 || idx.i >= in.c) {
+                    error = "array index " + to_string(idx.i) + " out of bounds in " + fn->name;
+                    ok = false;
+                    break;
+                }
+                TacValue* base = (in.op == TAC_LOAD_INDEX || in.op == TAC_STORE_INDEX) ? fp : globals.data();
+                if (in.op == TAC_LOAD_INDEX || in.op == TAC_LOAD_GINDEX) fp[in.dst] = base[in.a + idx.i];
+                else base[in.a + idx.i] = tac_convert(fp[in.dst], in.kind);
+                break;
+            }
+            case TAC_PARAM:
+                args.push_back(fp[in.a]);
+                break;
+            case TAC_CALL: {
+                const TacFunction* callee = &prog.functions[in.a];
+                if ((size_t)in.b != callee->param_slots.size() || args.size() < (size_t)in.b) {
+                    error = "call to " + callee->name + " with " + to_string(in.b) + " arguments";
+                    ok = false;
+                    break;
+                }
+                TacValue* callee_fp = fp + fn->frame_size;
+                if (callee_fp + callee->frame_size > stack_end || frames.size() >= max_depth) {
+                    error = "stack overflow calling " + callee->name;
+                    ok = false;
+                    break;
+                }
+                frames.push_back({fn, pc, fp, in.dst});
+                fill(callee_fp, callee_fp + callee->frame_size, TacValue());
+                size_t first = args.size() - in.b;
+                for (int k = 0; k < in.b; k++) {
+                    callee_fp[callee->param_slots[k]] = tac_convert(args[first + k], callee->param_kinds[k]);
+                }
+                args.resize(first);
+                stats.calls++;
+                if (PROFILE) profile->calls[in.a]++;
+                fn = callee;
+                fp = callee_fp;
+                code = fn->code.data();
+                consts = fn->constants.data();
+                code_size = fn->code.size();
+                TAC_PROFILE_FUNCTION()
+                pc = 0;
+                break;
+            }
+            case TAC_RET:
+            case TAC_RET_VOID: {
+                TacValue value;
+                if (in.op == TAC_RET) value = tac_convert(fp[in.a], tac_kind_of(fn->return_type));
+                if (frames.empty()) {
+                    result = value;
+                    pc = -1;
+                    break;
+                }
+                CallRecord& ret = frames.back();
+                fn = ret.fn;
+                fp = ret.fp;
+                pc = ret.pc;
+                fp[ret.dst] = value;
+                frames.pop_back();
+                code = fn->code.data();
+                consts = fn->constants.data();
+                code_size = fn->code.size();
+                TAC_PROFILE_FUNCTION()
+                break;
+            }
+            case TAC_IF:
+                if (fp[in.a].truthy()) {
+                    if (PROFILE) taken[pc - 1]++;
+                    pc = in.dst;
+                }
+                break;
+            case TAC_GOTO:
+                pc = in.dst;
+                break;
+            case TAC_IF_FALSE:
+                if (!fp[in.a].truthy()) {
+                    if (PROFILE) taken[pc - 1]++;
+                    pc = in.dst;
+                }
+                break;
+            default:
+                error = "bad opcode " + to_string(in.op);
+                ok = false;
+                break;
+            }
+            if (!ok || pc < 0) break;
+        }
+
+        stats.instructions = steps;
+        stats.dispatches = steps;
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return ok;
+#undef TAC_PROFILE_FUNCTION
+    }
+
+public:
+    long long max_steps;
+    size_t max_depth;
+    TacRunStats stats;
+    TacProfile* profile; // counts are recorded here when set
+
+    TacVM(const TacProgram& p, size_t stack_values = 1 << 22)
+        : prog(p), stack(stack_values), max_steps(1000000000LL), max_depth(100000), profile(NULL) {}
+
+    bool run(const string& entry, TacValue& result, string& error) {
+        int f = prog.find_function(entry);
+        if (f < 0) {
+            error = "no function named " + entry;
+            return false;
+        }
+        const TacFunction* fn = &prog.functions[f];
+        if (!fn->param_slots.empty()) {
+            error = entry + " takes parameters";
+            return false;
+        }
+        if ((size_t)fn->frame_size > stack.size()) {
+            error = "stack overflow";
+            return false;
+        }
+        return profile ? execute<true>(f, result, error) : execute<false>(f, result, error);
+    }
+};
+
+inline string tac_value_string(const TacValue& v) {
+    if (!v.is_float) return to_string(v.i);
+    stringstream ss;
+    ss << v.f;
+    return ss.str();
+}
+
+// Loads TAC from a code.txt file, or compiles a .c file first
+// In tac_bytecode.h
+bool load_tac_bytecode(const char* data, size_t size, TacProgram& prog, string& error);
+
+bool load_tac_program(const string& path, TacProgram& prog, string& error) {
+    string text;
+    ifstream in(path.c_str(), ios::binary);
+    if (!in) {
+        error = "couldn't open " + path;
+        return false;
+    }
+    stringstream ss;
+    ss << in.rdbuf();
+    text = ss.str();
+
+    if (text.compare(0, 4, "TACB") == 0) return load_tac_bytecode(text.data(), text.size(), prog, error);
+    if (path.size() > 2 && path.compare(path.size() - 2, 2, ".c") == 0) {
+        CompileOptions options;
+        options.generate_log = false;
+        CompileResult compiled = compile(text, options);
+        if (!compiled.ok) {
+            error = "compilation failed:\n" + compiled.errors;
+            return false;
+        }
+        text = compiled.tac;
+    }
+
+    stringstream code(text);
+    TacLoader loader(prog);
+    if (!loader.load(code)) {
+        error = loader.get_error();
+        return false;
+    }
+    return true;
+}
+
+// ./compiler --run file [--entry NAME] [--max-steps N]
+// file is TAC (code.txt), its bytecode (code.bin) or a source file, which is
+// compiled first
+int run_tac(int argc, char *argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " --run file [--entry NAME] [--max-steps N]" << endl;
+        return 1;
+    }
+    string entry = "main";
+    long long max_steps = 1000000000LL;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--entry") entry = argv[i + 1];
+        else if (arg == "--max-steps") max_steps = atoll(argv[i + 1]);
+    }
+
+    TacProgram prog;
+    string error;
+    if (!load_tac_program(argv[2], prog, error)) {
+        cout << "Couldn't load TAC: " << error << endl;
+        return 1;
+    }
+
+    TacVM vm(prog);
+    vm.max_steps = max_steps;
+    TacValue result;
+    bool ok = vm.run(entry, result, error);
+
+    if (ok) cout << entry << " returned " << tac_value_string(result) << endl;
+    else cout << "Runtime error: " << error << endl;
+    cout << "Executed " << vm.stats.instructions << " instructions, " << vm.stats.calls << " calls in "
+         << vm.stats.seconds * 1000 << " ms" << endl;
+    return ok ? 0 : 1;
+}
+
+#endif // TAC_VM_H
@@ -2,6 +2,7 @@
 #define THREE_ADDR_CODE_H
 
 #include "ast.h"
+#include "flat_ast.h"
 #include <fstream>
 #include <string>
 #include <map>
@@ -11,43 +12,52 @@ using namespace std;
 class ThreeAddrCodeGenerator {
 private:
     ProgramNode* ast_root;
-    ofstream& outcode;
+    FlatView flat; // lowered instead of ast_root when that's NULL
+    ostream& outcode;
     map<string, string> symbol_to_temp;
     int temp_count;
     int label_count;
 
 public:
-    ThreeAddrCodeGenerator(ProgramNode* root, ofstream& out)
-        : ast_root(root), outcode(out), temp_count(0), label_count(0) {}
+    ThreeAddrCodeGenerator(ProgramNode* root, ostream& out)
+        : ast_root(root), flat(), outcode(out), temp_count(0), label_count(0) {}
+
+    ThreeAddrCodeGenerator(const FlatAst& flat_ast, ostream& out)
+        : ast_root(NULL), flat(flat_ast.view()), outcode(out), temp_count(0), label_count(0) {}
+
+    ThreeAddrCodeGenerator(const FlatView& flat_view, ostream& out)
+        : ast_root(NULL), flat(flat_view), outcode(out), temp_count(0), label_count(0) {}
 
     void generate() {
         // TODO: Implement this method
         // This method should:
         // 1. Write a header to the output file
 
-        outcode << "//========== THREE ADDRESS CODE ==========" << endl;
+        outcode << "//========== THREE ADDRESS CODE ==========" << "\n";
 
-        outcode << ""<< endl;
+        outcode << ""<< "\n";
 
-        outcode << "// This code was generated by a two-pass compiler" << endl;
-        outcode << "// Format: " << endl;
-        outcode << "// - t0, t1, etc. are temporary variables" << endl;
-        outcode << "// - L0, L1, etc. are labels for jumps" << endl;
-        outcode << "// - Operations follow the three-address code format" << endl;
+        outcode << "// This code was generated by a two-pass compiler" << "\n";
+        outcode << "// Format: " << "\n";
+        outcode << "// - t0, t1, etc. are temporary variables" << "\n";
+        outcode << "// - L0, L1, etc. are labels for jumps" << "\n";
+        outcode << "// - Operations follow the three-address code format" << "\n";
 
-        outcode << ""<< endl;
+        outcode << ""<< "\n";
 
-        outcode << "// Three Address Code" << endl << endl;
+        outcode << "// Three Address Code" << "\n\n";
 
-        // 2. Call the generate_code method of the AST root
+        // 2. Generate code for the AST root
         if (ast_root) {
-            ast_root->generate_code(outcode, symbol_to_temp, temp_count, label_count);
+            ast_generate(ast_root, outcode, symbol_to_temp, temp_count, label_count);
+        } else if (flat.root != FLAT_NONE && flat.root < flat.size()) {
+            FlatTacWriter(flat, outcode, symbol_to_temp, temp_count, label_count).lower(flat.root);
         }
 
-        outcode << ""<< endl;
+        outcode << ""<< "\n";
 
         // 3. Write a footer to the output file
-        outcode << "//========== END OF CODE ==========" << endl;
+        outcode << "//========== END OF CODE ==========" << "\n";
     }
 
     // You may add helper methods here
@@ -0,0 +1,226 @@
+#ifndef WATCH_MODE_H
+#define WATCH_MODE_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "incremental.h"
+#include "batch_driver.h"
+
+using namespace std;
+
+// --watch: compiles the given files, then again whenever one of them is
+// saved, until interrupted.
+//
+// inotify watches the directories the files are in rather than the files,
+// because many editors save by writing a new file and renaming it over the
+// old one, which ends a watch on the file itself. Events arriving within a
+// few milliseconds of each other are handled as one rebuild, and a file
+// whose bytes haven't changed isn't compiled again. All the files go
+// through one IncrementalCompiler, so an edit to one function recompiles
+// just that function where it can.
+
+struct WatchedFile {
+    string path;
+    string name;        // within its directory
+    int dir_watch;
+    string out_prefix;  // as for --batch, see BatchDriver::output_prefix
+    uint64_t content;   // hash of the last bytes compiled
+    bool compiled;
+};
+
+class SourceWatcher {
+private:
+    vector<WatchedFile> files;
+    string out_dir;
+    int fd;
+    map<string, int> dir_watches; // directory -> watch descriptor
+    IncrementalCompiler incremental;
+    size_t rebuilds = 0;
+
+    static string directory_of(const string& path) {
+        size_t slash = path.rfind('/');
+        if (slash == string::npos) return ".";
+        return slash == 0 ? "/" : path.substr(0, slash);
+    }
+
+    // Writes one output of file; says so and returns false if it can't
+    static bool write_output(const string& path, const string& text) {
+        ofstream out(path.c_str(), ios::binary | ios::trunc);
+        out.write(text.data(), text.size());
+        out.close();
+        if (!out) cout << "Couldn't write " << path << endl;
+        return (bool)out;
+    }
+
+    // Compiles file if its bytes changed. seen is when the change that
+    // led here was noticed, or NULL for the first build.
+    void rebuild(WatchedFile& file, const chrono::steady_clock::time_point* seen) {
+        auto start = chrono::steady_clock::now();
+        ifstream in(file.path.c_str(), ios::binary);
+        if (!in) {
+            if (!seen) cout << file.path << ": couldn't open" << endl;
+            return;
+        }
+        stringstream ss;
+        ss << in.rdbuf();
+        string source = ss.str();
+        uint64_t content = fnv1a(source);
+        if (file.compiled && content == file.content) return;
+        file.content = content;
+        file.compiled = true;
+
+        IncrementalStats stats;
+        CompileResult result = incremental.compile(source, &stats);
+        bool written = write_output(file.out_prefix + ".code.txt", result.tac);
+        written = write_output(file.out_prefix + ".error.txt", result.errors) && written;
+        // Compile it again on the next event even if it hasn't changed, so
+        // the outputs get another chance
+        if (!written) file.compiled = false;
+        auto end = chrono::steady_clock::now();
+        rebuilds++;
+
+        cout << file.path << ": ";
+        if (stats.split) cout << stats.misses << " of " << stats.functions << " functions compiled";
+        else cout << "compiled whole";
+        cout << ", " << (result.ok ? "ok" : to_string(result.stats.errors) + " errors") << ", "
+             << chrono::duration<double>(end - start).count() * 1000 << " ms";
+        if (seen) cout << " (" << chrono::duration<double>(end - *seen).count() * 1000 << " ms after the change was seen)";
+        cout << endl;
+    }
+
+public:
+    SourceWatcher(const string& out_dir) : out_dir(out_dir), fd(-1) {}
+    ~SourceWatcher() {
+        if (fd >= 0) close(fd);
+    }
+
+    void add(const string& path) {
+        WatchedFile file;
+        file.path = path;
+        size_t slash = path.rfind('/');
+        file.name = slash == string::npos ? path : path.substr(slash + 1);
+        file.dir_watch = -1;
+        file.out_prefix = BatchDriver::output_prefix(out_dir, path);
+        file.content = 0;
+        file.compiled = false;
+        files.push_back(file);
+    }
+
+    // Builds everything, then rebuilds on changes until max_rebuilds
+    // rebuilds after the first build have been done (forever by default)
+    int run(size_t max_rebuilds = SIZE_MAX) {
+        if (files.empty()) {
+            cout << "No input files given" << endl;
+            return 1;
+        }
+        for (const WatchedFile& file : files) {
+            string dir = file.out_prefix.substr(0, file.out_prefix.rfind('/'));
+            if (!BatchDriver::make_dirs(dir)) {
+                cout << "Couldn't create " << dir << ": " << strerror(errno) << endl;
+                return 1;
+            }
+        }
+        fd = inotify_init1(IN_CLOEXEC);
+        if (fd < 0) {
+            cout << "inotify isn't available" << endl;
+            return 1;
+        }
+        for (WatchedFile& file : files) {
+            string dir = directory_of(file.path);
+            auto it = dir_watches.find(dir);
+            if (it == dir_watches.end()) {
+                int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+                if (wd < 0) {
+                    cout << "Couldn't watch " << dir << endl;
+                    return 1;
+                }
+                it = dir_watches.insert(make_pair(dir, wd)).first;
+            }
+            file.dir_watch = it->second;
+        }
+
+        for (WatchedFile& file : files) rebuild(file, NULL);
+        size_t first_build = rebuilds;
+        cout << "Watching " << files.size() << (files.size() == 1 ? " file" : " files") << ", outputs in " << out_dir
+             << endl;
+
+        alignas(struct inotify_event) char buffer[16384];
+        while (rebuilds - first_build < max_rebuilds) {
+            // Block for the first event, then collect whatever follows it
+            // closely, so one save is one rebuild
+            vector<bool> touched(files.size(), false);
+            auto first_event = chrono::steady_clock::now();
+            int timeout = -1;
+            for (;;) {
+                struct pollfd p = {fd, POLLIN, 0};
+                int ready = poll(&p, 1, timeout);
+                if (ready < 0 && errno == EINTR) continue;
+                if (ready == 0) break; // quiet for a while, the save is over
+                ssize_t n = ready < 0 ? -1 : read(fd, buffer, sizeof(buffer));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    cout << "Couldn't read file events: " << (n < 0 ? strerror(errno) : "end of file") << endl;
+                    return 1;
+                }
+                if (timeout < 0) first_event = chrono::steady_clock::now();
+                for (char* at = buffer; at < buffer + n;) {
+                    struct inotify_event* e = (struct inotify_event*)at;
+                    // The directory went away, so its files can't be rebuilt
+                    if (e->mask & IN_IGNORED) {
+                        for (auto& d : dir_watches) {
+                            if (d.second == e->wd) cout << "Stopped watching " << d.first << ", it was removed" << endl;
+                        }
+                        return 1;
+                    }
+                    // Events were dropped; unchanged files are skipped anyway
+                    if (e->mask & IN_Q_OVERFLOW) touched.assign(files.size(), true);
+                    if (e->len) {
+                        for (size_t i = 0; i < files.size(); i++) {
+                            if (files[i].dir_watch == e->wd && files[i].name == e->name) touched[i] = true;
+                        }
+                    }
+                    at += sizeof(struct inotify_event) + e->len;
+                }
+                timeout = 5;
+            }
+            for (size_t i = 0; i < files.size(); i++) {
+                if (touched[i]) rebuild(files[i], &first_event);
+            }
+        }
+        cout << "Hits " << incremental.hits() << ", misses " << incremental.misses() << " ("
+             << incremental.hit_rate() * 100 << "% hit rate)" << endl;
+        return 0;
+    }
+};
+
+// ./compiler --watch [-o DIR] [-n REBUILDS] file...
+int run_watch(int argc, char *argv[])
+{
+    string out_dir = "watch_out";
+    size_t max_rebuilds = SIZE_MAX;
+    vector<string> inputs;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) out_dir = argv[++i];
+        else if (arg == "-n" && i + 1 < argc) max_rebuilds = strtoul(argv[++i], NULL, 10);
+        else inputs.push_back(arg);
+    }
+    SourceWatcher watcher(out_dir);
+    for (const string& in : inputs) watcher.add(in);
+    return watcher.run(max_rebuilds);
+}
+
+#endif // WATCH_MODE_H
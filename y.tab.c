@@ -1,21 +1,22 @@
-/* A Bison parser, made by GNU Bison 2.7.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989-1990, 2000-2012 Free Software Foundation, Inc.
-   
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -26,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.7"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -61,14 +66,35 @@
 
 
 
-/* Copy the first part of user declarations.  */
-/* Line 371 of yacc.c  */
+/* First part of user prologue.  */
 #line 1 "22101088_22101357.y"
 
 
 #include "symbol_table.h"
 #include "ast.h"
 #include "three_addr_code.h"
+#include "ast_passes.h"
+#include "compiler.h"
+#include "mapped_source.h"
+#include "flat_ast_file.h"
+#include "output_buffer.h"
+#include "ast_bench.h"
+#include "batch_driver.h"
+#include "compile_server.h"
+#include "tac_vm.h"
+#include "tac_threaded.h"
+#include "tac_bytecode.h"
+#include "tac_native.h"
+#include "tac_jit.h"
+#include "tac_c_backend.h"
+#include "tac_profile.h"
+#include "tac_layout.h"
+#include "tac_census.h"
+#include "ast_stress.h"
+#include "incremental.h"
+#include "compile_cache.h"
+#include "watch_mode.h"
+#include "program_generator.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -76,17 +102,44 @@
 /* Define the type for all grammar symbols */
 #define YYSTYPE symbol_info*
 
+/* Bison only grows its stacks in C++ when it's told the value type can
+   be copied as raw bytes, which a pointer can. Without this they stay at
+   200 entries and a few hundred nested parentheses or ifs fail with
+   "memory exhausted". Past bison's default 10000 entries, only memory
+   limits nesting. */
+#define YYSTYPE_IS_TRIVIAL 1
+#define YYMAXDEPTH 100000000
+
 extern FILE *yyin;
+void yyrestart(FILE *input_file);
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+YY_BUFFER_STATE yy_scan_buffer(char *base, unsigned int size);
+void yy_delete_buffer(YY_BUFFER_STATE b);
 int yyparse(void);
 int yylex(void);
 extern YYSTYPE yylval;
+extern char *yytext;
+extern int yyleng;
 
 symbol_table *symtbl = new symbol_table();
 ProgramNode* ast_root = new ProgramNode();
+FlatAst flat_ast; // built alongside the node tree while flat_ast.enabled is set
+bool lower_flat_ast = false; // --flat-ast: generate code from flat_ast instead
+bool time_passes = false; // --time-passes: print the pass timing after compiling
 
 int lines = 1;
 int errors = 0;
-ofstream outlog, outerror, outcode;
+// The output streams get attached to files (compile_file) or to in-memory
+// sinks (compile_in_place) before each compilation
+ostream outlog(NULL), outerror(NULL), outcode(NULL);
+OutputBuffer log_out, error_out, code_out;
+
+bool scan_mapped = false; // --mmap: map input files instead of reading them through yyin
+bool emit_bytecode = false; // --bytecode: also write code.bin next to code.txt
+string pgo_profile; // --pgo FILE: lay code.txt out for this profile
+string emit_ast_path; // --emit-ast FILE: also save the flat tree there
+string cache_dir; // --cache DIR: reuse the outputs of earlier identical compiles
+size_t cache_max_mb = 256; // --cache-size MB: bound on the cache directory
 
 string varlist=""; //for variable declarartion list
 vector<string>paramlist; //for parameter list fot func dec and func def
@@ -99,8 +152,8 @@ string ret_type, func_name, func_ret_type;
 
 void yyerror(char *s)
 {
-	outlog<<"At line "<<lines<<" "<<s<<endl<<endl;
-	outerror<<"At line "<<lines<<" "<<s<<endl<<endl;
+	outlog<<"At line "<<lines<<" "<<s<<"\n\n";
+	outerror<<"At line "<<lines<<" "<<s<<"\n\n";
 	errors++;
 	
 	varlist = "";
@@ -114,30 +167,34 @@ void yyerror(char *s)
 }
 
 
-/* Line 371 of yacc.c  */
-#line 119 "y.tab.c"
+#line 171 "y.tab.c"
 
-# ifndef YY_NULL
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULL nullptr
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
 #  else
-#   define YY_NULL 0
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* In a future release of Bison, this section will be replaced
-   by #include "y.tab.h".  */
+/* Use api.header.include to #include this header
+   instead of duplicating it here.  */
 #ifndef YY_YY_Y_TAB_H_INCLUDED
 # define YY_YY_Y_TAB_H_INCLUDED
-/* Enabling traces.  */
+/* Debug traces.  */
 #ifndef YYDEBUG
 # define YYDEBUG 1
 #endif
@@ -145,52 +202,60 @@ void yyerror(char *s)
 extern int yydebug;
 #endif
 
-/* Tokens.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     IF = 258,
-     ELSE = 259,
-     FOR = 260,
-     WHILE = 261,
-     DO = 262,
-     BREAK = 263,
-     INT = 264,
-     CHAR = 265,
-     FLOAT = 266,
-     DOUBLE = 267,
-     VOID = 268,
-     RETURN = 269,
-     SWITCH = 270,
-     CASE = 271,
-     DEFAULT = 272,
-     CONTINUE = 273,
-     PRINTLN = 274,
-     ADDOP = 275,
-     MULOP = 276,
-     INCOP = 277,
-     DECOP = 278,
-     RELOP = 279,
-     ASSIGNOP = 280,
-     LOGICOP = 281,
-     NOT = 282,
-     LPAREN = 283,
-     RPAREN = 284,
-     LCURL = 285,
-     RCURL = 286,
-     LTHIRD = 287,
-     RTHIRD = 288,
-     COMMA = 289,
-     SEMICOLON = 290,
-     CONST_INT = 291,
-     CONST_FLOAT = 292,
-     ID = 293,
-     LOWER_THAN_ELSE = 294
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    IF = 258,                      /* IF  */
+    ELSE = 259,                    /* ELSE  */
+    FOR = 260,                     /* FOR  */
+    WHILE = 261,                   /* WHILE  */
+    DO = 262,                      /* DO  */
+    BREAK = 263,                   /* BREAK  */
+    INT = 264,                     /* INT  */
+    CHAR = 265,                    /* CHAR  */
+    FLOAT = 266,                   /* FLOAT  */
+    DOUBLE = 267,                  /* DOUBLE  */
+    VOID = 268,                    /* VOID  */
+    RETURN = 269,                  /* RETURN  */
+    SWITCH = 270,                  /* SWITCH  */
+    CASE = 271,                    /* CASE  */
+    DEFAULT = 272,                 /* DEFAULT  */
+    CONTINUE = 273,                /* CONTINUE  */
+    PRINTLN = 274,                 /* PRINTLN  */
+    ADDOP = 275,                   /* ADDOP  */
+    MULOP = 276,                   /* MULOP  */
+    INCOP = 277,                   /* INCOP  */
+    DECOP = 278,                   /* DECOP  */
+    RELOP = 279,                   /* RELOP  */
+    ASSIGNOP = 280,                /* ASSIGNOP  */
+    LOGICOP = 281,                 /* LOGICOP  */
+    NOT = 282,                     /* NOT  */
+    LPAREN = 283,                  /* LPAREN  */
+    RPAREN = 284,                  /* RPAREN  */
+    LCURL = 285,                   /* LCURL  */
+    RCURL = 286,                   /* RCURL  */
+    LTHIRD = 287,                  /* LTHIRD  */
+    RTHIRD = 288,                  /* RTHIRD  */
+    COMMA = 289,                   /* COMMA  */
+    SEMICOLON = 290,               /* SEMICOLON  */
+    CONST_INT = 291,               /* CONST_INT  */
+    CONST_FLOAT = 292,             /* CONST_FLOAT  */
+    ID = 293,                      /* ID  */
+    LOWER_THAN_ELSE = 294          /* LOWER_THAN_ELSE  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
 #define IF 258
 #define ELSE 259
 #define FOR 260
@@ -229,67 +294,182 @@ extern int yydebug;
 #define ID 293
 #define LOWER_THAN_ELSE 294
 
-
-
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 typedef int YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
+
 extern YYSTYPE yylval;
 
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
+
 int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
+
 
 #endif /* !YY_YY_Y_TAB_H_INCLUDED  */
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_IF = 3,                         /* IF  */
+  YYSYMBOL_ELSE = 4,                       /* ELSE  */
+  YYSYMBOL_FOR = 5,                        /* FOR  */
+  YYSYMBOL_WHILE = 6,                      /* WHILE  */
+  YYSYMBOL_DO = 7,                         /* DO  */
+  YYSYMBOL_BREAK = 8,                      /* BREAK  */
+  YYSYMBOL_INT = 9,                        /* INT  */
+  YYSYMBOL_CHAR = 10,                      /* CHAR  */
+  YYSYMBOL_FLOAT = 11,                     /* FLOAT  */
+  YYSYMBOL_DOUBLE = 12,                    /* DOUBLE  */
+  YYSYMBOL_VOID = 13,                      /* VOID  */
+  YYSYMBOL_RETURN = 14,                    /* RETURN  */
+  YYSYMBOL_SWITCH = 15,                    /* SWITCH  */
+  YYSYMBOL_CASE = 16,                      /* CASE  */
+  YYSYMBOL_DEFAULT = 17,                   /* DEFAULT  */
+  YYSYMBOL_CONTINUE = 18,                  /* CONTINUE  */
+  YYSYMBOL_PRINTLN = 19,                   /* PRINTLN  */
+  YYSYMBOL_ADDOP = 20,                     /* ADDOP  */
+  YYSYMBOL_MULOP = 21,                     /* MULOP  */
+  YYSYMBOL_INCOP = 22,                     /* INCOP  */
+  YYSYMBOL_DECOP = 23,                     /* DECOP  */
+  YYSYMBOL_RELOP = 24,                     /* RELOP  */
+  YYSYMBOL_ASSIGNOP = 25,                  /* ASSIGNOP  */
+  YYSYMBOL_LOGICOP = 26,                   /* LOGICOP  */
+  YYSYMBOL_NOT = 27,                       /* NOT  */
+  YYSYMBOL_LPAREN = 28,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 29,                    /* RPAREN  */
+  YYSYMBOL_LCURL = 30,                     /* LCURL  */
+  YYSYMBOL_RCURL = 31,                     /* RCURL  */
+  YYSYMBOL_LTHIRD = 32,                    /* LTHIRD  */
+  YYSYMBOL_RTHIRD = 33,                    /* RTHIRD  */
+  YYSYMBOL_COMMA = 34,                     /* COMMA  */
+  YYSYMBOL_SEMICOLON = 35,                 /* SEMICOLON  */
+  YYSYMBOL_CONST_INT = 36,                 /* CONST_INT  */
+  YYSYMBOL_CONST_FLOAT = 37,               /* CONST_FLOAT  */
+  YYSYMBOL_ID = 38,                        /* ID  */
+  YYSYMBOL_LOWER_THAN_ELSE = 39,           /* LOWER_THAN_ELSE  */
+  YYSYMBOL_YYACCEPT = 40,                  /* $accept  */
+  YYSYMBOL_start = 41,                     /* start  */
+  YYSYMBOL_program = 42,                   /* program  */
+  YYSYMBOL_unit = 43,                      /* unit  */
+  YYSYMBOL_func_definition = 44,           /* func_definition  */
+  YYSYMBOL_enter_func = 45,                /* enter_func  */
+  YYSYMBOL_parameter_list = 46,            /* parameter_list  */
+  YYSYMBOL_compound_statement = 47,        /* compound_statement  */
+  YYSYMBOL_enter_scope_variables = 48,     /* enter_scope_variables  */
+  YYSYMBOL_var_declaration = 49,           /* var_declaration  */
+  YYSYMBOL_type_specifier = 50,            /* type_specifier  */
+  YYSYMBOL_declaration_list = 51,          /* declaration_list  */
+  YYSYMBOL_id_name = 52,                   /* id_name  */
+  YYSYMBOL_statements = 53,                /* statements  */
+  YYSYMBOL_statement = 54,                 /* statement  */
+  YYSYMBOL_expression_statement = 55,      /* expression_statement  */
+  YYSYMBOL_variable = 56,                  /* variable  */
+  YYSYMBOL_expression = 57,                /* expression  */
+  YYSYMBOL_logic_expression = 58,          /* logic_expression  */
+  YYSYMBOL_rel_expression = 59,            /* rel_expression  */
+  YYSYMBOL_simple_expression = 60,         /* simple_expression  */
+  YYSYMBOL_term = 61,                      /* term  */
+  YYSYMBOL_unary_expression = 62,          /* unary_expression  */
+  YYSYMBOL_factor = 63,                    /* factor  */
+  YYSYMBOL_argument_list = 64,             /* argument_list  */
+  YYSYMBOL_arguments = 65                  /* arguments  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
 
-/* Copy the second part of user declarations.  */
 
-/* Line 390 of yacc.c  */
-#line 263 "y.tab.c"
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
 typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef short int yytype_int8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -297,16 +477,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -320,32 +512,71 @@ typedef short int yytype_int16;
 # endif
 #endif
 
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(N) (N)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int yyi)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (yyi)
-    int yyi;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return yyi;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -362,8 +593,7 @@ YYID (yyi)
 #    define alloca _alloca
 #   else
 #    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
 #     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
       /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
 #     ifndef EXIT_SUCCESS
@@ -375,8 +605,8 @@ YYID (yyi)
 # endif
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -392,7 +622,7 @@ YYID (yyi)
 #  endif
 #  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
 #   ifndef EXIT_SUCCESS
 #    define EXIT_SUCCESS 0
@@ -400,40 +630,37 @@ YYID (yyi)
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined EXIT_SUCCESS && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -443,16 +670,16 @@ union yyalloc
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack_alloc, Stack)				\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack_alloc, Stack, yysize);			\
-	Stack = &yyptr->Stack_alloc;					\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
@@ -462,16 +689,16 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
-      while (YYID (0))
+      while (0)
 #  endif
 # endif
 #endif /* !YYCOPY_NEEDED */
@@ -487,18 +714,23 @@ union yyalloc
 #define YYNNTS  26
 /* YYNRULES -- Number of rules.  */
 #define YYNRULES  68
-/* YYNRULES -- Number of states.  */
+/* YYNSTATES -- Number of states.  */
 #define YYNSTATES  121
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   294
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -533,147 +765,64 @@ static const yytype_uint8 yytranslate[] =
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint8 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     5,     8,    10,    12,    14,    16,    24,
-      31,    32,    37,    41,    44,    46,    51,    55,    56,    60,
-      62,    64,    66,    70,    77,    79,    84,    86,    88,    91,
-      93,    96,    98,   100,   102,   104,   112,   118,   126,   132,
-     138,   142,   144,   147,   149,   154,   156,   160,   162,   166,
-     168,   172,   174,   178,   180,   184,   187,   190,   192,   194,
-     199,   203,   205,   207,   210,   213,   215,   216,   220
+       0,   109,   109,   123,   149,   169,   178,   187,   193,   230,
+     262,   308,   325,   335,   345,   357,   371,   388,   412,   486,
+     494,   502,   512,   523,   535,   545,   557,   565,   583,   600,
+     607,   615,   624,   632,   641,   650,   667,   682,   698,   713,
+     736,   750,   762,   776,   822,   865,   875,   916,   926,   962,
+     972,  1008,  1019,  1060,  1071,  1147,  1173,  1199,  1213,  1223,
+    1298,  1308,  1321,  1334,  1355,  1378,  1386,  1398,  1421
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      41,     0,    -1,    42,    -1,    42,    43,    -1,    43,    -1,
-      49,    -1,    44,    -1,     1,    -1,    50,    52,    28,    46,
-      29,    45,    47,    -1,    50,    52,    28,    29,    45,    47,
-      -1,    -1,    46,    34,    50,    38,    -1,    46,    34,    50,
-      -1,    50,    38,    -1,    50,    -1,    30,    48,    53,    31,
-      -1,    30,    48,    31,    -1,    -1,    50,    51,    35,    -1,
-       9,    -1,    11,    -1,    13,    -1,    51,    34,    52,    -1,
-      51,    34,    52,    32,    36,    33,    -1,    52,    -1,    52,
-      32,    36,    33,    -1,    38,    -1,    54,    -1,    53,    54,
-      -1,     1,    -1,    53,     1,    -1,    49,    -1,    44,    -1,
-      55,    -1,    47,    -1,     5,    28,    55,    55,    57,    29,
-      54,    -1,     3,    28,    57,    29,    54,    -1,     3,    28,
-      57,    29,    54,     4,    54,    -1,     6,    28,    57,    29,
-      54,    -1,    19,    28,    52,    29,    35,    -1,    14,    57,
-      35,    -1,    35,    -1,    57,    35,    -1,    52,    -1,    52,
-      32,    57,    33,    -1,    58,    -1,    56,    25,    58,    -1,
-      59,    -1,    59,    26,    59,    -1,    60,    -1,    60,    24,
-      60,    -1,    61,    -1,    60,    20,    61,    -1,    62,    -1,
-      61,    21,    62,    -1,    20,    62,    -1,    27,    62,    -1,
-      63,    -1,    56,    -1,    52,    28,    64,    29,    -1,    28,
-      57,    29,    -1,    36,    -1,    37,    -1,    56,    22,    -1,
-      56,    23,    -1,    65,    -1,    -1,    65,    34,    58,    -1,
-      58,    -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint16 yyrline[] =
-{
-       0,    60,    60,    73,    95,   111,   119,   127,   133,   165,
-     193,   239,   256,   266,   276,   288,   301,   317,   341,   411,
-     419,   427,   437,   448,   460,   470,   482,   490,   504,   518,
-     524,   531,   539,   547,   555,   563,   579,   593,   608,   622,
-     644,   657,   668,   681,   726,   768,   777,   817,   826,   861,
-     870,   905,   915,   955,   965,  1040,  1065,  1090,  1103,  1112,
-    1186,  1195,  1207,  1219,  1235,  1253,  1261,  1272,  1295
-};
-#endif
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "IF", "ELSE", "FOR", "WHILE", "DO",
-  "BREAK", "INT", "CHAR", "FLOAT", "DOUBLE", "VOID", "RETURN", "SWITCH",
-  "CASE", "DEFAULT", "CONTINUE", "PRINTLN", "ADDOP", "MULOP", "INCOP",
-  "DECOP", "RELOP", "ASSIGNOP", "LOGICOP", "NOT", "LPAREN", "RPAREN",
-  "LCURL", "RCURL", "LTHIRD", "RTHIRD", "COMMA", "SEMICOLON", "CONST_INT",
-  "CONST_FLOAT", "ID", "LOWER_THAN_ELSE", "$accept", "start", "program",
-  "unit", "func_definition", "enter_func", "parameter_list",
-  "compound_statement", "enter_scope_variables", "var_declaration",
-  "type_specifier", "declaration_list", "id_name", "statements",
-  "statement", "expression_statement", "variable", "expression",
-  "logic_expression", "rel_expression", "simple_expression", "term",
-  "unary_expression", "factor", "argument_list", "arguments", YY_NULL
+  "\"end of file\"", "error", "\"invalid token\"", "IF", "ELSE", "FOR",
+  "WHILE", "DO", "BREAK", "INT", "CHAR", "FLOAT", "DOUBLE", "VOID",
+  "RETURN", "SWITCH", "CASE", "DEFAULT", "CONTINUE", "PRINTLN", "ADDOP",
+  "MULOP", "INCOP", "DECOP", "RELOP", "ASSIGNOP", "LOGICOP", "NOT",
+  "LPAREN", "RPAREN", "LCURL", "RCURL", "LTHIRD", "RTHIRD", "COMMA",
+  "SEMICOLON", "CONST_INT", "CONST_FLOAT", "ID", "LOWER_THAN_ELSE",
+  "$accept", "start", "program", "unit", "func_definition", "enter_func",
+  "parameter_list", "compound_statement", "enter_scope_variables",
+  "var_declaration", "type_specifier", "declaration_list", "id_name",
+  "statements", "statement", "expression_statement", "variable",
+  "expression", "logic_expression", "rel_expression", "simple_expression",
+  "term", "unary_expression", "factor", "argument_list", "arguments", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
-     285,   286,   287,   288,   289,   290,   291,   292,   293,   294
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
-{
-       0,    40,    41,    42,    42,    43,    43,    43,    44,    44,
-      45,    46,    46,    46,    46,    47,    47,    48,    49,    50,
-      50,    50,    51,    51,    51,    51,    52,    53,    53,    53,
-      53,    54,    54,    54,    54,    54,    54,    54,    54,    54,
-      54,    55,    55,    56,    56,    57,    57,    58,    58,    59,
-      59,    60,    60,    61,    61,    62,    62,    62,    63,    63,
-      63,    63,    63,    63,    63,    64,    64,    65,    65
-};
+#define YYPACT_NINF (-72)
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
-{
-       0,     2,     1,     2,     1,     1,     1,     1,     7,     6,
-       0,     4,     3,     2,     1,     4,     3,     0,     3,     1,
-       1,     1,     3,     6,     1,     4,     1,     1,     2,     1,
-       2,     1,     1,     1,     1,     7,     5,     7,     5,     5,
-       3,     1,     2,     1,     4,     1,     3,     1,     3,     1,
-       3,     1,     3,     1,     3,     2,     2,     1,     1,     4,
-       3,     1,     1,     2,     2,     1,     0,     3,     1
-};
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-/* YYDEFACT[STATE-NAME] -- Default reduction number in state STATE-NUM.
-   Performed when YYTABLE doesn't specify something else to do.  Zero
-   means the default is an error.  */
-static const yytype_uint8 yydefact[] =
-{
-       0,     7,    19,    20,    21,     0,     0,     4,     6,     5,
-       0,     1,     3,    26,     0,    24,     0,    18,     0,     0,
-      22,    10,     0,    14,     0,     0,     0,    10,     0,    13,
-      25,     0,    17,     9,     0,    12,    23,     0,     8,    11,
-      29,     0,     0,     0,     0,     0,     0,     0,     0,    16,
-      41,    61,    62,    32,    34,    31,    43,     0,    27,    33,
-      58,     0,    45,    47,    49,    51,    53,    57,     0,     0,
-       0,     0,     0,    58,    55,    56,     0,    66,     0,    30,
-      15,    28,    63,    64,     0,    42,     0,     0,     0,     0,
-       0,     0,     0,    40,     0,    60,    68,     0,    65,     0,
-      46,    48,    52,    50,    54,     0,     0,     0,     0,    59,
-       0,    44,    36,     0,    38,    39,    67,     0,     0,    37,
-      35
-};
+#define YYTABLE_NINF (-3)
 
-/* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int8 yydefgoto[] =
-{
-      -1,     5,     6,     7,    53,    26,    22,    54,    37,    55,
-      10,    14,    56,    57,    58,    59,    60,    61,    62,    63,
-      64,    65,    66,    67,    97,    98
-};
+#define yytable_value_is_error(Yyn) \
+  0
 
 /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
    STATE-NUM.  */
-#define YYPACT_NINF -72
 static const yytype_int16 yypact[] =
 {
       45,   -72,   -72,   -72,   -72,    28,    44,   -72,   -72,   -72,
@@ -691,6 +840,26 @@ static const yytype_int16 yypact[] =
      -72
 };
 
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       0,     7,    19,    20,    21,     0,     0,     4,     6,     5,
+       0,     1,     3,    26,     0,    24,     0,    18,     0,     0,
+      22,    10,     0,    14,     0,     0,     0,    10,     0,    13,
+      25,     0,    17,     9,     0,    12,    23,     0,     8,    11,
+      29,     0,     0,     0,     0,     0,     0,     0,     0,    16,
+      41,    61,    62,    32,    34,    31,    43,     0,    27,    33,
+      58,     0,    45,    47,    49,    51,    53,    57,     0,     0,
+       0,     0,     0,    58,    55,    56,     0,    66,     0,    30,
+      15,    28,    63,    64,     0,    42,     0,     0,     0,     0,
+       0,     0,     0,    40,     0,    60,    68,     0,    65,     0,
+      46,    48,    52,    50,    54,     0,     0,     0,     0,    59,
+       0,    44,    36,     0,    38,    39,    67,     0,     0,    37,
+      35
+};
+
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
@@ -699,10 +868,17 @@ static const yytype_int16 yypgoto[] =
       73,    76,   -38,   -72,   -72,   -72
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     5,     6,     7,    53,    26,    22,    54,    37,    55,
+      10,    14,    56,    57,    58,    59,    60,    61,    62,    63,
+      64,    65,    66,    67,    97,    98
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -3
 static const yytype_int8 yytable[] =
 {
       73,    73,    81,    71,    15,    23,    96,    76,    74,    75,
@@ -725,12 +901,6 @@ static const yytype_int8 yytable[] =
       32,     0,     0,     0,     0,    50,    51,    52,    13
 };
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-72)))
-
-#define yytable_value_is_error(Yytable_value) \
-  YYID (0)
-
 static const yytype_int8 yycheck[] =
 {
       46,    47,    57,    44,    10,    18,    77,    48,    46,    47,
@@ -753,9 +923,9 @@ static const yytype_int8 yycheck[] =
       30,    -1,    -1,    -1,    -1,    35,    36,    37,    38
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
        0,     1,     9,    11,    13,    41,    42,    43,    44,    49,
       50,     0,    43,    38,    51,    52,    34,    35,    28,    32,
@@ -772,67 +942,65 @@ static const yytype_uint8 yystos[] =
       54
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
-
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
-
-
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  However,
-   YYFAIL appears to be in use.  Nevertheless, it is formally deprecated
-   in Bison 2.4.2's NEWS entry, where a plan to phase it out is
-   discussed.  */
-
-#define YYFAIL		goto yyerrlab
-#if defined YYFAIL
-  /* This is here to suppress warnings from the GCC cpp's
-     -Wunused-macros.  Normally we don't worry about that warning, but
-     some users do, and we want to make it easy for users to remove
-     YYFAIL uses, which will produce warnings from Bison 2.5.  */
-#endif
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    40,    41,    42,    42,    43,    43,    43,    44,    44,
+      45,    46,    46,    46,    46,    47,    47,    48,    49,    50,
+      50,    50,    51,    51,    51,    51,    52,    53,    53,    53,
+      53,    54,    54,    54,    54,    54,    54,    54,    54,    54,
+      54,    55,    55,    56,    56,    57,    57,    58,    58,    59,
+      59,    60,    60,    61,    61,    62,    62,    62,    63,    63,
+      63,    63,    63,    63,    63,    64,    64,    65,    65
+};
 
-#define YYRECOVERING()  (!!yyerrstatus)
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     2,     1,     1,     1,     1,     7,     6,
+       0,     4,     3,     2,     1,     4,     3,     0,     3,     1,
+       1,     1,     3,     6,     1,     4,     1,     1,     2,     1,
+       2,     1,     1,     1,     1,     7,     5,     7,     5,     5,
+       3,     1,     2,     1,     4,     1,     3,     1,     3,     1,
+       3,     1,     3,     1,     3,     2,     2,     1,     1,     4,
+       3,     1,     1,     2,     2,     1,     0,     3,     1
+};
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-/* Error token number */
-#define YYTERROR	1
-#define YYERRCODE	256
-
-
-/* This macro is provided for backward compatibility. */
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
 
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
-/* YYLEX -- calling `yylex' with the right arguments.  */
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (YYLEX_PARAM)
-#else
-# define YYLEX yylex ()
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -842,82 +1010,58 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
-    {
-      default:
-        break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep)
-#else
 static void
-yy_symbol_print (yyoutput, yytype, yyvaluep)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -925,16 +1069,8 @@ yy_symbol_print (yyoutput, yytype, yyvaluep)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
-#else
 static void
-yy_stack_print (yybottom, yytop)
-    yytype_int16 *yybottom;
-    yytype_int16 *yytop;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -945,63 +1081,56 @@ yy_stack_print (yybottom, yytop)
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_reduce_print (YYSTYPE *yyvsp, int yyrule)
-#else
 static void
-yy_reduce_print (yyvsp, yyrule)
-    YYSTYPE *yyvsp;
-    int yyrule;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       		       );
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
       YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, Rule); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -1017,363 +1146,77 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
-yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
 
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
 
-  return yyd - 1;
-}
-#  endif
-# endif
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
 
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
 {
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
-    do_not_strip_quotes: ;
-    }
-
-  if (! yyres)
-    return yystrlen (yystr);
+  YY_USE (yyvaluep);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-  return yystpcpy (yyres, yystr) - yyres;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
-# endif
 
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
-{
-  YYSIZE_T yysize0 = yytnamerr (YY_NULL, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULL;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
-  int yycount = 0;
-
-  /* There are many possibilities here to consider:
-     - Assume YYFAIL is not used.  It's too flawed to consider.  See
-       <http://lists.gnu.org/archive/html/bison-patches/2009-12/msg00024.html>
-       for details.  YYERROR is fine as it does not invoke this
-       function.
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULL, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
-    }
 
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
+/* Lookahead token kind.  */
+int yychar;
 
-  {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
-  }
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
 
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
-
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          yyp++;
-          yyformat++;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
-
-/*-----------------------------------------------.
-| Release the memory associated to this symbol.  |
-`-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep)
-#else
-static void
-yydestruct (yymsg, yytype, yyvaluep)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-#endif
-{
-  YYUSE (yyvaluep);
-
-  if (!yymsg)
-    yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
-
-  switch (yytype)
-    {
-
-      default:
-        break;
-    }
-}
-
-
-
-
-/* The lookahead symbol.  */
-int yychar;
-
-
-#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END
-#endif
-#ifndef YY_INITIAL_VALUE
-# define YY_INITIAL_VALUE(Value) /* Nothing. */
-#endif
-
-/* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval YY_INITIAL_VALUE(yyval_default);
-
-/* Number of syntax errors so far.  */
-int yynerrs;
 
 
 /*----------.
 | yyparse.  |
 `----------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM)
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 int
 yyparse (void)
-#else
-int
-yyparse ()
-
-#endif
-#endif
 {
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
+    int yyerrstatus = 0;
 
-    /* The stacks and their tools:
-       `yyss': related to states.
-       `yyvs': related to semantic values.
-
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    YYSIZE_T yystacksize;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1381,102 +1224,107 @@ yyparse ()
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-		    &yystacksize);
-
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss_alloc, yyss);
-	YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1487,18 +1335,29 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1526,15 +1385,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1549,14 +1406,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1569,167 +1426,186 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-/* Line 1792 of yacc.c  */
-#line 61 "22101088_22101357.y"
-    {
-		outlog<<"At line no: "<<lines<<" start : program "<<endl<<endl;
-		outlog<<"Symbol Table"<<endl<<endl;
+  case 2: /* start: program  */
+#line 110 "22101088_22101357.y"
+        {
+		outlog<<"At line no: "<<lines<<" start : program "<<"\n\n";
+		outlog<<"Symbol Table"<<"\n\n";
 		
 		symtbl->Print_all_scope(outlog);
 		
-		(yyval) = (yyvsp[(1) - (1)]);
+		yyval = yyvsp[0];
 		// Root of AST is the program node
-		ast_root = (ProgramNode*)(yyvsp[(1) - (1)])->get_ast_node();
+		ast_root = (ProgramNode*)yyvsp[0]->get_ast_node();
+		flat_ast.root = yyvsp[0]->get_flat_node();
 	}
+#line 1443 "y.tab.c"
     break;
 
-  case 3:
-/* Line 1792 of yacc.c  */
-#line 74 "22101088_22101357.y"
-    {
-		outlog<<"At line no: "<<lines<<" program : program unit "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (2)])->getname()+"\n"+(yyvsp[(2) - (2)])->getname()<<endl<<endl;
+  case 3: /* program: program unit  */
+#line 124 "22101088_22101357.y"
+        {
+		outlog<<"At line no: "<<lines<<" program : program unit "<<"\n\n";
+		outlog<<yyvsp[-1]->getname()+"\n"+yyvsp[0]->getname()<<"\n\n";
 		
-		(yyval) = new symbol_info((yyvsp[(1) - (2)])->getname()+"\n"+(yyvsp[(2) - (2)])->getname(),"program");
+		yyval = new symbol_info(yyvsp[-1]->getname()+"\n"+yyvsp[0]->getname(),"program");
 		
 		// Create/update AST node for program
 		ProgramNode* prog;
-		if((yyvsp[(1) - (2)])->get_ast_node()) {
-			prog = (ProgramNode*)(yyvsp[(1) - (2)])->get_ast_node();
+		if(yyvsp[-1]->get_ast_node()) {
+			prog = (ProgramNode*)yyvsp[-1]->get_ast_node();
 		} else {
 			prog = new ProgramNode();
 		}
 		
 		// Add the unit to the program
-		if((yyvsp[(2) - (2)])->get_ast_node()) {
-			prog->add_unit((yyvsp[(2) - (2)])->get_ast_node());
+		if(yyvsp[0]->get_ast_node()) {
+			prog->add_unit(yyvsp[0]->get_ast_node());
 		}
 		
-		(yyval)->set_ast_node(prog);
+		yyval->set_ast_node(prog);
+		
+		uint32_t flat_prog = yyvsp[-1]->get_flat_node() != FLAT_NONE ? yyvsp[-1]->get_flat_node() : flat_ast.program();
+		flat_ast.append(flat_prog, yyvsp[0]->get_flat_node());
+		yyval->set_flat_node(flat_prog);
 	}
+#line 1473 "y.tab.c"
     break;
 
-  case 4:
-/* Line 1792 of yacc.c  */
-#line 96 "22101088_22101357.y"
-    {
-		outlog<<"At line no: "<<lines<<" program : unit "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 4: /* program: unit  */
+#line 150 "22101088_22101357.y"
+        {
+		outlog<<"At line no: "<<lines<<" program : unit "<<"\n\n";
+		outlog<<yyvsp[0]->getname()<<"\n\n";
 		
-		(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"program");
+		yyval = new symbol_info(yyvsp[0]->getname(),"program");
 		
 		// Create AST node for program with a single unit
 		ProgramNode* prog = new ProgramNode();
-		if((yyvsp[(1) - (1)])->get_ast_node()) {
-			prog->add_unit((yyvsp[(1) - (1)])->get_ast_node());
+		if(yyvsp[0]->get_ast_node()) {
+			prog->add_unit(yyvsp[0]->get_ast_node());
 		}
-		(yyval)->set_ast_node(prog);
+		yyval->set_ast_node(prog);
+		
+		uint32_t flat_prog = flat_ast.program();
+		flat_ast.append(flat_prog, yyvsp[0]->get_flat_node());
+		yyval->set_flat_node(flat_prog);
 	}
+#line 1495 "y.tab.c"
     break;
 
-  case 5:
-/* Line 1792 of yacc.c  */
-#line 112 "22101088_22101357.y"
-    {
-		outlog<<"At line no: "<<lines<<" unit : var_declaration "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 5: /* unit: var_declaration  */
+#line 170 "22101088_22101357.y"
+         {
+		outlog<<"At line no: "<<lines<<" unit : var_declaration "<<"\n\n";
+		outlog<<yyvsp[0]->getname()<<"\n\n";
 		
-		(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"unit");
-		(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+		yyval = new symbol_info(yyvsp[0]->getname(),"unit");
+		yyval->set_ast_node(yyvsp[0]->get_ast_node());
+		yyval->set_flat_node(yyvsp[0]->get_flat_node());
 	 }
+#line 1508 "y.tab.c"
     break;
 
-  case 6:
-/* Line 1792 of yacc.c  */
-#line 120 "22101088_22101357.y"
-    {
-		outlog<<"At line no: "<<lines<<" unit : func_definition "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 6: /* unit: func_definition  */
+#line 179 "22101088_22101357.y"
+     {
+		outlog<<"At line no: "<<lines<<" unit : func_definition "<<"\n\n";
+		outlog<<yyvsp[0]->getname()<<"\n\n";
 		
-		(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"unit");
-		(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+		yyval = new symbol_info(yyvsp[0]->getname(),"unit");
+		yyval->set_ast_node(yyvsp[0]->get_ast_node());
+		yyval->set_flat_node(yyvsp[0]->get_flat_node());
 	 }
+#line 1521 "y.tab.c"
     break;
 
-  case 7:
-/* Line 1792 of yacc.c  */
-#line 128 "22101088_22101357.y"
-    {
-	 	(yyval) = new symbol_info("","unit");
+  case 7: /* unit: error  */
+#line 188 "22101088_22101357.y"
+         {
+	 	yyval = new symbol_info("","unit");
 	 }
+#line 1529 "y.tab.c"
     break;
 
-  case 8:
-/* Line 1792 of yacc.c  */
-#line 134 "22101088_22101357.y"
-    {	
-			outlog<<"At line no: "<<lines<<" func_definition : type_specifier ID LPAREN parameter_list RPAREN compound_statement "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (7)])->getname()<<" "<<(yyvsp[(2) - (7)])->getname()<<"("+(yyvsp[(4) - (7)])->getname()+")\n"<<(yyvsp[(7) - (7)])->getname()<<endl<<endl;
+  case 8: /* func_definition: type_specifier id_name LPAREN parameter_list RPAREN enter_func compound_statement  */
+#line 194 "22101088_22101357.y"
+                {	
+			outlog<<"At line no: "<<lines<<" func_definition : type_specifier ID LPAREN parameter_list RPAREN compound_statement "<<"\n\n";
+			outlog<<yyvsp[-6]->getname()<<" "<<yyvsp[-5]->getname()<<"("+yyvsp[-3]->getname()+")\n"<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (7)])->getname()+" "+(yyvsp[(2) - (7)])->getname()+"("+(yyvsp[(4) - (7)])->getname()+")\n"+(yyvsp[(7) - (7)])->getname(),"func_def");	
+			yyval = new symbol_info(yyvsp[-6]->getname()+" "+yyvsp[-5]->getname()+"("+yyvsp[-3]->getname()+")\n"+yyvsp[0]->getname(),"func_def");	
 			
 			// Create AST node for function definition
-			FuncDeclNode* func = new FuncDeclNode((yyvsp[(1) - (7)])->getname(), (yyvsp[(2) - (7)])->getname());
+			FuncDeclNode* func = new FuncDeclNode(yyvsp[-6]->getname(), yyvsp[-5]->getname());
+			
+			uint32_t flat_func = flat_ast.func(yyvsp[-6]->getname(), yyvsp[-5]->getname());
 			
 			// Add parameters
 			for(int i = 0; i < paramlist.size(); i++) {
 				if(paramname[i] != "_null_") {
 					func->add_param(paramlist[i], paramname[i]);
+					flat_ast.append(flat_func, flat_ast.param(paramlist[i], paramname[i]));
 				}
 			}
 			
 			// Set body
-			if((yyvsp[(7) - (7)])->get_ast_node()) {
-				func->set_body((BlockNode*)(yyvsp[(7) - (7)])->get_ast_node());
+			if(yyvsp[0]->get_ast_node()) {
+				func->set_body((BlockNode*)yyvsp[0]->get_ast_node());
 			}
+			flat_ast.set_body(flat_func, yyvsp[0]->get_flat_node());
 			
-			(yyval)->set_ast_node(func);
+			yyval->set_ast_node(func);
+			yyval->set_flat_node(flat_func);
 			
 			if(symtbl->getID()!=1)
 			{
-				symtbl->Remove_from_table((yyvsp[(2) - (7)])->getname());
+				symtbl->Remove_from_table(yyvsp[-5]->getname());
 			}
 			
 			paramlist.clear();
 			paramname.clear();	
 		}
+#line 1570 "y.tab.c"
     break;
 
-  case 9:
-/* Line 1792 of yacc.c  */
-#line 166 "22101088_22101357.y"
-    {
+  case 9: /* func_definition: type_specifier id_name LPAREN RPAREN enter_func compound_statement  */
+#line 231 "22101088_22101357.y"
+                {
 			
-			outlog<<"At line no: "<<lines<<" func_definition : type_specifier ID LPAREN RPAREN compound_statement "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (6)])->getname()<<" "<<(yyvsp[(2) - (6)])->getname()<<"()\n"<<(yyvsp[(6) - (6)])->getname()<<endl<<endl;
+			outlog<<"At line no: "<<lines<<" func_definition : type_specifier ID LPAREN RPAREN compound_statement "<<"\n\n";
+			outlog<<yyvsp[-5]->getname()<<" "<<yyvsp[-4]->getname()<<"()\n"<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (6)])->getname()+" "+(yyvsp[(2) - (6)])->getname()+"()\n"+(yyvsp[(6) - (6)])->getname(),"func_def");	
+			yyval = new symbol_info(yyvsp[-5]->getname()+" "+yyvsp[-4]->getname()+"()\n"+yyvsp[0]->getname(),"func_def");	
 			
 			// Create AST node for function definition
-			FuncDeclNode* func = new FuncDeclNode((yyvsp[(1) - (6)])->getname(), (yyvsp[(2) - (6)])->getname());
+			FuncDeclNode* func = new FuncDeclNode(yyvsp[-5]->getname(), yyvsp[-4]->getname());
 			
 			// Set body
-			if((yyvsp[(6) - (6)])->get_ast_node()) {
-				func->set_body((BlockNode*)(yyvsp[(6) - (6)])->get_ast_node());
+			if(yyvsp[0]->get_ast_node()) {
+				func->set_body((BlockNode*)yyvsp[0]->get_ast_node());
 			}
 			
-			(yyval)->set_ast_node(func);
+			yyval->set_ast_node(func);
+			
+			uint32_t flat_func = flat_ast.func(yyvsp[-5]->getname(), yyvsp[-4]->getname());
+			flat_ast.set_body(flat_func, yyvsp[0]->get_flat_node());
+			yyval->set_flat_node(flat_func);
 			
 			if(symtbl->getID()!=1)
 			{
-				symtbl->Remove_from_table((yyvsp[(2) - (6)])->getname());
+				symtbl->Remove_from_table(yyvsp[-4]->getname());
 			}
 			
 			paramlist.clear();
 			paramname.clear();	
 		}
+#line 1604 "y.tab.c"
     break;
 
-  case 10:
-/* Line 1792 of yacc.c  */
-#line 193 "22101088_22101357.y"
-    {
+  case 10: /* enter_func: %empty  */
+#line 262 "22101088_22101357.y"
+             {
 				//if(symtbl->getID()!="1") goto end2; //not in global scope , doesnt work because if not inserted lots of errors come in compound statement
 				
 				is_func=1;//compound statement is coming in function definition. enter parameter variables.
@@ -1740,8 +1616,8 @@ yyreduce:
 					{
 						if(paramname[i]=="_null_")
 						{
-							outerror<<"At line no: "<<lines<<" Parameter "<<i+1<<"'s name not given in function definition of "<<func_name<<endl<<endl;
-							outlog<<"At line no: "<<lines<<" Parameter "<<i+1<<"'s name not given in function definition of "<<func_name<<endl<<endl;
+							outerror<<"At line no: "<<lines<<" Parameter "<<i+1<<"'s name not given in function definition of "<<func_name<<"\n\n";
+							outlog<<"At line no: "<<lines<<" Parameter "<<i+1<<"'s name not given in function definition of "<<func_name<<"\n\n";
 							errors++;
 						}
 					}
@@ -1757,126 +1633,128 @@ yyreduce:
 				}
 				else
 				{
-					outerror<<"At line no: "<<lines<<" Multiple declaration of function "<<func_name<<endl<<endl;
-					outlog<<"At line no: "<<lines<<" Multiple declaration of function "<<func_name<<endl<<endl;
+					outerror<<"At line no: "<<lines<<" Multiple declaration of function "<<func_name<<"\n\n";
+					outlog<<"At line no: "<<lines<<" Multiple declaration of function "<<func_name<<"\n\n";
 					errors++;
 					// (symtbl->Lookup_in_table(func_name))->setidtype("func_def");
 				}
 					
 				if((symtbl->Lookup_in_table(func_name))->getvartype() != func_ret_type)
 				{
-					outerror<<"At line no: "<<lines<<" Return type mismatch of function "<<func_name<<endl<<endl;
-					outlog<<"At line no: "<<lines<<" Return type mismatch of function "<<func_name<<endl<<endl;
+					outerror<<"At line no: "<<lines<<" Return type mismatch of function "<<func_name<<"\n\n";
+					outlog<<"At line no: "<<lines<<" Return type mismatch of function "<<func_name<<"\n\n";
 					errors++;
 				}
 				
 				//end2:
 				//;
             }
+#line 1653 "y.tab.c"
     break;
 
-  case 11:
-/* Line 1792 of yacc.c  */
-#line 240 "22101088_22101357.y"
-    {
-			outlog<<"At line no: "<<lines<<" parameter_list : parameter_list COMMA type_specifier ID "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (4)])->getname()+","+(yyvsp[(3) - (4)])->getname()+" "+(yyvsp[(4) - (4)])->getname()<<endl<<endl;
+  case 11: /* parameter_list: parameter_list COMMA type_specifier ID  */
+#line 309 "22101088_22101357.y"
+                {
+			outlog<<"At line no: "<<lines<<" parameter_list : parameter_list COMMA type_specifier ID "<<"\n\n";
+			outlog<<yyvsp[-3]->getname()+","+yyvsp[-1]->getname()+" "+yyvsp[0]->getname()<<"\n\n";
 					
-			(yyval) = new symbol_info((yyvsp[(1) - (4)])->getname()+","+(yyvsp[(3) - (4)])->getname()+" "+(yyvsp[(4) - (4)])->getname(),"param_list");
+			yyval = new symbol_info(yyvsp[-3]->getname()+","+yyvsp[-1]->getname()+" "+yyvsp[0]->getname(),"param_list");
 			
-			if(count(paramname.begin(),paramname.end(),(yyvsp[(4) - (4)])->getname()))
+			if(count(paramname.begin(),paramname.end(),yyvsp[0]->getname()))
 			{
-				outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<(yyvsp[(4) - (4)])->getname()<<" in parameter of "<<func_name<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<(yyvsp[(4) - (4)])->getname()<<" in parameter of "<<func_name<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<yyvsp[0]->getname()<<" in parameter of "<<func_name<<"\n\n";
+				outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<yyvsp[0]->getname()<<" in parameter of "<<func_name<<"\n\n";
 				errors++;
 			}
 			
-			paramlist.push_back((yyvsp[(3) - (4)])->getname());
-			paramname.push_back((yyvsp[(4) - (4)])->getname());
+			paramlist.push_back(yyvsp[-1]->getname());
+			paramname.push_back(yyvsp[0]->getname());
 		}
+#line 1674 "y.tab.c"
     break;
 
-  case 12:
-/* Line 1792 of yacc.c  */
-#line 257 "22101088_22101357.y"
-    {
-			outlog<<"At line no: "<<lines<<" parameter_list : parameter_list COMMA type_specifier "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (3)])->getname()+","+(yyvsp[(3) - (3)])->getname()<<endl<<endl;
+  case 12: /* parameter_list: parameter_list COMMA type_specifier  */
+#line 326 "22101088_22101357.y"
+                {
+			outlog<<"At line no: "<<lines<<" parameter_list : parameter_list COMMA type_specifier "<<"\n\n";
+			outlog<<yyvsp[-2]->getname()+","+yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (3)])->getname()+","+(yyvsp[(3) - (3)])->getname(),"param_list");
+			yyval = new symbol_info(yyvsp[-2]->getname()+","+yyvsp[0]->getname(),"param_list");
 			
-			paramlist.push_back((yyvsp[(3) - (3)])->getname());
+			paramlist.push_back(yyvsp[0]->getname());
 			paramname.push_back("_null_");
 		}
+#line 1688 "y.tab.c"
     break;
 
-  case 13:
-/* Line 1792 of yacc.c  */
-#line 267 "22101088_22101357.y"
-    {
-			outlog<<"At line no: "<<lines<<" parameter_list : type_specifier ID "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (2)])->getname()<<" "<<(yyvsp[(2) - (2)])->getname()<<endl<<endl;
+  case 13: /* parameter_list: type_specifier ID  */
+#line 336 "22101088_22101357.y"
+                {
+			outlog<<"At line no: "<<lines<<" parameter_list : type_specifier ID "<<"\n\n";
+			outlog<<yyvsp[-1]->getname()<<" "<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (2)])->getname()+" "+(yyvsp[(2) - (2)])->getname(),"param_list");
+			yyval = new symbol_info(yyvsp[-1]->getname()+" "+yyvsp[0]->getname(),"param_list");
 			
-			paramlist.push_back((yyvsp[(1) - (2)])->getname());
-			paramname.push_back((yyvsp[(2) - (2)])->getname());
+			paramlist.push_back(yyvsp[-1]->getname());
+			paramname.push_back(yyvsp[0]->getname());
 		}
+#line 1702 "y.tab.c"
     break;
 
-  case 14:
-/* Line 1792 of yacc.c  */
-#line 277 "22101088_22101357.y"
-    {
-			outlog<<"At line no: "<<lines<<" parameter_list : type_specifier "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 14: /* parameter_list: type_specifier  */
+#line 346 "22101088_22101357.y"
+                {
+			outlog<<"At line no: "<<lines<<" parameter_list : type_specifier "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"param_list");
+			yyval = new symbol_info(yyvsp[0]->getname(),"param_list");
 			
-			paramlist.push_back((yyvsp[(1) - (1)])->getname());
+			paramlist.push_back(yyvsp[0]->getname());
 			paramname.push_back("_null_");
 		}
+#line 1716 "y.tab.c"
     break;
 
-  case 15:
-/* Line 1792 of yacc.c  */
-#line 289 "22101088_22101357.y"
-    { 
- 		    	outlog<<"At line no: "<<lines<<" compound_statement : LCURL statements RCURL "<<endl<<endl;
-				outlog<<"{\n"+(yyvsp[(3) - (4)])->getname()+"\n}"<<endl<<endl;
+  case 15: /* compound_statement: LCURL enter_scope_variables statements RCURL  */
+#line 358 "22101088_22101357.y"
+                        { 
+ 		    	outlog<<"At line no: "<<lines<<" compound_statement : LCURL statements RCURL "<<"\n\n";
+				outlog<<"{\n"+yyvsp[-1]->getname()+"\n}"<<"\n\n";
 				
-				(yyval) = new symbol_info("{\n"+(yyvsp[(3) - (4)])->getname()+"\n}","comp_stmnt");
+				yyval = new symbol_info("{\n"+yyvsp[-1]->getname()+"\n}","comp_stmnt");
 				
 				// Set AST node for compound statement
-				(yyval)->set_ast_node((yyvsp[(3) - (4)])->get_ast_node());
+				yyval->set_ast_node(yyvsp[-1]->get_ast_node());
+				yyval->set_flat_node(yyvsp[-1]->get_flat_node());
 				
 				symtbl->Print_all_scope(outlog);
 			    symtbl->exit_scope(outlog);
  		    }
+#line 1734 "y.tab.c"
     break;
 
-  case 16:
-/* Line 1792 of yacc.c  */
-#line 302 "22101088_22101357.y"
-    { 
- 		    	outlog<<"At line no: "<<lines<<" compound_statement : LCURL RCURL "<<endl<<endl;
-				outlog<<"{\n}"<<endl<<endl;
+  case 16: /* compound_statement: LCURL enter_scope_variables RCURL  */
+#line 372 "22101088_22101357.y"
+                    { 
+ 		    	outlog<<"At line no: "<<lines<<" compound_statement : LCURL RCURL "<<"\n\n";
+				outlog<<"{\n}"<<"\n\n";
 				
-				(yyval) = new symbol_info("{\n}","comp_stmnt");
+				yyval = new symbol_info("{\n}","comp_stmnt");
 				
 				// Create empty block node
 				BlockNode* block = new BlockNode();
-				(yyval)->set_ast_node(block);
+				yyval->set_ast_node(block);
+				yyval->set_flat_node(flat_ast.block());
 				
 				symtbl->Print_all_scope(outlog);
 			    symtbl->exit_scope(outlog);
  		    }
+#line 1753 "y.tab.c"
     break;
 
-  case 17:
-/* Line 1792 of yacc.c  */
-#line 317 "22101088_22101357.y"
-    {
+  case 17: /* enter_scope_variables: %empty  */
+#line 388 "22101088_22101357.y"
+                        {
 				symtbl->enter_scope(outlog);
 				
 				if(is_func == 1)
@@ -1898,27 +1776,28 @@ yyreduce:
 				}
 				
 			}
+#line 1780 "y.tab.c"
     break;
 
-  case 18:
-/* Line 1792 of yacc.c  */
-#line 342 "22101088_22101357.y"
-    {
-			outlog<<"At line no: "<<lines<<" var_declaration : type_specifier declaration_list SEMICOLON "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (3)])->getname()<<" "<<varlist<<";"<<endl<<endl;
+  case 18: /* var_declaration: type_specifier declaration_list SEMICOLON  */
+#line 413 "22101088_22101357.y"
+                 {
+			outlog<<"At line no: "<<lines<<" var_declaration : type_specifier declaration_list SEMICOLON "<<"\n\n";
+			outlog<<yyvsp[-2]->getname()<<" "<<varlist<<";"<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (3)])->getname()+" "+varlist+";","var_dec");
+			yyval = new symbol_info(yyvsp[-2]->getname()+" "+varlist+";","var_dec");
 			
-			if((yyvsp[(1) - (3)])->getname()=="void")
+			if(yyvsp[-2]->getname()=="void")
 			{
-				outerror<<"At line no: "<<lines<<" variable type can not be void "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" variable type can not be void "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" variable type can not be void "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" variable type can not be void "<<"\n\n";
 				errors++;
-				(yyvsp[(1) - (3)]) = new symbol_info("error","type"); //variable is declared void so pass error instead
+				yyvsp[-2] = new symbol_info("error","type"); //variable is declared void so pass error instead
 			}
 			
 			// Create AST node for variable declaration
-			DeclNode* declNode = new DeclNode((yyvsp[(1) - (3)])->getname());
+			DeclNode* declNode = new DeclNode(yyvsp[-2]->getname());
+			uint32_t flat_decl = flat_ast.decl(yyvsp[-2]->getname());
 			
 			// Parse the varlist to add variables to the declaration node
 			stringstream _varlist(varlist);
@@ -1929,16 +1808,17 @@ yyreduce:
 				if(varname.find("[") == string::npos) // normal variable
 				{
 					declNode->add_var(varname, 0);
+					flat_ast.append(flat_decl, flat_ast.decl_var(varname, 0));
 					
 					if(symtbl->Insert_in_table(varname,"ID"))
 					{
-						(symtbl->Lookup_in_table(varname))->setvartype((yyvsp[(1) - (3)])->getname());
+						(symtbl->Lookup_in_table(varname))->setvartype(yyvsp[-2]->getname());
 						(symtbl->Lookup_in_table(varname))->setidtype("var");
 					}
 					else
 					{
-						outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<varname<<endl<<endl;
-						outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<varname<<endl<<endl;
+						outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<varname<<"\n\n";
+						outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<varname<<"\n\n";
 						errors++;
 					}
 				}
@@ -1951,898 +1831,936 @@ yyreduce:
 					getline(_varname,size,']'); // get array size
 					
 					declNode->add_var(name, stoi(size));
+					flat_ast.append(flat_decl, flat_ast.decl_var(name, stoi(size)));
 					
 					if(symtbl->Insert_in_table(name,"ID"))
 					{
-						(symtbl->Lookup_in_table(name))->setvartype((yyvsp[(1) - (3)])->getname());
+						(symtbl->Lookup_in_table(name))->setvartype(yyvsp[-2]->getname());
 						(symtbl->Lookup_in_table(name))->setidtype("array");
 						(symtbl->Lookup_in_table(name))->setarraysize(stoi(size));
 					}
 					else
 					{
-						outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<name<<endl<<endl;
-						outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<name<<endl<<endl;
+						outerror<<"At line no: "<<lines<<" Multiple declaration of variable "<<name<<"\n\n";
+						outlog<<"At line no: "<<lines<<" Multiple declaration of variable "<<name<<"\n\n";
 						errors++;
 					}
 				}
 			}
 			
-			(yyval)->set_ast_node(declNode);
+			yyval->set_ast_node(declNode);
+			yyval->set_flat_node(flat_decl);
 			varlist = "";
 		 }
+#line 1856 "y.tab.c"
     break;
 
-  case 19:
-/* Line 1792 of yacc.c  */
-#line 412 "22101088_22101357.y"
-    {
-			outlog<<"At line no: "<<lines<<" type_specifier : INT "<<endl<<endl;
-			outlog<<"int"<<endl<<endl;
+  case 19: /* type_specifier: INT  */
+#line 487 "22101088_22101357.y"
+                {
+			outlog<<"At line no: "<<lines<<" type_specifier : INT "<<"\n\n";
+			outlog<<"int"<<"\n\n";
 			
-			(yyval) = new symbol_info("int","type");
+			yyval = new symbol_info("int","type");
 			ret_type = "int";
 	    }
+#line 1868 "y.tab.c"
     break;
 
-  case 20:
-/* Line 1792 of yacc.c  */
-#line 420 "22101088_22101357.y"
-    {
-			outlog<<"At line no: "<<lines<<" type_specifier : FLOAT "<<endl<<endl;
-			outlog<<"float"<<endl<<endl;
+  case 20: /* type_specifier: FLOAT  */
+#line 495 "22101088_22101357.y"
+                {
+			outlog<<"At line no: "<<lines<<" type_specifier : FLOAT "<<"\n\n";
+			outlog<<"float"<<"\n\n";
 			
-			(yyval) = new symbol_info("float","type");
+			yyval = new symbol_info("float","type");
 			ret_type = "float";
 	    }
+#line 1880 "y.tab.c"
     break;
 
-  case 21:
-/* Line 1792 of yacc.c  */
-#line 428 "22101088_22101357.y"
-    {
-			outlog<<"At line no: "<<lines<<" type_specifier : VOID "<<endl<<endl;
-			outlog<<"void"<<endl<<endl;
+  case 21: /* type_specifier: VOID  */
+#line 503 "22101088_22101357.y"
+                {
+			outlog<<"At line no: "<<lines<<" type_specifier : VOID "<<"\n\n";
+			outlog<<"void"<<"\n\n";
 			
-			(yyval) = new symbol_info("void","type");
+			yyval = new symbol_info("void","type");
 			ret_type = "void";
 	    }
+#line 1892 "y.tab.c"
     break;
 
-  case 22:
-/* Line 1792 of yacc.c  */
-#line 438 "22101088_22101357.y"
-    {
- 		  	string name = (yyvsp[(3) - (3)])->getname();
- 		  	outlog<<"At line no: "<<lines<<" declaration_list : declaration_list COMMA ID "<<endl<<endl;
+  case 22: /* declaration_list: declaration_list COMMA id_name  */
+#line 513 "22101088_22101357.y"
+                  {
+ 		  	string name = yyvsp[0]->getname();
+ 		  	outlog<<"At line no: "<<lines<<" declaration_list : declaration_list COMMA ID "<<"\n\n";
  		  	
  		  	varlist=varlist+","+name;
  		  	
-			outlog<<varlist<<endl<<endl;
+			outlog<<varlist<<"\n\n";
 			
-			(yyval) = new symbol_info(varlist,"decl_list");
+			yyval = new symbol_info(varlist,"decl_list");
  		  }
+#line 1907 "y.tab.c"
     break;
 
-  case 23:
-/* Line 1792 of yacc.c  */
-#line 449 "22101088_22101357.y"
-    {
- 		  	string name = (yyvsp[(3) - (6)])->getname();
- 		  	string size = (yyvsp[(5) - (6)])->getname();
- 		  	outlog<<"At line no: "<<lines<<" declaration_list : declaration_list COMMA ID LTHIRD CONST_INT RTHIRD "<<endl<<endl;
+  case 23: /* declaration_list: declaration_list COMMA id_name LTHIRD CONST_INT RTHIRD  */
+#line 524 "22101088_22101357.y"
+                  {
+ 		  	string name = yyvsp[-3]->getname();
+ 		  	string size = yyvsp[-1]->getname();
+ 		  	outlog<<"At line no: "<<lines<<" declaration_list : declaration_list COMMA ID LTHIRD CONST_INT RTHIRD "<<"\n\n";
  		  	
  		  	varlist=varlist+","+name+"["+size+"]";
  		  	
-			outlog<<varlist<<endl<<endl;
+			outlog<<varlist<<"\n\n";
 			
-			(yyval) = new symbol_info(varlist,"decl_list");
+			yyval = new symbol_info(varlist,"decl_list");
  		  }
+#line 1923 "y.tab.c"
     break;
 
-  case 24:
-/* Line 1792 of yacc.c  */
-#line 461 "22101088_22101357.y"
-    {
- 		  	string name = (yyvsp[(1) - (1)])->getname();
- 		  	outlog<<"At line no: "<<lines<<" declaration_list : ID "<<endl<<endl;
-			outlog<<name<<endl<<endl;
+  case 24: /* declaration_list: id_name  */
+#line 536 "22101088_22101357.y"
+                  {
+ 		  	string name = yyvsp[0]->getname();
+ 		  	outlog<<"At line no: "<<lines<<" declaration_list : ID "<<"\n\n";
+			outlog<<name<<"\n\n";
 			
 			varlist+=name;
 			
-			(yyval) = new symbol_info(name,"decl_list");
+			yyval = new symbol_info(name,"decl_list");
  		  }
+#line 1937 "y.tab.c"
     break;
 
-  case 25:
-/* Line 1792 of yacc.c  */
-#line 471 "22101088_22101357.y"
-    {
- 		  	string name = (yyvsp[(1) - (4)])->getname();
- 		  	string size = (yyvsp[(3) - (4)])->getname();
- 		  	outlog<<"At line no: "<<lines<<" declaration_list : ID LTHIRD CONST_INT RTHIRD "<<endl<<endl;
-			outlog<<name+"["+size+"]"<<endl<<endl;
+  case 25: /* declaration_list: id_name LTHIRD CONST_INT RTHIRD  */
+#line 546 "22101088_22101357.y"
+                  {
+ 		  	string name = yyvsp[-3]->getname();
+ 		  	string size = yyvsp[-1]->getname();
+ 		  	outlog<<"At line no: "<<lines<<" declaration_list : ID LTHIRD CONST_INT RTHIRD "<<"\n\n";
+			outlog<<name+"["+size+"]"<<"\n\n";
 			
 			varlist=varlist+name+"["+size+"]";
 			
-			(yyval) = new symbol_info(name+"["+size+"]","decl_list");
+			yyval = new symbol_info(name+"["+size+"]","decl_list");
  		  }
+#line 1952 "y.tab.c"
     break;
 
-  case 26:
-/* Line 1792 of yacc.c  */
-#line 483 "22101088_22101357.y"
-    {
-		   	(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"ID");
-		   	func_name = (yyvsp[(1) - (1)])->getname();
+  case 26: /* id_name: ID  */
+#line 558 "22101088_22101357.y"
+                  {
+		   	yyval = new symbol_info(yyvsp[0]->getname(),"ID");
+		   	func_name = yyvsp[0]->getname();
 		   	func_ret_type = ret_type;
 		  }
+#line 1962 "y.tab.c"
     break;
 
-  case 27:
-/* Line 1792 of yacc.c  */
-#line 491 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statements : statement "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 27: /* statements: statement  */
+#line 566 "22101088_22101357.y"
+           {
+	    	outlog<<"At line no: "<<lines<<" statements : statement "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"stmnts");
+			yyval = new symbol_info(yyvsp[0]->getname(),"stmnts");
 			
 			// Create block for statements
 			BlockNode* block = new BlockNode();
-			if((yyvsp[(1) - (1)])->get_ast_node()) {
-				block->add_statement((StmtNode*)(yyvsp[(1) - (1)])->get_ast_node());
+			if(yyvsp[0]->get_ast_node()) {
+				block->add_statement((StmtNode*)yyvsp[0]->get_ast_node());
 			}
-			(yyval)->set_ast_node(block);
+			yyval->set_ast_node(block);
+			
+			uint32_t flat_block = flat_ast.block();
+			flat_ast.append(flat_block, yyvsp[0]->get_flat_node());
+			yyval->set_flat_node(flat_block);
 	   }
+#line 1984 "y.tab.c"
     break;
 
-  case 28:
-/* Line 1792 of yacc.c  */
-#line 505 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statements : statements statement "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (2)])->getname()<<"\n"<<(yyvsp[(2) - (2)])->getname()<<endl<<endl;
+  case 28: /* statements: statements statement  */
+#line 584 "22101088_22101357.y"
+           {
+	    	outlog<<"At line no: "<<lines<<" statements : statements statement "<<"\n\n";
+			outlog<<yyvsp[-1]->getname()<<"\n"<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (2)])->getname()+"\n"+(yyvsp[(2) - (2)])->getname(),"stmnts");
+			yyval = new symbol_info(yyvsp[-1]->getname()+"\n"+yyvsp[0]->getname(),"stmnts");
 			
 			// Update block with new statement
-			BlockNode* block = (BlockNode*)(yyvsp[(1) - (2)])->get_ast_node();
-			if((yyvsp[(2) - (2)])->get_ast_node()) {
-				block->add_statement((StmtNode*)(yyvsp[(2) - (2)])->get_ast_node());
+			BlockNode* block = (BlockNode*)yyvsp[-1]->get_ast_node();
+			if(yyvsp[0]->get_ast_node()) {
+				block->add_statement((StmtNode*)yyvsp[0]->get_ast_node());
 			}
-			(yyval)->set_ast_node(block);
+			yyval->set_ast_node(block);
+			
+			flat_ast.append(yyvsp[-1]->get_flat_node(), yyvsp[0]->get_flat_node());
+			yyval->set_flat_node(yyvsp[-1]->get_flat_node());
 	   }
+#line 2005 "y.tab.c"
     break;
 
-  case 29:
-/* Line 1792 of yacc.c  */
-#line 519 "22101088_22101357.y"
-    {
-	  		(yyval) = new symbol_info("","stmnts");
+  case 29: /* statements: error  */
+#line 601 "22101088_22101357.y"
+           {
+	  		yyval = new symbol_info("","stmnts");
 			BlockNode* block = new BlockNode();
-			(yyval)->set_ast_node(block);
+			yyval->set_ast_node(block);
+			yyval->set_flat_node(flat_ast.block());
 	   }
+#line 2016 "y.tab.c"
     break;
 
-  case 30:
-/* Line 1792 of yacc.c  */
-#line 525 "22101088_22101357.y"
-    {
-	   		(yyval) = new symbol_info((yyvsp[(1) - (2)])->getname(),"stmnts");
-			(yyval)->set_ast_node((yyvsp[(1) - (2)])->get_ast_node());
+  case 30: /* statements: statements error  */
+#line 608 "22101088_22101357.y"
+           {
+	   		yyval = new symbol_info(yyvsp[-1]->getname(),"stmnts");
+			yyval->set_ast_node(yyvsp[-1]->get_ast_node());
+			yyval->set_flat_node(yyvsp[-1]->get_flat_node());
 	   }
+#line 2026 "y.tab.c"
     break;
 
-  case 31:
-/* Line 1792 of yacc.c  */
-#line 532 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statement : var_declaration "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 31: /* statement: var_declaration  */
+#line 616 "22101088_22101357.y"
+          {
+	    	outlog<<"At line no: "<<lines<<" statement : var_declaration "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"stmnt");
-			(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+			yyval = new symbol_info(yyvsp[0]->getname(),"stmnt");
+			yyval->set_ast_node(yyvsp[0]->get_ast_node());
+			yyval->set_flat_node(yyvsp[0]->get_flat_node());
 	  }
+#line 2039 "y.tab.c"
     break;
 
-  case 32:
-/* Line 1792 of yacc.c  */
-#line 540 "22101088_22101357.y"
-    {
-	  		outlog<<"At line no: "<<lines<<" Function definition must be in the global scope "<<endl<<endl;
-	  		outerror<<"At line no: "<<lines<<" Function definition must be in the global scope "<<endl<<endl;
+  case 32: /* statement: func_definition  */
+#line 625 "22101088_22101357.y"
+          {
+	  		outlog<<"At line no: "<<lines<<" Function definition must be in the global scope "<<"\n\n";
+	  		outerror<<"At line no: "<<lines<<" Function definition must be in the global scope "<<"\n\n";
 	  		errors++;
-	  		(yyval) = new symbol_info("","stmnt");
+	  		yyval = new symbol_info("","stmnt");
 	  		
 	  }
+#line 2051 "y.tab.c"
     break;
 
-  case 33:
-/* Line 1792 of yacc.c  */
-#line 548 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statement : expression_statement "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 33: /* statement: expression_statement  */
+#line 633 "22101088_22101357.y"
+          {
+	    	outlog<<"At line no: "<<lines<<" statement : expression_statement "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"stmnt");
-			(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+			yyval = new symbol_info(yyvsp[0]->getname(),"stmnt");
+			yyval->set_ast_node(yyvsp[0]->get_ast_node());
+			yyval->set_flat_node(yyvsp[0]->get_flat_node());
 	  }
+#line 2064 "y.tab.c"
     break;
 
-  case 34:
-/* Line 1792 of yacc.c  */
-#line 556 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statement : compound_statement "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 34: /* statement: compound_statement  */
+#line 642 "22101088_22101357.y"
+          {
+	    	outlog<<"At line no: "<<lines<<" statement : compound_statement "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"stmnt");
-			(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+			yyval = new symbol_info(yyvsp[0]->getname(),"stmnt");
+			yyval->set_ast_node(yyvsp[0]->get_ast_node());
+			yyval->set_flat_node(yyvsp[0]->get_flat_node());
 	  }
+#line 2077 "y.tab.c"
     break;
 
-  case 35:
-/* Line 1792 of yacc.c  */
-#line 564 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statement : FOR LPAREN expression_statement expression_statement expression RPAREN statement "<<endl<<endl;
-			outlog<<"for("<<(yyvsp[(3) - (7)])->getname()<<(yyvsp[(4) - (7)])->getname()<<(yyvsp[(5) - (7)])->getname()<<")\n"<<(yyvsp[(7) - (7)])->getname()<<endl<<endl;
+  case 35: /* statement: FOR LPAREN expression_statement expression_statement expression RPAREN statement  */
+#line 651 "22101088_22101357.y"
+          {
+	    	outlog<<"At line no: "<<lines<<" statement : FOR LPAREN expression_statement expression_statement expression RPAREN statement "<<"\n\n";
+			outlog<<"for("<<yyvsp[-4]->getname()<<yyvsp[-3]->getname()<<yyvsp[-2]->getname()<<")\n"<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info("for("+(yyvsp[(3) - (7)])->getname()+(yyvsp[(4) - (7)])->getname()+(yyvsp[(5) - (7)])->getname()+")\n"+(yyvsp[(7) - (7)])->getname(),"stmnt");
+			yyval = new symbol_info("for("+yyvsp[-4]->getname()+yyvsp[-3]->getname()+yyvsp[-2]->getname()+")\n"+yyvsp[0]->getname(),"stmnt");
 			
 			// Create AST node for for loop
 			ForNode* forNode = new ForNode(
-				(ExprNode*)(yyvsp[(3) - (7)])->get_ast_node(),
-				(ExprNode*)(yyvsp[(4) - (7)])->get_ast_node(),
-				(ExprNode*)(yyvsp[(5) - (7)])->get_ast_node(),
-				(StmtNode*)(yyvsp[(7) - (7)])->get_ast_node()
+				ast_cast<ExprStmtNode>(yyvsp[-4]->get_ast_node()),
+				ast_cast<ExprStmtNode>(yyvsp[-3]->get_ast_node()),
+				(ExprNode*)yyvsp[-2]->get_ast_node(),
+				(StmtNode*)yyvsp[0]->get_ast_node()
 			);
-			(yyval)->set_ast_node(forNode);
+			yyval->set_ast_node(forNode);
+			yyval->set_flat_node(flat_ast.for_stmt(yyvsp[-4]->get_flat_node(), yyvsp[-3]->get_flat_node(), yyvsp[-2]->get_flat_node(), yyvsp[0]->get_flat_node()));
 	  }
+#line 2098 "y.tab.c"
     break;
 
-  case 36:
-/* Line 1792 of yacc.c  */
-#line 580 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statement : IF LPAREN expression RPAREN statement "<<endl<<endl;
-			outlog<<"if("<<(yyvsp[(3) - (5)])->getname()<<")\n"<<(yyvsp[(5) - (5)])->getname()<<endl<<endl;
+  case 36: /* statement: IF LPAREN expression RPAREN statement  */
+#line 668 "22101088_22101357.y"
+          {
+	    	outlog<<"At line no: "<<lines<<" statement : IF LPAREN expression RPAREN statement "<<"\n\n";
+			outlog<<"if("<<yyvsp[-2]->getname()<<")\n"<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info("if("+(yyvsp[(3) - (5)])->getname()+")\n"+(yyvsp[(5) - (5)])->getname(),"stmnt");
+			yyval = new symbol_info("if("+yyvsp[-2]->getname()+")\n"+yyvsp[0]->getname(),"stmnt");
 			
 			// Create AST node for if statement (without else)
 			IfNode* ifNode = new IfNode(
-				(ExprNode*)(yyvsp[(3) - (5)])->get_ast_node(),
-				(StmtNode*)(yyvsp[(5) - (5)])->get_ast_node()
+				(ExprNode*)yyvsp[-2]->get_ast_node(),
+				(StmtNode*)yyvsp[0]->get_ast_node()
 			);
-			(yyval)->set_ast_node(ifNode);
+			yyval->set_ast_node(ifNode);
+			yyval->set_flat_node(flat_ast.if_stmt(yyvsp[-2]->get_flat_node(), yyvsp[0]->get_flat_node()));
 	  }
+#line 2117 "y.tab.c"
     break;
 
-  case 37:
-/* Line 1792 of yacc.c  */
-#line 594 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statement : IF LPAREN expression RPAREN statement ELSE statement "<<endl<<endl;
-			outlog<<"if("<<(yyvsp[(3) - (7)])->getname()<<")\n"<<(yyvsp[(5) - (7)])->getname()<<"\nelse\n"<<(yyvsp[(7) - (7)])->getname()<<endl<<endl;
+  case 37: /* statement: IF LPAREN expression RPAREN statement ELSE statement  */
+#line 683 "22101088_22101357.y"
+          {
+	    	outlog<<"At line no: "<<lines<<" statement : IF LPAREN expression RPAREN statement ELSE statement "<<"\n\n";
+			outlog<<"if("<<yyvsp[-4]->getname()<<")\n"<<yyvsp[-2]->getname()<<"\nelse\n"<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info("if("+(yyvsp[(3) - (7)])->getname()+")\n"+(yyvsp[(5) - (7)])->getname()+"\nelse\n"+(yyvsp[(7) - (7)])->getname(),"stmnt");
+			yyval = new symbol_info("if("+yyvsp[-4]->getname()+")\n"+yyvsp[-2]->getname()+"\nelse\n"+yyvsp[0]->getname(),"stmnt");
 			
 			// Create AST node for if-else statement
 			IfNode* ifNode = new IfNode(
-				(ExprNode*)(yyvsp[(3) - (7)])->get_ast_node(),
-				(StmtNode*)(yyvsp[(5) - (7)])->get_ast_node(),
-				(StmtNode*)(yyvsp[(7) - (7)])->get_ast_node()
+				(ExprNode*)yyvsp[-4]->get_ast_node(),
+				(StmtNode*)yyvsp[-2]->get_ast_node(),
+				(StmtNode*)yyvsp[0]->get_ast_node()
 			);
-			(yyval)->set_ast_node(ifNode);
+			yyval->set_ast_node(ifNode);
+			yyval->set_flat_node(flat_ast.if_stmt(yyvsp[-4]->get_flat_node(), yyvsp[-2]->get_flat_node(), yyvsp[0]->get_flat_node()));
 	  }
+#line 2137 "y.tab.c"
     break;
 
-  case 38:
-/* Line 1792 of yacc.c  */
-#line 609 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statement : WHILE LPAREN expression RPAREN statement "<<endl<<endl;
-			outlog<<"while("<<(yyvsp[(3) - (5)])->getname()<<")\n"<<(yyvsp[(5) - (5)])->getname()<<endl<<endl;
+  case 38: /* statement: WHILE LPAREN expression RPAREN statement  */
+#line 699 "22101088_22101357.y"
+          {
+	    	outlog<<"At line no: "<<lines<<" statement : WHILE LPAREN expression RPAREN statement "<<"\n\n";
+			outlog<<"while("<<yyvsp[-2]->getname()<<")\n"<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info("while("+(yyvsp[(3) - (5)])->getname()+")\n"+(yyvsp[(5) - (5)])->getname(),"stmnt");
+			yyval = new symbol_info("while("+yyvsp[-2]->getname()+")\n"+yyvsp[0]->getname(),"stmnt");
 			
 			// Create AST node for while loop
 			WhileNode* whileNode = new WhileNode(
-				(ExprNode*)(yyvsp[(3) - (5)])->get_ast_node(),
-				(StmtNode*)(yyvsp[(5) - (5)])->get_ast_node()
+				(ExprNode*)yyvsp[-2]->get_ast_node(),
+				(StmtNode*)yyvsp[0]->get_ast_node()
 			);
-			(yyval)->set_ast_node(whileNode);
+			yyval->set_ast_node(whileNode);
+			yyval->set_flat_node(flat_ast.while_stmt(yyvsp[-2]->get_flat_node(), yyvsp[0]->get_flat_node()));
 	  }
+#line 2156 "y.tab.c"
     break;
 
-  case 39:
-/* Line 1792 of yacc.c  */
-#line 623 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statement : PRINTLN LPAREN ID RPAREN SEMICOLON "<<endl<<endl;
-			outlog<<"printf("<<(yyvsp[(3) - (5)])->getname()<<");"<<endl<<endl; 
+  case 39: /* statement: PRINTLN LPAREN id_name RPAREN SEMICOLON  */
+#line 714 "22101088_22101357.y"
+          {
+	    	outlog<<"At line no: "<<lines<<" statement : PRINTLN LPAREN ID RPAREN SEMICOLON "<<"\n\n";
+			outlog<<"printf("<<yyvsp[-2]->getname()<<");"<<"\n\n"; 
 			
-			if(symtbl->Lookup_in_table((yyvsp[(3) - (5)])->getname()) == NULL)
+			if(symtbl->Lookup_in_table(yyvsp[-2]->getname()) == NULL)
 			{
-				outerror<<"At line no: "<<lines<<" Undeclared variable "<<(yyvsp[(3) - (5)])->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" Undeclared variable "<<(yyvsp[(3) - (5)])->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" Undeclared variable "<<yyvsp[-2]->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" Undeclared variable "<<yyvsp[-2]->getname()<<"\n\n";
 				errors++;
 			}
 			
-			(yyval) = new symbol_info("printf("+(yyvsp[(3) - (5)])->getname()+");","stmnt");
+			yyval = new symbol_info("printf("+yyvsp[-2]->getname()+");","stmnt");
 			
 			// Could add a PrintNode to AST if needed
 			// For now, create a basic expression statement
-			VarNode* var = new VarNode((yyvsp[(3) - (5)])->getname(), 
-			                         symtbl->Lookup_in_table((yyvsp[(3) - (5)])->getname()) ? 
-			                         symtbl->Lookup_in_table((yyvsp[(3) - (5)])->getname())->getvartype() : "error");
+			VarNode* var = new VarNode(yyvsp[-2]->getname(), 
+			                         symtbl->Lookup_in_table(yyvsp[-2]->getname()) ? 
+			                         symtbl->Lookup_in_table(yyvsp[-2]->getname())->getvartype() : "error");
 			ExprStmtNode* printNode = new ExprStmtNode(var);
-			(yyval)->set_ast_node(printNode);
+			yyval->set_ast_node(printNode);
+			yyval->set_flat_node(flat_ast.expr_stmt(flat_ast.var(yyvsp[-2]->getname(), var->get_type())));
 	  }
+#line 2183 "y.tab.c"
     break;
 
-  case 40:
-/* Line 1792 of yacc.c  */
-#line 645 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" statement : RETURN expression SEMICOLON "<<endl<<endl;
-			outlog<<"return "<<(yyvsp[(2) - (3)])->getname()<<";"<<endl<<endl;
+  case 40: /* statement: RETURN expression SEMICOLON  */
+#line 737 "22101088_22101357.y"
+          {
+	    	outlog<<"At line no: "<<lines<<" statement : RETURN expression SEMICOLON "<<"\n\n";
+			outlog<<"return "<<yyvsp[-1]->getname()<<";"<<"\n\n";
 			
-			(yyval) = new symbol_info("return "+(yyvsp[(2) - (3)])->getname()+";","stmnt");
+			yyval = new symbol_info("return "+yyvsp[-1]->getname()+";","stmnt");
 			
 			// Create AST node for return statement
-			ReturnNode* returnNode = new ReturnNode((ExprNode*)(yyvsp[(2) - (3)])->get_ast_node());
-			(yyval)->set_ast_node(returnNode);
+			ReturnNode* returnNode = new ReturnNode((ExprNode*)yyvsp[-1]->get_ast_node());
+			yyval->set_ast_node(returnNode);
+			yyval->set_flat_node(flat_ast.return_stmt(yyvsp[-1]->get_flat_node()));
 	  }
+#line 2199 "y.tab.c"
     break;
 
-  case 41:
-/* Line 1792 of yacc.c  */
-#line 658 "22101088_22101357.y"
-    {
-				outlog<<"At line no: "<<lines<<" expression_statement : SEMICOLON "<<endl<<endl;
-				outlog<<";"<<endl<<endl;
+  case 41: /* expression_statement: SEMICOLON  */
+#line 751 "22101088_22101357.y"
+                        {
+				outlog<<"At line no: "<<lines<<" expression_statement : SEMICOLON "<<"\n\n";
+				outlog<<";"<<"\n\n";
 				
-				(yyval) = new symbol_info(";","expr_stmt");
+				yyval = new symbol_info(";","expr_stmt");
 				
 				// Create empty expression statement
 				ExprStmtNode* exprStmt = new ExprStmtNode(nullptr);
-				(yyval)->set_ast_node(exprStmt);
+				yyval->set_ast_node(exprStmt);
+				yyval->set_flat_node(flat_ast.expr_stmt(FLAT_NONE));
 	        }
+#line 2215 "y.tab.c"
     break;
 
-  case 42:
-/* Line 1792 of yacc.c  */
-#line 669 "22101088_22101357.y"
-    {
-				outlog<<"At line no: "<<lines<<" expression_statement : expression SEMICOLON "<<endl<<endl;
-				outlog<<(yyvsp[(1) - (2)])->getname()<<";"<<endl<<endl;
+  case 42: /* expression_statement: expression SEMICOLON  */
+#line 763 "22101088_22101357.y"
+                        {
+				outlog<<"At line no: "<<lines<<" expression_statement : expression SEMICOLON "<<"\n\n";
+				outlog<<yyvsp[-1]->getname()<<";"<<"\n\n";
 				
-				(yyval) = new symbol_info((yyvsp[(1) - (2)])->getname()+";","expr_stmt");
+				yyval = new symbol_info(yyvsp[-1]->getname()+";","expr_stmt");
 				
 				// Create expression statement from expression
-				ExprStmtNode* exprStmt = new ExprStmtNode((ExprNode*)(yyvsp[(1) - (2)])->get_ast_node());
-				(yyval)->set_ast_node(exprStmt);
+				ExprStmtNode* exprStmt = new ExprStmtNode((ExprNode*)yyvsp[-1]->get_ast_node());
+				yyval->set_ast_node(exprStmt);
+				yyval->set_flat_node(flat_ast.expr_stmt(yyvsp[-1]->get_flat_node()));
 	        }
+#line 2231 "y.tab.c"
     break;
 
-  case 43:
-/* Line 1792 of yacc.c  */
-#line 682 "22101088_22101357.y"
-    {
-	    outlog<<"At line no: "<<lines<<" variable : ID "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 43: /* variable: id_name  */
+#line 777 "22101088_22101357.y"
+      {
+	    outlog<<"At line no: "<<lines<<" variable : ID "<<"\n\n";
+		outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-		(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"varbl");
+		yyval = new symbol_info(yyvsp[0]->getname(),"varbl");
 		
-		if(symtbl->Lookup_in_table((yyvsp[(1) - (1)])->getname()) == NULL)
+		if(symtbl->Lookup_in_table(yyvsp[0]->getname()) == NULL)
 		{
-			outerror<<"At line no: "<<lines<<" Undeclared variable "<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
-			outlog<<"At line no: "<<lines<<" Undeclared variable "<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+			outerror<<"At line no: "<<lines<<" Undeclared variable "<<yyvsp[0]->getname()<<"\n\n";
+			outlog<<"At line no: "<<lines<<" Undeclared variable "<<yyvsp[0]->getname()<<"\n\n";
 			errors++;
 			
-			(yyval)->setvartype("error");; //not found set error type
+			yyval->setvartype("error");; //not found set error type
 		}
-		else if((symtbl->Lookup_in_table((yyvsp[(1) - (1)])->getname()))->getidtype() != "var") //variable is not a normal variable
+		else if((symtbl->Lookup_in_table(yyvsp[0]->getname()))->getidtype() != "var") //variable is not a normal variable
 		{
-			if((symtbl->Lookup_in_table((yyvsp[(1) - (1)])->getname()))->getidtype() == "array")
+			if((symtbl->Lookup_in_table(yyvsp[0]->getname()))->getidtype() == "array")
 			{
-				outerror<<"At line no: "<<lines<<" variable is of array type : "<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" variable is of array type : "<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" variable is of array type : "<<yyvsp[0]->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" variable is of array type : "<<yyvsp[0]->getname()<<"\n\n";
 				errors++;
 			}
-			else if((symtbl->Lookup_in_table((yyvsp[(1) - (1)])->getname()))->getidtype() == "func_def") 
+			else if((symtbl->Lookup_in_table(yyvsp[0]->getname()))->getidtype() == "func_def") 
 			{
-				outerror<<"At line no: "<<lines<<" variable is of function type : "<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" variable is of function type : "<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" variable is of function type : "<<yyvsp[0]->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" variable is of function type : "<<yyvsp[0]->getname()<<"\n\n";
 				errors++;
 			}
-			else if((symtbl->Lookup_in_table((yyvsp[(1) - (1)])->getname()))->getidtype() == "func_dec") 
+			else if((symtbl->Lookup_in_table(yyvsp[0]->getname()))->getidtype() == "func_dec") 
 			{
-				outerror<<"At line no: "<<lines<<" variable is of function type : "<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" variable is of function type : "<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" variable is of function type : "<<yyvsp[0]->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" variable is of function type : "<<yyvsp[0]->getname()<<"\n\n";
 				errors++;
 			}
 			
 			
-			(yyval)->setvartype("error");; //doesnt match set error type
+			yyval->setvartype("error");; //doesnt match set error type
 		}
-		else (yyval)->setvartype((symtbl->Lookup_in_table((yyvsp[(1) - (1)])->getname()))->getvartype());  //set variable type as id type
+		else yyval->setvartype((symtbl->Lookup_in_table(yyvsp[0]->getname()))->getvartype());  //set variable type as id type
 		
 		// Create AST node for variable
-		VarNode* varNode = new VarNode((yyvsp[(1) - (1)])->getname(), (yyval)->getvartype());
-		(yyval)->set_ast_node(varNode);
+		VarNode* varNode = new VarNode(yyvsp[0]->getname(), yyval->getvartype());
+		yyval->set_ast_node(varNode);
+		yyval->set_flat_node(flat_ast.var(yyvsp[0]->getname(), yyval->getvartype()));
 	 }
+#line 2281 "y.tab.c"
     break;
 
-  case 44:
-/* Line 1792 of yacc.c  */
-#line 727 "22101088_22101357.y"
-    {
-	 	outlog<<"At line no: "<<lines<<" variable : ID LTHIRD expression RTHIRD "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (4)])->getname()<<"["<<(yyvsp[(3) - (4)])->getname()<<"]"<<endl<<endl;
+  case 44: /* variable: id_name LTHIRD expression RTHIRD  */
+#line 823 "22101088_22101357.y"
+         {
+	 	outlog<<"At line no: "<<lines<<" variable : ID LTHIRD expression RTHIRD "<<"\n\n";
+		outlog<<yyvsp[-3]->getname()<<"["<<yyvsp[-1]->getname()<<"]"<<"\n\n";
 		
-		(yyval) = new symbol_info((yyvsp[(1) - (4)])->getname()+"["+(yyvsp[(3) - (4)])->getname()+"]","varbl");
+		yyval = new symbol_info(yyvsp[-3]->getname()+"["+yyvsp[-1]->getname()+"]","varbl");
 		
-		if(symtbl->Lookup_in_table((yyvsp[(1) - (4)])->getname()) == NULL)
+		if(symtbl->Lookup_in_table(yyvsp[-3]->getname()) == NULL)
 		{
-			outerror<<"At line no: "<<lines<<" Undeclared variable "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
-			outlog<<"At line no: "<<lines<<" Undeclared variable "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
+			outerror<<"At line no: "<<lines<<" Undeclared variable "<<yyvsp[-3]->getname()<<"\n\n";
+			outlog<<"At line no: "<<lines<<" Undeclared variable "<<yyvsp[-3]->getname()<<"\n\n";
 			errors++;
 			
-			(yyval)->setvartype("error");; //not found set error type
+			yyval->setvartype("error");; //not found set error type
 		}
-		else if((symtbl->Lookup_in_table((yyvsp[(1) - (4)])->getname()))->getidtype() != "array") //variable is not an array
+		else if((symtbl->Lookup_in_table(yyvsp[-3]->getname()))->getidtype() != "array") //variable is not an array
 		{
-			outerror<<"At line no: "<<lines<<" variable is not of array type : "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
-			outlog<<"At line no: "<<lines<<" variable is not of array type : "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
+			outerror<<"At line no: "<<lines<<" variable is not of array type : "<<yyvsp[-3]->getname()<<"\n\n";
+			outlog<<"At line no: "<<lines<<" variable is not of array type : "<<yyvsp[-3]->getname()<<"\n\n";
 			errors++;
 			
-			(yyval)->setvartype("error");; //doesnt match set error type
+			yyval->setvartype("error");; //doesnt match set error type
 		}
-		else if((yyvsp[(3) - (4)])->getvartype()!="int") // get type of expression of array index
+		else if(yyvsp[-1]->getvartype()!="int") // get type of expression of array index
 		{
-			outerror<<"At line no: "<<lines<<" array index is not of integer type : "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
-			outlog<<"At line no: "<<lines<<" array index is not of integer type : "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
+			outerror<<"At line no: "<<lines<<" array index is not of integer type : "<<yyvsp[-3]->getname()<<"\n\n";
+			outlog<<"At line no: "<<lines<<" array index is not of integer type : "<<yyvsp[-3]->getname()<<"\n\n";
 			errors++;
 			
-			(yyval)->setvartype("error");
+			yyval->setvartype("error");
 		}
 		else
 		{
-			(yyval)->setvartype((symtbl->Lookup_in_table((yyvsp[(1) - (4)])->getname()))->getvartype());
+			yyval->setvartype((symtbl->Lookup_in_table(yyvsp[-3]->getname()))->getvartype());
 		}
 		
 		// Create AST node for array access
-		VarNode* varNode = new VarNode((yyvsp[(1) - (4)])->getname(), (yyval)->getvartype(), (ExprNode*)(yyvsp[(3) - (4)])->get_ast_node());
-		(yyval)->set_ast_node(varNode);
+		VarNode* varNode = new VarNode(yyvsp[-3]->getname(), yyval->getvartype(), (ExprNode*)yyvsp[-1]->get_ast_node());
+		yyval->set_ast_node(varNode);
+		yyval->set_flat_node(flat_ast.var(yyvsp[-3]->getname(), yyval->getvartype(), yyvsp[-1]->get_flat_node()));
 	 }
+#line 2326 "y.tab.c"
     break;
 
-  case 45:
-/* Line 1792 of yacc.c  */
-#line 769 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" expression : logic_expression "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 45: /* expression: logic_expression  */
+#line 866 "22101088_22101357.y"
+           {
+	    	outlog<<"At line no: "<<lines<<" expression : logic_expression "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"expr");
-			(yyval)->setvartype((yyvsp[(1) - (1)])->getvartype());
-			(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+			yyval = new symbol_info(yyvsp[0]->getname(),"expr");
+			yyval->setvartype(yyvsp[0]->getvartype());
+			yyval->set_ast_node(yyvsp[0]->get_ast_node());
+			yyval->set_flat_node(yyvsp[0]->get_flat_node());
 	   }
+#line 2340 "y.tab.c"
     break;
 
-  case 46:
-/* Line 1792 of yacc.c  */
-#line 778 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" expression : variable ASSIGNOP logic_expression "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (3)])->getname()<<"="<<(yyvsp[(3) - (3)])->getname()<<endl<<endl;
+  case 46: /* expression: variable ASSIGNOP logic_expression  */
+#line 876 "22101088_22101357.y"
+           {
+	    	outlog<<"At line no: "<<lines<<" expression : variable ASSIGNOP logic_expression "<<"\n\n";
+			outlog<<yyvsp[-2]->getname()<<"="<<yyvsp[0]->getname()<<"\n\n";
 
-			(yyval) = new symbol_info((yyvsp[(1) - (3)])->getname()+"="+(yyvsp[(3) - (3)])->getname(),"expr");
-			(yyval)->setvartype((yyvsp[(1) - (3)])->getvartype());
+			yyval = new symbol_info(yyvsp[-2]->getname()+"="+yyvsp[0]->getname(),"expr");
+			yyval->setvartype(yyvsp[-2]->getvartype());
 			
-			if((yyvsp[(1) - (3)])->getvartype() == "void" || (yyvsp[(3) - (3)])->getvartype() == "void") //if any of them is a void
+			if(yyvsp[-2]->getvartype() == "void" || yyvsp[0]->getvartype() == "void") //if any of them is a void
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
 				errors++;
 				
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
-			else if((yyvsp[(1) - (3)])->getvartype() == "int" && (yyvsp[(3) - (3)])->getvartype() == "float") // assignment of float into int
+			else if(yyvsp[-2]->getvartype() == "int" && yyvsp[0]->getvartype() == "float") // assignment of float into int
 			{
-				outerror<<"At line no: "<<lines<<" Warning: Assignment of float value into variable of integer type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" Warning: Assignment of float value into variable of integer type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" Warning: Assignment of float value into variable of integer type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" Warning: Assignment of float value into variable of integer type "<<"\n\n";
 				errors++;
 				
-				(yyval)->setvartype("int");
+				yyval->setvartype("int");
 			}
 			
-			if((yyvsp[(1) - (3)])->getvartype() == "error" || (yyvsp[(3) - (3)])->getvartype() == "error") //if any of them is a error
+			if(yyvsp[-2]->getvartype() == "error" || yyvsp[0]->getvartype() == "error") //if any of them is a error
 			{
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
 			
 			// Create AST node for assignment
 			AssignNode* assignNode = new AssignNode(
-				(VarNode*)(yyvsp[(1) - (3)])->get_ast_node(),
-				(ExprNode*)(yyvsp[(3) - (3)])->get_ast_node(),
-				(yyval)->getvartype()
+				(VarNode*)yyvsp[-2]->get_ast_node(),
+				(ExprNode*)yyvsp[0]->get_ast_node(),
+				yyval->getvartype()
 			);
-			(yyval)->set_ast_node(assignNode);
+			yyval->set_ast_node(assignNode);
+			yyval->set_flat_node(flat_ast.assign(yyvsp[-2]->get_flat_node(), yyvsp[0]->get_flat_node(), yyval->getvartype()));
 	   }
+#line 2383 "y.tab.c"
     break;
 
-  case 47:
-/* Line 1792 of yacc.c  */
-#line 818 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" logic_expression : rel_expression "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 47: /* logic_expression: rel_expression  */
+#line 917 "22101088_22101357.y"
+             {
+	    	outlog<<"At line no: "<<lines<<" logic_expression : rel_expression "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"lgc_expr");
-			(yyval)->setvartype((yyvsp[(1) - (1)])->getvartype());
-			(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+			yyval = new symbol_info(yyvsp[0]->getname(),"lgc_expr");
+			yyval->setvartype(yyvsp[0]->getvartype());
+			yyval->set_ast_node(yyvsp[0]->get_ast_node());
+			yyval->set_flat_node(yyvsp[0]->get_flat_node());
 	     }
+#line 2397 "y.tab.c"
     break;
 
-  case 48:
-/* Line 1792 of yacc.c  */
-#line 827 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" logic_expression : rel_expression LOGICOP rel_expression "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (3)])->getname()<<(yyvsp[(2) - (3)])->getname()<<(yyvsp[(3) - (3)])->getname()<<endl<<endl;
+  case 48: /* logic_expression: rel_expression LOGICOP rel_expression  */
+#line 927 "22101088_22101357.y"
+                 {
+	    	outlog<<"At line no: "<<lines<<" logic_expression : rel_expression LOGICOP rel_expression "<<"\n\n";
+			outlog<<yyvsp[-2]->getname()<<yyvsp[-1]->getname()<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (3)])->getname()+(yyvsp[(2) - (3)])->getname()+(yyvsp[(3) - (3)])->getname(),"lgc_expr");
-			(yyval)->setvartype("int");
+			yyval = new symbol_info(yyvsp[-2]->getname()+yyvsp[-1]->getname()+yyvsp[0]->getname(),"lgc_expr");
+			yyval->setvartype("int");
 			
 			//do type checking of both side of logicop
 			
-			if((yyvsp[(1) - (3)])->getvartype() == "void" || (yyvsp[(3) - (3)])->getvartype() == "void") //if any of them is a void
+			if(yyvsp[-2]->getvartype() == "void" || yyvsp[0]->getvartype() == "void") //if any of them is a void
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
 				errors++;
 				
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
 			
-			if((yyvsp[(1) - (3)])->getvartype() == "error" || (yyvsp[(3) - (3)])->getvartype() == "error") //if any of them is a error
+			if(yyvsp[-2]->getvartype() == "error" || yyvsp[0]->getvartype() == "error") //if any of them is a error
 			{
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
 			
 			// Create AST node for logical operation
 			BinaryOpNode* logicNode = new BinaryOpNode(
-				(yyvsp[(2) - (3)])->getname(),
-				(ExprNode*)(yyvsp[(1) - (3)])->get_ast_node(),
-				(ExprNode*)(yyvsp[(3) - (3)])->get_ast_node(),
-				(yyval)->getvartype()
+				yyvsp[-1]->getname(),
+				(ExprNode*)yyvsp[-2]->get_ast_node(),
+				(ExprNode*)yyvsp[0]->get_ast_node(),
+				yyval->getvartype()
 			);
-			(yyval)->set_ast_node(logicNode);
+			yyval->set_ast_node(logicNode);
+			yyval->set_flat_node(flat_ast.binary(yyvsp[-1]->getname(), yyvsp[-2]->get_flat_node(), yyvsp[0]->get_flat_node(), yyval->getvartype()));
 	     }
+#line 2435 "y.tab.c"
     break;
 
-  case 49:
-/* Line 1792 of yacc.c  */
-#line 862 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" rel_expression : simple_expression "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 49: /* rel_expression: simple_expression  */
+#line 963 "22101088_22101357.y"
+                {
+	    	outlog<<"At line no: "<<lines<<" rel_expression : simple_expression "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"rel_expr");
-			(yyval)->setvartype((yyvsp[(1) - (1)])->getvartype());
-			(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+			yyval = new symbol_info(yyvsp[0]->getname(),"rel_expr");
+			yyval->setvartype(yyvsp[0]->getvartype());
+			yyval->set_ast_node(yyvsp[0]->get_ast_node());
+			yyval->set_flat_node(yyvsp[0]->get_flat_node());
 	    }
+#line 2449 "y.tab.c"
     break;
 
-  case 50:
-/* Line 1792 of yacc.c  */
-#line 871 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" rel_expression : simple_expression RELOP simple_expression "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (3)])->getname()<<(yyvsp[(2) - (3)])->getname()<<(yyvsp[(3) - (3)])->getname()<<endl<<endl;
+  case 50: /* rel_expression: simple_expression RELOP simple_expression  */
+#line 973 "22101088_22101357.y"
+                {
+	    	outlog<<"At line no: "<<lines<<" rel_expression : simple_expression RELOP simple_expression "<<"\n\n";
+			outlog<<yyvsp[-2]->getname()<<yyvsp[-1]->getname()<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (3)])->getname()+(yyvsp[(2) - (3)])->getname()+(yyvsp[(3) - (3)])->getname(),"rel_expr");
-			(yyval)->setvartype("int");
+			yyval = new symbol_info(yyvsp[-2]->getname()+yyvsp[-1]->getname()+yyvsp[0]->getname(),"rel_expr");
+			yyval->setvartype("int");
 			
 			//do type checking of both side of relop
 			
-			if((yyvsp[(1) - (3)])->getvartype() == "void" || (yyvsp[(3) - (3)])->getvartype() == "void") //if any of them is a void
+			if(yyvsp[-2]->getvartype() == "void" || yyvsp[0]->getvartype() == "void") //if any of them is a void
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
 				errors++;
 				
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
 			
-			if((yyvsp[(1) - (3)])->getvartype() == "error" || (yyvsp[(3) - (3)])->getvartype() == "error") //if any of them is a error
+			if(yyvsp[-2]->getvartype() == "error" || yyvsp[0]->getvartype() == "error") //if any of them is a error
 			{
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
 			
 			// Create AST node for relational operation
 			BinaryOpNode* relNode = new BinaryOpNode(
-				(yyvsp[(2) - (3)])->getname(),
-				(ExprNode*)(yyvsp[(1) - (3)])->get_ast_node(),
-				(ExprNode*)(yyvsp[(3) - (3)])->get_ast_node(),
-				(yyval)->getvartype()
+				yyvsp[-1]->getname(),
+				(ExprNode*)yyvsp[-2]->get_ast_node(),
+				(ExprNode*)yyvsp[0]->get_ast_node(),
+				yyval->getvartype()
 			);
-			(yyval)->set_ast_node(relNode);
+			yyval->set_ast_node(relNode);
+			yyval->set_flat_node(flat_ast.binary(yyvsp[-1]->getname(), yyvsp[-2]->get_flat_node(), yyvsp[0]->get_flat_node(), yyval->getvartype()));
 	    }
+#line 2487 "y.tab.c"
     break;
 
-  case 51:
-/* Line 1792 of yacc.c  */
-#line 906 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" simple_expression : term "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 51: /* simple_expression: term  */
+#line 1009 "22101088_22101357.y"
+          {
+	    	outlog<<"At line no: "<<lines<<" simple_expression : term "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"simp_expr");
-			(yyval)->setvartype((yyvsp[(1) - (1)])->getvartype());
-			(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+			yyval = new symbol_info(yyvsp[0]->getname(),"simp_expr");
+			yyval->setvartype(yyvsp[0]->getvartype());
+			yyval->set_ast_node(yyvsp[0]->get_ast_node());
+			yyval->set_flat_node(yyvsp[0]->get_flat_node());
 			
 	      }
+#line 2502 "y.tab.c"
     break;
 
-  case 52:
-/* Line 1792 of yacc.c  */
-#line 916 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" simple_expression : simple_expression ADDOP term "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (3)])->getname()<<(yyvsp[(2) - (3)])->getname()<<(yyvsp[(3) - (3)])->getname()<<endl<<endl;
+  case 52: /* simple_expression: simple_expression ADDOP term  */
+#line 1020 "22101088_22101357.y"
+                  {
+	    	outlog<<"At line no: "<<lines<<" simple_expression : simple_expression ADDOP term "<<"\n\n";
+			outlog<<yyvsp[-2]->getname()<<yyvsp[-1]->getname()<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (3)])->getname()+(yyvsp[(2) - (3)])->getname()+(yyvsp[(3) - (3)])->getname(),"simp_expr");
-			(yyval)->setvartype((yyvsp[(1) - (3)])->getvartype());
+			yyval = new symbol_info(yyvsp[-2]->getname()+yyvsp[-1]->getname()+yyvsp[0]->getname(),"simp_expr");
+			yyval->setvartype(yyvsp[-2]->getvartype());
 			
 			//do type checking of both side of addop
 			
-			if((yyvsp[(1) - (3)])->getvartype() == "void" || (yyvsp[(3) - (3)])->getvartype() == "void") //if any of them is a void
+			if(yyvsp[-2]->getvartype() == "void" || yyvsp[0]->getvartype() == "void") //if any of them is a void
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
 				errors++;
 				
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
-			else if((yyvsp[(1) - (3)])->getvartype() == "float" || (yyvsp[(3) - (3)])->getvartype() == "float") //if any of them is a float
+			else if(yyvsp[-2]->getvartype() == "float" || yyvsp[0]->getvartype() == "float") //if any of them is a float
 			{
-				(yyval)->setvartype("float");
+				yyval->setvartype("float");
 			}
-			else (yyval)->setvartype("int");
+			else yyval->setvartype("int");
 			
-			if((yyvsp[(1) - (3)])->getvartype() == "error" || (yyvsp[(3) - (3)])->getvartype() == "error") //if any of them is a error
+			if(yyvsp[-2]->getvartype() == "error" || yyvsp[0]->getvartype() == "error") //if any of them is a error
 			{
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
 			
 			// Create AST node for addition/subtraction
 			BinaryOpNode* addopNode = new BinaryOpNode(
-				(yyvsp[(2) - (3)])->getname(),
-				(ExprNode*)(yyvsp[(1) - (3)])->get_ast_node(),
-				(ExprNode*)(yyvsp[(3) - (3)])->get_ast_node(),
-				(yyval)->getvartype()
+				yyvsp[-1]->getname(),
+				(ExprNode*)yyvsp[-2]->get_ast_node(),
+				(ExprNode*)yyvsp[0]->get_ast_node(),
+				yyval->getvartype()
 			);
-			(yyval)->set_ast_node(addopNode);
+			yyval->set_ast_node(addopNode);
+			yyval->set_flat_node(flat_ast.binary(yyvsp[-1]->getname(), yyvsp[-2]->get_flat_node(), yyvsp[0]->get_flat_node(), yyval->getvartype()));
 	      }
+#line 2545 "y.tab.c"
     break;
 
-  case 53:
-/* Line 1792 of yacc.c  */
-#line 956 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" term : unary_expression "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 53: /* term: unary_expression  */
+#line 1061 "22101088_22101357.y"
+     {
+	    	outlog<<"At line no: "<<lines<<" term : unary_expression "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"term");
-			(yyval)->setvartype((yyvsp[(1) - (1)])->getvartype());
-			(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+			yyval = new symbol_info(yyvsp[0]->getname(),"term");
+			yyval->setvartype(yyvsp[0]->getvartype());
+			yyval->set_ast_node(yyvsp[0]->get_ast_node());
+			yyval->set_flat_node(yyvsp[0]->get_flat_node());
 			
 	 }
+#line 2560 "y.tab.c"
     break;
 
-  case 54:
-/* Line 1792 of yacc.c  */
-#line 966 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" term : term MULOP unary_expression "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (3)])->getname()<<(yyvsp[(2) - (3)])->getname()<<(yyvsp[(3) - (3)])->getname()<<endl<<endl;
+  case 54: /* term: term MULOP unary_expression  */
+#line 1072 "22101088_22101357.y"
+     {
+	    	outlog<<"At line no: "<<lines<<" term : term MULOP unary_expression "<<"\n\n";
+			outlog<<yyvsp[-2]->getname()<<yyvsp[-1]->getname()<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (3)])->getname()+(yyvsp[(2) - (3)])->getname()+(yyvsp[(3) - (3)])->getname(),"term");
-			(yyval)->setvartype((yyvsp[(1) - (3)])->getvartype());
+			yyval = new symbol_info(yyvsp[-2]->getname()+yyvsp[-1]->getname()+yyvsp[0]->getname(),"term");
+			yyval->setvartype(yyvsp[-2]->getvartype());
 			
 			//do type checking of both side of mulop
-			if((yyvsp[(1) - (3)])->getvartype() == "void" || (yyvsp[(3) - (3)])->getvartype() == "void") //if any of them is a void
+			if(yyvsp[-2]->getvartype() == "void" || yyvsp[0]->getvartype() == "void") //if any of them is a void
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type "<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type "<<"\n\n";
 				errors++;
 				
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
-			else if((yyvsp[(1) - (3)])->getvartype() == "float" || (yyvsp[(3) - (3)])->getvartype() == "float") //if any of them is a float
+			else if(yyvsp[-2]->getvartype() == "float" || yyvsp[0]->getvartype() == "float") //if any of them is a float
 			{
-				(yyval)->setvartype("float");
+				yyval->setvartype("float");
 			}
-			else (yyval)->setvartype("int");
+			else yyval->setvartype("int");
 			
 			//check if both int for modulous
-			if((yyvsp[(2) - (3)])->getname() == "%")
+			if(yyvsp[-1]->getname() == "%")
 			{
-				if((yyvsp[(1) - (3)])->getvartype() == "int" && (yyvsp[(3) - (3)])->getvartype() == "int")
+				if(yyvsp[-2]->getvartype() == "int" && yyvsp[0]->getvartype() == "int")
 				{
-					if((yyvsp[(3) - (3)])->getname()=="0")
+					if(yyvsp[0]->getname()=="0")
 					{
-						outerror<<"At line no: "<<lines<<" Modulus by 0 "<<endl<<endl;
-						outlog<<"At line no: "<<lines<<" Modulus by 0 "<<endl<<endl;
+						outerror<<"At line no: "<<lines<<" Modulus by 0 "<<"\n\n";
+						outlog<<"At line no: "<<lines<<" Modulus by 0 "<<"\n\n";
 						errors++;
 						
-						(yyval)->setvartype("error");
+						yyval->setvartype("error");
 					}
-					else (yyval)->setvartype("int");
+					else yyval->setvartype("int");
 				}
-				else if((yyvsp[(1) - (3)])->getvartype() == "float" || (yyvsp[(3) - (3)])->getvartype() == "float")
+				else if(yyvsp[-2]->getvartype() == "float" || yyvsp[0]->getvartype() == "float")
 				{
-					outerror<<"At line no: "<<lines<<" Modulus operator on non integer type "<<endl<<endl;
-					outlog<<"At line no: "<<lines<<" Modulus operator on non integer type "<<endl<<endl;
+					outerror<<"At line no: "<<lines<<" Modulus operator on non integer type "<<"\n\n";
+					outlog<<"At line no: "<<lines<<" Modulus operator on non integer type "<<"\n\n";
 					errors++;
 					
-					(yyval)->setvartype("error");
+					yyval->setvartype("error");
 				}
 			}
 			
-			if((yyvsp[(2) - (3)])->getname() == "/") //divide by 0
+			if(yyvsp[-1]->getname() == "/") //divide by 0
 			{
-				if((yyvsp[(3) - (3)])->getname()=="0")
+				if(yyvsp[0]->getname()=="0")
 				{
-					outerror<<"At line no: "<<lines<<" Divide by 0 "<<endl<<endl;
-					outlog<<"At line no: "<<lines<<" Divide by 0 "<<endl<<endl;
+					outerror<<"At line no: "<<lines<<" Divide by 0 "<<"\n\n";
+					outlog<<"At line no: "<<lines<<" Divide by 0 "<<"\n\n";
 					errors++;
 					
-					(yyval)->setvartype("error");
+					yyval->setvartype("error");
 				}
 			}
-			if((yyvsp[(1) - (3)])->getvartype() == "error" || (yyvsp[(3) - (3)])->getvartype() == "error") //if any of them is a error
+			if(yyvsp[-2]->getvartype() == "error" || yyvsp[0]->getvartype() == "error") //if any of them is a error
 			{
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
 			
 			// Create AST node for multiplication/division/modulus
 			BinaryOpNode* mulopNode = new BinaryOpNode(
-				(yyvsp[(2) - (3)])->getname(),
-				(ExprNode*)(yyvsp[(1) - (3)])->get_ast_node(),
-				(ExprNode*)(yyvsp[(3) - (3)])->get_ast_node(),
-				(yyval)->getvartype()
+				yyvsp[-1]->getname(),
+				(ExprNode*)yyvsp[-2]->get_ast_node(),
+				(ExprNode*)yyvsp[0]->get_ast_node(),
+				yyval->getvartype()
 			);
-			(yyval)->set_ast_node(mulopNode);
+			yyval->set_ast_node(mulopNode);
+			yyval->set_flat_node(flat_ast.binary(yyvsp[-1]->getname(), yyvsp[-2]->get_flat_node(), yyvsp[0]->get_flat_node(), yyval->getvartype()));
 	 }
+#line 2638 "y.tab.c"
     break;
 
-  case 55:
-/* Line 1792 of yacc.c  */
-#line 1041 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" unary_expression : ADDOP unary_expression "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (2)])->getname()<<(yyvsp[(2) - (2)])->getname()<<endl<<endl;
+  case 55: /* unary_expression: ADDOP unary_expression  */
+#line 1148 "22101088_22101357.y"
+                 {
+	    	outlog<<"At line no: "<<lines<<" unary_expression : ADDOP unary_expression "<<"\n\n";
+			outlog<<yyvsp[-1]->getname()<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (2)])->getname()+(yyvsp[(2) - (2)])->getname(),"un_expr");
-			(yyval)->setvartype((yyvsp[(2) - (2)])->getvartype());
+			yyval = new symbol_info(yyvsp[-1]->getname()+yyvsp[0]->getname(),"un_expr");
+			yyval->setvartype(yyvsp[0]->getvartype());
 			
-			if((yyvsp[(2) - (2)])->getvartype()=="void")
+			if(yyvsp[0]->getvartype()=="void")
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type : "<<(yyvsp[(2) - (2)])->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type : "<<(yyvsp[(2) - (2)])->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type : "<<yyvsp[0]->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type : "<<yyvsp[0]->getname()<<"\n\n";
 				errors++;
 				
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
 			
 			// Create AST node for unary plus/minus
 			UnaryOpNode* unaryNode = new UnaryOpNode(
-				(yyvsp[(1) - (2)])->getname(),
-				(ExprNode*)(yyvsp[(2) - (2)])->get_ast_node(),
-				(yyval)->getvartype()
+				yyvsp[-1]->getname(),
+				(ExprNode*)yyvsp[0]->get_ast_node(),
+				yyval->getvartype()
 			);
-			(yyval)->set_ast_node(unaryNode);
+			yyval->set_ast_node(unaryNode);
+			yyval->set_flat_node(flat_ast.unary(yyvsp[-1]->getname(), yyvsp[0]->get_flat_node(), yyval->getvartype()));
 	     }
+#line 2668 "y.tab.c"
     break;
 
-  case 56:
-/* Line 1792 of yacc.c  */
-#line 1066 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" unary_expression : NOT unary_expression "<<endl<<endl;
-			outlog<<"!"<<(yyvsp[(2) - (2)])->getname()<<endl<<endl;
+  case 56: /* unary_expression: NOT unary_expression  */
+#line 1174 "22101088_22101357.y"
+                 {
+	    	outlog<<"At line no: "<<lines<<" unary_expression : NOT unary_expression "<<"\n\n";
+			outlog<<"!"<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info("!"+(yyvsp[(2) - (2)])->getname(),"un_expr");
-			(yyval)->setvartype("int");
+			yyval = new symbol_info("!"+yyvsp[0]->getname(),"un_expr");
+			yyval->setvartype("int");
 			
-			if((yyvsp[(2) - (2)])->getvartype()=="void")
+			if(yyvsp[0]->getvartype()=="void")
 			{
-				outerror<<"At line no: "<<lines<<" operation on void type : "<<(yyvsp[(2) - (2)])->getname()<<endl<<endl;
-				outlog<<"At line no: "<<lines<<" operation on void type : "<<(yyvsp[(2) - (2)])->getname()<<endl<<endl;
+				outerror<<"At line no: "<<lines<<" operation on void type : "<<yyvsp[0]->getname()<<"\n\n";
+				outlog<<"At line no: "<<lines<<" operation on void type : "<<yyvsp[0]->getname()<<"\n\n";
 				errors++;
 				
-				(yyval)->setvartype("error");
+				yyval->setvartype("error");
 			}
 			
 			// Create AST node for logical NOT
 			UnaryOpNode* notNode = new UnaryOpNode(
 				"!",
-				(ExprNode*)(yyvsp[(2) - (2)])->get_ast_node(),
-				(yyval)->getvartype()
+				(ExprNode*)yyvsp[0]->get_ast_node(),
+				yyval->getvartype()
 			);
-			(yyval)->set_ast_node(notNode);
+			yyval->set_ast_node(notNode);
+			yyval->set_flat_node(flat_ast.unary("!", yyvsp[0]->get_flat_node(), yyval->getvartype()));
 	     }
+#line 2698 "y.tab.c"
     break;
 
-  case 57:
-/* Line 1792 of yacc.c  */
-#line 1091 "22101088_22101357.y"
-    {
-	    	outlog<<"At line no: "<<lines<<" unary_expression : factor "<<endl<<endl;
-			outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 57: /* unary_expression: factor  */
+#line 1200 "22101088_22101357.y"
+                 {
+	    	outlog<<"At line no: "<<lines<<" unary_expression : factor "<<"\n\n";
+			outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-			(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"un_expr");
-			(yyval)->setvartype((yyvsp[(1) - (1)])->getvartype());
-			(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+			yyval = new symbol_info(yyvsp[0]->getname(),"un_expr");
+			yyval->setvartype(yyvsp[0]->getvartype());
+			yyval->set_ast_node(yyvsp[0]->get_ast_node());
+			yyval->set_flat_node(yyvsp[0]->get_flat_node());
 			
 			//outlog<<$1->getvartype()<<endl;
 	     }
+#line 2714 "y.tab.c"
     break;
 
-  case 58:
-/* Line 1792 of yacc.c  */
-#line 1104 "22101088_22101357.y"
+  case 58: /* factor: variable  */
+#line 1214 "22101088_22101357.y"
     {
-	    outlog<<"At line no: "<<lines<<" factor : variable "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+	    outlog<<"At line no: "<<lines<<" factor : variable "<<"\n\n";
+		outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-		(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"fctr");
-		(yyval)->setvartype((yyvsp[(1) - (1)])->getvartype());
-		(yyval)->set_ast_node((yyvsp[(1) - (1)])->get_ast_node());
+		yyval = new symbol_info(yyvsp[0]->getname(),"fctr");
+		yyval->setvartype(yyvsp[0]->getvartype());
+		yyval->set_ast_node(yyvsp[0]->get_ast_node());
+		yyval->set_flat_node(yyvsp[0]->get_flat_node());
 	}
+#line 2728 "y.tab.c"
     break;
 
-  case 59:
-/* Line 1792 of yacc.c  */
-#line 1113 "22101088_22101357.y"
-    {
-	    outlog<<"At line no: "<<lines<<" factor : ID LPAREN argument_list RPAREN "<<endl<<endl;
-	    outlog<<(yyvsp[(1) - (4)])->getname()<<"("<<(yyvsp[(3) - (4)])->getname()<<")"<<endl<<endl;
+  case 59: /* factor: id_name LPAREN argument_list RPAREN  */
+#line 1224 "22101088_22101357.y"
+        {
+	    outlog<<"At line no: "<<lines<<" factor : ID LPAREN argument_list RPAREN "<<"\n\n";
+	    outlog<<yyvsp[-3]->getname()<<"("<<yyvsp[-1]->getname()<<")"<<"\n\n";
 	
-	    (yyval) = new symbol_info((yyvsp[(1) - (4)])->getname()+"("+(yyvsp[(3) - (4)])->getname()+")","fctr");
-	    (yyval)->setvartype("error");
+	    yyval = new symbol_info(yyvsp[-3]->getname()+"("+yyvsp[-1]->getname()+")","fctr");
+	    yyval->setvartype("error");
 	
 	    int flag = 0;
 	
 	    // Type checking (existing code)
-	    if(symtbl->Lookup_in_table((yyvsp[(1) - (4)])->getname())==NULL) //undeclared function
+	    if(symtbl->Lookup_in_table(yyvsp[-3]->getname())==NULL) //undeclared function
 	    {
-	        outerror<<"At line no: "<<lines<<" Undeclared function: "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
-	        outlog<<"At line no: "<<lines<<" Undeclared function: "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
+	        outerror<<"At line no: "<<lines<<" Undeclared function: "<<yyvsp[-3]->getname()<<"\n\n";
+	        outlog<<"At line no: "<<lines<<" Undeclared function: "<<yyvsp[-3]->getname()<<"\n\n";
 	        errors++;
 	    }
 	    else
 	    {
-	        if((symtbl->Lookup_in_table((yyvsp[(1) - (4)])->getname()))->getidtype()=="func_dec") //declared but not defined
+	        if((symtbl->Lookup_in_table(yyvsp[-3]->getname()))->getidtype()=="func_dec") //declared but not defined
 	        {
-	            outerror<<"At line no: "<<lines<<" Undefined function: "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
-	            outlog<<"At line no: "<<lines<<" Undefined function: "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
+	            outerror<<"At line no: "<<lines<<" Undefined function: "<<yyvsp[-3]->getname()<<"\n\n";
+	            outlog<<"At line no: "<<lines<<" Undefined function: "<<yyvsp[-3]->getname()<<"\n\n";
 	            errors++;
 	        }
-	        else if((symtbl->Lookup_in_table((yyvsp[(1) - (4)])->getname()))->getidtype()=="func_def")
+	        else if((symtbl->Lookup_in_table(yyvsp[-3]->getname()))->getidtype()=="func_def")
 	        {
-	            vector<string> templist = (symtbl->Lookup_in_table((yyvsp[(1) - (4)])->getname()))->getparamlist();
+	            vector<string> templist = (symtbl->Lookup_in_table(yyvsp[-3]->getname()))->getparamlist();
 	
 	            if(arglist.size()!=templist.size()) //number of prameters don't match
 	            {
-	                outerror<<"At line no: "<<lines<<" Inconsistencies in number of arguments in function call: "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
-	                outlog<<"At line no: "<<lines<<" Inconsistencies in number of arguments in function call: "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
+	                outerror<<"At line no: "<<lines<<" Inconsistencies in number of arguments in function call: "<<yyvsp[-3]->getname()<<"\n\n";
+	                outlog<<"At line no: "<<lines<<" Inconsistencies in number of arguments in function call: "<<yyvsp[-3]->getname()<<"\n\n";
 	                errors++;
 	            }
 	            else if(templist.size()!=0)
@@ -2855,23 +2773,23 @@ yyreduce:
 	                        else if(arglist[i]!="error")
 	                        {
 	                            flag = 1;
-	                            outerror<<"At line no: "<<lines<<" "<<"argument "<<i+1<<" type mismatch in function call: "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
-	                            outlog<<"At line no: "<<lines<<" "<<"argument "<<i+1<<" type mismatch in function call: "<<(yyvsp[(1) - (4)])->getname()<<endl<<endl;
+	                            outerror<<"At line no: "<<lines<<" "<<"argument "<<i+1<<" type mismatch in function call: "<<yyvsp[-3]->getname()<<"\n\n";
+	                            outlog<<"At line no: "<<lines<<" "<<"argument "<<i+1<<" type mismatch in function call: "<<yyvsp[-3]->getname()<<"\n\n";
 	                            errors++;
 	                        }
 	                    }
 	                }                   
 	            }
-	            if(!flag) (yyval)->setvartype((symtbl->Lookup_in_table((yyvsp[(1) - (4)])->getname()))->getvartype());
+	            if(!flag) yyval->setvartype((symtbl->Lookup_in_table(yyvsp[-3]->getname()))->getvartype());
 	        }
 	    }
 	
 	    // Create function call node
-	    FuncCallNode* funcCall = new FuncCallNode((yyvsp[(1) - (4)])->getname(), (yyval)->getvartype());
+	    FuncCallNode* funcCall = new FuncCallNode(yyvsp[-3]->getname(), yyval->getvartype());
 	
 	    // Get arguments from the ArgumentsNode if it exists
-	    if ((yyvsp[(3) - (4)])->get_ast_node()) {
-	        ArgumentsNode* argsNode = dynamic_cast<ArgumentsNode*>((yyvsp[(3) - (4)])->get_ast_node());
+	    if (yyvsp[-1]->get_ast_node()) {
+	        ArgumentsNode* argsNode = ast_cast<ArgumentsNode>(yyvsp[-1]->get_ast_node());
 	        if (argsNode) {
 	            // Add each argument to the function call
 	            for (auto arg : argsNode->get_arguments()) {
@@ -2880,172 +2798,191 @@ yyreduce:
 	        }
 	    }
 	
-	    (yyval)->set_ast_node(funcCall);
+	    yyval->set_ast_node(funcCall);
+	    yyval->set_flat_node(flat_ast.call(yyvsp[-3]->getname(), yyval->getvartype(), yyvsp[-1]->get_flat_node()));
 	
 	    arglist.clear();
 	}
+#line 2807 "y.tab.c"
     break;
 
-  case 60:
-/* Line 1792 of yacc.c  */
-#line 1187 "22101088_22101357.y"
-    {
-	   	outlog<<"At line no: "<<lines<<" factor : LPAREN expression RPAREN "<<endl<<endl;
-		outlog<<"("<<(yyvsp[(2) - (3)])->getname()<<")"<<endl<<endl;
+  case 60: /* factor: LPAREN expression RPAREN  */
+#line 1299 "22101088_22101357.y"
+        {
+	   	outlog<<"At line no: "<<lines<<" factor : LPAREN expression RPAREN "<<"\n\n";
+		outlog<<"("<<yyvsp[-1]->getname()<<")"<<"\n\n";
 		
-		(yyval) = new symbol_info("("+(yyvsp[(2) - (3)])->getname()+")","fctr");
-		(yyval)->setvartype((yyvsp[(2) - (3)])->getvartype());
-		(yyval)->set_ast_node((yyvsp[(2) - (3)])->get_ast_node()); // Pass through the expression AST
+		yyval = new symbol_info("("+yyvsp[-1]->getname()+")","fctr");
+		yyval->setvartype(yyvsp[-1]->getvartype());
+		yyval->set_ast_node(yyvsp[-1]->get_ast_node()); // Pass through the expression AST
+		yyval->set_flat_node(yyvsp[-1]->get_flat_node());
 	}
+#line 2821 "y.tab.c"
     break;
 
-  case 61:
-/* Line 1792 of yacc.c  */
-#line 1196 "22101088_22101357.y"
-    {
-	    outlog<<"At line no: "<<lines<<" factor : CONST_INT "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 61: /* factor: CONST_INT  */
+#line 1309 "22101088_22101357.y"
+        {
+	    outlog<<"At line no: "<<lines<<" factor : CONST_INT "<<"\n\n";
+		outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-		(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"fctr");
-		(yyval)->setvartype("int");
+		yyval = new symbol_info(yyvsp[0]->getname(),"fctr");
+		yyval->setvartype("int");
 		
 		// Create AST node for integer constant
-		ConstNode* intNode = new ConstNode((yyvsp[(1) - (1)])->getname(), "int");
-		(yyval)->set_ast_node(intNode);
+		ConstNode* intNode = new ConstNode(yyvsp[0]->getname(), "int");
+		yyval->set_ast_node(intNode);
+		yyval->set_flat_node(flat_ast.constant(yyvsp[0]->getname(), "int"));
 	}
+#line 2838 "y.tab.c"
     break;
 
-  case 62:
-/* Line 1792 of yacc.c  */
-#line 1208 "22101088_22101357.y"
-    {
-	    outlog<<"At line no: "<<lines<<" factor : CONST_FLOAT "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 62: /* factor: CONST_FLOAT  */
+#line 1322 "22101088_22101357.y"
+        {
+	    outlog<<"At line no: "<<lines<<" factor : CONST_FLOAT "<<"\n\n";
+		outlog<<yyvsp[0]->getname()<<"\n\n";
 			
-		(yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"fctr");
-		(yyval)->setvartype("float");
+		yyval = new symbol_info(yyvsp[0]->getname(),"fctr");
+		yyval->setvartype("float");
 		
 		// Create AST node for float constant
-		ConstNode* floatNode = new ConstNode((yyvsp[(1) - (1)])->getname(), "float");
-		(yyval)->set_ast_node(floatNode);
+		ConstNode* floatNode = new ConstNode(yyvsp[0]->getname(), "float");
+		yyval->set_ast_node(floatNode);
+		yyval->set_flat_node(flat_ast.constant(yyvsp[0]->getname(), "float"));
 	}
+#line 2855 "y.tab.c"
     break;
 
-  case 63:
-/* Line 1792 of yacc.c  */
-#line 1220 "22101088_22101357.y"
-    {
-	    outlog<<"At line no: "<<lines<<" factor : variable INCOP "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (2)])->getname()<<"++"<<endl<<endl;
+  case 63: /* factor: variable INCOP  */
+#line 1335 "22101088_22101357.y"
+        {
+	    outlog<<"At line no: "<<lines<<" factor : variable INCOP "<<"\n\n";
+		outlog<<yyvsp[-1]->getname()<<"++"<<"\n\n";
 			
-		(yyval) = new symbol_info((yyvsp[(1) - (2)])->getname()+"++","fctr");
-		(yyval)->setvartype((yyvsp[(1) - (2)])->getvartype());
+		yyval = new symbol_info(yyvsp[-1]->getname()+"++","fctr");
+		yyval->setvartype(yyvsp[-1]->getvartype());
 		
 		// Create AST nodes for increment
 		// For x++, equivalent to (x = x + 1)
-		VarNode* varNode = (VarNode*)(yyvsp[(1) - (2)])->get_ast_node();
+		VarNode* varNode = (VarNode*)yyvsp[-1]->get_ast_node();
 		ConstNode* oneNode = new ConstNode("1", "int");
-		BinaryOpNode* addNode = new BinaryOpNode("+", varNode, oneNode, (yyvsp[(1) - (2)])->getvartype());
-		AssignNode* assignNode = new AssignNode(varNode, addNode, (yyvsp[(1) - (2)])->getvartype());
-		(yyval)->set_ast_node(assignNode);
+		BinaryOpNode* addNode = new BinaryOpNode("+", varNode, oneNode, yyvsp[-1]->getvartype());
+		AssignNode* assignNode = new AssignNode(varNode, addNode, yyvsp[-1]->getvartype());
+		yyval->set_ast_node(assignNode);
+		
+		// The flat tree can share the variable without any ownership trouble
+		uint32_t flat_one = flat_ast.constant("1", "int");
+		uint32_t flat_update = flat_ast.binary("+", yyvsp[-1]->get_flat_node(), flat_one, yyvsp[-1]->getvartype());
+		yyval->set_flat_node(flat_ast.assign(yyvsp[-1]->get_flat_node(), flat_update, yyvsp[-1]->getvartype()));
 	}
+#line 2880 "y.tab.c"
     break;
 
-  case 64:
-/* Line 1792 of yacc.c  */
-#line 1236 "22101088_22101357.y"
-    {
-	    outlog<<"At line no: "<<lines<<" factor : variable DECOP "<<endl<<endl;
-		outlog<<(yyvsp[(1) - (2)])->getname()<<"--"<<endl<<endl;
+  case 64: /* factor: variable DECOP  */
+#line 1356 "22101088_22101357.y"
+        {
+	    outlog<<"At line no: "<<lines<<" factor : variable DECOP "<<"\n\n";
+		outlog<<yyvsp[-1]->getname()<<"--"<<"\n\n";
 			
-		(yyval) = new symbol_info((yyvsp[(1) - (2)])->getname()+"--","fctr");
-		(yyval)->setvartype((yyvsp[(1) - (2)])->getvartype());
+		yyval = new symbol_info(yyvsp[-1]->getname()+"--","fctr");
+		yyval->setvartype(yyvsp[-1]->getvartype());
 		
 		// Create AST nodes for decrement
 		// For x--, equivalent to (x = x - 1)
-		VarNode* varNode = (VarNode*)(yyvsp[(1) - (2)])->get_ast_node();
+		VarNode* varNode = (VarNode*)yyvsp[-1]->get_ast_node();
 		ConstNode* oneNode = new ConstNode("1", "int");
-		BinaryOpNode* subNode = new BinaryOpNode("-", varNode, oneNode, (yyvsp[(1) - (2)])->getvartype());
-		AssignNode* assignNode = new AssignNode(varNode, subNode, (yyvsp[(1) - (2)])->getvartype());
-		(yyval)->set_ast_node(assignNode);
+		BinaryOpNode* subNode = new BinaryOpNode("-", varNode, oneNode, yyvsp[-1]->getvartype());
+		AssignNode* assignNode = new AssignNode(varNode, subNode, yyvsp[-1]->getvartype());
+		yyval->set_ast_node(assignNode);
+		
+		// The flat tree can share the variable without any ownership trouble
+		uint32_t flat_one = flat_ast.constant("1", "int");
+		uint32_t flat_update = flat_ast.binary("-", yyvsp[-1]->get_flat_node(), flat_one, yyvsp[-1]->getvartype());
+		yyval->set_flat_node(flat_ast.assign(yyvsp[-1]->get_flat_node(), flat_update, yyvsp[-1]->getvartype()));
 	}
+#line 2905 "y.tab.c"
     break;
 
-  case 65:
-/* Line 1792 of yacc.c  */
-#line 1254 "22101088_22101357.y"
-    {
-                    outlog<<"At line no: "<<lines<<" argument_list : arguments "<<endl<<endl;
-                    outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 65: /* argument_list: arguments  */
+#line 1379 "22101088_22101357.y"
+              {
+                    outlog<<"At line no: "<<lines<<" argument_list : arguments "<<"\n\n";
+                    outlog<<yyvsp[0]->getname()<<"\n\n";
                         
-                    (yyval) = (yyvsp[(1) - (1)]); // Pass through the arguments node
+                    yyval = yyvsp[0]; // Pass through the arguments node
               }
+#line 2916 "y.tab.c"
     break;
 
-  case 66:
-/* Line 1792 of yacc.c  */
-#line 1261 "22101088_22101357.y"
-    {
-                    outlog<<"At line no: "<<lines<<" argument_list :  "<<endl<<endl;
-                    outlog<<""<<endl<<endl;
+  case 66: /* argument_list: %empty  */
+#line 1386 "22101088_22101357.y"
+              {
+                    outlog<<"At line no: "<<lines<<" argument_list :  "<<"\n\n";
+                    outlog<<""<<"\n\n";
                         
-                    (yyval) = new symbol_info("","arg_list");
+                    yyval = new symbol_info("","arg_list");
                     // Create empty arguments node
                     ArgumentsNode* args = new ArgumentsNode();
-                    (yyval)->set_ast_node(args);
+                    yyval->set_ast_node(args);
+                    yyval->set_flat_node(flat_ast.args());
               }
+#line 2931 "y.tab.c"
     break;
 
-  case 67:
-/* Line 1792 of yacc.c  */
-#line 1273 "22101088_22101357.y"
-    {
-                outlog<<"At line no: "<<lines<<" arguments : arguments COMMA logic_expression "<<endl<<endl;
-                outlog<<(yyvsp[(1) - (3)])->getname()<<","<<(yyvsp[(3) - (3)])->getname()<<endl<<endl;
+  case 67: /* arguments: arguments COMMA logic_expression  */
+#line 1399 "22101088_22101357.y"
+          {
+                outlog<<"At line no: "<<lines<<" arguments : arguments COMMA logic_expression "<<"\n\n";
+                outlog<<yyvsp[-2]->getname()<<","<<yyvsp[0]->getname()<<"\n\n";
                         
-                (yyval) = new symbol_info((yyvsp[(1) - (3)])->getname()+","+(yyvsp[(3) - (3)])->getname(),"arg");
+                yyval = new symbol_info(yyvsp[-2]->getname()+","+yyvsp[0]->getname(),"arg");
                 
                 // Get existing arguments node or create new one
-                ArgumentsNode* args;
-                if ((yyvsp[(1) - (3)])->get_ast_node()) {
-                    args = dynamic_cast<ArgumentsNode*>((yyvsp[(1) - (3)])->get_ast_node());
-                } else {
+                ArgumentsNode* args = ast_cast<ArgumentsNode>(yyvsp[-2]->get_ast_node());
+                if (!args) {
                     args = new ArgumentsNode();
                 }
                 
                 // Add the new argument
-                if ((yyvsp[(3) - (3)])->get_ast_node()) {
-                    args->add_argument(dynamic_cast<ExprNode*>((yyvsp[(3) - (3)])->get_ast_node()));
+                if (yyvsp[0]->get_ast_node()) {
+                    args->add_argument(ast_cast<ExprNode>(yyvsp[0]->get_ast_node()));
                 }
                 
-                (yyval)->set_ast_node(args);
-                arglist.push_back((yyvsp[(3) - (3)])->getvartype());
+                yyval->set_ast_node(args);
+                flat_ast.append(yyvsp[-2]->get_flat_node(), yyvsp[0]->get_flat_node());
+                yyval->set_flat_node(yyvsp[-2]->get_flat_node());
+                arglist.push_back(yyvsp[0]->getvartype());
           }
+#line 2958 "y.tab.c"
     break;
 
-  case 68:
-/* Line 1792 of yacc.c  */
-#line 1296 "22101088_22101357.y"
-    {
-                outlog<<"At line no: "<<lines<<" arguments : logic_expression "<<endl<<endl;
-                outlog<<(yyvsp[(1) - (1)])->getname()<<endl<<endl;
+  case 68: /* arguments: logic_expression  */
+#line 1422 "22101088_22101357.y"
+          {
+                outlog<<"At line no: "<<lines<<" arguments : logic_expression "<<"\n\n";
+                outlog<<yyvsp[0]->getname()<<"\n\n";
                         
-                (yyval) = new symbol_info((yyvsp[(1) - (1)])->getname(),"arg");
+                yyval = new symbol_info(yyvsp[0]->getname(),"arg");
                 
                 // Create a new arguments node with single argument
                 ArgumentsNode* args = new ArgumentsNode();
-                if ((yyvsp[(1) - (1)])->get_ast_node()) {
-                    args->add_argument(dynamic_cast<ExprNode*>((yyvsp[(1) - (1)])->get_ast_node()));
+                if (yyvsp[0]->get_ast_node()) {
+                    args->add_argument(ast_cast<ExprNode>(yyvsp[0]->get_ast_node()));
                 }
                 
-                (yyval)->set_ast_node(args);
-                arglist.push_back((yyvsp[(1) - (1)])->getvartype());
+                yyval->set_ast_node(args);
+                uint32_t flat_args = flat_ast.args();
+                flat_ast.append(flat_args, yyvsp[0]->get_flat_node());
+                yyval->set_flat_node(flat_args);
+                arglist.push_back(yyvsp[0]->getvartype());
           }
+#line 2981 "y.tab.c"
     break;
 
 
-/* Line 1792 of yacc.c  */
-#line 3049 "y.tab.c"
+#line 2985 "y.tab.c"
+
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -3059,96 +2996,58 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
-	 error, discard it.  */
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
     }
 
   /* Else will try to reuse lookahead token after shifting the error
@@ -3160,14 +3059,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -3180,29 +3078,30 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
 
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -3214,7 +3113,7 @@ yyerrlab1:
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -3225,26 +3124,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
-yyreturn:
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -3253,89 +3156,578 @@ yyreturn:
       yydestruct ("Cleanup: discarding lookahead",
                   yytoken, &yylval);
     }
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
-}
 
+  return yyresult;
+}
 
-/* Line 2055 of yacc.c  */
-#line 1314 "22101088_22101357.y"
+#line 1443 "22101088_22101357.y"
 
 
-int main(int argc, char *argv[])
+// Puts the parser/scanner globals back to their startup values so one process
+// can compile several inputs in a row (batch mode)
+void reset_compiler_state()
 {
-	if(argc != 2) 
-	{
-		cout<<"Please input file name"<<endl;
-		return 0;
-	}
-	yyin = fopen(argv[1], "r");
-	outlog.open("log.txt", ios::trunc);
-	outerror.open("error.txt", ios::trunc);
-	outcode.open("code.txt", ios::trunc);
+	delete symtbl;
+	symtbl = new symbol_table();
+	// ast_delete frees the variable x++ shares between the assignment and
+	// the addition only once
+	ast_delete(ast_root);
+	ast_root = new ProgramNode();
+	flat_ast.clear();
+	
+	lines = 1;
+	errors = 0;
+	
+	varlist = "";
+	paramlist.clear();
+	paramname.clear();
+	arglist.clear();
+	is_func = 0;
+	ret_type = "";
+	func_name = "";
+	func_ret_type = "";
+	
+	temp_cond = "";
+	var_last_loaded_temp.clear();
+	var_last_assigned_temp.clear();
+}
 
-	if(yyin == NULL)
-	{
-		cout<<"Couldn't open file"<<endl;
-		return 0;
-	}
+// Filled in by run_passes for the library API
+CompileStats pass_stats;
+
+// Runs both passes over whatever the scanner is currently reading and writes
+// to whatever outlog/outerror/outcode are attached to. Returns the error count.
+int run_passes(const string& code_name, bool quiet)
+{
+	auto start = chrono::steady_clock::now();
+	pass_stats = CompileStats();
 	
 	// First pass: Parse the input and build AST
-	cout << "==== Pass 1: Parsing input and building AST ====" << endl;
-	outlog << "==== Pass 1: Parsing input and building AST ====" << endl;
+	if(!quiet) cout << "==== Pass 1: Parsing input and building AST ====" << endl;
+	outlog << "==== Pass 1: Parsing input and building AST ====" << "\n";
 	
 	symtbl->enter_scope(outlog);
 	yyparse();
 	
-	outlog << endl << "Symbol Table after first pass:" << endl;
+	outlog << "\n" << "Symbol Table after first pass:" << "\n";
 	symtbl->Print_all_scope(outlog);
 	
+	auto parsed = chrono::steady_clock::now();
+	pass_stats.parse_seconds = chrono::duration<double>(parsed - start).count();
+	
 	// Only proceed to second pass if no errors
 	if (errors == 0 && ast_root) {
-		cout << "==== Pass 2: Generating Three-Address Code from AST ====" << endl;
-		outlog << endl << "==== Pass 2: Generating Three-Address Code from AST ====" << endl;
+		if(!quiet) cout << "==== Pass 2: Generating Three-Address Code from AST ====" << endl;
+		outlog << "\n" << "==== Pass 2: Generating Three-Address Code from AST ====" << "\n";
 		
 		// Generate three-address code (second pass)
-		outlog << "Generating Three-Address Code..." << endl;
-		ThreeAddrCodeGenerator tacGen(ast_root, outcode);
-		tacGen.generate();
+		outlog << "Generating Three-Address Code..." << "\n";
+		// The enabled passes, ending with code generation (ast_passes.h)
+		AstPassContext context = {outlog, outcode, lower_flat_ast ? &flat_ast : NULL};
+		ast_passes().run(ast_root, context);
 		
-		outlog << "Three-Address Code Generation Complete" << endl;
-		cout << "Three-Address Code Generation Complete. Output written to code.txt" << endl;
+		outlog << "Three-Address Code Generation Complete" << "\n";
+		if(!quiet) cout << "Three-Address Code Generation Complete. Output written to " << code_name << endl;
 	} else {
-		cout << "Three-Address Code generation skipped due to errors" << endl;
-		outlog << endl << "Three-Address Code generation skipped due to errors" << endl;
-		outcode << "// Three-Address Code generation failed due to errors" << endl;
+		if(!quiet) cout << "Three-Address Code generation skipped due to errors" << endl;
+		outlog << "\n" << "Three-Address Code generation skipped due to errors" << "\n";
+		outcode << "// Three-Address Code generation failed due to errors" << "\n";
 	}
 	
-	outlog<<endl<<"Total lines: "<<lines<<endl;
-	outlog<<"Total errors: "<<errors<<endl;
-	outerror<<"Total errors: "<<errors<<endl;
+	outlog<<"\n"<<"Total lines: "<<lines<<"\n";
+	outlog<<"Total errors: "<<errors<<"\n";
+	outerror<<"Total errors: "<<errors<<"\n";
 	
-	outlog.close();
-	outerror.close();
-	outcode.close();
+	pass_stats.codegen_seconds = chrono::duration<double>(chrono::steady_clock::now() - parsed).count();
+	pass_stats.lines = lines;
+	pass_stats.errors = errors;
+	return errors;
+}
+
+// Where the bytecode for code_path goes: code.txt -> code.bin
+string bytecode_path(const string& code_path)
+{
+	if(code_path.size() > 4 && code_path.compare(code_path.size() - 4, 4, ".txt") == 0)
+		return code_path.substr(0, code_path.size() - 4) + ".bin";
+	return code_path + ".bin";
+}
 
+// Reorders the blocks of the TAC just written to code_path for pgo_profile
+void apply_block_layout(const string& code_path, bool quiet)
+{
+	string summary, error;
+	if(!layout_tac_file(code_path, pgo_profile, summary, error))
+	{
+		if(!quiet) cout<<"Block layout skipped: "<<error<<endl;
+		return;
+	}
+	if(!quiet) cout<<"Block layout: "<<summary<<endl;
+}
+
+// Encodes the TAC just written to code_path as bytecode beside it
+void write_bytecode(const string& code_path, bool quiet)
+{
+	ifstream in(code_path.c_str(), ios::binary);
+	stringstream text;
+	text << in.rdbuf();
+	
+	string error;
+	string bytecode = tac_text_to_bytecode(text.str(), error);
+	string path = bytecode_path(code_path);
+	if(bytecode.empty() || !save_tac_bytecode(bytecode, path, error))
+	{
+		if(!quiet) cout<<"Couldn't write bytecode: "<<error<<endl;
+		return;
+	}
+	if(!quiet) cout<<"Bytecode written to "<<path<<endl;
+}
+
+// Runs both passes on one input file and writes the log, error and code files.
+// Returns the number of errors found, or -1 if the input couldn't be opened.
+int compile_file(const char *input, const string& log_path, const string& error_path, const string& code_path, bool quiet)
+{
+	MappedSource mapped;
+	bool opened;
+	if(scan_mapped) opened = mapped.open(input);
+	else opened = (yyin = fopen(input, "r")) != NULL;
+	
+	log_out.open(log_path);
+	error_out.open(error_path);
+	code_out.open(code_path);
+	outlog.rdbuf(&log_out);
+	outerror.rdbuf(&error_out);
+	outcode.rdbuf(&code_out);
+
+	int result = -1;
+	if(!opened)
+	{
+		if(!quiet) cout<<"Couldn't open file"<<endl;
+	}
+	else if(scan_mapped)
+	{
+		YY_BUFFER_STATE scan = yy_scan_buffer(mapped.data(), mapped.scan_size());
+		result = run_passes(code_path, quiet);
+		yy_delete_buffer(scan);
+	}
+	else
+	{
+		yyrestart(yyin);
+		result = run_passes(code_path, quiet);
+		fclose(yyin);
+		yyin = NULL;
+	}
+	
+	// The only flush point: everything goes out here
+	log_out.close();
+	error_out.close();
+	code_out.close();
+	
+	if(!pgo_profile.empty() && result == 0) apply_block_layout(code_path, quiet);
+	if(emit_bytecode && result == 0) write_bytecode(code_path, quiet);
+	
+	return result;
+}
+
+// Generates code from a flat tree saved with --emit-ast instead of a source
+// file: no scanning or parsing, and the tree is lowered straight from the
+// mapped file. Returns 0, or -1 if the file couldn't be used.
+int compile_ast_file(const char *input, const string& code_path, bool quiet)
+{
+	auto start = chrono::steady_clock::now();
+	FlatAstFile file;
+	string error;
+	if(!file.open(input, error))
+	{
+		if(!quiet) cout<<"Couldn't load the tree: "<<error<<endl;
+		return -1;
+	}
+	auto mapped = chrono::steady_clock::now();
 	
-	fclose(yyin);
+	code_out.open(code_path);
+	outcode.rdbuf(&code_out);
+	temp_cond = "";
+	var_last_loaded_temp.clear();
+	var_last_assigned_temp.clear();
+	ThreeAddrCodeGenerator(file.view(), outcode).generate();
+	code_out.close();
 	
+	if(!quiet)
+	{
+		cout<<"Loaded "<<file.view().size()<<" nodes ("<<file.bytes()<<" bytes) in "
+			<<chrono::duration<double>(mapped - start).count() * 1000<<" ms, lowered in "
+			<<chrono::duration<double>(chrono::steady_clock::now() - mapped).count() * 1000<<" ms. Output written to "<<code_path<<endl;
+	}
+	if(!pgo_profile.empty()) apply_block_layout(code_path, quiet);
+	if(emit_bytecode) write_bytecode(code_path, quiet);
 	return 0;
-}
\ No newline at end of file
+}
+
+// Everything besides the source that changes what compile_file writes
+string compile_settings()
+{
+	string settings = "passes=" + ast_passes().enabled_names();
+	settings += string(";flat=") + (lower_flat_ast ? "1" : "0");
+	settings += string(";bytecode=") + (emit_bytecode ? "1" : "0");
+	if(!pgo_profile.empty())
+	{
+		ifstream in(pgo_profile.c_str(), ios::binary);
+		stringstream profile;
+		profile << in.rdbuf();
+		settings += ";pgo=" + to_string(fnv1a(profile.str()));
+	}
+	return settings;
+}
+
+// compile_file through the cache in cache_dir: a hit writes the stored
+// outputs instead of compiling, a miss compiles and stores them
+int compile_file_cached(const char *input, const string& log_path, const string& error_path, const string& code_path, bool quiet)
+{
+	CompileCache cache((size_t)cache_max_mb << 20);
+	string error;
+	ifstream in(input, ios::binary);
+	if(!in || !cache.open(cache_dir, error))
+	{
+		if(!quiet && in) cout<<"Not caching: "<<error<<endl;
+		return compile_file(input, log_path, error_path, code_path, quiet);
+	}
+	stringstream source;
+	source << in.rdbuf();
+	in.close();
+	
+	auto start = chrono::steady_clock::now();
+	string text = source.str(), settings = compile_settings();
+	string key = cache.key(text, settings);
+	vector<CachedOutput> outputs;
+	int result;
+	if(cache.load(key, text, settings, outputs, result))
+	{
+		for(const CachedOutput& output : outputs)
+		{
+			ofstream out(output.name.c_str(), ios::binary | ios::trunc);
+			out.write(output.bytes.data(), output.bytes.size());
+			out.close();
+			if(!out)
+			{
+				// The compile writes the outputs itself, or reports why it can't
+				if(!quiet) cout<<"Cache hit not restored, couldn't write "<<output.name<<endl;
+				return compile_file(input, log_path, error_path, code_path, quiet);
+			}
+		}
+		if(!quiet)
+		{
+			cout<<"Cache hit: "<<outputs.size()<<" outputs restored from "<<cache_dir<<" in "
+				<<chrono::duration<double>(chrono::steady_clock::now() - start).count() * 1000<<" ms"<<endl;
+		}
+		return result;
+	}
+	
+	result = compile_file(input, log_path, error_path, code_path, quiet);
+	vector<string> paths = {log_path, error_path, code_path};
+	if(emit_bytecode && result == 0) paths.push_back(bytecode_path(code_path));
+	for(const string& path : paths)
+	{
+		ifstream file(path.c_str(), ios::binary);
+		if(!file) return result; // nothing to store if an output is missing
+		stringstream bytes;
+		bytes << file.rdbuf();
+		outputs.push_back({path, bytes.str()});
+	}
+	if(!cache.store(key, text, settings, outputs, result, error) && !quiet) cout<<"Not cached: "<<error<<endl;
+	return result;
+}
+
+mutex compile_lock;
+
+CompileResult compile_in_place(char* buffer, size_t size, const CompileOptions& options)
+{
+	lock_guard<mutex> guard(compile_lock);
+	CompileResult result;
+	
+	// Outputs without a caller sink go straight into the result strings
+	if(options.code_sink) code_out.attach(options.code_sink->rdbuf());
+	else code_out.attach(&result.tac);
+	if(options.error_sink) error_out.attach(options.error_sink->rdbuf());
+	else error_out.attach(&result.errors);
+	if(options.log_sink) log_out.attach(options.log_sink->rdbuf());
+	else log_out.attach(&result.log);
+	outcode.rdbuf(&code_out);
+	outerror.rdbuf(&error_out);
+	outlog.rdbuf(options.generate_log ? &log_out : NULL);
+	
+	reset_compiler_state();
+	int errs = -1;
+	YY_BUFFER_STATE scan = yy_scan_buffer(buffer, size);
+	if(scan == NULL)
+	{
+		outerror << "Source buffer is not terminated by two NUL bytes\n";
+	}
+	else
+	{
+		errs = run_passes("", true);
+		yy_delete_buffer(scan);
+	}
+	
+	// Every path ends here, so each sink gets its text and is let go
+	log_out.close();
+	error_out.close();
+	code_out.close();
+	if(errs < 0) return result;
+	
+	result.ok = errs == 0;
+	if(result.ok && options.generate_bytecode && !options.code_sink)
+	{
+		string error;
+		result.bytecode = tac_text_to_bytecode(result.tac, error);
+	}
+	result.stats = pass_stats;
+	result.stats.source_bytes = size - 2;
+	return result;
+}
+
+CompileResult compile(string_view source, const CompileOptions& options)
+{
+	// yy_scan_buffer wants a writable buffer ending in two NULs; keep one
+	// around per thread so repeated calls don't allocate
+	thread_local vector<char> buffer;
+	buffer.assign(source.begin(), source.end());
+	buffer.push_back('\0');
+	buffer.push_back('\0');
+	return compile_in_place(buffer.data(), buffer.size(), options);
+}
+
+bool lex_source(string_view source, vector<SourceToken>& tokens)
+{
+	lock_guard<mutex> guard(compile_lock);
+	thread_local vector<char> buffer;
+	buffer.assign(source.begin(), source.end());
+	buffer.push_back('\0');
+	buffer.push_back('\0');
+	tokens.clear();
+	YY_BUFFER_STATE scan = yy_scan_buffer(buffer.data(), buffer.size());
+	if(scan == NULL) return false;
+	int saved_lines = lines;
+	for(;;)
+	{
+		yylval = NULL;
+		int token = yylex();
+		delete yylval;
+		if(token == 0) break;
+		SourceToken t;
+		switch(token)
+		{
+			case INT: case FLOAT: case VOID: t.kind = SRC_TYPE; break;
+			case ID: t.kind = SRC_ID; break;
+			case LPAREN: t.kind = SRC_LPAREN; break;
+			case RPAREN: t.kind = SRC_RPAREN; break;
+			case LCURL: t.kind = SRC_LCURL; break;
+			case RCURL: t.kind = SRC_RCURL; break;
+			case SEMICOLON: t.kind = SRC_SEMICOLON; break;
+			default: t.kind = SRC_OTHER; break;
+		}
+		t.begin = yytext - buffer.data();
+		t.end = t.begin + yyleng;
+		tokens.push_back(t);
+	}
+	yylval = NULL;
+	lines = saved_lines;
+	yy_delete_buffer(scan);
+	return true;
+}
+
+#ifndef COMPILER_LIBRARY
+int main(int argc, char *argv[])
+{
+	if(argc >= 2 && string(argv[1]) == "--batch")
+	{
+		return run_batch(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--serve")
+	{
+		if(argc != 3)
+		{
+			cout<<"Usage: "<<argv[0]<<" --serve SOCKET"<<endl;
+			return 1;
+		}
+		CompileServer server(argv[2]);
+		return server.run();
+	}
+	if(argc >= 2 && string(argv[1]) == "--client")
+	{
+		return run_client(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--loadgen")
+	{
+		return run_loadgen(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--run")
+	{
+		return run_tac(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--bench-dispatch")
+	{
+		return run_dispatch_bench(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--bench-load")
+	{
+		return run_load_bench(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--native")
+	{
+		return run_native(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--jit")
+	{
+		return run_jit_bench(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--native-c")
+	{
+		return run_native_c(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--profile")
+	{
+		return run_profile(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--census")
+	{
+		return run_census(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--bench-ast")
+	{
+		return run_ast_bench(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--stress-depth")
+	{
+		return run_depth_stress(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--generate")
+	{
+		return run_generate(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--watch")
+	{
+		return run_watch(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--incremental")
+	{
+		if(argc < 3)
+		{
+			cout<<"Usage: "<<argv[0]<<" --incremental FILE..."<<endl;
+			return 1;
+		}
+		return run_incremental(argc, argv);
+	}
+	if(argc >= 2 && string(argv[1]) == "--list-passes")
+	{
+		cout<<"AST passes, in the order they run:"<<endl;
+		ast_passes().write_passes(cout);
+		return 0;
+	}
+	
+	while(argc >= 2 && (string(argv[1]) == "--mmap" || string(argv[1]) == "--bytecode" || string(argv[1]) == "--pgo" || string(argv[1]) == "--flat-ast"
+		|| string(argv[1]) == "--pass" || string(argv[1]) == "--no-pass" || string(argv[1]) == "--time-passes"
+		|| string(argv[1]) == "--emit-ast" || string(argv[1]) == "--cache" || string(argv[1]) == "--cache-size"))
+	{
+		// An option that takes a value needs it and the input file after it
+		string option = argv[1];
+		const char *value = option == "--pgo" || option == "--emit-ast" ? "FILE" : option == "--cache" ? "DIR"
+			: option == "--cache-size" ? "MB" : option == "--pass" || option == "--no-pass" ? "NAME" : NULL;
+		if(value && argc < 4)
+		{
+			cout<<"Usage: "<<argv[0]<<" "<<option<<" "<<value<<" [options] file"<<endl;
+			return 1;
+		}
+		if(string(argv[1]) == "--pgo")
+		{
+			pgo_profile = argv[2];
+			argv++;
+			argc--;
+		}
+		else if(string(argv[1]) == "--emit-ast")
+		{
+			emit_ast_path = argv[2];
+			flat_ast.enabled = true;
+			argv++;
+			argc--;
+		}
+		else if(string(argv[1]) == "--cache")
+		{
+			cache_dir = argv[2];
+			argv++;
+			argc--;
+		}
+		else if(string(argv[1]) == "--cache-size")
+		{
+			cache_max_mb = strtoul(argv[2], NULL, 10);
+			argv++;
+			argc--;
+		}
+		else if(string(argv[1]) == "--pass" || string(argv[1]) == "--no-pass")
+		{
+			if(!ast_passes().set_enabled(argv[2], string(argv[1]) == "--pass"))
+			{
+				cout<<"No pass named "<<argv[2]<<" (see --list-passes)"<<endl;
+				return 1;
+			}
+			argv++;
+			argc--;
+		}
+		else if(string(argv[1]) == "--mmap") scan_mapped = true;
+		else if(string(argv[1]) == "--bytecode") emit_bytecode = true;
+		else if(string(argv[1]) == "--flat-ast") lower_flat_ast = flat_ast.enabled = true;
+		else if(string(argv[1]) == "--time-passes") time_passes = true;
+		argv++;
+		argc--;
+	}
+	
+	// Code from the flat tree, or a saved one, would silently miss a rewrite
+	// of the node tree
+	const char *rewriter = ast_passes().tree_rewriter();
+	if(rewriter && (lower_flat_ast || !emit_ast_path.empty()))
+	{
+		cout<<"The "<<rewriter<<" pass rewrites the node tree only, so it can't be used with "
+			<<(lower_flat_ast ? "--flat-ast" : "--emit-ast")<<endl;
+		return 1;
+	}
+	
+	// A tree saved earlier with --emit-ast stands in for the source
+	if(argc == 3 && string(argv[1]) == "--from-ast")
+	{
+		return compile_ast_file(argv[2], "code.txt", false) == 0 ? 0 : 1;
+	}
+	
+	if(argc != 2) 
+	{
+		cout<<"Please input file name"<<endl;
+		return 0;
+	}
+	
+	// A saved tree comes from the parse, so --emit-ast always compiles
+	int result;
+	if(!cache_dir.empty() && emit_ast_path.empty()) result = compile_file_cached(argv[1], "log.txt", "error.txt", "code.txt", false);
+	else result = compile_file(argv[1], "log.txt", "error.txt", "code.txt", false);
+	if(time_passes) ast_passes().write_timing(cout);
+	if(!emit_ast_path.empty() && result == 0)
+	{
+		string error;
+		if(save_flat_ast(flat_ast, emit_ast_path, error)) cout<<"Tree saved to "<<emit_ast_path<<endl;
+		else cout<<"Tree not saved: "<<error<<endl;
+	}
+	
+	return 0;
+}
+
+#endif // COMPILER_LIBRARY
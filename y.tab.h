@@ -1,21 +1,22 @@
-/* A Bison parser, made by GNU Bison 2.7.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
-   
-      Copyright (C) 1984, 1989-1990, 2000-2012 Free Software Foundation, Inc.
-   
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
    the Free Software Foundation, either version 3 of the License, or
    (at your option) any later version.
-   
+
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
    GNU General Public License for more details.
-   
+
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -26,13 +27,17 @@
    special exception, which will cause the skeleton and the resulting
    Bison output files to be licensed under the GNU General Public
    License without this special exception.
-   
+
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 #ifndef YY_YY_Y_TAB_H_INCLUDED
 # define YY_YY_Y_TAB_H_INCLUDED
-/* Enabling traces.  */
+/* Debug traces.  */
 #ifndef YYDEBUG
 # define YYDEBUG 1
 #endif
@@ -40,52 +45,60 @@
 extern int yydebug;
 #endif
 
-/* Tokens.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     IF = 258,
-     ELSE = 259,
-     FOR = 260,
-     WHILE = 261,
-     DO = 262,
-     BREAK = 263,
-     INT = 264,
-     CHAR = 265,
-     FLOAT = 266,
-     DOUBLE = 267,
-     VOID = 268,
-     RETURN = 269,
-     SWITCH = 270,
-     CASE = 271,
-     DEFAULT = 272,
-     CONTINUE = 273,
-     PRINTLN = 274,
-     ADDOP = 275,
-     MULOP = 276,
-     INCOP = 277,
-     DECOP = 278,
-     RELOP = 279,
-     ASSIGNOP = 280,
-     LOGICOP = 281,
-     NOT = 282,
-     LPAREN = 283,
-     RPAREN = 284,
-     LCURL = 285,
-     RCURL = 286,
-     LTHIRD = 287,
-     RTHIRD = 288,
-     COMMA = 289,
-     SEMICOLON = 290,
-     CONST_INT = 291,
-     CONST_FLOAT = 292,
-     ID = 293,
-     LOWER_THAN_ELSE = 294
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    IF = 258,                      /* IF  */
+    ELSE = 259,                    /* ELSE  */
+    FOR = 260,                     /* FOR  */
+    WHILE = 261,                   /* WHILE  */
+    DO = 262,                      /* DO  */
+    BREAK = 263,                   /* BREAK  */
+    INT = 264,                     /* INT  */
+    CHAR = 265,                    /* CHAR  */
+    FLOAT = 266,                   /* FLOAT  */
+    DOUBLE = 267,                  /* DOUBLE  */
+    VOID = 268,                    /* VOID  */
+    RETURN = 269,                  /* RETURN  */
+    SWITCH = 270,                  /* SWITCH  */
+    CASE = 271,                    /* CASE  */
+    DEFAULT = 272,                 /* DEFAULT  */
+    CONTINUE = 273,                /* CONTINUE  */
+    PRINTLN = 274,                 /* PRINTLN  */
+    ADDOP = 275,                   /* ADDOP  */
+    MULOP = 276,                   /* MULOP  */
+    INCOP = 277,                   /* INCOP  */
+    DECOP = 278,                   /* DECOP  */
+    RELOP = 279,                   /* RELOP  */
+    ASSIGNOP = 280,                /* ASSIGNOP  */
+    LOGICOP = 281,                 /* LOGICOP  */
+    NOT = 282,                     /* NOT  */
+    LPAREN = 283,                  /* LPAREN  */
+    RPAREN = 284,                  /* RPAREN  */
+    LCURL = 285,                   /* LCURL  */
+    RCURL = 286,                   /* RCURL  */
+    LTHIRD = 287,                  /* LTHIRD  */
+    RTHIRD = 288,                  /* RTHIRD  */
+    COMMA = 289,                   /* COMMA  */
+    SEMICOLON = 290,               /* SEMICOLON  */
+    CONST_INT = 291,               /* CONST_INT  */
+    CONST_FLOAT = 292,             /* CONST_FLOAT  */
+    ID = 293,                      /* ID  */
+    LOWER_THAN_ELSE = 294          /* LOWER_THAN_ELSE  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
 #define IF 258
 #define ELSE 259
 #define FOR 260
@@ -124,29 +137,18 @@ extern int yydebug;
 #define ID 293
 #define LOWER_THAN_ELSE 294
 
-
-
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 typedef int YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
+
 extern YYSTYPE yylval;
 
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM);
-#else
-int yyparse ();
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
+
 int yyparse (void);
-#else
-int yyparse ();
-#endif
-#endif /* ! YYPARSE_PARAM */
+
 
 #endif /* !YY_YY_Y_TAB_H_INCLUDED  */